@@ -0,0 +1,213 @@
+#include "baldr/contractionhierarchy.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <boost/filesystem/operations.hpp>
+
+namespace {
+
+// Find the arc with the given vertex
+const valhalla::baldr::ContractionArc* find_arc(
+    const std::pair<const valhalla::baldr::ContractionArc*,
+                    const valhalla::baldr::ContractionArc*>& arcs,
+    const uint32_t vertex) {
+  auto arc = std::find_if(arcs.first, arcs.second,
+    [vertex](const valhalla::baldr::ContractionArc& a) {
+      return a.vertex == vertex;
+    });
+  if (arc == arcs.second) {
+    throw std::runtime_error("Contraction hierarchy is missing a shortcut arc");
+  }
+  return arc;
+}
+
+}
+
+namespace valhalla {
+namespace baldr {
+
+// Constructor of an empty hierarchy
+ContractionHierarchy::ContractionHierarchy()
+    : header_(nullptr),
+      tiles_(nullptr),
+      ranks_(nullptr),
+      up_offsets_(nullptr),
+      up_arcs_(nullptr),
+      down_offsets_(nullptr),
+      down_arcs_(nullptr) {
+}
+
+// Constructor. Maps the file and finds the sections within it.
+ContractionHierarchy::ContractionHierarchy(const std::string& file_name)
+    : ContractionHierarchy() {
+  size_t size = boost::filesystem::file_size(file_name);
+  if (size < sizeof(ContractionHeader)) {
+    throw std::runtime_error(file_name + " is not a contraction hierarchy");
+  }
+  file_.map(file_name, size, true);
+  header_ = reinterpret_cast<const ContractionHeader*>(file_.get());
+  if (std::memcmp(header_->magic, kContractionMagic, sizeof(kContractionMagic)) != 0 ||
+      header_->version != kContractionVersion) {
+    throw std::runtime_error(file_name + " is not a contraction hierarchy of a supported version");
+  }
+
+  // The ranks are padded to keep the offsets that follow aligned. The arcs
+  // come last as they are not a multiple of 8 bytes.
+  uint64_t vertices = header_->vertex_count;
+  size_t expected = sizeof(ContractionHeader) +
+      header_->tile_count * sizeof(ContractionTile) +
+      (vertices + (vertices & 1)) * sizeof(uint32_t) +
+      2 * (vertices + 1) * sizeof(uint64_t) +
+      (header_->up_arc_count + header_->down_arc_count) * sizeof(ContractionArc);
+  if (size != expected) {
+    throw std::runtime_error(file_name + " has an unexpected size");
+  }
+
+  const char* p = file_.get() + sizeof(ContractionHeader);
+  tiles_ = reinterpret_cast<const ContractionTile*>(p);
+  p += header_->tile_count * sizeof(ContractionTile);
+  ranks_ = reinterpret_cast<const uint32_t*>(p);
+  p += (vertices + (vertices & 1)) * sizeof(uint32_t);
+  up_offsets_ = reinterpret_cast<const uint64_t*>(p);
+  p += (vertices + 1) * sizeof(uint64_t);
+  down_offsets_ = reinterpret_cast<const uint64_t*>(p);
+  p += (vertices + 1) * sizeof(uint64_t);
+  up_arcs_ = reinterpret_cast<const ContractionArc*>(p);
+  p += header_->up_arc_count * sizeof(ContractionArc);
+  down_arcs_ = reinterpret_cast<const ContractionArc*>(p);
+}
+
+// Get the name of the contraction file within the tile directory
+std::string ContractionHierarchy::FileName(const std::string& tile_dir) {
+  return tile_dir + "/contraction.bin";
+}
+
+// Get a fingerprint of the tiles of the routing levels. Combines the id,
+// the directed edge count, the size and the dataset of each tile in order.
+uint64_t ContractionHierarchy::TileFingerprint(GraphReader& reader) {
+  auto combine = [](uint64_t& hash, const uint64_t value) {
+    hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+  };
+  uint64_t hash = 0;
+  for (const auto& level : TileHierarchy::levels()) {
+    for (uint32_t id = 0; id < level.second.tiles.TileCount(); id++) {
+      GraphId tile_id(id, level.second.level, 0);
+      if (!reader.DoesTileExist(tile_id)) {
+        continue;
+      }
+      if (reader.OverCommitted()) {
+        reader.Clear();
+      }
+      const GraphTile* tile = reader.GetGraphTile(tile_id);
+      if (tile == nullptr) {
+        continue;
+      }
+      combine(hash, tile_id.value);
+      combine(hash, tile->header()->directededgecount());
+      combine(hash, tile->header()->end_offset());
+      combine(hash, tile->header()->dataset_id());
+    }
+  }
+  reader.Clear();
+  return hash;
+}
+
+// Was the hierarchy built from the tiles the reader reads
+bool ContractionHierarchy::Matches(GraphReader& reader) const {
+  return header_ != nullptr && header_->tile_fingerprint == TileFingerprint(reader);
+}
+
+bool ContractionHierarchy::empty() const {
+  return header_ == nullptr;
+}
+
+uint32_t ContractionHierarchy::vertex_count() const {
+  return header_ == nullptr ? 0 : header_->vertex_count;
+}
+
+// Get the vertex of a directed edge
+uint32_t ContractionHierarchy::GetVertex(const GraphId& edgeid) const {
+  if (header_ == nullptr) {
+    return kInvalidVertex;
+  }
+  uint64_t tile = edgeid.Tile_Base().value;
+  const ContractionTile* end = tiles_ + header_->tile_count;
+  const ContractionTile* t = std::lower_bound(tiles_, end, tile,
+    [](const ContractionTile& a, const uint64_t b) { return a.tile < b; });
+  if (t == end || t->tile != tile || edgeid.id() >= t->count) {
+    return kInvalidVertex;
+  }
+  return t->first + edgeid.id();
+}
+
+// Get the directed edge of a vertex
+GraphId ContractionHierarchy::GetEdgeId(const uint32_t vertex) const {
+  const ContractionTile* end = tiles_ + header_->tile_count;
+  const ContractionTile* t = std::upper_bound(tiles_, end, vertex,
+    [](const uint32_t a, const ContractionTile& b) { return a < b.first; });
+  --t;
+  GraphId tileid(t->tile);
+  return { tileid.tileid(), tileid.level(), vertex - t->first };
+}
+
+// Get the vertices of a tile, they are consecutive
+std::pair<uint32_t, uint32_t> ContractionHierarchy::GetTileVertices(
+        const GraphId& tileid) const {
+  if (header_ == nullptr) {
+    return { 0, 0 };
+  }
+  uint64_t tile = tileid.Tile_Base().value;
+  const ContractionTile* end = tiles_ + header_->tile_count;
+  const ContractionTile* t = std::lower_bound(tiles_, end, tile,
+    [](const ContractionTile& a, const uint64_t b) { return a.tile < b; });
+  if (t == end || t->tile != tile) {
+    return { 0, 0 };
+  }
+  return { t->first, t->count };
+}
+
+uint32_t ContractionHierarchy::rank(const uint32_t vertex) const {
+  return ranks_[vertex];
+}
+
+// Get the upward arcs leaving a vertex
+std::pair<const ContractionArc*, const ContractionArc*>
+ContractionHierarchy::UpArcs(const uint32_t vertex) const {
+  return { up_arcs_ + up_offsets_[vertex], up_arcs_ + up_offsets_[vertex + 1] };
+}
+
+// Get the downward arcs entering a vertex
+std::pair<const ContractionArc*, const ContractionArc*>
+ContractionHierarchy::DownArcs(const uint32_t vertex) const {
+  return { down_arcs_ + down_offsets_[vertex],
+           down_arcs_ + down_offsets_[vertex + 1] };
+}
+
+// Expand an arc into transitions. A shortcut from u to v skipping m is
+// the arc from u down to m followed by the arc from m up to v. Uses a
+// stack rather than recursion as long shortcuts can be nested deeply.
+void ContractionHierarchy::Unpack(const uint32_t from, const uint32_t to,
+          const ContractionArc& arc,
+          std::vector<std::pair<uint32_t, const ContractionArc*> >& arcs) const {
+  struct Part {
+    uint32_t from;
+    uint32_t to;
+    const ContractionArc* arc;
+  };
+  std::vector<Part> stack = { { from, to, &arc } };
+  while (!stack.empty()) {
+    Part part = stack.back();
+    stack.pop_back();
+    uint32_t middle = part.arc->middle;
+    if (middle == kInvalidVertex) {
+      arcs.emplace_back(part.to, part.arc);
+    } else {
+      stack.push_back({ middle, part.to, find_arc(UpArcs(middle), part.to) });
+      stack.push_back({ part.from, middle, find_arc(DownArcs(middle), part.from) });
+    }
+  }
+}
+
+}
+}
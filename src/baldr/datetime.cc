@@ -11,6 +11,8 @@
 
 #include "baldr/datetime.h"
 #include "baldr/graphconstants.h"
+#include "baldr/speedprofile.h"
+#include "midgard/constants.h"
 
 #include "date_time_zonespec.h"
 
@@ -654,6 +656,43 @@ std::string get_duration(const std::string& date_time, const uint32_t seconds,
   return formatted_date_time;
 }
 
+// get the seconds elapsed from the start of the week (Sunday at midnight).
+// date_time is in the format of 2015-05-06T08:00
+uint32_t seconds_of_week(const std::string& date_time) {
+  // Ignore any utc offset after the local time
+  std::string local = date_time.substr(0, 16);
+  if (!is_iso_local(local))
+    return kInvalidSecondsOfWeek;
+
+  boost::gregorian::date date = get_formatted_date(local);
+  if (date < pivot_date_)
+    return kInvalidSecondsOfWeek;
+
+  uint32_t seconds = seconds_from_midnight(local);
+  return offset_seconds_of_week(date.day_of_week().as_number() * midgard::kSecondsPerDay, seconds);
+}
+
+// add x seconds to a local date_time and return a local date_time string.
+// date_time is in the format of 2015-05-06T08:00
+std::string offset_date_time(const std::string& date_time, const int32_t seconds) {
+  // Ignore any utc offset after the local time
+  std::string dt = date_time.substr(0, 16);
+  if (!is_iso_local(dt))
+    return "";
+
+  dt.erase(boost::remove_if(dt, boost::is_any_of("-,:")), dt.end());
+  boost::posix_time::ptime start = boost::posix_time::from_iso_string(dt);
+  if (start.is_not_a_date_time() || start.date() < pivot_date_)
+    return "";
+
+  boost::posix_time::ptime end = start + boost::posix_time::seconds(seconds);
+  std::string formatted_date_time = boost::posix_time::to_iso_extended_string(end);
+  std::size_t found = formatted_date_time.find_last_of(":"); // remove seconds.
+  if (found != std::string::npos)
+    formatted_date_time = formatted_date_time.substr(0,found);
+  return formatted_date_time;
+}
+
 // checks if string is in the format of %Y-%m-%dT%H:%M
 bool is_iso_local(const std::string& date_time) {
 
@@ -1,6 +1,7 @@
 #include "baldr/directededge.h"
 #include "baldr/nodeinfo.h"
 #include <boost/functional/hash.hpp>
+#include <algorithm>
 #include "midgard/logging.h"
 
 using namespace valhalla::baldr;
@@ -197,6 +198,19 @@ void DirectedEdge::set_opp_index(const uint32_t opp_index) {
   opp_index_ = opp_index;
 }
 
+// Set the number of nodes that can be reached from the end node of this
+// directed edge. Stored + 1 so that 0 means it is not known.
+void DirectedEdge::set_reach(const uint32_t access, const uint32_t reach) {
+  uint32_t r = std::min(reach, kMaxReach) + 1;
+  if (access == kAutoAccess) {
+    auto_reach_ = r;
+  } else if (access == kPedestrianAccess) {
+    pedestrian_reach_ = r;
+  } else {
+    LOG_WARN("Reach is not stored for access mode: " + std::to_string(access));
+  }
+}
+
 // Sets the type of cycle lane (if any) present on this edge.
 void DirectedEdge::set_cyclelane(const CycleLane cyclelane) {
   cycle_lane_ = static_cast<uint32_t>(cyclelane);
@@ -1,5 +1,7 @@
 #include "baldr/double_bucket_queue.h"
 #include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace valhalla {
 namespace baldr {
@@ -58,13 +60,32 @@ void DoubleBucketQueue::decrease(const uint32_t label, const float newcost) {
   // if old cost and the new cost are in the same buckets.
   bucket_t& prevbucket = get_bucket(labelcost_(label));
   bucket_t& newbucket  = get_bucket(newcost);
-  if (prevbucket != newbucket) {
-    // Add label to newbucket and remove from previous bucket
-    newbucket.push_back(label);
-    prevbucket.erase(std::remove(prevbucket.begin(), prevbucket.end(), label));
+  if (&prevbucket != &newbucket) {
+    // Remove label from previous bucket and add it to newbucket
+    remove(prevbucket, label);
+    push(newbucket, label);
   }
 }
 
+// Removes a label from a bucket by moving the last label in the bucket into
+// its place. Order within a bucket does not matter.
+void DoubleBucketQueue::remove(bucket_t& bucket, const uint32_t label) {
+  uint32_t pos = positions_[label];
+  if (pos >= bucket.size() || bucket[pos] != label) {
+    // Should not happen, but fall back to a search rather than corrupting
+    // the bucket if the label is not where we expect it
+    auto itr = std::find(bucket.begin(), bucket.end(), label);
+    if (itr == bucket.end()) {
+      return;
+    }
+    pos = itr - bucket.begin();
+  }
+  uint32_t last = bucket.back();
+  bucket[pos] = last;
+  positions_[last] = pos;
+  bucket.pop_back();
+}
+
 // Remove the label with the lowest cost
 uint32_t DoubleBucketQueue::pop()  {
   if (empty()) {
@@ -92,7 +113,8 @@ uint32_t DoubleBucketQueue::pop()  {
 }
 
 // Empties the overflow bucket by placing the labels into the
-// low level buckets.
+// low level buckets. Labels that remain in the overflow bucket are compacted
+// in place.
 void DoubleBucketQueue::empty_overflow()  {
   bool found = false;
   while (!found && !overflowbucket_.empty()) {
@@ -100,20 +122,31 @@ void DoubleBucketQueue::empty_overflow()  {
     mincost_ += bucketrange_;
     maxcost_ += bucketrange_;
 
-    bucket_t tmp;
-    for (const auto& label : overflowbucket_) {
+    uint32_t remaining = 0;
+    float lowest = std::numeric_limits<float>::max();
+    for (const auto label : overflowbucket_) {
       // Get the cost (using the label cost function)
       float cost = labelcost_(label);
       if (cost < maxcost_) {
-        buckets_[static_cast<uint32_t>((cost-mincost_)*inv_)].push_back(label);
+        push(buckets_[static_cast<uint32_t>((cost-mincost_)*inv_)], label);
         found = true;
       } else {
-        tmp.push_back(label);
+        positions_[label] = remaining;
+        overflowbucket_[remaining++] = label;
+        lowest = std::min(lowest, cost);
       }
     }
 
-    // Add any labels that lie outside the new range back to overflow bucket
-    overflowbucket_ = tmp;
+    // Drop the labels that were moved to the low level buckets
+    overflowbucket_.resize(remaining);
+
+    // Skip straight to the range holding the lowest remaining cost rather
+    // than rescanning the overflow bucket once per empty range
+    if (!found && remaining > 0) {
+      float skip = std::floor((lowest - maxcost_) / bucketrange_) * bucketrange_;
+      mincost_ += skip;
+      maxcost_ += skip;
+    }
   }
 
   // Reset current cost and bucket to beginning of low level buckets
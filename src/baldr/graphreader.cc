@@ -1,6 +1,8 @@
 #include "baldr/graphreader.h"
 
 #include <string>
+#include <algorithm>
+#include <limits>
 #include <iostream>
 #include <fstream>
 #include <sys/stat.h>
@@ -102,6 +104,13 @@ const GraphTile* TileCache::Put(const GraphId& graphid, const GraphTile& tile, s
   return &cache_.emplace(graphid, tile).first->second;
 }
 
+// Brings an over committed cache back under its limit.
+void TileCache::Trim()
+{
+  if(OverCommitted())
+    Clear();
+}
+
 // Constructor.
 SynchronizedTileCache::SynchronizedTileCache(std::mutex& mutex, size_t max_size)
       : TileCache(max_size), mutex_ref_(mutex)
@@ -190,6 +199,296 @@ const GraphTile* CopyForwardingTileCache::Put(const GraphId& graphid, const Grap
 std::mutex CopyForwardingTileCache::mutex_;
 std::unordered_set<CopyForwardingTileCache*> CopyForwardingTileCache::members_;
 
+// Constructor.
+TileCacheLRU::TileCacheLRU(size_t max_size)
+      : TileCache(max_size), hits_(0), misses_(0), evictions_(0)
+{
+}
+
+// Reserves enough cache to hold (max_cache_size / tile_size) items.
+void TileCacheLRU::Reserve(size_t tile_size)
+{
+  index_.reserve(max_cache_size_ / tile_size);
+}
+
+// Checks if tile exists in the cache.
+bool TileCacheLRU::Contains(const GraphId& graphid) const
+{
+  return index_.find(graphid) != index_.end();
+}
+
+// Puts a copy of a tile of into the cache and marks it most recently used.
+const GraphTile* TileCacheLRU::Put(const GraphId& graphid, const GraphTile& tile, size_t size)
+{
+  // Already have it so just refresh it
+  auto cached = index_.find(graphid);
+  if(cached != index_.end()) {
+    entries_.splice(entries_.begin(), entries_, cached->second);
+    return &cached->second->tile;
+  }
+
+  // Add it to the front
+  cache_size_ += size;
+  entries_.emplace_front(entry_t{graphid, tile, size});
+  index_.emplace(graphid, entries_.begin());
+  return &entries_.front().tile;
+}
+
+// Get a pointer to a graph tile object given a GraphId.
+const GraphTile* TileCacheLRU::Get(const GraphId& graphid) const
+{
+  auto cached = index_.find(graphid);
+  if(cached == index_.end()) {
+    ++misses_;
+    return nullptr;
+  }
+
+  // Move it to the front since it was just used
+  ++hits_;
+  entries_.splice(entries_.begin(), entries_, cached->second);
+  return &cached->second->tile;
+}
+
+// Clears the cache.
+void TileCacheLRU::Clear()
+{
+  cache_size_ = 0;
+  index_.clear();
+  entries_.clear();
+}
+
+// Evicts least recently used tiles until the cache is within its limit.
+void TileCacheLRU::Trim()
+{
+  if(!OverCommitted())
+    return;
+  while(OverCommitted() && !entries_.empty()) {
+    const auto& lru = entries_.back();
+    cache_size_ -= lru.size;
+    index_.erase(lru.id);
+    entries_.pop_back();
+    ++evictions_;
+  }
+  LOG_DEBUG("TileCacheLRU::Trim(): " + std::to_string(hits_) + " hits " +
+            std::to_string(misses_) + " misses " + std::to_string(evictions_) + " evictions");
+}
+
+struct SharedTileCache::store_t {
+  // A tile in the store with the bookkeeping needed to evict it
+  struct cached_t {
+    GraphTile tile;
+    size_t size;
+    std::atomic<bool> referenced;
+  };
+
+  store_t(size_t max_size) : size(0), max_size(max_size), epoch(1), hand(0) {
+    // One slot for each tile of each level, transit uses the local tiling
+    size_t count = 0;
+    for(uint8_t level = 0; level <= TileHierarchy::get_max_level(); ++level) {
+      offsets.push_back(count);
+      auto l = TileHierarchy::levels().find(level);
+      if(l != TileHierarchy::levels().cend())
+        count += l->second.tiles.TileCount();
+      else if(level == TileHierarchy::GetTransitLevel().level)
+        count += TileHierarchy::GetTransitLevel().tiles.TileCount();
+    }
+    offsets.push_back(count);
+    slots.reset(new std::atomic<cached_t*>[count]());
+  }
+
+  ~store_t() {
+    for(auto index : resident)
+      delete slots[index].load();
+    for(const auto& r : retired)
+      delete r.second;
+  }
+
+  // Get the slot of a tile, nullptr if the tile is not part of the hierarchy
+  std::atomic<cached_t*>* slot(const GraphId& graphid) const {
+    if(graphid.level() + 1 >= offsets.size())
+      return nullptr;
+    size_t index = offsets[graphid.level()] + graphid.tileid();
+    return index < offsets[graphid.level() + 1] ? &slots[index] : nullptr;
+  }
+
+  // Remove a tile from its slot, it is freed once no reader can hold it. Must
+  // be called with the mutex held
+  void Evict(size_t position) {
+    cached_t* cached = slots[resident[position]].exchange(nullptr);
+    retired.emplace_back(epoch.fetch_add(1) + 1, cached);
+    size -= cached->size;
+    resident[position] = resident.back();
+    resident.pop_back();
+  }
+
+  // Free the evicted tiles that were evicted before every reader currently
+  // holding tiles started doing so. Must be called with the mutex held
+  void Reclaim() {
+    uint64_t oldest = std::numeric_limits<uint64_t>::max();
+    for(const auto* member : members) {
+      auto e = member->epoch_.load();
+      if(e != 0)
+        oldest = std::min(oldest, e);
+    }
+    auto reclaimable = std::partition(retired.begin(), retired.end(),
+      [oldest](const std::pair<uint64_t, cached_t*>& r) { return r.first > oldest; });
+    for(auto r = reclaimable; r != retired.end(); ++r)
+      delete r->second;
+    retired.erase(reclaimable, retired.end());
+  }
+
+  // Slots of the tiles and where each level's slots start
+  std::unique_ptr<std::atomic<cached_t*>[]> slots;
+  std::vector<size_t> offsets;
+
+  // Size of the tiles in the store
+  std::atomic<size_t> size;
+  const size_t max_size;
+
+  // Incremented on every eviction, readers note it when they start using tiles
+  std::atomic<uint64_t> epoch;
+
+  // Everything below is protected by the mutex
+  std::mutex mutex;
+  std::unordered_set<const SharedTileCache*> members;
+  // Slot indices of the tiles in the store and the CLOCK hand sweeping them
+  std::vector<size_t> resident;
+  size_t hand;
+  // Evicted tiles along with the epoch at which they were evicted
+  std::vector<std::pair<uint64_t, cached_t*> > retired;
+};
+
+std::shared_ptr<SharedTileCache::store_t> SharedTileCache::get_store_instance(size_t max_size) {
+  static std::shared_ptr<SharedTileCache::store_t> store(new SharedTileCache::store_t(max_size));
+  return store;
+}
+
+// Constructor.
+SharedTileCache::SharedTileCache(size_t max_size)
+      : TileCache(max_size), store_(get_store_instance(max_size)),
+        epoch_(0), holding_(false), overflow_(max_size)
+{
+  std::lock_guard<std::mutex> lock(store_->mutex);
+  store_->members.insert(this);
+  LOG_DEBUG("SharedTileCache(): " + std::to_string(store_->members.size()) + " members");
+}
+
+// Destructor.
+SharedTileCache::~SharedTileCache()
+{
+  std::lock_guard<std::mutex> lock(store_->mutex);
+  store_->members.erase(this);
+  store_->Reclaim();
+  LOG_DEBUG("~SharedTileCache(): " + std::to_string(store_->members.size()) + " members");
+}
+
+// Let the store know this reader may hold tiles from now on
+void SharedTileCache::Acquire() const
+{
+  // The fence keeps our slot reads from moving before the store sees our
+  // epoch so an evicting reader either sees us or we miss the evicted tile
+  epoch_.store(store_->epoch.load());
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  holding_ = true;
+}
+
+// The shared store has a slot for every tile so there is nothing to reserve.
+void SharedTileCache::Reserve(size_t tile_size)
+{
+}
+
+// Checks if tile exists in the shared store.
+bool SharedTileCache::Contains(const GraphId& graphid) const
+{
+  auto* slot = store_->slot(graphid);
+  return slot ? slot->load(std::memory_order_acquire) != nullptr : overflow_.Contains(graphid);
+}
+
+// Get a pointer to a graph tile object given a GraphId.
+const GraphTile* SharedTileCache::Get(const GraphId& graphid) const
+{
+  auto* slot = store_->slot(graphid);
+  if(!slot)
+    return overflow_.Get(graphid);
+
+  if(!holding_)
+    Acquire();
+  auto* cached = slot->load(std::memory_order_acquire);
+  if(!cached)
+    return nullptr;
+
+  // Avoid writing to the shared cache line unless we have to
+  if(!cached->referenced.load(std::memory_order_relaxed))
+    cached->referenced.store(true, std::memory_order_relaxed);
+  return &cached->tile;
+}
+
+// Puts a copy of a tile into the shared store.
+const GraphTile* SharedTileCache::Put(const GraphId& graphid, const GraphTile& tile, size_t size)
+{
+  auto* slot = store_->slot(graphid);
+  if(!slot)
+    return overflow_.Put(graphid, tile, size);
+
+  if(!holding_)
+    Acquire();
+  std::unique_ptr<store_t::cached_t> cached(new store_t::cached_t{tile, size, {true}});
+  store_t::cached_t* expected = nullptr;
+  if(!slot->compare_exchange_strong(expected, cached.get()))
+    return &expected->tile;
+
+  // We won the race to store it
+  std::lock_guard<std::mutex> lock(store_->mutex);
+  store_->resident.push_back(slot - store_->slots.get());
+  store_->size += size;
+  return &cached.release()->tile;
+}
+
+// Lets you know if the shared store is too large.
+bool SharedTileCache::OverCommitted() const
+{
+  return store_->max_size < store_->size || overflow_.OverCommitted();
+}
+
+// Evicts every tile from the shared store.
+void SharedTileCache::Clear()
+{
+  overflow_.Clear();
+  epoch_ = 0;
+  holding_ = false;
+  std::lock_guard<std::mutex> lock(store_->mutex);
+  while(!store_->resident.empty())
+    store_->Evict(store_->resident.size() - 1);
+  store_->hand = 0;
+  store_->Reclaim();
+}
+
+// Marks this reader as holding no tiles and evicts from the shared store.
+void SharedTileCache::Trim()
+{
+  overflow_.Trim();
+  epoch_ = 0;
+  holding_ = false;
+  std::lock_guard<std::mutex> lock(store_->mutex);
+
+  // Sweep the CLOCK hand giving recently referenced tiles a second chance,
+  // after two laps everything has been evicted
+  size_t sweeps = store_->resident.size() * 2;
+  while(store_->max_size < store_->size && !store_->resident.empty() && sweeps--) {
+    if(store_->hand >= store_->resident.size())
+      store_->hand = 0;
+    auto* cached = store_->slots[store_->resident[store_->hand]].load();
+    if(cached->referenced.exchange(false))
+      ++store_->hand;
+    else
+      store_->Evict(store_->hand);
+  }
+
+  // Free what nobody can be holding anymore
+  if(!store_->retired.empty())
+    store_->Reclaim();
+}
+
 // Constructs tile cache.
 TileCache* TileCacheFactory::createTileCache(const boost::property_tree::ptree& pt)
 {
@@ -199,6 +498,14 @@ TileCache* TileCacheFactory::createTileCache(const boost::property_tree::ptree&
   if (pt.get<bool>("memory_optimized_cache", false))
     return new CopyForwardingTileCache(max_cache_size);
 
+  // a single store shared by every reader in the process
+  if (pt.get<bool>("use_shared_tile_cache", false))
+    return new SharedTileCache(max_cache_size);
+
+  // lru cache which only evicts the least recently used tiles when trimmed
+  if (pt.get<bool>("use_lru_mem_cache", false))
+    return new TileCacheLRU(max_cache_size);
+
   // default
   return new TileCache(max_cache_size);
 }
@@ -206,6 +513,7 @@ TileCache* TileCacheFactory::createTileCache(const boost::property_tree::ptree&
 // Constructor using separate tile files
 GraphReader::GraphReader(const boost::property_tree::ptree& pt)
     : tile_dir_(pt.get<std::string>("tile_dir")),
+      mmap_tiles_(pt.get<bool>("mmap_tiles", false)),
       tile_extract_(get_extract_instance(pt)),
       cache_(TileCacheFactory::createTileCache(pt)) {
   // Reserve cache (based on whether using individual tile files or shared,
@@ -279,8 +587,8 @@ const GraphTile* GraphReader::GetGraphTile(const GraphId& graphid) {
     return inserted;
   }// Try getting it from flat file
   else {
-    // This reads the tile from disk
-    GraphTile tile(tile_dir_, base);
+    // This reads (or maps) the tile from disk
+    GraphTile tile(tile_dir_, base, mmap_tiles_);
     if (!tile.header())
       return nullptr;
 
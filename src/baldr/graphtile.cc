@@ -14,11 +14,10 @@
 #include <locale>
 #include <iomanip>
 #include <cmath>
+#include <sys/stat.h>
+#include <algorithm>
+#include <zlib.h>
 #include <boost/algorithm/string.hpp>
-#include <boost/iostreams/filtering_stream.hpp>
-#include <boost/iostreams/device/back_inserter.hpp>
-#include <boost/iostreams/filter/gzip.hpp>
-#include <boost/iostreams/copy.hpp>
 
 namespace {
   struct dir_facet : public std::numpunct<char> {
@@ -33,6 +32,52 @@ namespace {
   };
   const std::locale dir_locale(std::locale("C"), new dir_facet());
   const AABB2<PointLL> world_box(PointLL(-180, -90), PointLL(180, 90));
+
+  // Inflates gzipped data. The gzip footer records the uncompressed size
+  // (modulo 2^32) so we can decompress straight into one exact allocation
+  // and only have to grow the output if that size turns out to be wrong
+  bool inflate_gzip(const std::vector<char>& compressed, std::vector<char>& inflated) {
+    // Need at least a header and a footer
+    if (compressed.size() < 18)
+      return false;
+    const auto* footer = reinterpret_cast<const unsigned char*>(compressed.data() + compressed.size() - 4);
+    size_t size = static_cast<size_t>(footer[0]) | static_cast<size_t>(footer[1]) << 8 |
+                  static_cast<size_t>(footer[2]) << 16 | static_cast<size_t>(footer[3]) << 24;
+    inflated.resize(std::max(size, compressed.size()));
+
+    z_stream z;
+    z.next_in = (unsigned char*) compressed.data();
+    z.avail_in = compressed.size();
+    z.next_out = (unsigned char*) inflated.data();
+    z.avail_out = inflated.size();
+    z.zalloc = Z_NULL;
+    z.zfree = Z_NULL;
+    z.opaque = Z_NULL;
+    // 16 tells zlib to expect the gzip wrapper
+    if (inflateInit2(&z, 16 + MAX_WBITS) != Z_OK)
+      return false;
+
+    int result;
+    size_t written;
+    do {
+      result = inflate(&z, Z_FINISH);
+      written = reinterpret_cast<char*>(z.next_out) - inflated.data();
+      // Concatenated gzip members keep going after the end of the first
+      if (result == Z_STREAM_END && z.avail_in > 0)
+        result = inflateReset(&z);
+      // Ran out of room so the footer lied, grow the output
+      else if (result == Z_BUF_ERROR && z.avail_out == 0) {
+        inflated.resize(inflated.size() * 2);
+        z.next_out = (unsigned char*) inflated.data() + written;
+        z.avail_out = inflated.size() - written;
+        result = Z_OK;
+      }
+    } while (result == Z_OK);
+
+    inflated.resize(written);
+    inflateEnd(&z);
+    return result == Z_STREAM_END;
+  }
 }
 
 namespace valhalla {
@@ -65,19 +110,35 @@ GraphTile::GraphTile()
       traffic_chunk_size_(0),
       lane_connectivity_(nullptr),
       lane_connectivity_size_(0),
-      edge_elevation_(nullptr) {
+      edge_elevation_(nullptr),
+      speed_profile_offsets_(nullptr),
+      speed_profiles_(nullptr) {
 }
 
-// Constructor given a filename. Reads the graph data into memory.
-GraphTile::GraphTile(const std::string& tile_dir, const GraphId& graphid)
+// Constructor given a filename. Reads the graph data into memory or maps it.
+GraphTile::GraphTile(const std::string& tile_dir, const GraphId& graphid, bool mmap)
       : header_(nullptr) {
 
   // Don't bother with invalid ids
   if (!graphid.Is_Valid() || graphid.level() > TileHierarchy::get_max_level())
     return;
 
-  // Open to the end of the file so we can immediately get size;
+  // Map the file if it is there, the kernel will page in what we touch
   std::string file_location = tile_dir + "/" + FileSuffix(graphid.Tile_Base());
+  struct stat s;
+  if (mmap && stat(file_location.c_str(), &s) == 0 && s.st_size > 0) {
+    try {
+      memmap_.reset(new midgard::mem_map<char>(file_location, s.st_size, true));
+      Initialize(graphid, memmap_->get(), memmap_->size());
+      return;
+    }
+    catch (const std::runtime_error& e) {
+      LOG_WARN("Could not map tile, falling back to reading it: " + std::string(e.what()));
+      memmap_.reset();
+    }
+  }
+
+  // Open to the end of the file so we can immediately get size;
   std::ifstream file(file_location, std::ios::in | std::ios::binary | std::ios::ate);
   if (file.is_open()) {
     // Read binary file into memory. TODO - protect against failure to
@@ -94,17 +155,20 @@ GraphTile::GraphTile(const std::string& tile_dir, const GraphId& graphid)
   else {
     std::ifstream file(file_location + ".gz", std::ios::in | std::ios::binary | std::ios::ate);
     if (file.is_open()) {
-      // Pre-allocate assuming 3.25:1 compression ratio (based on scanning some large NA tiles)
+      // Read the compressed tile
       size_t filesize = file.tellg();
       file.seekg(0, std::ios::beg);
-      graphtile_.reset(new std::vector<char>());
-      graphtile_->reserve(filesize * 3 + filesize/4);  // TODO: read the gzip footer and get the real size?
+      std::vector<char> compressed(filesize);
+      file.read(compressed.data(), filesize);
+      file.close();
 
       // Decompress tile into memory
-      boost::iostreams::filtering_ostream os;
-      os.push(boost::iostreams::gzip_decompressor());
-      os.push(boost::iostreams::back_inserter(*graphtile_));
-      boost::iostreams::copy(file, os);
+      graphtile_.reset(new std::vector<char>());
+      if (!inflate_gzip(compressed, *graphtile_)) {
+        LOG_ERROR("Tile " + file_location + ".gz could not be decompressed");
+        graphtile_.reset();
+        return;
+      }
 
       // Set pointers to internal data structures
       Initialize(graphid, &(*graphtile_)[0], graphtile_->size());
@@ -212,6 +276,16 @@ void GraphTile::Initialize(const GraphId& graphid, char* tile_ptr,
   // the header) then the count is the same as the directed edge count.
   edge_elevation_ = reinterpret_cast<EdgeElevation*>(tile_ptr + header_->edge_elevation_offset());
 
+  // Start of the speed profiles. If the tile has speed profiles there is a
+  // profile index for every directed edge followed by the profiles.
+  speed_profile_offsets_ = nullptr;
+  speed_profiles_ = nullptr;
+  if (header_->speed_profile_offset() != 0 &&
+      header_->end_offset() > header_->speed_profile_offset()) {
+    speed_profile_offsets_ = reinterpret_cast<uint32_t*>(tile_ptr + header_->speed_profile_offset());
+    speed_profiles_ = reinterpret_cast<int16_t*>(speed_profile_offsets_ + header_->directededgecount());
+  }
+
   // For reference - how to use the end offset to set size of an object (that
   // is not fixed size and count).
   // example_size_ = header_->end_offset() - header_->example_offset();
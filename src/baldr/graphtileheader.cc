@@ -197,9 +197,15 @@ void GraphTileHeader::set_edge_elevation_offset(const uint32_t offset) {
   edge_elevation_offset_ = offset;
 }
 
-// Gets the offset to the end of the tile.
+// Sets the offset to the speed profiles.
+void GraphTileHeader::set_speed_profile_offset(const uint32_t offset) {
+  speed_profile_offset_ = offset;
+}
+
+// Gets the offset to the end of the tile. Tiles built before the speed
+// profile offset took its slot may only have the end offset in that slot.
 uint32_t GraphTileHeader::end_offset() const {
-  return empty_slots_[0];
+  return (empty_slots_[0] != 0) ? empty_slots_[0] : speed_profile_offset_;
 }
 
 // Sets the offset to the end of the tile. Fills all empty slots with the
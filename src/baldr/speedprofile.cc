@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "baldr/speedprofile.h"
+
+namespace {
+
+// Orthonormal DCT-II basis for the kept coefficients, one row per bucket
+const std::vector<float>& speed_basis() {
+  static const std::vector<float> basis = []() {
+    using namespace valhalla::baldr;
+    std::vector<float> b(kSpeedBucketCount * kSpeedCoefficientCount);
+    const double n = static_cast<double>(kSpeedBucketCount);
+    for (uint32_t bucket = 0; bucket < kSpeedBucketCount; ++bucket) {
+      for (uint32_t k = 0; k < kSpeedCoefficientCount; ++k) {
+        double scale = std::sqrt((k == 0 ? 1.0 : 2.0) / n);
+        b[bucket * kSpeedCoefficientCount + k] =
+            static_cast<float>(scale * std::cos(M_PI / n * (bucket + 0.5) * k));
+      }
+    }
+    return b;
+  }();
+  return basis;
+}
+
+}
+
+namespace valhalla {
+namespace baldr {
+
+// Compress the speeds of a week into a speed profile.
+speed_profile_t compress_speed_buckets(const float* speeds) {
+  const auto& basis = speed_basis();
+  std::array<double, kSpeedCoefficientCount> sums{};
+  for (uint32_t bucket = 0; bucket < kSpeedBucketCount; ++bucket) {
+    const float* row = &basis[bucket * kSpeedCoefficientCount];
+    for (uint32_t k = 0; k < kSpeedCoefficientCount; ++k) {
+      sums[k] += speeds[bucket] * row[k];
+    }
+  }
+  speed_profile_t coefficients;
+  for (uint32_t k = 0; k < kSpeedCoefficientCount; ++k) {
+    double c = std::round(sums[k] * kSpeedCoefficientScale);
+    c = std::min<double>(std::max<double>(c, std::numeric_limits<int16_t>::min()),
+                         std::numeric_limits<int16_t>::max());
+    coefficients[k] = static_cast<int16_t>(c);
+  }
+  return coefficients;
+}
+
+// Get the speed in one bucket of the week from a speed profile.
+float decompress_speed_bucket(const int16_t* coefficients, const uint32_t bucket) {
+  const float* row = &speed_basis()[bucket * kSpeedCoefficientCount];
+  float speed = 0.0f;
+  for (uint32_t k = 0; k < kSpeedCoefficientCount; ++k) {
+    speed += coefficients[k] * row[k];
+  }
+  return speed / kSpeedCoefficientScale;
+}
+
+}
+}
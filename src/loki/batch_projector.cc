@@ -0,0 +1,180 @@
+#include "loki/batch_projector.h"
+#include "midgard/constants.h"
+#include "midgard/distanceapproximator.h"
+
+#include <cmath>
+#include <limits>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace valhalla::midgard;
+
+namespace {
+
+//project a location onto the segments starting at first and keep the closest point.
+//longitude is scaled by the cosine of the latitude for the projection and the distance
+//is the one DistanceApproximator::DistanceSquared gives. the vector kernel does the same
+//arithmetic in the same order so the two agree exactly, as long as the compiler does not
+//contract it into fused multiply-adds (the build passes -ffp-contract=off for this file)
+void project_scalar(const float lng, const float lat, const float lon_scale, const float m_per_lng_degree,
+  const float* xs, const float* ys, size_t first, size_t segments, valhalla::loki::projection_t& best) {
+  for(size_t i = first; i < segments; ++i) {
+    auto bx = xs[i + 1] - xs[i];
+    auto by = ys[i + 1] - ys[i];
+    auto bx2 = bx * lon_scale;
+    auto sq = bx2 * bx2 + by * by;
+    auto scale = (lng - xs[i]) * lon_scale * bx2 + (lat - ys[i]) * by;
+    float x, y;
+    if(scale <= 0.f) {
+      x = xs[i]; y = ys[i];
+    }
+    else if(scale >= sq) {
+      x = xs[i + 1]; y = ys[i + 1];
+    }
+    else {
+      scale /= sq;
+      x = xs[i] + bx * scale; y = ys[i] + by * scale;
+    }
+    auto dlat = (y - lat) * kMetersPerDegreeLat;
+    auto dlng = (x - lng) * m_per_lng_degree;
+    auto sq_distance = dlat * dlat + dlng * dlng;
+    if(sq_distance < best.sq_distance) {
+      best.sq_distance = sq_distance;
+      best.point = PointLL(x, y);
+      best.index = i;
+    }
+  }
+}
+
+#ifdef __AVX2__
+//eight segments at a time, each lane keeps its own closest point. returns the number of
+//segments done so the scalar loop can finish the rest
+size_t project_avx2(const float lng, const float lat, const float lon_scale, const float m_per_lng_degree,
+  const float* xs, const float* ys, size_t segments, valhalla::loki::projection_t& best) {
+  size_t done = segments - segments % 8;
+  if(done == 0)
+    return 0;
+
+  const __m256 plng = _mm256_set1_ps(lng);
+  const __m256 plat = _mm256_set1_ps(lat);
+  const __m256 scale_lng = _mm256_set1_ps(lon_scale);
+  const __m256 m_lng = _mm256_set1_ps(m_per_lng_degree);
+  const __m256 m_lat = _mm256_set1_ps(kMetersPerDegreeLat);
+  const __m256 zero = _mm256_setzero_ps();
+  __m256 best_sq = _mm256_set1_ps(std::numeric_limits<float>::max());
+  __m256 best_x = zero, best_y = zero;
+  __m256 best_i = zero;
+  __m256 index = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256 eight = _mm256_set1_ps(8);
+
+  for(size_t i = 0; i < done; i += 8, index = _mm256_add_ps(index, eight)) {
+    __m256 ux = _mm256_loadu_ps(xs + i);
+    __m256 uy = _mm256_loadu_ps(ys + i);
+    __m256 vx = _mm256_loadu_ps(xs + i + 1);
+    __m256 vy = _mm256_loadu_ps(ys + i + 1);
+    __m256 bx = _mm256_sub_ps(vx, ux);
+    __m256 by = _mm256_sub_ps(vy, uy);
+    __m256 bx2 = _mm256_mul_ps(bx, scale_lng);
+    __m256 sq = _mm256_add_ps(_mm256_mul_ps(bx2, bx2), _mm256_mul_ps(by, by));
+    __m256 scale = _mm256_add_ps(
+      _mm256_mul_ps(_mm256_mul_ps(_mm256_sub_ps(plng, ux), scale_lng), bx2),
+      _mm256_mul_ps(_mm256_sub_ps(plat, uy), by));
+
+    //along the segment, then clamp to v past the end and to u before the start
+    __m256 ratio = _mm256_div_ps(scale, sq);
+    __m256 x = _mm256_add_ps(ux, _mm256_mul_ps(bx, ratio));
+    __m256 y = _mm256_add_ps(uy, _mm256_mul_ps(by, ratio));
+    __m256 after = _mm256_cmp_ps(scale, sq, _CMP_GE_OQ);
+    x = _mm256_blendv_ps(x, vx, after);
+    y = _mm256_blendv_ps(y, vy, after);
+    __m256 before = _mm256_cmp_ps(scale, zero, _CMP_LE_OQ);
+    x = _mm256_blendv_ps(x, ux, before);
+    y = _mm256_blendv_ps(y, uy, before);
+
+    __m256 dlat = _mm256_mul_ps(_mm256_sub_ps(y, plat), m_lat);
+    __m256 dlng = _mm256_mul_ps(_mm256_sub_ps(x, plng), m_lng);
+    __m256 sq_distance = _mm256_add_ps(_mm256_mul_ps(dlat, dlat), _mm256_mul_ps(dlng, dlng));
+    __m256 closer = _mm256_cmp_ps(sq_distance, best_sq, _CMP_LT_OQ);
+    best_sq = _mm256_blendv_ps(best_sq, sq_distance, closer);
+    best_x = _mm256_blendv_ps(best_x, x, closer);
+    best_y = _mm256_blendv_ps(best_y, y, closer);
+    best_i = _mm256_blendv_ps(best_i, index, closer);
+  }
+
+  //the closest of the lanes, on a tie the first segment like the scalar loop
+  alignas(32) float lane_sq[8], lane_x[8], lane_y[8], lane_i[8];
+  _mm256_store_ps(lane_sq, best_sq);
+  _mm256_store_ps(lane_x, best_x);
+  _mm256_store_ps(lane_y, best_y);
+  _mm256_store_ps(lane_i, best_i);
+  for(int lane = 0; lane < 8; ++lane) {
+    size_t i = static_cast<size_t>(lane_i[lane]);
+    if(lane_sq[lane] < best.sq_distance || (lane_sq[lane] == best.sq_distance && i < best.index)) {
+      best.sq_distance = lane_sq[lane];
+      best.point = PointLL(lane_x[lane], lane_y[lane]);
+      best.index = i;
+    }
+  }
+  return done;
+}
+#endif
+
+}
+
+namespace valhalla{
+namespace loki{
+
+void batch_projector_t::clear_locations() {
+  lngs.clear();
+  lats.clear();
+  lon_scales.clear();
+  m_per_lng_degrees.clear();
+}
+
+void batch_projector_t::add_location(const PointLL& ll) {
+  lngs.push_back(ll.lng());
+  lats.push_back(ll.lat());
+  lon_scales.push_back(cosf(ll.lat() * kRadPerDeg));
+  m_per_lng_degrees.push_back(DistanceApproximator::MetersPerLngDegree(ll.lat()));
+}
+
+size_t batch_projector_t::location_count() const {
+  return lngs.size();
+}
+
+void batch_projector_t::clear_shape() {
+  shape_lngs.clear();
+  shape_lats.clear();
+}
+
+void batch_projector_t::add_shape_point(const PointLL& ll) {
+  shape_lngs.push_back(ll.lng());
+  shape_lats.push_back(ll.lat());
+}
+
+size_t batch_projector_t::shape_size() const {
+  return shape_lngs.size();
+}
+
+void batch_projector_t::project(std::vector<projection_t>& closest) const {
+  size_t segments = shape_lngs.empty() ? 0 : shape_lngs.size() - 1;
+  closest.resize(lngs.size());
+  for(size_t j = 0; j < lngs.size(); ++j) {
+    auto& best = closest[j];
+    best.sq_distance = std::numeric_limits<float>::max();
+    best.point = PointLL();
+    best.index = 0;
+    size_t first = 0;
+#ifdef __AVX2__
+    first = project_avx2(lngs[j], lats[j], lon_scales[j], m_per_lng_degrees[j],
+      shape_lngs.data(), shape_lats.data(), segments, best);
+#endif
+    project_scalar(lngs[j], lats[j], lon_scales[j], m_per_lng_degrees[j],
+      shape_lngs.data(), shape_lats.data(), first, segments, best);
+  }
+}
+
+}
+}
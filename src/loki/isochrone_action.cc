@@ -103,11 +103,12 @@ namespace valhalla {
         }
       }
 
+      correlated.clear();
       try{
         //correlate the various locations to the underlying graph
-        const auto projections = loki::Search(locations, reader, edge_filter, node_filter);
+        const auto projections = loki::Search(locations, reader, edge_filter, node_filter, access_mode);
         for(size_t i = 0; i < locations.size(); ++i) {
-          rapidjson::Pointer("/correlated_" + std::to_string(i)).Set(request, projections.at(locations[i]).ToRapidJson(i, allocator));
+          correlated.push_back(projections.at(locations[i]));
         }
       }
       catch(const std::exception&) {
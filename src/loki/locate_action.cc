@@ -134,6 +134,7 @@ namespace valhalla {
       else {
         edge_filter = loki::PassThroughEdgeFilter;
         node_filter = loki::PassThroughNodeFilter;
+        access_mode = 0;
       }
     }
 
@@ -142,7 +143,7 @@ namespace valhalla {
       //correlate the various locations to the underlying graph
       auto json = json::array({});
       bool verbose = GetOptionalFromRapidJson<bool>(request, "/verbose").get_value_or(false);
-      const auto projections = loki::Search(locations, reader, edge_filter, node_filter);
+      const auto projections = loki::Search(locations, reader, edge_filter, node_filter, access_mode);
       auto id = GetOptionalFromRapidJson<std::string>(request, "/id");
       for(const auto& location : locations) {
         try {
@@ -117,12 +117,13 @@ namespace valhalla {
 
       //correlate the various locations to the underlying graph
       std::unordered_map<size_t, size_t> color_counts;
+      correlated.clear();
       try{
-        const auto searched = loki::Search(sources_targets, reader, edge_filter, node_filter);
+        const auto searched = loki::Search(sources_targets, reader, edge_filter, node_filter, access_mode);
         for(size_t i = 0; i < sources_targets.size(); ++i) {
           const auto& l = sources_targets[i];
           const auto& projection = searched.at(l);
-          rapidjson::Pointer("/correlated_" + std::to_string(i)).Set(request, projection.ToRapidJson(i, request.GetAllocator()));
+          correlated.push_back(projection);
           //TODO: get transit level for transit costing
           //TODO: if transit send a non zero radius
           auto colors = connectivity_map.get_colors(TileHierarchy::levels().rbegin()->first, projection, 0);
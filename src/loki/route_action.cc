@@ -107,14 +107,14 @@ namespace valhalla {
 
       //correlate the various locations to the underlying graph
       std::unordered_map<size_t, size_t> color_counts;
+      correlated.clear();
       try{
-        const auto projections = loki::Search(locations, reader, edge_filter, node_filter);
+        const auto projections = loki::Search(locations, reader, edge_filter, node_filter, access_mode);
         for(size_t i = 0; i < locations.size(); ++i) {
-          const auto& correlated = projections.at(locations[i]);
-          rapidjson::Pointer("/correlated_" + std::to_string(i)).Set(request, correlated.ToRapidJson(i,allocator));
+          correlated.push_back(projections.at(locations[i]));
           //TODO: get transit level for transit costing
           //TODO: if transit send a non zero radius
-          auto colors = connectivity_map.get_colors(TileHierarchy::levels().rbegin()->first, correlated, 0);
+          auto colors = connectivity_map.get_colors(TileHierarchy::levels().rbegin()->first, correlated.back(), 0);
           for(auto color : colors){
             auto itr = color_counts.find(color);
             if(itr == color_counts.cend())
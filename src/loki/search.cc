@@ -1,4 +1,5 @@
 #include "loki/search.h"
+#include "loki/batch_projector.h"
 #include "midgard/linesegment2.h"
 #include "midgard/distanceapproximator.h"
 #include "baldr/tilehierarchy.h"
@@ -32,6 +33,9 @@ constexpr float HEADING_SAMPLE = 30.f;
 constexpr float DEFAULT_ANGLE_WIDTH = 60.f;
 //a scale factor to apply to the score so that we bias towards closer results more
 constexpr float SCORE_SCALE = 10.f;
+//distances from the approximator can be a bit longer than the edge lengths they are
+//compared to when rejecting edges, so they are scaled down by this much first
+constexpr float REJECT_SLACK = .95f;
 
 
 //TODO: move this to midgard and test the crap out of it
@@ -153,17 +157,14 @@ struct candidate_t {
 
 // This structure contains the context of the projection of a
 // Location.  At the creation, a bin is affected to the point.  The
-// test() method should be called to each valid segment of the bin.
-// When the bin is finished, next_bin() switch to the next possible
-// interesting bin.  if has_bin() is false, then the best projection
-// is found.
+// segments of the bin are projected by the bin handler for all of the
+// locations that share the bin.  When the bin is finished, next_bin()
+// switch to the next possible interesting bin.  if has_bin() is false,
+// then the best projection is found.
 struct projector_t {
   projector_t(const Location& location, GraphReader& reader):
     binner(make_binner(location.latlng_, reader)),
     location(location), sq_radius(location.radius_ * location.radius_),
-    lon_scale(cosf(location.latlng_.lat() * kRadPerDeg)),
-    lat(location.latlng_.lat()),
-    lng(location.latlng_.lng()),
     approx(location.latlng_) {
     //TODO: something more empirical based on radius
     unreachable.reserve(64);
@@ -215,35 +216,6 @@ struct projector_t {
     } while (!cur_tile);
   }
 
-  // Test if a segment is a candidate to the projection.  This method
-  // is performance critical.  Copy, function call, cache locality and
-  // useless computation must be handled with care.
-  PointLL project(const PointLL& u, const PointLL& v) {
-    //we're done if this is a zero length segment
-    if(u == v)
-      return u;
-
-    //project a onto b where b is the origin vector representing this segment
-    //and a is the origin vector to the point we are projecting, (a.b/b.b)*b
-    auto bx = v.first - u.first;
-    auto by = v.second - u.second;
-
-    // Scale longitude when finding the projection
-    auto bx2 = bx * lon_scale;
-    auto sq = bx2 * bx2 + by * by;
-    auto scale = (lng - u.lng()) * lon_scale * bx2 + (lat - u.lat()) * by; //only need the numerator at first
-
-    //projects along the ray before u
-    if(scale <= 0.f)
-      return u;
-    //projects along the ray after v
-    else if(scale >= sq)
-      return v;
-    //projects along the ray between u and v
-    scale /= sq;
-    return {u.first + bx * scale, u.second + by * scale};
-  }
-
   std::function<std::tuple<int32_t, unsigned short, float>()> binner;
   const GraphTile* cur_tile = nullptr;
   Location location;
@@ -251,11 +223,6 @@ struct projector_t {
   double sq_radius;
   std::vector<candidate_t> unreachable;
   std::vector<candidate_t> reachable;
-
-  // critical data
-  float lon_scale;
-  float lat;
-  float lng;
   DistanceApproximator approx;
 };
 
@@ -264,8 +231,11 @@ struct bin_handler_t {
   valhalla::baldr::GraphReader& reader;
   const EdgeFilter& edge_filter;
   const NodeFilter& node_filter;
+  uint32_t access_mode;
   unsigned int max_reach_limit;
   std::vector<candidate_t> bin_candidates;
+  batch_projector_t projector;
+  std::vector<projection_t> projections;
   std::unordered_set<uint64_t> correlated_edges;
 
   //key is the edge id, size_t is the index into the reachability number
@@ -285,8 +255,8 @@ struct bin_handler_t {
   };
 
   bin_handler_t(const std::vector<valhalla::baldr::Location>& locations, valhalla::baldr::GraphReader& reader,
-    const EdgeFilter& edge_filter, const NodeFilter& node_filter):
-    reader(reader), edge_filter(edge_filter), node_filter(node_filter) {
+    const EdgeFilter& edge_filter, const NodeFilter& node_filter, uint32_t access_mode):
+    reader(reader), edge_filter(edge_filter), node_filter(node_filter), access_mode(access_mode) {
     //get the unique set of input locations and the max reachability of them all
     std::unordered_set<Location> uniq_locations(locations.begin(), locations.end());
     pps.reserve(uniq_locations.size());
@@ -302,11 +272,16 @@ struct bin_handler_t {
     reaches.reserve(std::max(max_reach_limit, static_cast<decltype(max_reach_limit)>(1)) * 1024);
   }
 
+  //the reach mjolnir stored in the tile for this mode, -1 when there isnt one
+  int stored_reach(const DirectedEdge* edge) const {
+    return access_mode ? edge->reach(access_mode) : -1;
+  }
+
   //returns -1 when we dont know it
   int get_reach(const DirectedEdge* edge) {
     auto itr = reach_indices.find(edge->endnode());
     if(itr == reach_indices.cend())
-      return -1; //TODO: if we didnt find it should we run the reachability check
+      return stored_reach(edge); //TODO: if we didnt find it should we run the reachability check
     return reaches[itr->second];
   }
 
@@ -443,6 +418,11 @@ struct bin_handler_t {
     if(max_reach_limit == 0)
       return 0;
 
+    //the tile may already know, unless we need more than it stores
+    auto stored = stored_reach(edge);
+    if(stored >= 0 && (static_cast<unsigned int>(stored) < kMaxReach || max_reach_limit <= kMaxReach))
+      return std::min(static_cast<unsigned int>(stored), max_reach_limit);
+
     //do we already know about this one?
     auto found = reach_indices.find(edge->endnode());
     if(found != reach_indices.cend())
@@ -473,12 +453,38 @@ struct bin_handler_t {
     return reaches.back();
   }
 
+  //a lower bound on the distance from a point to an edge comes from the ends of its shape:
+  //every point of the shape is at most the length of the edge from either end. if that
+  //cant beat what a location already has then there is no point projecting onto the edge
+  bool could_improve(std::vector<projector_t>::iterator begin, std::vector<projector_t>::iterator end,
+    const GraphTile* tile, const DirectedEdge* edge, const PointLL& front) const {
+    //the end node is the other end of the shape when it goes the same way as the edge
+    const PointLL* back = edge->forward() && !edge->leaves_tile() ? &tile->node(edge->endnode())->latlng() : nullptr;
+    auto length = edge->length() + 1.f;
+    for (auto p_itr = begin; p_itr != end; ++p_itr) {
+      //we keep anything when there is nothing to compare against
+      if(p_itr->reachable.empty() || (p_itr->location.minimum_reachability_ && p_itr->unreachable.empty()))
+        return true;
+      auto bound = sqrtf(p_itr->approx.DistanceSquared(front)) * REJECT_SLACK;
+      bound = back ? (bound + sqrtf(p_itr->approx.DistanceSquared(*back)) * REJECT_SLACK - length) * .5f : bound - length;
+      auto sq_bound = bound > 0.f ? bound * bound : 0.f;
+      //the edge would be kept if its in the radius or better than the last one of the batch
+      if(sq_bound < p_itr->sq_radius || sq_bound < p_itr->reachable.back().sq_distance ||
+         (p_itr->location.minimum_reachability_ && sq_bound < p_itr->unreachable.back().sq_distance))
+        return true;
+    }
+    return false;
+  }
+
   //handle a bin for the range of candidates that share it
   void handle_bin(std::vector<projector_t>::iterator begin,
                   std::vector<projector_t>::iterator end) {
     //iterate over the edges in the bin
     auto tile = begin->cur_tile;
     auto edges = tile->GetBin(begin->bin_index);
+    projector.clear_locations();
+    for (auto p_itr = begin; p_itr != end; ++p_itr)
+      projector.add_location(p_itr->location.latlng_);
     for(auto e : edges) {
       //get the tile and edge
       if(!reader.GetGraphTile(e, tile))
@@ -492,44 +498,31 @@ struct bin_handler_t {
         continue;
       }
 
-      //reset these so we know the best point along the edge
-      auto c_itr = bin_candidates.begin();
-      decltype(begin) p_itr;
-      for (p_itr = begin; p_itr != end; ++p_itr, ++c_itr)
-        c_itr->sq_distance = std::numeric_limits<float>::max();
-
-      //TODO: can we speed this up? the majority of edges will be short and far away enough
-      //such that the closest point on the edge will be one of the edges end points, we can get
-      //these coordinates them from the nodes in the graph. we can then find whichever end is
-      //closest to the input point p, call it n. we can then define an half plane h intersecting n
-      //so that its orthogonal to the ray from p to n. using h, we only need to test segments
-      //of the shape which are on the same side of h that p is. to make this fast we would need a
-      //a trivial half plane test as maybe a single dot product and comparison?
-
       //get some shape of the edge
-      auto edge_info = std::make_shared<const EdgeInfo>(tile->edgeinfo(edge->edgeinfo_offset()));
-      auto shape = edge_info->lazy_shape();
-      PointLL v;
+      auto info = tile->edgeinfo(edge->edgeinfo_offset());
+      auto shape = info.lazy_shape();
+      PointLL front;
       if (!shape.empty())
-        v = shape.pop();
-
-      //iterate along this edges segments projecting each of the points
-      for(size_t i = 0; !shape.empty(); ++i) {
-        auto u = v;
-        v = shape.pop();
-        //for each input point
-        c_itr = bin_candidates.begin();
-        for (p_itr = begin; p_itr != end; ++p_itr, ++c_itr) {
-          //how close is the input to this segment
-          auto point = p_itr->project(u, v);
-          auto sq_distance = p_itr->approx.DistanceSquared(point);
-          //do we want to keep it
-          if(sq_distance < c_itr->sq_distance) {
-            c_itr->sq_distance = sq_distance;
-            c_itr->point = std::move(point);
-            c_itr->index = i;
-          }
-        }
+        front = shape.pop();
+
+      //the majority of edges will be short and far enough away that they cant beat what
+      //we have, skip those before decoding the rest of the shape
+      if(!could_improve(begin, end, tile, edge, front))
+        continue;
+
+      //decode the shape and project all of the input points onto all of its segments
+      projector.clear_shape();
+      projector.add_shape_point(front);
+      while(!shape.empty())
+        projector.add_shape_point(shape.pop());
+      projector.project(projections);
+      auto edge_info = std::make_shared<const EdgeInfo>(std::move(info));
+      auto c_itr = bin_candidates.begin();
+      decltype(begin) p_itr;
+      for (auto projection = projections.cbegin(); projection != projections.cend(); ++projection, ++c_itr) {
+        c_itr->sq_distance = projection->sq_distance;
+        c_itr->point = projection->point;
+        c_itr->index = projection->index;
       }
 
       //if we already have a better reachable candidate we can just assume this one is reachable
@@ -676,12 +669,13 @@ namespace valhalla {
 namespace loki {
 
 std::unordered_map<Location, PathLocation>
-Search(const std::vector<Location>& locations, GraphReader& reader, const EdgeFilter& edge_filter, const NodeFilter& node_filter) {
+Search(const std::vector<Location>& locations, GraphReader& reader, const EdgeFilter& edge_filter, const NodeFilter& node_filter,
+  uint32_t access_mode) {
   //trivially finished already
   if(locations.empty())
     return std::unordered_map<Location, PathLocation>{};
   //setup the unique list of locations
-  bin_handler_t handler(locations, reader, edge_filter, node_filter);
+  bin_handler_t handler(locations, reader, edge_filter, node_filter, access_mode);
   //search over the bins doing multiple locations per bin
   handler.search();
   //turn each locations candidate set into path locations
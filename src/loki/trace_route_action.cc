@@ -159,11 +159,12 @@ namespace valhalla {
       locations_child.PushBack(locations.back().ToRapidJson(allocator), allocator);
       rapidjson::Pointer("/locations").Set(request, locations_child);
 
-      // Add first and last correlated locations to request
+      // Keep the first and last correlated locations for thor
+      correlated.clear();
       try{
-        auto projections = loki::Search(locations, reader, edge_filter, node_filter);
-        rapidjson::Pointer("/correlated_0").Set(request, projections.at(locations.front()).ToRapidJson(0, allocator));
-        rapidjson::Pointer("/correlated_1").Set(request, projections.at(locations.back()).ToRapidJson(1, allocator));
+        auto projections = loki::Search(locations, reader, edge_filter, node_filter, access_mode);
+        correlated.push_back(projections.at(locations.front()));
+        correlated.push_back(projections.at(locations.back()));
       }
       catch(const std::exception&) {
         throw valhalla_exception_t{171};
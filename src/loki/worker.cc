@@ -15,6 +15,7 @@
 #include "baldr/json.h"
 #include "baldr/rapidjson_utils.h"
 #include "tyr/actor.h"
+#include "proto/request.pb.h"
 
 #include "loki/worker.h"
 #include "loki/search.h"
@@ -80,6 +81,7 @@ namespace valhalla {
         c = factory.Create(*costing, *method_options_ptr);
         edge_filter = c->GetEdgeFilter();
         node_filter = c->GetNodeFilter();
+        access_mode = c->access_mode();
       }
       catch(const std::runtime_error&) {
         throw valhalla_exception_t{125, "'" + *costing + "'"};
@@ -91,7 +93,7 @@ namespace valhalla {
         if(avoid_locations.size() > max_avoid_locations)
           throw valhalla_exception_t{157, std::to_string(max_avoid_locations)};
         try {
-          auto results = loki::Search(avoid_locations, reader, edge_filter, node_filter);
+          auto results = loki::Search(avoid_locations, reader, edge_filter, node_filter, access_mode);
           std::unordered_set<uint64_t> avoids;
           for(const auto& result : results) {
             for(const auto& edge : result.second.edges) {
@@ -190,11 +192,40 @@ namespace valhalla {
       sources.clear();
       targets.clear();
       shape.clear();
-      if(reader.OverCommitted())
-        reader.Clear();
+      correlated.clear();
+      reader.Trim();
+    }
+
+    const std::vector<baldr::PathLocation>& loki_worker_t::correlated_locations() const {
+      return correlated;
     }
 
 #ifdef HAVE_HTTP
+    namespace {
+    //the request options and the correlated locations go to thor in the envelope
+    std::string serialize_request(ACTION_TYPE action, const rapidjson::Document& request,
+        const std::vector<baldr::PathLocation>& correlated) {
+      Request envelope;
+      envelope.set_action(action);
+      for(size_t i = 0; i < correlated.size(); ++i) {
+        auto* location = envelope.add_correlated();
+        location->set_location_index(i);
+        for(const auto& e : correlated[i].edges) {
+          auto* edge = location->add_edges();
+          edge->set_graph_id(e.id.value);
+          edge->set_dist(e.dist);
+          edge->set_lon(e.projected.first);
+          edge->set_lat(e.projected.second);
+          edge->set_score(e.score);
+          edge->set_sos(static_cast<uint32_t>(e.sos));
+          edge->set_minimum_reachability(e.minimum_reachability);
+        }
+      }
+      envelope.set_options(rapidjson::to_string(request));
+      return envelope.SerializeAsString();
+    }
+    }
+
     worker_t::result_t loki_worker_t::work(const std::list<zmq::message_t>& job, void* request_info, const worker_t::interrupt_function_t&) {
       //get time for start of request
       auto s = std::chrono::system_clock::now();
@@ -227,7 +258,7 @@ namespace valhalla {
           case ROUTE:
           case VIAROUTE:
             route(request_rj);
-            result.messages.emplace_back(rapidjson::to_string(request_rj));
+            result.messages.emplace_back(serialize_request(action->second, request_rj, correlated));
             break;
           case LOCATE:
             result = to_response(locate(request_rj), jsonp, info);
@@ -238,16 +269,16 @@ namespace valhalla {
           case SOURCES_TO_TARGETS:
           case OPTIMIZED_ROUTE:
             matrix(action->second, request_rj);
-            result.messages.emplace_back(rapidjson::to_string(request_rj));
+            result.messages.emplace_back(serialize_request(action->second, request_rj, correlated));
             break;
           case ISOCHRONE:
             isochrones(request_rj);
-            result.messages.emplace_back(rapidjson::to_string(request_rj));
+            result.messages.emplace_back(serialize_request(action->second, request_rj, correlated));
             break;
           case TRACE_ATTRIBUTES:
           case TRACE_ROUTE:
             trace(action->second, request_rj);
-            result.messages.emplace_back(rapidjson::to_string(request_rj));
+            result.messages.emplace_back(serialize_request(action->second, request_rj, correlated));
             break;
           default:
             //apparently you wanted something that we figured we'd support but havent written yet
@@ -0,0 +1,112 @@
+#include "midgard/point2.h"
+#include "midgard/pointll.h"
+#include "midgard/tiles.h"
+#include "midgard/summed_area_grid.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace valhalla {
+namespace midgard {
+
+// Constructor.
+template <class coord_t>
+SummedAreaGrid<coord_t>::SummedAreaGrid(const AABB2<coord_t>& bounds,
+                                        const float cellsize)
+    : Tiles<coord_t>(bounds, cellsize, 1, false),
+      sums_((this->nrows_ + 1) * (this->ncolumns_ + 1), 0.0) {
+}
+
+// Add a value to the grid cell at a specified coordinate.
+template <class coord_t>
+bool SummedAreaGrid<coord_t>::Add(const coord_t& pt, const float value) {
+  int32_t row = this->Row(pt.y());
+  int32_t col = this->Col(pt.x());
+  if (row < 0 || col < 0 || row >= this->nrows_ || col >= this->ncolumns_) {
+    return false;
+  }
+  sums_[(row + 1) * (this->ncolumns_ + 1) + col + 1] += value;
+  return true;
+}
+
+// Convert the cell values into the summed-area table. Accumulate along each
+// row and then down each column.
+template <class coord_t>
+void SummedAreaGrid<coord_t>::Build() {
+  const int32_t stride = this->ncolumns_ + 1;
+  for (int32_t row = 1; row <= this->nrows_; ++row) {
+    double* entry = &sums_[row * stride];
+    for (int32_t col = 1; col <= this->ncolumns_; ++col) {
+      entry[col] += entry[col - 1];
+    }
+  }
+  for (int32_t row = 2; row <= this->nrows_; ++row) {
+    double* entry = &sums_[row * stride];
+    const double* below = entry - stride;
+    for (int32_t col = 1; col <= this->ncolumns_; ++col) {
+      entry[col] += below[col];
+    }
+  }
+}
+
+// Get the sum of the values in all grid cells whose centers are within a
+// bounding box.
+template <class coord_t>
+double SummedAreaGrid<coord_t>::Sum(const AABB2<coord_t>& box) const {
+  // Nothing to sum if the box is outside the grid
+  if (box.maxx() < this->tilebounds_.minx() || box.minx() > this->tilebounds_.maxx() ||
+      box.maxy() < this->tilebounds_.miny() || box.miny() > this->tilebounds_.maxy()) {
+    return 0.0;
+  }
+
+  // Nothing to sum if no cell center is within the box
+  int32_t col0 = FirstCol(box.minx());
+  int32_t col1 = LastCol(box.maxx());
+  int32_t row0 = FirstRow(box.miny());
+  int32_t row1 = LastRow(box.maxy());
+  if (col1 < col0 || row1 < row0) {
+    return 0.0;
+  }
+
+  // Entries at the corners of the covered cells (exclusive of the lower left)
+  const int32_t stride = this->ncolumns_ + 1;
+  row0 *= stride;
+  row1 = (row1 + 1) * stride;
+  col1 += 1;
+  return sums_[row1 + col1] - sums_[row0 + col1] - sums_[row1 + col0] + sums_[row0 + col0];
+}
+
+// Get the first column with its cell center at or to the right of x.
+template <class coord_t>
+int32_t SummedAreaGrid<coord_t>::FirstCol(const float x) const {
+  int32_t col = static_cast<int32_t>(std::ceil((x - this->tilebounds_.minx()) / this->tilesize_ - 0.5f));
+  return std::min(std::max(col, 0), this->ncolumns_);
+}
+
+// Get the last column with its cell center to the left of x.
+template <class coord_t>
+int32_t SummedAreaGrid<coord_t>::LastCol(const float x) const {
+  int32_t col = static_cast<int32_t>(std::ceil((x - this->tilebounds_.minx()) / this->tilesize_ - 0.5f)) - 1;
+  return std::min(std::max(col, -1), this->ncolumns_ - 1);
+}
+
+// Get the first row with its cell center at or above y.
+template <class coord_t>
+int32_t SummedAreaGrid<coord_t>::FirstRow(const float y) const {
+  int32_t row = static_cast<int32_t>(std::ceil((y - this->tilebounds_.miny()) / this->tilesize_ - 0.5f));
+  return std::min(std::max(row, 0), this->nrows_);
+}
+
+// Get the last row with its cell center below y.
+template <class coord_t>
+int32_t SummedAreaGrid<coord_t>::LastRow(const float y) const {
+  int32_t row = static_cast<int32_t>(std::ceil((y - this->tilebounds_.miny()) / this->tilesize_ - 0.5f)) - 1;
+  return std::min(std::max(row, -1), this->nrows_ - 1);
+}
+
+// Explicit instantiation
+template class SummedAreaGrid<Point2>;
+template class SummedAreaGrid<PointLL>;
+
+}
+}
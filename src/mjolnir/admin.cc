@@ -2,6 +2,8 @@
 #include "baldr/datetime.h"
 #include "midgard/logging.h"
 #include <boost/filesystem/operations.hpp>
+#include <algorithm>
+#include <iterator>
 
 namespace valhalla {
 namespace mjolnir {
@@ -53,6 +55,106 @@ uint32_t GetMultiPolyId(const std::unordered_map<uint32_t,multi_polygon_type>& p
   return index;
 }
 
+PolygonIndex::PolygonIndex(const std::unordered_map<uint32_t,multi_polygon_type>& polys,
+                           const AABB2<PointLL>& bounds, const uint32_t divisions)
+    : bounds_(bounds),
+      divisions_(std::max(divisions, 1u)),
+      cell_width_(bounds.Width() / divisions_),
+      cell_height_(bounds.Height() / divisions_),
+      cells_(divisions_ * divisions_) {
+  // Index each polygon of the multi polygons by its bounding box
+  std::vector<value_type> values;
+  for (const auto& poly : polys) {
+    for (const auto& polygon : poly.second) {
+      box_type box = boost::geometry::return_envelope<box_type>(polygon);
+      values.emplace_back(box, parts_.size());
+      parts_.push_back({ poly.first, &polygon, box });
+    }
+  }
+  rtree_ = rtree_type(values.begin(), values.end());
+}
+
+// Get the parts whose bounding box intersects the box, in part order
+std::vector<uint32_t> PolygonIndex::Candidates(const box_type& box) const {
+  std::vector<value_type> values;
+  rtree_.query(boost::geometry::index::intersects(box),
+               std::back_inserter(values));
+  std::vector<uint32_t> candidates;
+  candidates.reserve(values.size());
+  for (const auto& value : values) {
+    candidates.push_back(value.second);
+  }
+  std::sort(candidates.begin(), candidates.end());
+  return candidates;
+}
+
+// Get the id of the first of the candidate parts that covers the point
+uint32_t PolygonIndex::Find(const std::vector<uint32_t>& candidates,
+                            const point_type& p) const {
+  for (const auto candidate : candidates) {
+    const Part& part = parts_[candidate];
+    if (boost::geometry::covered_by(p, part.box) &&
+        boost::geometry::covered_by(p, *part.polygon))
+      return part.id;
+  }
+  return 0;
+}
+
+// Classify a cell. If the first part that intersects the cell covers all of
+// it every point in the cell gets that part's id, if no part intersects it
+// no point in the cell has a polygon. The cell is padded a little so points
+// rounded into a neighboring cell are still classified correctly.
+void PolygonIndex::Classify(const uint32_t row, const uint32_t col,
+                            Cell& cell) const {
+  constexpr double kPadding = 1e-9;
+  double minx = bounds_.minx() + col * cell_width_;
+  double miny = bounds_.miny() + row * cell_height_;
+  box_type box(point_type(minx - kPadding, miny - kPadding),
+               point_type(minx + cell_width_ + kPadding,
+                          miny + cell_height_ + kPadding));
+  cell.candidates = Candidates(box);
+  if (cell.candidates.empty()) {
+    cell.resolved = true;
+    cell.id = 0;
+  } else {
+    polygon_type cell_polygon;
+    boost::geometry::convert(box, cell_polygon);
+    if (boost::geometry::covered_by(cell_polygon,
+            *parts_[cell.candidates.front()].polygon)) {
+      cell.resolved = true;
+      cell.id = parts_[cell.candidates.front()].id;
+      cell.candidates.clear();
+    }
+  }
+  cell.classified = true;
+}
+
+// Get the index of the polygon that covers the point
+uint32_t PolygonIndex::GetId(const PointLL& ll) const {
+  point_type p(ll.lng(), ll.lat());
+
+  // Points outside of the grid just use the rtree
+  if (!bounds_.Contains(ll) || cell_width_ <= 0.0 || cell_height_ <= 0.0) {
+    return Find(Candidates(box_type(p, p)), p);
+  }
+
+  // Clamp to the last row or column in case of rounding
+  uint32_t col = std::min(static_cast<uint32_t>((ll.lng() - bounds_.minx()) /
+                              cell_width_), divisions_ - 1);
+  uint32_t row = std::min(static_cast<uint32_t>((ll.lat() - bounds_.miny()) /
+                              cell_height_), divisions_ - 1);
+  Cell& cell = cells_[row * divisions_ + col];
+  if (!cell.classified) {
+    Classify(row, col, cell);
+  }
+  return cell.resolved ? cell.id : Find(cell.candidates, p);
+}
+
+// Get the polygon index using a spatial index of the polys
+uint32_t GetMultiPolyId(const PolygonIndex& index, const PointLL& ll) {
+  return index.GetId(ll);
+}
+
 // Get the timezone polys from the db
 std::unordered_map<uint32_t,multi_polygon_type> GetTimeZones(sqlite3 *db_handle,
                                                              const AABB2<PointLL>& aabb) {
@@ -0,0 +1,454 @@
+#include "mjolnir/contractionbuilder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <boost/property_tree/ptree.hpp>
+
+#include "midgard/logging.h"
+#include "baldr/double_bucket_queue.h"
+#include "baldr/graphconstants.h"
+#include "baldr/graphid.h"
+#include "baldr/graphreader.h"
+#include "baldr/graphtile.h"
+#include "baldr/tilehierarchy.h"
+#include "sif/autocost.h"
+#include "sif/edgelabel.h"
+
+using namespace valhalla::midgard;
+using namespace valhalla::baldr;
+using namespace valhalla::sif;
+using namespace valhalla::mjolnir;
+
+namespace {
+
+// Number of vertices a witness search settles before giving up. Giving up
+// early only adds shortcuts that are not strictly needed.
+constexpr uint32_t kMaxWitnessSettled = 500;
+
+constexpr float kUnreached = std::numeric_limits<float>::max();
+
+// Arcs an arc list can hold before unused blocks are compacted away
+constexpr uint64_t kMinCompactArcs = 1 << 20;
+
+// Write the offsets of one direction of the hierarchy
+void write_offsets(std::ofstream& file, const ArcLists& arcs) {
+  uint64_t offset = 0;
+  for (uint32_t vertex = 0; vertex < arcs.vertex_count(); ++vertex) {
+    file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+    offset += arcs[vertex].size();
+  }
+  file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+}
+
+// Write the arcs of one direction of the hierarchy
+void write_arcs(std::ofstream& file, const ArcLists& arcs) {
+  for (uint32_t vertex = 0; vertex < arcs.vertex_count(); ++vertex) {
+    auto vertex_arcs = arcs[vertex];
+    file.write(reinterpret_cast<const char*>(vertex_arcs.begin()),
+               vertex_arcs.size() * sizeof(ContractionArc));
+  }
+}
+
+}
+
+namespace valhalla {
+namespace mjolnir {
+
+// Constructor. Every vertex starts with an empty block.
+ArcLists::ArcLists(const uint32_t vertex_count)
+    : blocks_(vertex_count, block_t{ 0, 0, 0 }),
+      arc_count_(0) {
+}
+
+// Add an arc to a vertex, moving its arcs if the block is full
+void ArcLists::Add(const uint32_t vertex, const ContractionArc& arc) {
+  block_t& block = blocks_[vertex];
+  if (block.size == block.capacity) {
+    Move(vertex, std::max<uint32_t>(block.capacity * 2, 2));
+  }
+  arcs_[block.offset + block.size++] = arc;
+  arc_count_++;
+}
+
+// Remove the arc of a vertex that leads to another vertex
+void ArcLists::Remove(const uint32_t vertex, const uint32_t other) {
+  auto arcs = (*this)[vertex];
+  auto arc = std::find_if(arcs.begin(), arcs.end(),
+    [other](const ContractionArc& a) { return a.vertex == other; });
+  if (arc != arcs.end()) {
+    *arc = *(arcs.end() - 1);
+    blocks_[vertex].size--;
+    arc_count_--;
+  }
+}
+
+// Replace the arcs of a vertex with a copy of arcs from another list
+void ArcLists::Assign(const uint32_t vertex, const range_t<ContractionArc>& arcs) {
+  Clear(vertex);
+  if (arcs.empty()) {
+    return;
+  }
+  Move(vertex, arcs.size());
+  std::copy(arcs.begin(), arcs.end(), arcs_.begin() + blocks_[vertex].offset);
+  blocks_[vertex].size = arcs.size();
+  arc_count_ += arcs.size();
+}
+
+// Remove all arcs of a vertex. Its block is left for the next compaction.
+void ArcLists::Clear(const uint32_t vertex) {
+  arc_count_ -= blocks_[vertex].size;
+  blocks_[vertex] = { 0, 0, 0 };
+}
+
+// Move the arcs of a vertex to a new block at the end of the array
+void ArcLists::Move(const uint32_t vertex, const uint32_t capacity) {
+  if (arcs_.size() + capacity > kMinCompactArcs &&
+      arcs_.size() + capacity > 2 * (arc_count_ + capacity)) {
+    Compact();
+  }
+  block_t& block = blocks_[vertex];
+  uint64_t offset = arcs_.size();
+  arcs_.resize(offset + capacity);
+  std::copy(arcs_.begin() + block.offset, arcs_.begin() + block.offset + block.size,
+            arcs_.begin() + offset);
+  block.offset = offset;
+  block.capacity = capacity;
+}
+
+// Keep only the arcs in use, each block just large enough for its arcs
+void ArcLists::Compact() {
+  std::vector<ContractionArc> arcs;
+  arcs.reserve(2 * arc_count_);
+  for (auto& block : blocks_) {
+    uint64_t offset = arcs.size();
+    arcs.insert(arcs.end(), arcs_.begin() + block.offset,
+                arcs_.begin() + block.offset + block.size);
+    block.offset = offset;
+    block.capacity = block.size;
+  }
+  arcs_.swap(arcs);
+}
+
+// Constructor
+Contractor::Contractor(const uint32_t vertex_count)
+    : out_(vertex_count),
+      in_(vertex_count),
+      up_(vertex_count),
+      down_(vertex_count),
+      ranks_(vertex_count, kInvalidVertex),
+      contracted_neighbors_(vertex_count, 0),
+      witness_cost_(vertex_count, kUnreached) {
+}
+
+// Add an arc. U-turns onto the same vertex are of no use to a path.
+void Contractor::AddArc(const uint32_t from, const uint32_t to,
+                        const float cost, const float secs,
+                        const uint32_t length) {
+  if (from != to) {
+    AddOrUpdate(from, { to, cost, secs, length, kInvalidVertex });
+  }
+}
+
+// Add an arc to the remaining graph or lower the cost of the existing one
+void Contractor::AddOrUpdate(const uint32_t from, const ContractionArc& arc) {
+  auto out = out_[from];
+  auto existing = std::find_if(out.begin(), out.end(),
+    [&arc](const ContractionArc& a) { return a.vertex == arc.vertex; });
+  if (existing == out.end()) {
+    out_.Add(from, arc);
+    in_.Add(arc.vertex, { from, arc.cost, arc.secs, arc.length, arc.middle });
+  } else if (arc.cost < existing->cost) {
+    *existing = arc;
+    for (auto& in : in_[arc.vertex]) {
+      if (in.vertex == from) {
+        in = { from, arc.cost, arc.secs, arc.length, arc.middle };
+        break;
+      }
+    }
+  }
+}
+
+// Find the shortcuts needed to contract a vertex. For each vertex u with an
+// arc into the vertex a search around it finds whether each vertex x the
+// vertex leads to can be reached as cheaply without it.
+void Contractor::FindShortcuts(const uint32_t vertex,
+                               std::vector<shortcut_t>& shortcuts) {
+  shortcuts.clear();
+  auto out = out_[vertex];
+  if (out.empty()) {
+    return;
+  }
+  float max_out = 0.0f;
+  for (const auto& arc : out) {
+    max_out = std::max(max_out, arc.cost);
+  }
+
+  using entry_t = std::pair<float, uint32_t>;
+  for (const auto& in : in_[vertex]) {
+    // Witness search from u, bounded by the most expensive path via the vertex
+    float limit = in.cost + max_out;
+    std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t> > queue;
+    witness_cost_[in.vertex] = 0.0f;
+    witness_touched_.push_back(in.vertex);
+    queue.emplace(0.0f, in.vertex);
+    for (uint32_t settled = 0; !queue.empty() && settled < kMaxWitnessSettled; ) {
+      auto next = queue.top();
+      queue.pop();
+      if (next.first > witness_cost_[next.second]) {
+        continue;
+      }
+      if (next.first > limit) {
+        break;
+      }
+      ++settled;
+      for (const auto& arc : out_[next.second]) {
+        float cost = next.first + arc.cost;
+        if (arc.vertex != vertex && cost < witness_cost_[arc.vertex]) {
+          if (witness_cost_[arc.vertex] == kUnreached) {
+            witness_touched_.push_back(arc.vertex);
+          }
+          witness_cost_[arc.vertex] = cost;
+          queue.emplace(cost, arc.vertex);
+        }
+      }
+    }
+
+    // A shortcut is needed unless a witness is at least as cheap
+    for (const auto& arc : out) {
+      float cost = in.cost + arc.cost;
+      if (arc.vertex != in.vertex && witness_cost_[arc.vertex] > cost) {
+        shortcuts.emplace_back(in.vertex,
+            ContractionArc{ arc.vertex, cost, in.secs + arc.secs,
+                            in.length + arc.length, vertex });
+      }
+    }
+
+    for (auto touched : witness_touched_) {
+      witness_cost_[touched] = kUnreached;
+    }
+    witness_touched_.clear();
+  }
+}
+
+// Priority of a vertex (edge difference plus contracted neighbors)
+int32_t Contractor::Priority(const uint32_t vertex,
+                             std::vector<shortcut_t>& shortcuts) {
+  FindShortcuts(vertex, shortcuts);
+  return static_cast<int32_t>(shortcuts.size()) -
+         static_cast<int32_t>(in_[vertex].size() + out_[vertex].size()) +
+         static_cast<int32_t>(contracted_neighbors_[vertex]);
+}
+
+// Contract all vertices
+void Contractor::Contract() {
+  using entry_t = std::pair<int32_t, uint32_t>;
+  std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t> > queue;
+  std::vector<shortcut_t> shortcuts;
+  for (uint32_t vertex = 0; vertex < out_.vertex_count(); ++vertex) {
+    queue.emplace(Priority(vertex, shortcuts), vertex);
+  }
+
+  uint32_t rank = 0;
+  uint64_t shortcut_count = 0;
+  while (!queue.empty()) {
+    // Contracting neighbors changes the priority of a vertex. Update it
+    // and put the vertex back if it is no longer the lowest.
+    uint32_t vertex = queue.top().second;
+    queue.pop();
+    int32_t priority = Priority(vertex, shortcuts);
+    if (!queue.empty() && priority > queue.top().first) {
+      queue.emplace(priority, vertex);
+      continue;
+    }
+
+    // The remaining arcs of the vertex all lead to or come from higher
+    // ranked vertices. Move them to the hierarchy and add the shortcuts
+    // that keep the remaining graph's costs the same without the vertex.
+    ranks_[vertex] = rank++;
+    for (const auto& arc : in_[vertex]) {
+      out_.Remove(arc.vertex, vertex);
+      contracted_neighbors_[arc.vertex]++;
+    }
+    for (const auto& arc : out_[vertex]) {
+      in_.Remove(arc.vertex, vertex);
+      contracted_neighbors_[arc.vertex]++;
+    }
+    up_.Assign(vertex, out_[vertex]);
+    down_.Assign(vertex, in_[vertex]);
+    out_.Clear(vertex);
+    in_.Clear(vertex);
+    for (const auto& shortcut : shortcuts) {
+      AddOrUpdate(shortcut.first, shortcut.second);
+    }
+    shortcut_count += shortcuts.size();
+
+    if (rank % 1000000 == 0) {
+      LOG_INFO("Contracted " + std::to_string(rank) + " of " +
+               std::to_string(out_.vertex_count()) + " vertices");
+    }
+  }
+  LOG_INFO("Contraction added " + std::to_string(shortcut_count) + " shortcuts");
+}
+
+// Write the hierarchy
+void Contractor::Write(const std::string& file_name,
+                       const std::vector<ContractionTile>& tiles,
+                       const uint64_t tile_fingerprint) const {
+  std::ofstream file(file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open " + file_name);
+  }
+
+  ContractionHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kContractionMagic, sizeof(kContractionMagic));
+  header.version = kContractionVersion;
+  header.tile_count = tiles.size();
+  header.vertex_count = ranks_.size();
+  header.up_arc_count = up_.arc_count();
+  header.down_arc_count = down_.arc_count();
+  header.tile_fingerprint = tile_fingerprint;
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(tiles.data()),
+             tiles.size() * sizeof(ContractionTile));
+
+  // Pad the ranks to keep the offsets that follow aligned
+  file.write(reinterpret_cast<const char*>(ranks_.data()),
+             ranks_.size() * sizeof(uint32_t));
+  if (ranks_.size() & 1) {
+    uint32_t padding = 0;
+    file.write(reinterpret_cast<const char*>(&padding), sizeof(padding));
+  }
+  write_offsets(file, up_);
+  write_offsets(file, down_);
+  write_arcs(file, up_);
+  write_arcs(file, down_);
+  if (!file) {
+    throw std::runtime_error("Failed to write " + file_name);
+  }
+}
+
+// Build the contraction hierarchy of the tiles
+void ContractionBuilder::Build(const boost::property_tree::ptree& pt) {
+  boost::property_tree::ptree hierarchy_properties = pt.get_child("mjolnir");
+  GraphReader reader(hierarchy_properties);
+
+  // Every directed edge of the routing levels (transit is not routed by
+  // auto) is a vertex. Vertices are numbered in the order of the tiles.
+  std::vector<ContractionTile> tiles;
+  for (const auto& level : TileHierarchy::levels()) {
+    for (uint32_t id = 0; id < level.second.tiles.TileCount(); id++) {
+      GraphId tile_id(id, level.second.level, 0);
+      if (GraphReader::DoesTileExist(hierarchy_properties, tile_id)) {
+        if (reader.OverCommitted()) {
+          reader.Clear();
+        }
+        const GraphTile* tile = reader.GetGraphTile(tile_id);
+        tiles.push_back({ tile_id.value, 0, tile->header()->directededgecount() });
+      }
+    }
+  }
+  std::sort(tiles.begin(), tiles.end(),
+    [](const ContractionTile& a, const ContractionTile& b) { return a.tile < b.tile; });
+  uint64_t vertex_count = 0;
+  for (auto& tile : tiles) {
+    tile.first = vertex_count;
+    vertex_count += tile.count;
+  }
+  if (vertex_count >= kInvalidVertex) {
+    throw std::runtime_error("Too many directed edges for a contraction hierarchy");
+  }
+  auto get_vertex = [&tiles](const GraphId& edgeid) {
+    auto tile = std::lower_bound(tiles.begin(), tiles.end(), edgeid.Tile_Base().value,
+      [](const ContractionTile& a, const uint64_t b) { return a.tile < b; });
+    return tile->first + edgeid.id();
+  };
+
+  // Arcs are the transitions the default auto costing allows, found the same
+  // way the path algorithms expand: from the end node of an edge and from
+  // the nodes its transition edges lead to. Complex restrictions are not
+  // part of the hierarchy.
+  LOG_INFO("Adding arcs for " + std::to_string(vertex_count) + " directed edges");
+  // Destination only (and private) edges are excluded the way the first
+  // pass of bidirectional A* excludes them, so routes cannot cut through
+  // them. Routes to or from such edges find no path in the hierarchy and
+  // fall back to bidirectional A*.
+  auto costing = CreateAutoCost(boost::property_tree::ptree());
+  costing->set_allow_destination_only(false);
+  auto filter = costing->GetEdgeFilter();
+  Contractor contractor(vertex_count);
+  uint64_t count = 0;
+  std::vector<GraphId> nodes;
+  for (const auto& t : tiles) {
+    GraphId tile_id(t.tile);
+    for (uint32_t i = 0; i < t.count; ++i) {
+      if (reader.OverCommitted()) {
+        reader.Clear();
+      }
+      GraphId edgeid(tile_id.tileid(), tile_id.level(), i);
+      const GraphTile* tile = reader.GetGraphTile(edgeid);
+      const DirectedEdge* edge = tile->directededge(edgeid);
+      if (filter(edge) == 0.0f) {
+        continue;
+      }
+      EdgeLabel pred(kInvalidLabel, edgeid, GraphId(), edge, Cost(),
+                     costing->travel_mode(), Cost(), 0, false);
+      uint32_t from = t.first + i;
+
+      // The end node and the same node on the other levels
+      nodes.clear();
+      nodes.push_back(edge->endnode());
+      const GraphTile* endtile = reader.GetGraphTile(edge->endnode());
+      if (endtile == nullptr) {
+        continue;
+      }
+      const NodeInfo* endnode = endtile->node(edge->endnode());
+      const DirectedEdge* trans = endtile->directededge(endnode->edge_index());
+      for (uint32_t j = 0; j < endnode->edge_count(); ++j, ++trans) {
+        if (trans->trans_up() || trans->trans_down()) {
+          nodes.push_back(trans->endnode());
+        }
+      }
+
+      for (const auto& node : nodes) {
+        const GraphTile* nodetile = reader.GetGraphTile(node);
+        if (nodetile == nullptr) {
+          continue;
+        }
+        const NodeInfo* nodeinfo = nodetile->node(node);
+        if (!costing->Allowed(nodeinfo)) {
+          continue;
+        }
+        GraphId toid = { node.tileid(), node.level(), nodeinfo->edge_index() };
+        const DirectedEdge* to = nodetile->directededge(toid);
+        for (uint32_t j = 0; j < nodeinfo->edge_count(); ++j, ++to, ++toid) {
+          if (to->trans_up() || to->trans_down() || to->is_shortcut() ||
+              !costing->Allowed(to, pred, nodetile, toid)) {
+            continue;
+          }
+          Cost cost = costing->TransitionCost(to, nodeinfo, pred) +
+                      costing->EdgeCost(to);
+          contractor.AddArc(from, get_vertex(toid), cost.cost, cost.secs,
+                            to->length());
+          ++count;
+        }
+      }
+    }
+  }
+
+  LOG_INFO("Contracting " + std::to_string(count) + " arcs");
+  contractor.Contract();
+
+  // Tie the hierarchy to these tiles so it is not used with others
+  std::string file_name = ContractionHierarchy::FileName(reader.tile_dir());
+  contractor.Write(file_name, tiles, ContractionHierarchy::TileFingerprint(reader));
+  LOG_INFO("Wrote contraction hierarchy to " + file_name);
+}
+
+}
+}
@@ -449,6 +449,10 @@ void BuildTileSet(const std::string& ways_file, const std::string& way_nodes_fil
         }
       }
 
+      // Spatially index the polygons for the node lookups
+      PolygonIndex admin_poly_index(admin_polys, tiling.TileBounds(id));
+      PolygonIndex tz_poly_index(tz_polys, tiling.TileBounds(id));
+
       // Iterate through the nodes
       uint32_t idx = 0;                 // Current directed edge index
 
@@ -477,7 +481,7 @@ void BuildTileSet(const std::string& ways_file, const std::string& way_nodes_fil
         // Get the admin index
         uint32_t admin_index = (tile_within_one_admin) ?
                       admin_polys.begin()->first :
-                      GetMultiPolyId(admin_polys, node_ll);
+                      GetMultiPolyId(admin_poly_index, node_ll);
 
         // Look for potential duplicates
         //CheckForDuplicates(nodeid, node, edgelengths, nodes, edges, osmdata.ways, stats);
@@ -835,7 +839,7 @@ void BuildTileSet(const std::string& ways_file, const std::string& way_nodes_fil
         // Set the time zone index
         uint32_t tz_index = (tile_within_one_tz) ?
                       tz_polys.begin()->first :
-                      GetMultiPolyId(tz_polys, node_ll);
+                      GetMultiPolyId(tz_poly_index, node_ll);
         graphtile.nodes().back().set_timezone(tz_index);
 
         // Increment the counts in the histogram
@@ -30,6 +30,7 @@
 #include "midgard/logging.h"
 #include "midgard/pointll.h"
 #include "midgard/sequence.h"
+#include "midgard/summed_area_grid.h"
 #include "midgard/util.h"
 #include "baldr/tilehierarchy.h"
 #include "baldr/graphid.h"
@@ -68,6 +69,9 @@ constexpr float kDensityRadius2 = kDensityRadius * kDensityRadius;
 constexpr float kDensityLatDeg  = (kDensityRadius * kMetersPerKm) /
                                       kMetersPerDegreeLat;
 
+// Cell size (degrees) of the grid used to sum road lengths for density
+constexpr float kDensityCellSize = 0.001f;
+
 // Factors used to adjust speed assignments
 constexpr float kTurnChannelFactor = 1.25f;
 constexpr float kRampDensityFactor = 0.8f;
@@ -414,40 +418,36 @@ bool IsIntersectionInternal(GraphReader& reader, std::mutex& lock,
 }
 
 /**
- * Get the road density around the specified lat,lng position. This is a
- * value from 0-15 indicating a relative road density. This can be used
- * in costing methods to help avoid dense, urban areas.
+ * Build a summed-area grid of road lengths covering a tile and enough of its
+ * neighbors to get the road density of any node within the tile. The length
+ * of each road edge is added at its start node.
  * @param  reader        Graph reader
  * @param  lock          Mutex for locking while tiles are retrieved
- * @param  ll            Lat,lng position
- * @param  maxdensity    (OUT) max density found
+ * @param  tile_bounds   Bounding box of the tile
  * @param  tiles         Tiling (for getting list of required tiles)
  * @param  local_level   Level of the local tiles.
- * @return  Returns the relative road density (0-15) - higher values are
- *          more dense.
+ * @return  Returns the grid of road lengths.
  */
-uint32_t GetDensity(GraphReader& reader, std::mutex& lock, const PointLL& ll,
-                    enhancer_stats& stats, const Tiles<PointLL>& tiles,
-                    uint8_t local_level) {
-  // Radius is in km - turn into meters
+SummedAreaGrid<PointLL> GetDensityGrid(GraphReader& reader, std::mutex& lock,
+                                       const AABB2<PointLL>& tile_bounds,
+                                       const Tiles<PointLL>& tiles,
+                                       uint8_t local_level) {
+  // Expand the tile by the density radius. Longitude degrees are widest at
+  // the latitude nearest the pole.
   float rm = kDensityRadius * kMetersPerKm;
-  float mr2 = rm * rm;
-
-  // Use distance approximator for all distance checks
-  DistanceApproximator approximator(ll);
-
-  // Get a list of tiles required for a node search within this radius
-  float lngdeg = (rm / DistanceApproximator::MetersPerLngDegree(ll.lat()));
-  AABB2<PointLL> bbox(Point2(ll.lng() - lngdeg, ll.lat() - kDensityLatDeg),
-                      Point2(ll.lng() + lngdeg, ll.lat() + kDensityLatDeg));
+  float maxlat = std::min(std::max(std::abs(tile_bounds.miny() - kDensityLatDeg),
+                                   std::abs(tile_bounds.maxy() + kDensityLatDeg)), 89.0f);
+  float lngdeg = (rm / DistanceApproximator::MetersPerLngDegree(maxlat));
+  AABB2<PointLL> bbox(PointLL(tile_bounds.minx() - lngdeg, tile_bounds.miny() - kDensityLatDeg),
+                      PointLL(tile_bounds.maxx() + lngdeg, tile_bounds.maxy() + kDensityLatDeg));
+  SummedAreaGrid<PointLL> grid(bbox, kDensityCellSize);
+
+  // For all tiles needed to cover the grid add lengths of directed edges at
+  // their start nodes. Nodes outside the grid are skipped.
   std::vector<int32_t> tilelist = tiles.TileList(bbox);
-
-  // For all tiles needed to find nodes within the radius...find nodes within
-  // the radius (squared) and add lengths of directed edges
-  float roadlengths = 0.0f;
   for (auto t : tilelist) {
-    // Check all the nodes within the tile. Skip if tile has no nodes (can be
-    // an empty tile added for connectivity map logic).
+    // Skip if tile has no nodes (can be an empty tile added for connectivity
+    // map logic).
     lock.lock();
     const GraphTile* newtile = reader.GetGraphTile(GraphId(t, local_level, 0));
     lock.unlock();
@@ -456,23 +456,47 @@ uint32_t GetDensity(GraphReader& reader, std::mutex& lock, const PointLL& ll,
     const auto start_node = newtile->node(0);
     const auto end_node   = start_node + newtile->header()->nodecount();
     for (auto node = start_node; node < end_node; ++node) {
-      // Check if within radius
-      if (approximator.DistanceSquared(node->latlng()) < mr2) {
-        // Get all directed edges and add length
-        const DirectedEdge* directededge = newtile->directededge(node->edge_index());
-        for (uint32_t i = 0; i < node->edge_count(); i++, directededge++) {
-          // Exclude non-roads (parking, walkways, ferries, etc.)
-          if (directededge->use() == Use::kRoad ||
-              directededge->use() == Use::kRamp ||
-              directededge->use() == Use::kTurnChannel ||
-              directededge->use() == Use::kAlley ||
-              directededge->use() == Use::kEmergencyAccess) {
-            roadlengths += directededge->length();
-          }
+      float roadlengths = 0.0f;
+      const DirectedEdge* directededge = newtile->directededge(node->edge_index());
+      for (uint32_t i = 0; i < node->edge_count(); i++, directededge++) {
+        // Exclude non-roads (parking, walkways, ferries, etc.)
+        if (directededge->use() == Use::kRoad ||
+            directededge->use() == Use::kRamp ||
+            directededge->use() == Use::kTurnChannel ||
+            directededge->use() == Use::kAlley ||
+            directededge->use() == Use::kEmergencyAccess) {
+          roadlengths += directededge->length();
         }
       }
+      if (roadlengths > 0.0f)
+        grid.Add(node->latlng(), roadlengths);
     }
   }
+  grid.Build();
+  return grid;
+}
+
+/**
+ * Get the road density around the specified lat,lng position. This is a
+ * value from 0-15 indicating a relative road density. This can be used
+ * in costing methods to help avoid dense, urban areas. Road lengths are
+ * summed over the grid cells centered within a square with the same area
+ * as the density radius circle.
+ * @param  grid          Summed-area grid of road lengths (see GetDensityGrid)
+ * @param  ll            Lat,lng position
+ * @param  stats         (OUT) max density and density counts
+ * @return  Returns the relative road density (0-15) - higher values are
+ *          more dense.
+ */
+uint32_t GetDensity(const SummedAreaGrid<PointLL>& grid, const PointLL& ll,
+                    enhancer_stats& stats) {
+  // Half the side of a square with the area of the density radius circle
+  float hm = 0.5f * std::sqrt(kPi) * kDensityRadius * kMetersPerKm;
+  float latdeg = hm / kMetersPerDegreeLat;
+  float lngdeg = hm / DistanceApproximator::MetersPerLngDegree(ll.lat());
+  AABB2<PointLL> bbox(PointLL(ll.lng() - lngdeg, ll.lat() - latdeg),
+                      PointLL(ll.lng() + lngdeg, ll.lat() + latdeg));
+  float roadlengths = grid.Sum(bbox);
 
   // Form density measure as km/km^2. Convert roadlengths to km and divide by 2
   // (since 2 directed edges per edge)
@@ -973,14 +997,17 @@ void enhance(const boost::property_tree::ptree& pt,
       }
     }
 
+    // Grid of road lengths around the tile for getting node densities
+    SummedAreaGrid<PointLL> density_grid = GetDensityGrid(reader, lock,
+                     tiles.TileBounds(id), tiles, local_level);
+
     // Second pass - add admin information and edge transition information.
     for (uint32_t i = 0; i < tilebuilder.header()->nodecount(); i++) {
       GraphId startnode(id, local_level, i);
       NodeInfo& nodeinfo = tilebuilder.node_builder(i);
 
       // Get relative road density and local density
-      uint32_t density = GetDensity(reader, lock, nodeinfo.latlng(),
-                                    stats, tiles, local_level);
+      uint32_t density = GetDensity(density_grid, nodeinfo.latlng(), stats);
       nodeinfo.set_density(density);
 
       uint32_t admin_index = nodeinfo.admin_index();
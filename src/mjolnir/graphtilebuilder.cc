@@ -222,12 +222,26 @@ GraphTileBuilder::GraphTileBuilder(const std::string& tile_dir,
     std::copy(edge_elevation_, edge_elevation_ + n,
         std::back_inserter(edge_elevation_builder_));
   }
+
+  // Speed profiles
+  if (speed_profile_offsets_ != nullptr) {
+    n = header_->directededgecount();
+    speed_profile_offsets_builder_.assign(speed_profile_offsets_, speed_profile_offsets_ + n);
+    n = (header_->end_offset() - header_->speed_profile_offset() - n * sizeof(uint32_t)) /
+        sizeof(int16_t);
+    speed_profile_builder_.assign(speed_profiles_, speed_profiles_ + n);
+  }
 }
 
 // Output the tile to file. Stores as binary data.
 void GraphTileBuilder::StoreTileData() {
+  StoreTileData(tile_dir_);
+}
+
+// Output the tile to file under the specified base directory.
+void GraphTileBuilder::StoreTileData(const std::string& tile_dir) {
   // Get the name of the file
-  boost::filesystem::path filename = tile_dir_ + '/'
+  boost::filesystem::path filename = tile_dir + '/'
       + GraphTile::FileSuffix(header_builder_.graphid());
 
   // Make sure the directory exists on the system
@@ -360,9 +374,24 @@ void GraphTileBuilder::StoreTileData() {
                          edge_elevation_builder_.size() * sizeof(EdgeElevation));
     }
 
+    // Write the speed profiles. If there are any, write a profile index for
+    // every directed edge followed by the profiles.
+    header_builder_.set_speed_profile_offset(header_builder_.edge_elevation_offset() +
+       (edge_elevation_builder_.size() * sizeof(EdgeElevation)));
+    if (speed_profile_builder_.size() > 0) {
+      speed_profile_offsets_builder_.resize(directededges_builder_.size(), kNoSpeedProfile);
+      in_mem.write(reinterpret_cast<const char*>(&speed_profile_offsets_builder_[0]),
+                   speed_profile_offsets_builder_.size() * sizeof(uint32_t));
+      in_mem.write(reinterpret_cast<const char*>(&speed_profile_builder_[0]),
+                   speed_profile_builder_.size() * sizeof(int16_t));
+    } else {
+      speed_profile_offsets_builder_.clear();
+    }
+
     // Set the end offset
-    header_builder_.set_end_offset(header_builder_.edge_elevation_offset() +
-      (edge_elevation_builder_.size() * sizeof(EdgeElevation)));
+    header_builder_.set_end_offset(header_builder_.speed_profile_offset() +
+      (speed_profile_offsets_builder_.size() * sizeof(uint32_t)) +
+      (speed_profile_builder_.size() * sizeof(int16_t)));
 
     // Sanity check for the end offset
     uint32_t curr = static_cast<uint32_t>(in_mem.tellp()) +
@@ -870,6 +899,7 @@ void GraphTileBuilder::AddBins(const std::string& tile_dir,
   header.set_traffic_chunk_offset(header.traffic_chunk_offset() + shift);
   header.set_lane_connectivity_offset(header.lane_connectivity_offset() + shift);
   header.set_edge_elevation_offset(header.edge_elevation_offset() + shift);
+  header.set_speed_profile_offset(header.speed_profile_offset() + shift);
   header.set_end_offset(header.end_offset() + shift);
   //rewrite the tile
   boost::filesystem::path filename = tile_dir + '/' + GraphTile::FileSuffix(header.graphid());
@@ -985,6 +1015,7 @@ void GraphTileBuilder::UpdateTrafficSegments() {
   uint32_t shift = new_segments * sizeof(TrafficAssociation) + new_chunks * sizeof(TrafficChunk);
   header_builder_.set_lane_connectivity_offset(header_builder_.lane_connectivity_offset() + shift);
   header_builder_.set_edge_elevation_offset(header_builder_.edge_elevation_offset() + shift);
+  header_builder_.set_speed_profile_offset(header_builder_.speed_profile_offset() + shift);
   header_builder_.set_end_offset(header_builder_.end_offset() + shift);
 
   // Get the name of the file
@@ -1014,8 +1045,8 @@ void GraphTileBuilder::UpdateTrafficSegments() {
     file.write(reinterpret_cast<const char*>(&traffic_chunk_builder_[0]),
                traffic_chunk_builder_.size() * sizeof(TrafficChunk));
 
-    // Write rest of the stuff after traffic chunks (includes lane connectivity
-    // and edge elevation...so far).
+    // Write rest of the stuff after traffic chunks (includes lane connectivity,
+    // edge elevation and speed profiles...so far).
     const auto* begin = reinterpret_cast<const char*>(header_) +
                 header_->lane_connectivity_offset();
     const auto* end = reinterpret_cast<const char*>(header_) +
@@ -1032,6 +1063,24 @@ std::vector<EdgeElevation>& GraphTileBuilder::edge_elevations() {
   return edge_elevation_builder_;
 }
 
+// Add a speed profile to a directed edge.
+void GraphTileBuilder::AddSpeedProfile(const uint32_t idx, const speed_profile_t& profile) {
+  if (idx >= speed_profile_offsets_builder_.size()) {
+    speed_profile_offsets_builder_.resize(
+        std::max(static_cast<size_t>(idx) + 1, directededges_builder_.size()), kNoSpeedProfile);
+  }
+
+  // Overwrite the edge's profile if it has one, else append a new profile
+  uint32_t& offset = speed_profile_offsets_builder_[idx];
+  if (offset == kNoSpeedProfile) {
+    offset = speed_profile_builder_.size() / kSpeedCoefficientCount;
+    speed_profile_builder_.insert(speed_profile_builder_.end(), profile.begin(), profile.end());
+  } else {
+    std::copy(profile.begin(), profile.end(),
+              speed_profile_builder_.begin() + offset * kSpeedCoefficientCount);
+  }
+}
+
 }
 }
 
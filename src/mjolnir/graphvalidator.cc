@@ -18,6 +18,8 @@
 #include <mutex>
 #include <numeric>
 #include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "midgard/logging.h"
 #include "midgard/pointll.h"
@@ -27,6 +29,8 @@
 #include "baldr/graphconstants.h"
 #include "baldr/graphreader.h"
 #include "baldr/nodeinfo.h"
+#include "sif/autocost.h"
+#include "sif/pedestriancost.h"
 
 using namespace valhalla::midgard;
 using namespace valhalla::baldr;
@@ -282,6 +286,72 @@ uint32_t GetOpposingEdgeIndex(const GraphId& startnode, DirectedEdge& edge,
   return opp_index;
 }
 
+// Filters of a mode whose reach is stored in the tiles. These are the
+// filters loki uses when it checks reachability for the mode.
+struct ReachMode {
+  uint32_t access;
+  valhalla::sif::EdgeFilter edge_filter;
+  valhalla::sif::NodeFilter node_filter;
+  std::unordered_map<uint64_t, uint32_t> cache;   // Reach of end nodes
+};
+
+// Get a tile through the reader while holding the lock
+const GraphTile* GetTile(GraphReader& reader, const GraphId& id,
+                         std::mutex& lock) {
+  lock.lock();
+  const GraphTile* tile = reader.GetGraphTile(id);
+  lock.unlock();
+  return tile;
+}
+
+// Count the nodes that can be reached from a node, up to kMaxReach. As in
+// loki transition edges are followed but the nodes at their ends are not
+// counted again. A node the mode cannot pass through reaches nothing.
+uint32_t GetReach(const GraphId& start, const ReachMode& mode,
+                  GraphReader& reader, std::mutex& lock) {
+  const GraphTile* tile = GetTile(reader, start, lock);
+  if (tile == nullptr || mode.node_filter(tile->node(start))) {
+    return 0;
+  }
+
+  uint32_t reach = 1;
+  std::unordered_set<uint64_t> visited{start.value};
+  std::queue<GraphId> expand;
+  expand.push(start);
+  while (!expand.empty() && reach < kMaxReach) {
+    GraphId node = expand.front();
+    expand.pop();
+    if (tile->id() != node.Tile_Base()) {
+      tile = GetTile(reader, node, lock);
+      if (tile == nullptr) {
+        continue;
+      }
+    }
+    const NodeInfo* nodeinfo = tile->node(node);
+    const DirectedEdge* edge = tile->directededge(nodeinfo->edge_index());
+    for (uint32_t i = 0; i < nodeinfo->edge_count() && reach < kMaxReach;
+         i++, edge++) {
+      if (!edge->IsTransition() && mode.edge_filter(edge) == 0.0f) {
+        continue;
+      }
+      if (!visited.insert(edge->endnode().value).second) {
+        continue;
+      }
+      const GraphTile* end_tile = (tile->id() == edge->endnode().Tile_Base()) ?
+            tile : GetTile(reader, edge->endnode(), lock);
+      if (end_tile == nullptr ||
+          mode.node_filter(end_tile->node(edge->endnode()))) {
+        continue;
+      }
+      if (!edge->IsTransition()) {
+        reach++;
+      }
+      expand.push(edge->endnode());
+    }
+  }
+  return reach;
+}
+
 using tweeners_t = GraphTileBuilder::tweeners_t;
 void validate(const boost::property_tree::ptree& pt,
               std::deque<GraphId>& tilequeue, std::mutex& lock,
@@ -303,6 +373,15 @@ void validate(const boost::property_tree::ptree& pt,
     // Vector to hold problem ways
     std::set<uint64_t> problem_ways;
 
+    // Modes whose reach is stored with each directed edge
+    boost::property_tree::ptree costing_options;
+    auto auto_cost = valhalla::sif::CreateAutoCost(costing_options);
+    auto pedestrian_cost = valhalla::sif::CreatePedestrianCost(costing_options);
+    std::vector<ReachMode> reach_modes{
+      {kAutoAccess, auto_cost->GetEdgeFilter(), auto_cost->GetNodeFilter(), {}},
+      {kPedestrianAccess, pedestrian_cost->GetEdgeFilter(),
+          pedestrian_cost->GetNodeFilter(), {}}};
+
     // Check for more tiles
     while (true) {
       lock.lock();
@@ -430,6 +509,23 @@ void validate(const boost::property_tree::ptree& pt,
             directededge.set_ctry_crossing(true);
           }
 
+          // Store how many nodes each mode can reach past the end of the
+          // edge so loki does not have to expand the graph to find out.
+          // Only edges the mode can use get one.
+          if (level != transit_level) {
+            for (auto& mode : reach_modes) {
+              if (mode.edge_filter(&directededge) == 0.0f) {
+                continue;
+              }
+              auto cached = mode.cache.find(directededge.endnode().value);
+              if (cached == mode.cache.end()) {
+                cached = mode.cache.emplace(directededge.endnode().value,
+                    GetReach(directededge.endnode(), mode, graph_reader, lock)).first;
+              }
+              directededge.set_reach(mode.access, cached->second);
+            }
+          }
+
           // Validate the complex restriction settings
           if (de->end_restriction()) {
             uint32_t modes = 0;
@@ -461,6 +557,11 @@ void validate(const boost::property_tree::ptree& pt,
         nodes.emplace_back(std::move(nodeinfo));
       }
 
+      // Reach of end nodes is only kept for the tile
+      for (auto& mode : reach_modes) {
+        mode.cache.clear();
+      }
+
       // Add density to return class. Approximate the tile area square km
       AABB2<PointLL> bb = tiles.TileBounds(tileid);
       float area = ((bb.maxy() - bb.miny()) * kMetersPerDegreeLat * kKmPerMeter) *
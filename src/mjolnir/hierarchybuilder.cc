@@ -1,5 +1,6 @@
 #include "mjolnir/hierarchybuilder.h"
 #include "mjolnir/graphtilebuilder.h"
+#include "mjolnir/util.h"
 
 #include <sstream>
 #include <iostream>
@@ -7,6 +8,16 @@
 #include <vector>
 #include <map>
 #include <utility>
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
 #include <boost/property_tree/ptree.hpp>
 
 #include "midgard/pointll.h"
@@ -125,8 +136,29 @@ OldToNewNodes find_nodes(sequence<OldToNewNodes>& old_to_new, const GraphId& nod
   }
 }
 
-// Form tiles in the new level.
-void FormTilesInNewLevel(GraphReader& reader, bool has_elevation) {
+// Get the next tile Id from the queue. Returns false once the queue is empty.
+bool NextTile(std::queue<GraphId>& tilequeue, std::mutex& lock,
+              GraphId& tile_id) {
+  std::lock_guard<std::mutex> guard(lock);
+  if (tilequeue.empty()) {
+    return false;
+  }
+  tile_id = tilequeue.front();
+  tilequeue.pop();
+  return true;
+}
+
+// Form tiles in the new level for the tiles in the queue. The new nodes of
+// each tile are a contiguous range within the sorted new to old sequence.
+// Each thread only writes the tiles it takes off the queue.
+void FormTilesInNewLevel(const boost::property_tree::ptree& hierarchy_properties,
+                         const bool has_elevation,
+                         const std::unordered_map<GraphId, std::pair<size_t, size_t>>& tile_ranges,
+                         std::queue<GraphId>& tilequeue, std::mutex& lock,
+                         std::promise<uint32_t>& result) {
+  // Local Graphreader
+  GraphReader reader(hierarchy_properties);
+
   // Use the sequence that associate new nodes to old nodes
   sequence<std::pair<GraphId, GraphId>> new_to_old(new_to_old_file, false);
 
@@ -154,326 +186,415 @@ void FormTilesInNewLevel(GraphReader& reader, bool has_elevation) {
     }
   };
 
-  // Iterate through the new nodes. They have been sorted by level so that
-  // highway level is done first.
-  reader.Clear();
+  // Iterate through the tiles in the queue
   bool added = false;
-  uint8_t current_level;
+  uint32_t tile_count = 0;
   GraphId tile_id;
   std::hash<std::string> hasher;
-  GraphTileBuilder* tilebuilder = nullptr;
-  for (auto new_node = new_to_old.begin(); new_node != new_to_old.end(); new_node++) {
-    // Get the node - check if a new tile
-    GraphId nodea = (*new_node).first;
-    if (nodea.Tile_Base() != tile_id) {
-      // Store the prior tile
-      if (tilebuilder != nullptr) {
-        tilebuilder->StoreTileData();
-        delete tilebuilder;
-      }
+  while (NextTile(tilequeue, lock, tile_id)) {
+    // New tilebuilder for the tile. Get the range of its new nodes
+    const auto& range = tile_ranges.find(tile_id)->second;
+    uint8_t current_level = tile_id.level();
+    GraphTileBuilder tilebuilder(reader.tile_dir(), tile_id, false);
 
-      // New tilebuilder for the next tile. Update current level.
-      tile_id = nodea.Tile_Base();
-      tilebuilder = new GraphTileBuilder(reader.tile_dir(), tile_id, false);
-      current_level = nodea.level();
+    // Create a dummy admin at index 0. Used if admins are not used/created.
+    tilebuilder.AddAdmin("None", "None", "", "");
 
-      // Create a dummy admin at index 0. Used if admins are not used/created.
-      tilebuilder->AddAdmin("None", "None", "", "");
+    // Iterate through the new nodes in this tile
+    for (auto new_node = new_to_old.at(range.first);
+         new_node.position() < range.second; new_node++) {
+      GraphId nodea = (*new_node).first;
 
-      // Check if we need to clear the base/local tile cache
-      if (reader.OverCommitted()) {
-        reader.Clear();
+      // Get the node in the base level
+      GraphId base_node = (*new_node).second;
+      const GraphTile* tile = reader.GetGraphTile(base_node);
+      if (tile == nullptr) {
+        LOG_ERROR("Base tile is null? ");
+        continue;
       }
-    }
 
-    // Get the node in the base level
-    GraphId base_node = (*new_node).second;
-    const GraphTile* tile = reader.GetGraphTile(base_node);
-    if (tile == nullptr) {
-      LOG_ERROR("Base tile is null? ");
-      continue;
-    }
+      // Copy the data version
+      tilebuilder.header_builder().set_dataset_id(tile->header()->dataset_id());
+
+      // Copy node information
+      NodeInfo baseni = *(tile->node(base_node.id()));
+      tilebuilder.nodes().push_back(baseni);
+      const auto& admin = tile->admininfo(baseni.admin_index());
+      NodeInfo& node = tilebuilder.nodes().back();
+      node.set_edge_index(tilebuilder.directededges().size());
+      node.set_timezone(baseni.timezone());
+      node.set_admin_index(tilebuilder.AddAdmin(admin.country_text(), admin.state_text(),
+                                                admin.country_iso(), admin.state_iso()));
+
+      // Density at this node
+      uint32_t density1 = baseni.density();
+
+      // Current edge count
+      size_t edge_count = tilebuilder.directededges().size();
+
+      // Iterate through directed edges of the base node to get remaining
+      // directed edges (based on classification/importance cutoff)
+      GraphId base_edge_id(base_node.tileid(), base_node.level(), baseni.edge_index());
+      for (uint32_t i = 0; i < baseni.edge_count(); i++, ++base_edge_id) {
+        // Check if the directed edge should exist on this level
+        const DirectedEdge* directededge = tile->directededge(base_edge_id);
+        if (!include_edge(directededge, base_node, current_level)) {
+          continue;
+        }
 
-    // Copy the data version
-    tilebuilder->header_builder().set_dataset_id(tile->header()->dataset_id());
-
-    // Copy node information
-    NodeInfo baseni = *(tile->node(base_node.id()));
-    tilebuilder->nodes().push_back(baseni);
-    const auto& admin = tile->admininfo(baseni.admin_index());
-    NodeInfo& node = tilebuilder->nodes().back();
-    node.set_edge_index(tilebuilder->directededges().size());
-    node.set_timezone(baseni.timezone());
-    node.set_admin_index(tilebuilder->AddAdmin(admin.country_text(), admin.state_text(),
-                                               admin.country_iso(), admin.state_iso()));
-
-    // Density at this node
-    uint32_t density1 = baseni.density();
-
-    // Current edge count
-    size_t edge_count = tilebuilder->directededges().size();
-
-    // Iterate through directed edges of the base node to get remaining
-    // directed edges (based on classification/importance cutoff)
-    GraphId base_edge_id(base_node.tileid(), base_node.level(), baseni.edge_index());
-    for (uint32_t i = 0; i < baseni.edge_count(); i++, ++base_edge_id) {
-      // Check if the directed edge should exist on this level
-      const DirectedEdge* directededge = tile->directededge(base_edge_id);
-      if (!include_edge(directededge, base_node, current_level)) {
-        continue;
-      }
+        // Copy the directed edge information
+        DirectedEdge newedge = *directededge;
 
-      // Copy the directed edge information
-      DirectedEdge newedge = *directededge;
-
-      // Set the end node for this edge. Transit connection edges
-      // remain connected to the same node on the transit level.
-      // Need to set nodeb for use in AddEdgeInfo
-      uint32_t density2 = 32;
-      GraphId nodeb;
-      if (directededge->use() == Use::kTransitConnection) {
-        nodeb = directededge->endnode();
-      } else {
-        auto new_nodes = find_nodes(old_to_new, directededge->endnode());
-        if (current_level == 0) {
-          nodeb = new_nodes.highway_node;
-        } else if (current_level == 1) {
-          nodeb = new_nodes.arterial_node;
+        // Set the end node for this edge. Transit connection edges
+        // remain connected to the same node on the transit level.
+        // Need to set nodeb for use in AddEdgeInfo
+        uint32_t density2 = 32;
+        GraphId nodeb;
+        if (directededge->use() == Use::kTransitConnection) {
+          nodeb = directededge->endnode();
         } else {
-          nodeb = new_nodes.local_node;
+          auto new_nodes = find_nodes(old_to_new, directededge->endnode());
+          if (current_level == 0) {
+            nodeb = new_nodes.highway_node;
+          } else if (current_level == 1) {
+            nodeb = new_nodes.arterial_node;
+          } else {
+            nodeb = new_nodes.local_node;
+          }
+          density2 = new_nodes.density;
         }
-        density2 = new_nodes.density;
-      }
-      if (!nodeb.Is_Valid()) {
-        LOG_ERROR("Invalid end node - not found in old_to_new map");
-      }
-      newedge.set_endnode(nodeb);
-
-      // Set the edge density  to the average of the relative density at the
-      // end nodes.
-      uint32_t edge_density = (density2 == 32) ? density1 :
-                (density1 + density2) / 2;
-      newedge.set_density(edge_density);
-
-      // Set opposing edge indexes to 0 (gets set in graph validator).
-      newedge.set_opp_index(0);
-
-      // Get signs from the base directed edge
-      if (directededge->exitsign()) {
-        std::vector<SignInfo> signs = tile->GetSigns(base_edge_id.id());
-        if (signs.size() == 0) {
-          LOG_ERROR("Base edge should have signs, but none found");
+        if (!nodeb.Is_Valid()) {
+          LOG_ERROR("Invalid end node - not found in old_to_new map");
+        }
+        newedge.set_endnode(nodeb);
+
+        // Set the edge density  to the average of the relative density at the
+        // end nodes.
+        uint32_t edge_density = (density2 == 32) ? density1 :
+                  (density1 + density2) / 2;
+        newedge.set_density(edge_density);
+
+        // Set opposing edge indexes to 0 (gets set in graph validator).
+        newedge.set_opp_index(0);
+
+        // Get signs from the base directed edge
+        if (directededge->exitsign()) {
+          std::vector<SignInfo> signs = tile->GetSigns(base_edge_id.id());
+          if (signs.size() == 0) {
+            LOG_ERROR("Base edge should have signs, but none found");
+          }
+          tilebuilder.AddSigns(tilebuilder.directededges().size(), signs);
         }
-        tilebuilder->AddSigns(tilebuilder->directededges().size(), signs);
-      }
 
-      // Get access restrictions from the base directed edge. Add these to
-      // the list of access restrictions in the new tile. Update the
-      // edge index in the restriction to be the current directed edge Id
-      if (directededge->access_restriction()) {
-        auto restrictions = tile->GetAccessRestrictions(base_edge_id.id(), kAllAccess);
-        for (const auto& res : restrictions) {
-          tilebuilder->AddAccessRestriction(
-              AccessRestriction(tilebuilder->directededges().size(),
-                 res.type(), res.modes(), res.value()));
+        // Get access restrictions from the base directed edge. Add these to
+        // the list of access restrictions in the new tile. Update the
+        // edge index in the restriction to be the current directed edge Id
+        if (directededge->access_restriction()) {
+          auto restrictions = tile->GetAccessRestrictions(base_edge_id.id(), kAllAccess);
+          for (const auto& res : restrictions) {
+            tilebuilder.AddAccessRestriction(
+                AccessRestriction(tilebuilder.directededges().size(),
+                   res.type(), res.modes(), res.value()));
+          }
         }
-      }
 
-      // Copy lane connectivity
-      if (directededge->laneconnectivity()) {
-        auto laneconnectivity = tile->GetLaneConnectivity(base_edge_id.id());
-        if (laneconnectivity.size() == 0) {
-          LOG_ERROR("Base edge should have lane connectivity, but none found");
+        // Copy lane connectivity
+        if (directededge->laneconnectivity()) {
+          auto laneconnectivity = tile->GetLaneConnectivity(base_edge_id.id());
+          if (laneconnectivity.size() == 0) {
+            LOG_ERROR("Base edge should have lane connectivity, but none found");
+          }
+          for (auto& lc : laneconnectivity) {
+            lc.set_to(tilebuilder.directededges().size());
+          }
+          tilebuilder.AddLaneConnectivity(laneconnectivity);
         }
-        for (auto& lc : laneconnectivity) {
-          lc.set_to(tilebuilder->directededges().size());
+
+        // Get edge info, shape, and names from the old tile and add to the
+        // new. Cannot use edge info offset since edges in arterial and
+        // highway hierarchy can cross base tiles! Use a hash based on the
+        // encoded shape plus way Id.
+        uint32_t idx = directededge->edgeinfo_offset();
+        auto edgeinfo = tile->edgeinfo(idx);
+        std::string encoded_shape = edgeinfo.encoded_shape();
+        uint32_t w = hasher(encoded_shape + std::to_string(edgeinfo.wayid()));
+        uint32_t edge_info_offset = tilebuilder.AddEdgeInfo(w, nodea, nodeb,
+                      edgeinfo.wayid(), encoded_shape,
+                      tile->GetNames(idx), added);
+        newedge.set_edgeinfo_offset(edge_info_offset);
+
+        // Add directed edge
+        tilebuilder.directededges().emplace_back(std::move(newedge));
+
+        // Add edge elevation
+        if (has_elevation) {
+          const EdgeElevation* elev = tile->edge_elevation(base_edge_id);
+          if (elev == nullptr) {
+            tilebuilder.edge_elevations().emplace_back(0.0f, 0.0f, 0.0f);
+          } else {
+            tilebuilder.edge_elevations().emplace_back(std::move(*elev));
+          }
         }
-        tilebuilder->AddLaneConnectivity(laneconnectivity);
       }
 
-      // Get edge info, shape, and names from the old tile and add to the
-      // new. Cannot use edge info offset since edges in arterial and
-      // highway hierarchy can cross base tiles! Use a hash based on the
-      // encoded shape plus way Id.
-      uint32_t idx = directededge->edgeinfo_offset();
-      auto edgeinfo = tile->edgeinfo(idx);
-      std::string encoded_shape = edgeinfo.encoded_shape();
-      uint32_t w = hasher(encoded_shape + std::to_string(edgeinfo.wayid()));
-      uint32_t edge_info_offset = tilebuilder->AddEdgeInfo(w, nodea, nodeb,
-                    edgeinfo.wayid(), encoded_shape,
-                    tile->GetNames(idx), added);
-      newedge.set_edgeinfo_offset(edge_info_offset);
-
-      // Add directed edge
-      tilebuilder->directededges().emplace_back(std::move(newedge));
-
-      // Add edge elevation
-      if (has_elevation) {
-        const EdgeElevation* elev = tile->edge_elevation(base_edge_id);
-        if (elev == nullptr) {
-          tilebuilder->edge_elevations().emplace_back(0.0f, 0.0f, 0.0f);
-        } else {
-          tilebuilder->edge_elevations().emplace_back(std::move(*elev));
-        }
+      // Add transition edges
+      auto new_nodes = find_nodes(old_to_new, base_node);
+      if (current_level == 0) {
+        AddDownwardTransition(new_nodes.arterial_node, &tilebuilder, has_elevation);
+        AddDownwardTransition(new_nodes.local_node, &tilebuilder, has_elevation);
+      } else if (current_level == 1) {
+        AddDownwardTransition(new_nodes.local_node, &tilebuilder, has_elevation);
+        AddUpwardTransition(new_nodes.highway_node, &tilebuilder, has_elevation);
+      }
+      if (current_level == 2) {
+        AddUpwardTransition(new_nodes.arterial_node, &tilebuilder, has_elevation);
+        AddUpwardTransition(new_nodes.highway_node, &tilebuilder, has_elevation);
       }
-    }
 
-    // Add transition edges
-    auto new_nodes = find_nodes(old_to_new, base_node);
-    if (current_level == 0) {
-      AddDownwardTransition(new_nodes.arterial_node, tilebuilder, has_elevation);
-      AddDownwardTransition(new_nodes.local_node, tilebuilder, has_elevation);
-    } else if (current_level == 1) {
-      AddDownwardTransition(new_nodes.local_node, tilebuilder, has_elevation);
-      AddUpwardTransition(new_nodes.highway_node, tilebuilder, has_elevation);
-    }
-    if (current_level == 2) {
-      AddUpwardTransition(new_nodes.arterial_node, tilebuilder, has_elevation);
-      AddUpwardTransition(new_nodes.highway_node, tilebuilder, has_elevation);
+      // Set the edge count for the new node
+      node.set_edge_count(tilebuilder.directededges().size() - edge_count);
     }
 
-    // Set the edge count for the new node
-    node.set_edge_count(tilebuilder->directededges().size() - edge_count);
-  }
+    // Store the tile
+    tilebuilder.StoreTileData();
+    tile_count++;
 
-  // Delete the tile builder
-  if (tilebuilder != nullptr) {
-    tilebuilder->StoreTileData();
-    delete tilebuilder;
+    // Check if we need to clear the base/local tile cache
+    if (reader.OverCommitted()) {
+      reader.Clear();
+    }
   }
+  result.set_value(tile_count);
 }
 
-/**
- * Create node associations between "new" nodes placed into respective
- * hierarchy levels and the existing nodes on the base/local level. The
- * associations go both ways: from the "old" nodes on the base/local level
- * to new nodes (using a mapping in memory) and from new nodes to old nodes
- * using a sequence (file).
- * @return  Returns true if any base tiles have edge elevation data.
- */
-bool CreateNodeAssociations(GraphReader& reader) {
-  // Map of tiles vs. count of nodes. Used to construct new node Ids.
-  std::unordered_map<GraphId, uint32_t> new_nodes;
-
-  // lambda to get the next "new" node Id given a tile
-  auto get_new_node = [&new_nodes](const GraphId& tile) {
-    auto itr = new_nodes.find(tile);
-    if (itr == new_nodes.end()) {
-      GraphId new_node(tile.tileid(), tile.level(), 0);
-      new_nodes[tile] = 1;
-      return new_node;
-    } else {
-      GraphId new_node(tile.tileid(), tile.level(), itr->second);
-      itr->second++;
-      return new_node;
+// Get the tiles in which new nodes are placed for a base/local node, indexed
+// by hierarchy level (highway, arterial, local). A tile is invalid if the
+// node does not exist on that level.
+std::array<GraphId, 3> GetNewNodeTiles(const GraphTile* tile,
+                                       const GraphId& basenode) {
+  // Iterate through the edges to see which levels this node exists.
+  // Skip transit connection edges
+  bool levels[3] = { false, false, false };
+  const NodeInfo* nodeinfo = tile->node(basenode);
+  const DirectedEdge* directededge = tile->directededge(nodeinfo->edge_index());
+  for (uint32_t j = 0; j < nodeinfo->edge_count(); j++, directededge++) {
+    if (directededge->use() != Use::kTransitConnection) {
+      levels[TileHierarchy::get_level(directededge->classification())] = true;
     }
-  };
-
-  // Create a sequence to associate new nodes to old nodes
-  sequence<std::pair<GraphId, GraphId>> new_to_old(new_to_old_file, true);
-
-  // Create a sequence to associate new nodes to old nodes
-  sequence<OldToNewNodes> old_to_new(old_to_new_file, true);
+  }
 
   // Hierarchy level information
   auto tile_level = TileHierarchy::levels().rbegin();
-  auto& base_level = tile_level->second;
   tile_level++;
   auto& arterial_level = tile_level->second;
   tile_level++;
   auto& highway_level = tile_level->second;
 
-  // Iterate through all tiles in the local level
-  bool has_elevation = false;
-  uint32_t ntiles = base_level.tiles.TileCount();
-  uint32_t bl = static_cast<uint32_t>(base_level.level);
-  uint32_t al = static_cast<uint32_t>(arterial_level.level);
-  uint32_t hl = static_cast<uint32_t>(highway_level.level);
-  for (uint32_t basetileid = 0; basetileid < ntiles; basetileid++) {
-    // Get the graph tile. Skip if no tile exists (common case)
-    const GraphTile* tile = reader.GetGraphTile(GraphId(basetileid, bl, 0));
+  std::array<GraphId, 3> new_tiles;
+  if (levels[0]) {
+    new_tiles[0] = GraphId(highway_level.tiles.TileId(nodeinfo->latlng()),
+                           highway_level.level, 0);
+  }
+  if (levels[1]) {
+    new_tiles[1] = GraphId(arterial_level.tiles.TileId(nodeinfo->latlng()),
+                           arterial_level.level, 0);
+  }
+  if (levels[2]) {
+    new_tiles[2] = basenode.Tile_Base();
+  }
+  return new_tiles;
+}
+
+// Count the new nodes each base tile in the queue adds to the new tiles.
+// The counts are used to assign new node Ids in base tile order, so the
+// Ids do not depend on which thread gets to a base tile first.
+void CountNewNodes(const boost::property_tree::ptree& hierarchy_properties,
+                   std::queue<GraphId>& tilequeue, std::mutex& lock,
+                   std::map<GraphId, std::unordered_map<GraphId, uint32_t>>& new_node_counts,
+                   bool& has_elevation, std::promise<uint32_t>& result) {
+  // Local Graphreader
+  GraphReader reader(hierarchy_properties);
+
+  uint32_t tile_count = 0;
+  GraphId tile_id;
+  while (NextTile(tilequeue, lock, tile_id)) {
+    // Get the graph tile. Skip if the tile is empty
+    const GraphTile* tile = reader.GetGraphTile(tile_id);
     if (tile == nullptr || tile->header()->nodecount() == 0) {
       continue;
     }
 
-    // Update the has_elevation flag
+    // Count the new nodes in each new tile
+    std::unordered_map<GraphId, uint32_t> counts;
+    GraphId basenode = tile_id;
+    for (uint32_t i = 0; i < tile->header()->nodecount(); i++, ++basenode) {
+      for (const auto& new_tile : GetNewNodeTiles(tile, basenode)) {
+        if (new_tile.Is_Valid()) {
+          counts[new_tile]++;
+        }
+      }
+    }
+
+    lock.lock();
+    new_node_counts[tile_id] = std::move(counts);
     if (tile->header()->has_edge_elevation()) {
       has_elevation = true;
     }
+    lock.unlock();
+    tile_count++;
+
+    // Check if we need to clear the tile cache
+    if (reader.OverCommitted()) {
+      reader.Clear();
+    }
+  }
+  result.set_value(tile_count);
+}
+
+// Associate new nodes to the base/local nodes for the tiles in the queue.
+// first_ids holds, per base tile, the first new node Id to use within each
+// new tile. Associations are added to the shared sequences under the lock.
+void AssociateNodes(const boost::property_tree::ptree& hierarchy_properties,
+                    std::queue<GraphId>& tilequeue, std::mutex& lock,
+                    const std::map<GraphId, std::unordered_map<GraphId, uint32_t>>& first_ids,
+                    sequence<std::pair<GraphId, GraphId>>& new_to_old,
+                    sequence<OldToNewNodes>& old_to_new,
+                    std::promise<uint32_t>& result) {
+  // Local Graphreader
+  GraphReader reader(hierarchy_properties);
+
+  uint32_t node_count = 0;
+  GraphId tile_id;
+  std::vector<std::pair<GraphId, GraphId>> new_to_old_nodes;
+  std::vector<OldToNewNodes> old_to_new_nodes;
+  while (NextTile(tilequeue, lock, tile_id)) {
+    // Get the graph tile and the next new node Id within each new tile
+    const GraphTile* tile = reader.GetGraphTile(tile_id);
+    std::unordered_map<GraphId, uint32_t> next_ids = first_ids.find(tile_id)->second;
 
     // Iterate through the nodes. Add nodes to the new level when
     // best road class <= the new level classification cutoff
-    bool levels[3];
-    uint32_t nodecount = tile->header()->nodecount();
-    GraphId basenode(basetileid, bl, 0);
-    GraphId edgeid(basetileid, bl, 0);
-    const NodeInfo* nodeinfo = tile->node(basenode);
-    for (uint32_t i = 0; i < nodecount; i++, nodeinfo++, ++basenode) {
-      // Iterate through the edges to see which levels this node exists.
-      levels[0] = levels[1] = levels[2] = false;
-      for (uint32_t j = 0; j < nodeinfo->edge_count(); j++, ++edgeid) {
-        // Update the flag for the level of this edge (skip transit
-        // connection edges)
-        const DirectedEdge* directededge = tile->directededge(edgeid);
-        if (directededge->use() != Use::kTransitConnection) {
-          levels[TileHierarchy::get_level(directededge->classification())] = true;
-        }
-      }
-
+    new_to_old_nodes.clear();
+    old_to_new_nodes.clear();
+    GraphId basenode = tile_id;
+    for (uint32_t i = 0; i < tile->header()->nodecount(); i++, ++basenode) {
       // Associate new nodes to base nodes and base node to new nodes
-      GraphId highway_node, arterial_node, local_node;
-      if (levels[0]) {
-        // New node is on the highway level. Associate back to base/local node
-        GraphId new_tile(highway_level.tiles.TileId(nodeinfo->latlng()), hl, 0);
-        highway_node = get_new_node(new_tile);
-        new_to_old.push_back(std::make_pair(highway_node, basenode));
-      }
-      if (levels[1]) {
-        // New node is on the arterial level. Associate back to base/local node
-        GraphId new_tile(arterial_level.tiles.TileId(nodeinfo->latlng()), al, 0);
-        arterial_node = get_new_node(new_tile);
-        new_to_old.push_back(std::make_pair(arterial_node, basenode));
-      }
-      if (levels[2]) {
-        // New node is on the local level. Associate back to base/local node
-        GraphId new_tile(basetileid, bl, 0);
-        local_node = get_new_node(new_tile);
-        new_to_old.push_back(std::make_pair(local_node, basenode));
+      std::array<GraphId, 3> new_nodes;
+      auto new_tiles = GetNewNodeTiles(tile, basenode);
+      for (uint32_t l = 0; l < 3; l++) {
+        if (new_tiles[l].Is_Valid()) {
+          new_nodes[l] = GraphId(new_tiles[l].tileid(), new_tiles[l].level(),
+                                 next_ids[new_tiles[l]]++);
+          new_to_old_nodes.emplace_back(new_nodes[l], basenode);
+        }
       }
-
-      if (!levels[0] && !levels[1] && !levels[2]) {
+      if (!new_tiles[0].Is_Valid() && !new_tiles[1].Is_Valid() &&
+          !new_tiles[2].Is_Valid()) {
         LOG_ERROR("No valid level for this node!");
       }
 
       // Associate the old node to the new node(s). Entries in the tuple
       // that are invalid nodes indicate no node exists in the new level.
-      OldToNewNodes assoc(basenode, highway_node, arterial_node,
-                           local_node, nodeinfo->density());
-      old_to_new.push_back(assoc);
+      old_to_new_nodes.emplace_back(basenode, new_nodes[0], new_nodes[1],
+                           new_nodes[2], tile->node(basenode)->density());
+    }
+
+    // Add the associations. Both sequences are sorted afterwards so the
+    // order threads add them in does not matter
+    lock.lock();
+    for (const auto& n : new_to_old_nodes) {
+      new_to_old.push_back(n);
+    }
+    for (const auto& n : old_to_new_nodes) {
+      old_to_new.push_back(n);
     }
+    lock.unlock();
+    node_count += old_to_new_nodes.size();
 
     // Check if we need to clear the tile cache
-    if(reader.OverCommitted()) {
+    if (reader.OverCommitted()) {
       reader.Clear();
     }
   }
+  result.set_value(node_count);
+}
+
+/**
+ * Create node associations between "new" nodes placed into respective
+ * hierarchy levels and the existing nodes on the base/local level. The
+ * associations go both ways: from the "old" nodes on the base/local level
+ * to new nodes and from new nodes to old nodes using sequences (files).
+ * Base tiles are processed by multiple threads in two passes: the first
+ * counts the new nodes per tile so that the second can hand out the same
+ * new node Ids a single thread walking the base tiles in order would.
+ * @return  Returns true if any base tiles have edge elevation data.
+ */
+bool CreateNodeAssociations(const boost::property_tree::ptree& hierarchy_properties,
+                            const unsigned int thread_count) {
+  // Queue up the tiles in the local level
+  auto& base_level = TileHierarchy::levels().rbegin()->second;
+  std::queue<GraphId> tilequeue;
+  for (uint32_t id = 0; id < base_level.tiles.TileCount(); id++) {
+    GraphId tile_id(id, base_level.level, 0);
+    if (GraphReader::DoesTileExist(hierarchy_properties, tile_id)) {
+      tilequeue.push(tile_id);
+    }
+  }
+
+  // Count new nodes per base tile and new tile
+  std::mutex lock;
+  bool has_elevation = false;
+  std::map<GraphId, std::unordered_map<GraphId, uint32_t>> new_node_ids;
+  RunThreads(thread_count, [&](std::promise<uint32_t>& result) {
+    CountNewNodes(hierarchy_properties, tilequeue, lock, new_node_ids,
+                  has_elevation, result);
+  });
+
+  // Turn the counts into the first new node Id each base tile uses within
+  // each new tile. Walk the base tiles in order.
+  std::unordered_map<GraphId, uint32_t> new_nodes;
+  for (auto& base_tile : new_node_ids) {
+    tilequeue.push(base_tile.first);
+    for (auto& new_tile : base_tile.second) {
+      uint32_t count = new_tile.second;
+      uint32_t& next_id = new_nodes[new_tile.first];
+      new_tile.second = next_id;
+      next_id += count;
+    }
+  }
+
+  // Create a sequence to associate new nodes to old nodes
+  sequence<std::pair<GraphId, GraphId>> new_to_old(new_to_old_file, true);
+
+  // Create a sequence to associate old nodes to new nodes
+  sequence<OldToNewNodes> old_to_new(old_to_new_file, true);
+
+  // Associate the nodes
+  uint32_t count = RunThreads(thread_count, [&](std::promise<uint32_t>& result) {
+    AssociateNodes(hierarchy_properties, tilequeue, lock, new_node_ids,
+                   new_to_old, old_to_new, result);
+  });
+  LOG_INFO("Associated " + std::to_string(count) + " base nodes");
   return has_elevation;
 }
 
 /**
- * Update end nodes of transit connection directed edges.
+ * Update end nodes of transit connection directed edges for the transit
+ * tiles in the queue.
  */
-void UpdateTransitConnections(GraphReader& reader) {
+void UpdateTransitConnections(const boost::property_tree::ptree& hierarchy_properties,
+                              std::queue<GraphId>& tilequeue, std::mutex& lock,
+                              std::promise<uint32_t>& result) {
+  // Local Graphreader
+  GraphReader reader(hierarchy_properties);
+
   // Use the sorted sequence that associates old nodes to new nodes
   sequence<OldToNewNodes> old_to_new(old_to_new_file, false);
 
-  auto tile_level = TileHierarchy::levels().rbegin();
-  auto& base_level = tile_level->second;
-  uint8_t transit_level = base_level.level + 1;
-  uint32_t ntiles = base_level.tiles.TileCount();
-  for (uint32_t basetileid = 0; basetileid < ntiles; basetileid++) {
-    // Get the graph tile. Skip if no tile exists (common case)
-    GraphId tile_id(basetileid, transit_level, 0);
+  uint32_t tile_count = 0;
+  GraphId tile_id;
+  while (NextTile(tilequeue, lock, tile_id)) {
+    // Get the graph tile. Skip if the tile is empty
     const GraphTile* tile = reader.GetGraphTile(tile_id);
     if (tile == nullptr || tile->header()->nodecount() == 0) {
       continue;
@@ -516,7 +637,14 @@ void UpdateTransitConnections(GraphReader& reader) {
        nodes.emplace_back(std::move(nodeinfo));
     }
     tilebuilder.Update(nodes, directededges);
+    tile_count++;
+
+    // Check if we need to clear the tile cache
+    if (reader.OverCommitted()) {
+      reader.Clear();
+    }
   }
+  result.set_value(tile_count);
 }
 
 // Remove any base tiles that no longer have any data (nodes and edges
@@ -556,16 +684,16 @@ namespace mjolnir {
 // base level. Each successive level of the hierarchy is based on
 // and connected to the next.
 void HierarchyBuilder::Build(const boost::property_tree::ptree& pt) {
+  // Number of threads to work on the tiles of each step
+  unsigned int thread_count = std::max(static_cast<unsigned int>(1),
+    pt.get<unsigned int>("concurrency", std::thread::hardware_concurrency()));
 
-  // TODO: thread this. Might be more possible now that we don't create
-  // shortcuts in the HierarchyBuilder
-
-  // Construct GraphReader
   LOG_INFO("HierarchyBuilder");
-  GraphReader reader(pt.get_child("mjolnir"));
+  boost::property_tree::ptree hierarchy_properties = pt.get_child("mjolnir");
+  std::string tile_dir = hierarchy_properties.get<std::string>("tile_dir");
 
   // Association of old nodes to new nodes
-  bool has_elevation = CreateNodeAssociations(reader);
+  bool has_elevation = CreateNodeAssociations(hierarchy_properties, thread_count);
   if (has_elevation) {
     LOG_INFO("Base tiles have edge elevation information");
   }
@@ -573,16 +701,63 @@ void HierarchyBuilder::Build(const boost::property_tree::ptree& pt) {
   // Sort the sequences
   SortSequences();
 
+  // Find the range of new nodes within each new tile. The new to old
+  // sequence is sorted by level so that the highway level comes first.
+  std::unordered_map<GraphId, std::pair<size_t, size_t>> tile_ranges;
+  std::map<uint8_t, std::deque<GraphId>> level_tiles;
+  {
+    sequence<std::pair<GraphId, GraphId>> new_to_old(new_to_old_file, false);
+    GraphId tile_id;
+    size_t begin = 0, index = 0;
+    for (auto new_node = new_to_old.begin(); new_node != new_to_old.end();
+         new_node++, index++) {
+      GraphId new_tile = (*new_node).first.Tile_Base();
+      if (new_tile != tile_id) {
+        if (tile_id.Is_Valid()) {
+          tile_ranges[tile_id] = std::make_pair(begin, index);
+        }
+        tile_id = new_tile;
+        begin = index;
+        level_tiles[tile_id.level()].push_back(tile_id);
+      }
+    }
+    if (tile_id.Is_Valid()) {
+      tile_ranges[tile_id] = std::make_pair(begin, index);
+    }
+  }
+
   // Iterate through the hierarchy (from highway down to local) and build
-  // new tiles
-  FormTilesInNewLevel(reader, has_elevation);
+  // new tiles. Levels are done one at a time: tiles on the local level are
+  // written over the base tiles the levels above are formed from.
+  std::mutex lock;
+  for (auto& level : level_tiles) {
+    std::random_shuffle(level.second.begin(), level.second.end());
+    std::queue<GraphId> tilequeue(level.second);
+    uint32_t count = RunThreads(thread_count, [&](std::promise<uint32_t>& result) {
+      FormTilesInNewLevel(hierarchy_properties, has_elevation, tile_ranges,
+                          tilequeue, lock, result);
+    });
+    LOG_INFO("Formed " + std::to_string(count) + " tiles on level " +
+             std::to_string(level.first));
+  }
 
   // Remove any base tiles that no longer have any data (nodes and edges
   // only exist on arterial and highway levels)
-  RemoveUnusedLocalTiles(reader.tile_dir());
+  RemoveUnusedLocalTiles(tile_dir);
 
   // Update the end nodes to all transit connections in the transit hierarchy
-  UpdateTransitConnections(reader);
+  auto& base_level = TileHierarchy::levels().rbegin()->second;
+  uint8_t transit_level = base_level.level + 1;
+  std::queue<GraphId> tilequeue;
+  for (uint32_t id = 0; id < base_level.tiles.TileCount(); id++) {
+    GraphId tile_id(id, transit_level, 0);
+    if (GraphReader::DoesTileExist(hierarchy_properties, tile_id)) {
+      tilequeue.push(tile_id);
+    }
+  }
+  RunThreads(thread_count, [&](std::promise<uint32_t>& result) {
+    UpdateTransitConnections(hierarchy_properties, tilequeue, lock, result);
+  });
   LOG_INFO("Done HierarchyBuilder");
 }
 
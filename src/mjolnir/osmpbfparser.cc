@@ -32,6 +32,11 @@
 #include <zlib.h>
 #include <vector>
 #include <unordered_map>
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <memory>
+#include <thread>
 
 #include "mjolnir/osmpbfparser.h"
 #include "midgard/logging.h"
@@ -44,6 +49,8 @@ namespace {
 #define MAX_BLOB_HEADER_SIZE 65536
 // the maximum size of an uncompressed blob in bytes 32 MB
 #define MAX_UNCOMPRESSED_BLOB_SIZE 33554432
+// how many blobs each thread decodes per batch
+#define BLOBS_PER_THREAD 2
 
 BlobHeader read_header(char* buffer, std::ifstream& file, bool& finished) {
   BlobHeader result;
@@ -73,8 +80,18 @@ BlobHeader read_header(char* buffer, std::ifstream& file, bool& finished) {
   return result;
 }
 
-int32_t read_blob(char* buffer, char* unpack_buffer, std::ifstream& file, const BlobHeader & header) {
-  Blob blob;
+// raw bytes of a blob as read from the file along with its type
+struct raw_blob_t {
+  std::string type;
+  std::string data;
+};
+
+bool read_raw_blob(char* buffer, std::ifstream& file, raw_blob_t& raw) {
+  //grab the blob header
+  bool finished = false;
+  BlobHeader header = read_header(buffer, file, finished);
+  if (finished)
+    return false;
 
   //is the size of the following blob sane
   int32_t sz = header.datasize();
@@ -82,28 +99,35 @@ int32_t read_blob(char* buffer, char* unpack_buffer, std::ifstream& file, const
     throw std::runtime_error("blob-size is bigger than allowed");
 
   //pull out the bytes
-  if (!file.read(buffer, sz))
+  raw.type = header.type();
+  raw.data.resize(sz);
+  if (!file.read(&raw.data[0], sz))
     throw std::runtime_error("unable to read blob from file");
+  return true;
+}
 
+void read_blob(const std::string& data, std::string& unpacked) {
   //turn it into a protobuf object
-  if (!blob.ParseFromArray(buffer, sz))
+  Blob blob;
+  if (!blob.ParseFromString(data))
     throw std::runtime_error("unable to parse blob");
 
   //if the blob was uncompressed
   if (blob.has_raw()) {
     //check that raw_size is set correctly and move it to the final buffer
-    sz = blob.raw().size();
-    if (sz != blob.raw_size())
+    if (static_cast<int32_t>(blob.raw().size()) != blob.raw_size())
       LOG_WARN("blob reports wrong raw_size: " + std::to_string(blob.raw_size()) + " bytes");
-    memcpy(unpack_buffer, buffer, sz);
-    return sz;
+    unpacked = std::move(*blob.mutable_raw());
+    return;
   }//if the blob was zlib compressed
   else if (blob.has_zlib_data()) {
-    sz = blob.zlib_data().size();
+    if (blob.raw_size() > MAX_UNCOMPRESSED_BLOB_SIZE)
+      throw std::runtime_error("blob-size is bigger than allowed");
+    unpacked.resize(blob.raw_size());
     z_stream z;
     z.next_in = (unsigned char*) blob.zlib_data().c_str();
-    z.avail_in = sz;
-    z.next_out = (unsigned char*) unpack_buffer;
+    z.avail_in = blob.zlib_data().size();
+    z.next_out = (unsigned char*) &unpacked[0];
     z.avail_out = blob.raw_size();
     z.zalloc = Z_NULL;
     z.zfree = Z_NULL;
@@ -114,7 +138,8 @@ int32_t read_blob(char* buffer, char* unpack_buffer, std::ifstream& file, const
       throw std::runtime_error("failed to inflate zlib stream");
     if (inflateEnd(&z) != Z_OK)
       throw std::runtime_error("failed to deinit zlib stream");
-    return z.total_out;
+    unpacked.resize(z.total_out);
+    return;
   }
 
   //if the blob was lzma compressed
@@ -137,12 +162,7 @@ OSMPBF::Tags get_tags(const T& object, const OSMPBF::PrimitiveBlock &primblock)
   return result;
 }
 
-void parse_primitive_block(char* unpack_buffer, int32_t sz, const Interest interest, Callback& callback) {
-  //turn the blob bytes into a protobuf object
-  PrimitiveBlock primblock;
-  if (!primblock.ParseFromArray(unpack_buffer, sz))
-    throw std::runtime_error("unable to parse primitive block");
-
+void parse_primitive_block(const PrimitiveBlock& primblock, const Interest interest, Callback& callback) {
   //for each primitive group
   for (const auto& primitive_group : primblock.primitivegroup()) {
 
@@ -232,15 +252,71 @@ void parse_primitive_block(char* unpack_buffer, int32_t sz, const Interest inter
   }
 }
 
-void parse_header_block(char* unpack_buffer, int32_t sz) {
+void parse_header_block(const std::string& unpacked) {
   //turn the blob bytes into a protobuf object
   HeaderBlock header_block;
-  if (!header_block.ParseFromArray(unpack_buffer, sz))
+  if (!header_block.ParseFromString(unpacked))
     throw std::runtime_error("unable to parse header block");
 
   //TODO: do something with replication information?
 }
 
+// a blob decoded into the primitive block it holds, if it held one
+struct decoded_blob_t {
+  std::string type;
+  std::unique_ptr<PrimitiveBlock> block;
+};
+
+// decompress and parse a batch of blobs. each thread takes a contiguous run of
+// blobs so the results stay in file order. if there are workers each thread also
+// makes the callbacks for its run on its own worker and the blocks are dropped
+std::vector<decoded_blob_t> decode_blobs(std::vector<raw_blob_t> raw, const unsigned int threads,
+    const Interest interest, const std::vector<Callback*> workers) {
+  std::vector<decoded_blob_t> decoded(raw.size());
+  const size_t run = (raw.size() + threads - 1) / threads;
+  auto decode = [&raw, &decoded, &workers, interest, run](const size_t t) {
+    std::string unpacked;
+    for (size_t i = t * run; i < std::min((t + 1) * run, raw.size()); ++i) {
+      decoded[i].type = std::move(raw[i].type);
+      //if its data parse it
+      if (decoded[i].type == "OSMData") {
+        read_blob(raw[i].data, unpacked);
+        decoded[i].block.reset(new PrimitiveBlock);
+        if (!decoded[i].block->ParseFromString(unpacked))
+          throw std::runtime_error("unable to parse primitive block");
+        if (!workers.empty()) {
+          parse_primitive_block(*decoded[i].block, interest, *workers[t]);
+          decoded[i].block.reset();
+        }
+      }//if its something other than a header
+      else if (decoded[i].type == "OSMHeader") {
+        read_blob(raw[i].data, unpacked);
+        parse_header_block(unpacked);
+      }
+      //free the raw bytes as soon as we are done with them
+      std::string().swap(raw[i].data);
+    }
+  };
+
+  //run the extra threads and then do our share, rethrowing anything the threads hit
+  std::vector<std::thread> pool;
+  std::vector<std::exception_ptr> errors(threads);
+  for (unsigned int t = 1; t < threads && t * run < raw.size(); ++t) {
+    pool.emplace_back([&decode, &errors, t]() {
+      try { decode(t); }
+      catch (...) { errors[t] = std::current_exception(); }
+    });
+  }
+  try { decode(0); }
+  catch (...) { errors[0] = std::current_exception(); }
+  for (auto& thread : pool)
+    thread.join();
+  for (const auto& error : errors)
+    if (error)
+      std::rethrow_exception(error);
+  return decoded;
+}
+
 }
 
 // extend the protobuf osmpbf namespace
@@ -252,37 +328,64 @@ Member::Member(const Relation::MemberType type, const uint64_t id, const std::st
 Member::Member(Member&& other): member_type(other.member_type), member_id(other.member_id), role(std::move(other.role)) {
 }
 
-void Parser::parse(std::ifstream& file, const Interest interest, Callback& callback) {
-  char* buffer = new char[MAX_UNCOMPRESSED_BLOB_SIZE];
-  char* unpack_buffer = new char[MAX_UNCOMPRESSED_BLOB_SIZE];
+void Parser::parse(std::ifstream& file, const Interest interest, Callback& callback, const unsigned int threads) {
+  //only used for blob headers now, the blobs themselves are read into their own buffers
+  std::unique_ptr<char[]> buffer(new char[MAX_BLOB_HEADER_SIZE]);
 
   //start from the top
   file.clear();
   file.seekg(0, std::ios::beg);
 
-  //while there is more to read
-  while (!file.eof()) {
-    //grab the blob header
-    bool finished = false;
-    BlobHeader header = read_header(buffer, file, finished);
-    //if we didnt hit the end
-    if (!finished) {
-      //grab the blob that goes with the blob header
-      int32_t sz = read_blob(buffer, unpack_buffer, file, header);
-      //if its data parse it
-      if (header.type() == "OSMData")
-        parse_primitive_block(unpack_buffer, sz, interest, callback);
-      //if its something other than a header
-      else if (header.type() == "OSMHeader")
-        parse_header_block(unpack_buffer, sz);
-      else
-        LOG_WARN("Unknown blob type: " + header.type());
+  //read the next batch of blobs, enough to keep all the threads busy
+  const unsigned int decoders = std::max(threads, 1u);
+  const size_t batch_size = decoders * BLOBS_PER_THREAD;
+  auto read_batch = [&file, &buffer, batch_size]() {
+    std::vector<raw_blob_t> batch;
+    raw_blob_t raw;
+    while (batch.size() < batch_size && !file.eof() && read_raw_blob(buffer.get(), file, raw))
+      batch.emplace_back(std::move(raw));
+    return batch;
+  };
+
+  //if the callback can run in parallel we need a worker per decoder thread. we keep two
+  //sets of them so one set can be merged while the other is busy with the next batch
+  std::vector<std::unique_ptr<Callback> > workers;
+  for (unsigned int w = 0; w < decoders * 2; ++w) {
+    workers.emplace_back(callback.worker());
+    if (!workers.back()) {
+      workers.clear();
+      break;
+    }
+  }
+  auto worker_set = [&workers, decoders](const size_t set) {
+    std::vector<Callback*> result;
+    for (size_t w = set * decoders; w < workers.size() && w < (set + 1) * decoders; ++w)
+      result.push_back(workers[w].get());
+    return result;
+  };
+
+  //decompressing and decoding the blobs, and making the callbacks if we have workers,
+  //happens on the decoder threads while we walk or merge the previous batch. either way
+  //the results land in file order so they are the same as a single threaded parse
+  size_t set = 0;
+  auto pending = std::async(std::launch::async, decode_blobs, read_batch(), decoders, interest, worker_set(set));
+  while (true) {
+    auto decoded = pending.get();
+    if (decoded.empty())
+      break;
+    const size_t merging = set;
+    set ^= 1;
+    pending = std::async(std::launch::async, decode_blobs, read_batch(), decoders, interest, worker_set(set));
+
+    for (auto* worker : worker_set(merging))
+      callback.merge(*worker);
+    for (const auto& blob : decoded) {
+      if (blob.block)
+        parse_primitive_block(*blob.block, interest, callback);
+      else if (blob.type != "OSMHeader" && blob.type != "OSMData")
+        LOG_WARN("Unknown blob type: " + blob.type);
     }
   }
-
-  //done with protobuf and buffers
-  delete [] buffer;
-  delete [] unpack_buffer;
 }
 
 void Parser::free() {
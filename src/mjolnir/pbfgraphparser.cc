@@ -35,6 +35,82 @@ constexpr uint64_t kMaxOSMNodeId = 5000000000;
 // Absurd classification.
 constexpr uint32_t kAbsurdRoadClass = 777777;
 
+// Runs the lua tag transform, which is most of the parse time, on a parsing thread and
+// keeps the results so that graph_callback can process them in file order when it merges
+struct transform_callback : public OSMPBF::Callback {
+ public:
+  transform_callback(const std::string& lua, const IdTable& shape) :
+    lua_(lua), shape_(shape), max_changeset_id_(0) {
+  }
+  virtual ~transform_callback() {}
+
+  virtual void node_callback(uint64_t osmid, double lng, double lat, const OSMPBF::Tags &tags) override {
+    // Only marked while parsing ways so its safe to read from many threads here
+    if (!shape_.IsUsed(osmid)) {
+      return;
+    }
+    Tags results = lua_.Transform(OSMType::kNode, tags);
+    if (results.size() == 0)
+      return;
+    nodes_.push_back({osmid, lng, lat, std::move(results)});
+  }
+
+  virtual void way_callback(uint64_t osmid, const OSMPBF::Tags &tags, const std::vector<uint64_t> &nodes) override {
+    if (nodes.size() < 2) {
+      return;
+    }
+    Tags results = lua_.Transform(OSMType::kWay, tags);
+    if (results.size() == 0)
+      return;
+    ways_.push_back({osmid, std::move(results), nodes});
+  }
+
+  virtual void relation_callback(const uint64_t osmid, const OSMPBF::Tags &tags, const std::vector<OSMPBF::Member> &members) override {
+    Tags results = lua_.Transform(OSMType::kRelation, tags);
+    if (results.size() == 0)
+      return;
+    relations_.push_back({osmid, std::move(results), {}});
+    for (const auto& member : members)
+      relations_.back().members.emplace_back(member.member_type, member.member_id, member.role);
+  }
+
+  virtual void changeset_callback(const uint64_t changeset_id) override {
+    max_changeset_id_ = std::max(max_changeset_id_, changeset_id);
+  }
+
+  void clear() {
+    nodes_.clear();
+    ways_.clear();
+    relations_.clear();
+    max_changeset_id_ = 0;
+  }
+
+  struct node_t {
+    uint64_t osmid;
+    double lng, lat;
+    Tags results;
+  };
+  struct way_t {
+    uint64_t osmid;
+    Tags results;
+    std::vector<uint64_t> nodes;
+  };
+  struct relation_t {
+    uint64_t osmid;
+    Tags results;
+    std::vector<OSMPBF::Member> members;
+  };
+
+  LuaTagTransform lua_;
+  const IdTable& shape_;
+
+  // Transformed elements in file order. Each pass only asks for one kind of element
+  std::vector<node_t> nodes_;
+  std::vector<way_t> ways_;
+  std::vector<relation_t> relations_;
+  uint64_t max_changeset_id_;
+};
+
 // Construct PBFGraphParser based on properties file and input PBF extract
 struct graph_callback : public OSMPBF::Callback {
  public:
@@ -44,7 +120,7 @@ struct graph_callback : public OSMPBF::Callback {
 
   graph_callback(const boost::property_tree::ptree& pt, OSMData& osmdata) :
     shape_(kMaxOSMNodeId), intersection_(kMaxOSMNodeId),
-    osmdata_(osmdata), lua_(get_lua(pt)){
+    osmdata_(osmdata), lua_script_(get_lua(pt)), lua_(lua_script_) {
 
     current_way_node_index_ = last_node_ = last_way_ = last_relation_ = 0;
 
@@ -80,6 +156,11 @@ struct graph_callback : public OSMPBF::Callback {
     Tags results = lua_.Transform(OSMType::kNode, tags);
     if (results.size() == 0)
       return;
+    process_node(osmid, lng, lat, results);
+  }
+
+  // Everything done with a node once its tags are transformed, this has to happen in file order
+  void process_node(uint64_t osmid, double lng, double lat, const Tags& results) {
 
     //unsorted extracts are just plain nasty, so they can bugger off!
     if(osmid < last_node_)
@@ -215,6 +296,11 @@ struct graph_callback : public OSMPBF::Callback {
     if (results.size() == 0) {
       return;
     }
+    process_way(osmid, results, nodes);
+  }
+
+  // Everything done with a way once its tags are transformed, this has to happen in file order
+  void process_way(uint64_t osmid, const Tags& results, const std::vector<uint64_t>& nodes) {
 
     // Throw away closed features with following tags: building, landuse,
     // leisure, natural. See: http://wiki.openstreetmap.org/wiki/Key:area
@@ -823,6 +909,11 @@ struct graph_callback : public OSMPBF::Callback {
     Tags results = lua_.Transform(OSMType::kRelation, tags);
     if (results.size() == 0)
       return;
+    process_relation(osmid, results, members);
+  }
+
+  // Everything done with a relation once its tags are transformed, this has to happen in file order
+  void process_relation(const uint64_t osmid, const Tags& results, const std::vector<OSMPBF::Member>& members) {
 
     //unsorted extracts are just plain nasty, so they can bugger off!
     if(osmid < last_relation_)
@@ -1121,6 +1212,25 @@ struct graph_callback : public OSMPBF::Callback {
     osmdata_.max_changeset_id_ = std::max(osmdata_.max_changeset_id_, changeset_id);
   }
 
+  // The parser runs these on its threads to do the tag transforms in parallel
+  virtual std::unique_ptr<OSMPBF::Callback> worker() override {
+    return std::unique_ptr<OSMPBF::Callback>(new transform_callback(lua_script_, shape_));
+  }
+
+  // The parser hands the workers back in file order so we process what they transformed
+  // exactly as if we had made the callbacks ourselves
+  virtual void merge(OSMPBF::Callback& worker) override {
+    auto& transformed = static_cast<transform_callback&>(worker);
+    for (const auto& node : transformed.nodes_)
+      process_node(node.osmid, node.lng, node.lat, node.results);
+    for (const auto& way : transformed.ways_)
+      process_way(way.osmid, way.results, way.nodes);
+    for (const auto& relation : transformed.relations_)
+      process_relation(relation.osmid, relation.results, relation.members);
+    osmdata_.max_changeset_id_ = std::max(osmdata_.max_changeset_id_, transformed.max_changeset_id_);
+    transformed.clear();
+  }
+
   //lets the sequences be set and reset
   void reset(sequence<OSMWay>* ways, sequence<OSMWayNode>* way_nodes,
              sequence<OSMAccess>* access, sequence<OSMRestriction>* complex_restrictions){
@@ -1146,7 +1256,8 @@ struct graph_callback : public OSMPBF::Callback {
   //Road class assignment needs to be set to the highway cutoff for ferries and auto trains.
   RoadClass highway_cutoff_rc_;
 
-  // Lua Tag Transformation class
+  // Lua Tag Transformation class and the script it runs (for the workers)
+  std::string lua_script_;
   LuaTagTransform lua_;
 
   // Pointer to all the OSM data (for use by callbacks)
@@ -1184,9 +1295,9 @@ namespace mjolnir {
 OSMData PBFGraphParser::Parse(const boost::property_tree::ptree& pt, const std::vector<std::string>& input_files,
     const std::string& ways_file, const std::string& way_nodes_file, const std::string& access_file,
     const std::string& complex_restriction_file) {
-  //TODO: option 1: each one threads makes an osmdata and we splice them together at the end
-  //option 2: synchronize around adding things to a single osmdata. will have to test to see
-  //which is the least expensive (memory and speed). leaning towards option 2
+  //blobs are decompressed, decoded and tag transformed in parallel, then the results are
+  //merged into the osmdata and sequences on this thread in file order as they rely on seeing
+  //ways, nodes and relations in that order
   unsigned int threads = std::max(static_cast<unsigned int>(1), pt.get<unsigned int>("concurrency", std::thread::hardware_concurrency()));
 
   // Create OSM data. Set the member pointer so that the parsing callback methods can use it.
@@ -1212,7 +1323,7 @@ OSMData PBFGraphParser::Parse(const boost::property_tree::ptree& pt, const std::
   LOG_INFO("Parsing ways...")
   for (auto& file_handle : file_handles) {
     callback.current_way_node_index_ = callback.last_node_ = callback.last_way_ = callback.last_relation_ = 0;
-    OSMPBF::Parser::parse(file_handle, static_cast<OSMPBF::Interest>(OSMPBF::Interest::WAYS | OSMPBF::Interest::CHANGESETS), callback);
+    OSMPBF::Parser::parse(file_handle, static_cast<OSMPBF::Interest>(OSMPBF::Interest::WAYS | OSMPBF::Interest::CHANGESETS), callback, threads);
   }
   callback.output_loops();
   LOG_INFO("Finished with " + std::to_string(osmdata.osm_way_count) + " routable ways containing " + std::to_string(osmdata.osm_way_node_count) + " nodes");
@@ -1232,7 +1343,7 @@ OSMData PBFGraphParser::Parse(const boost::property_tree::ptree& pt, const std::
   LOG_INFO("Parsing relations...")
   for (auto& file_handle : file_handles) {
     callback.current_way_node_index_ = callback.last_node_ = callback.last_way_ = callback.last_relation_ = 0;
-    OSMPBF::Parser::parse(file_handle, static_cast<OSMPBF::Interest>(OSMPBF::Interest::RELATIONS | OSMPBF::Interest::CHANGESETS), callback);
+    OSMPBF::Parser::parse(file_handle, static_cast<OSMPBF::Interest>(OSMPBF::Interest::RELATIONS | OSMPBF::Interest::CHANGESETS), callback, threads);
   }
   LOG_INFO("Finished with " + std::to_string(osmdata.restrictions.size()) + " simple restrictions");
   LOG_INFO("Finished with " + std::to_string(osmdata.lane_connectivity_map.size()) + " lane connections");
@@ -1268,7 +1379,7 @@ OSMData PBFGraphParser::Parse(const boost::property_tree::ptree& pt, const std::
     //because osm node ids are only sorted at the single pbf file level
     callback.reset(nullptr, new sequence<OSMWayNode>(way_nodes_file, false), nullptr, nullptr);
     callback.current_way_node_index_ = callback.last_node_ = callback.last_way_ = callback.last_relation_ = 0;
-    OSMPBF::Parser::parse(file_handle, static_cast<OSMPBF::Interest>(OSMPBF::Interest::NODES | OSMPBF::Interest::CHANGESETS), callback);
+    OSMPBF::Parser::parse(file_handle, static_cast<OSMPBF::Interest>(OSMPBF::Interest::NODES | OSMPBF::Interest::CHANGESETS), callback, threads);
   }
   callback.reset(nullptr, nullptr, nullptr, nullptr);
   LOG_INFO("Finished with " + std::to_string(osmdata.osm_node_count) + " nodes contained in routable ways");
@@ -1,5 +1,6 @@
 #include "mjolnir/shortcutbuilder.h"
 #include "mjolnir/graphtilebuilder.h"
+#include "mjolnir/util.h"
 
 #include <ostream>
 #include <sstream>
@@ -9,6 +10,14 @@
 #include <vector>
 #include <map>
 #include <utility>
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/format.hpp>
 #include <boost/filesystem/operations.hpp>
@@ -537,146 +546,171 @@ uint32_t AddShortcutEdges(GraphReader& reader, const GraphTile* tile,
   return shortcut_count;
 }
 
-// Form shortcuts for tiles in this level.
-uint32_t FormShortcuts(GraphReader& reader,
-            const TileLevel& level,
-            const std::unique_ptr<const valhalla::skadi::sample>& sample) {
-  // Iterate through the tiles at this level (TODO - can we mark the tiles
+// Form shortcuts for the tiles in the queue. Tiles on the level are always
+// read from the tile directory and the new tiles are written under
+// staging_dir, so every thread sees the original (shortcut free) tiles while
+// it walks into neighboring tiles and the result does not depend on which
+// tiles happen to have been rewritten already.
+void FormShortcuts(const boost::property_tree::ptree& hierarchy_properties,
+            const std::string& staging_dir,
+            const std::unique_ptr<const valhalla::skadi::sample>& sample,
+            std::queue<GraphId>& tilequeue, std::mutex& lock,
+            std::promise<uint32_t>& result) {
+  // Local Graphreader
+  GraphReader reader(hierarchy_properties);
+
+  // Iterate through the tiles in the queue (TODO - can we mark the tiles
   // the tiles that shortcuts end within?)
-  reader.Clear();
   bool added = false;
   uint32_t shortcut_count = 0;
-  uint32_t ntiles = level.tiles.TileCount();
-  uint32_t tile_level = (uint32_t)level.level;
-  const GraphTile* tile = nullptr;
-  for (uint32_t tileid = 0; tileid < ntiles; tileid++) {
-    // Get the graph tile. Skip if no tile exists (common case)
-    tile = reader.GetGraphTile(GraphId(tileid, tile_level, 0));
-    if (tile == nullptr || tile->header()->nodecount() == 0) {
-      continue;
+  while (true) {
+    // Get the next tile Id from the queue
+    lock.lock();
+    if (tilequeue.empty()) {
+      lock.unlock();
+      break;
     }
+    GraphId new_tile = tilequeue.front();
+    tilequeue.pop();
+    lock.unlock();
+
+    try {
+      // Get the graph tile. Skip if the tile is empty
+      uint32_t tileid = new_tile.tileid();
+      uint32_t tile_level = new_tile.level();
+      const GraphTile* tile = reader.GetGraphTile(new_tile);
+      if (tile == nullptr || tile->header()->nodecount() == 0) {
+        continue;
+      }
 
-    // Create GraphTileBuilder for the new tile
-    GraphId new_tile(tileid, tile_level, 0);
-    GraphTileBuilder tilebuilder(reader.tile_dir(), new_tile, false);
-
-    // Create a dummy admin at index 0.  Used if admins are not used/created.
-    tilebuilder.AddAdmin("None", "None", "", "");
-
-    // Iterate through the nodes in the tile
-    GraphId node_id(tileid, tile_level, 0);
-    for (uint32_t n = 0; n < tile->header()->nodecount(); n++, ++node_id) {
-      // Get the node info, copy node index and count from old tile
-      NodeInfo nodeinfo = *(tile->node(node_id));
-      uint32_t old_edge_index = nodeinfo.edge_index();
-      uint32_t old_edge_count = nodeinfo.edge_count();
-
-      // Update node information
-      const auto& admin = tile->admininfo(nodeinfo.admin_index());
-      nodeinfo.set_edge_index(tilebuilder.directededges().size());
-      nodeinfo.set_timezone(nodeinfo.timezone());
-      nodeinfo.set_admin_index(tilebuilder.AddAdmin(admin.country_text(),
-                admin.state_text(), admin.country_iso(), admin.state_iso()));
-
-      // Current edge count
-      size_t edge_count = tilebuilder.directededges().size();
-
-      // Add shortcut edges first.
-      std::unordered_map<uint32_t, uint32_t> shortcuts;
-      shortcut_count += AddShortcutEdges(reader, tile, tilebuilder, node_id,
-                   old_edge_index, old_edge_count, shortcuts, sample);
-
-      // Copy the rest of the directed edges from this node
-      GraphId edgeid(tileid, tile_level, old_edge_index);
-      for (uint32_t i = 0; i < old_edge_count; i++, ++edgeid) {
-        // Copy the directed edge information and update end node,
-        // edge data offset, and opp_index
-        const DirectedEdge* directededge = tile->directededge(edgeid);
-        DirectedEdge newedge = *directededge;
-
-        // Transition edges are stored as is (no need for EdgeInfo, signs,
-        // or restrictions).
-        if (!directededge->trans_down() && !directededge->trans_up()) {
-          // Get signs from the base directed edge
-          if (directededge->exitsign()) {
-            std::vector<SignInfo> signs = tile->GetSigns(edgeid.id());
-            if (signs.size() == 0) {
-              LOG_ERROR("Base edge should have signs, but none found");
+      // Create GraphTileBuilder for the new tile
+      GraphTileBuilder tilebuilder(reader.tile_dir(), new_tile, false);
+
+      // Create a dummy admin at index 0.  Used if admins are not used/created.
+      tilebuilder.AddAdmin("None", "None", "", "");
+
+      // Iterate through the nodes in the tile
+      GraphId node_id(tileid, tile_level, 0);
+      for (uint32_t n = 0; n < tile->header()->nodecount(); n++, ++node_id) {
+        // Get the node info, copy node index and count from old tile
+        NodeInfo nodeinfo = *(tile->node(node_id));
+        uint32_t old_edge_index = nodeinfo.edge_index();
+        uint32_t old_edge_count = nodeinfo.edge_count();
+
+        // Update node information
+        const auto& admin = tile->admininfo(nodeinfo.admin_index());
+        nodeinfo.set_edge_index(tilebuilder.directededges().size());
+        nodeinfo.set_timezone(nodeinfo.timezone());
+        nodeinfo.set_admin_index(tilebuilder.AddAdmin(admin.country_text(),
+                  admin.state_text(), admin.country_iso(), admin.state_iso()));
+
+        // Current edge count
+        size_t edge_count = tilebuilder.directededges().size();
+
+        // Add shortcut edges first.
+        std::unordered_map<uint32_t, uint32_t> shortcuts;
+        shortcut_count += AddShortcutEdges(reader, tile, tilebuilder, node_id,
+                     old_edge_index, old_edge_count, shortcuts, sample);
+
+        // Copy the rest of the directed edges from this node
+        GraphId edgeid(tileid, tile_level, old_edge_index);
+        for (uint32_t i = 0; i < old_edge_count; i++, ++edgeid) {
+          // Copy the directed edge information and update end node,
+          // edge data offset, and opp_index
+          const DirectedEdge* directededge = tile->directededge(edgeid);
+          DirectedEdge newedge = *directededge;
+
+          // Transition edges are stored as is (no need for EdgeInfo, signs,
+          // or restrictions).
+          if (!directededge->trans_down() && !directededge->trans_up()) {
+            // Get signs from the base directed edge
+            if (directededge->exitsign()) {
+              std::vector<SignInfo> signs = tile->GetSigns(edgeid.id());
+              if (signs.size() == 0) {
+                LOG_ERROR("Base edge should have signs, but none found");
+              }
+              tilebuilder.AddSigns(tilebuilder.directededges().size(), signs);
             }
-            tilebuilder.AddSigns(tilebuilder.directededges().size(), signs);
-          }
 
-          // Get access restrictions from the base directed edge. Add these to
-          // the list of access restrictions in the new tile. Update the
-          // edge index in the restriction to be the current directed edge Id
-          if (directededge->access_restriction()) {
-            auto restrictions = tile->GetAccessRestrictions(edgeid.id(), kAllAccess);
-            for (const auto& res : restrictions) {
-              tilebuilder.AddAccessRestriction(
-                  AccessRestriction(tilebuilder.directededges().size(),
-                     res.type(), res.modes(), res.value()));
+            // Get access restrictions from the base directed edge. Add these to
+            // the list of access restrictions in the new tile. Update the
+            // edge index in the restriction to be the current directed edge Id
+            if (directededge->access_restriction()) {
+              auto restrictions = tile->GetAccessRestrictions(edgeid.id(), kAllAccess);
+              for (const auto& res : restrictions) {
+                tilebuilder.AddAccessRestriction(
+                    AccessRestriction(tilebuilder.directededges().size(),
+                       res.type(), res.modes(), res.value()));
+              }
             }
-          }
 
-          // Copy lane connectivity
-          if (directededge->laneconnectivity()) {
-            auto laneconnectivity = tile->GetLaneConnectivity(edgeid.id());
-            if (laneconnectivity.size() == 0) {
-              LOG_ERROR("Base edge should have lane connectivity, but none found");
-            }
-            for (auto& lc : laneconnectivity) {
-              lc.set_to(tilebuilder.directededges().size());
+            // Copy lane connectivity
+            if (directededge->laneconnectivity()) {
+              auto laneconnectivity = tile->GetLaneConnectivity(edgeid.id());
+              if (laneconnectivity.size() == 0) {
+                LOG_ERROR("Base edge should have lane connectivity, but none found");
+              }
+              for (auto& lc : laneconnectivity) {
+                lc.set_to(tilebuilder.directededges().size());
+              }
+              tilebuilder.AddLaneConnectivity(laneconnectivity);
             }
-            tilebuilder.AddLaneConnectivity(laneconnectivity);
-          }
 
-          // Get edge info, shape, and names from the old tile and add
-          // to the new. Use prior edgeinfo offset as the key to make sure
-          // edges that have the same end nodes are differentiated (this
-          // should be a valid key since tile sizes aren't changed)
-          auto edgeinfo = tile->edgeinfo(directededge->edgeinfo_offset());
-          uint32_t edge_info_offset = tilebuilder.AddEdgeInfo(directededge->edgeinfo_offset(),
-                         node_id, directededge->endnode(), edgeinfo.wayid(), edgeinfo.encoded_shape(),
-                         tile->GetNames(directededge->edgeinfo_offset()), added);
-          newedge.set_edgeinfo_offset(edge_info_offset);
-
-          // Set the superseded mask - this is the shortcut mask that
-          // supersedes this edge (outbound from the node)
-          auto s = shortcuts.find(i);
-          uint32_t supersed_idx = (s != shortcuts.end()) ? s->second : 0;
-          newedge.set_superseded(supersed_idx);
-        }
+            // Get edge info, shape, and names from the old tile and add
+            // to the new. Use prior edgeinfo offset as the key to make sure
+            // edges that have the same end nodes are differentiated (this
+            // should be a valid key since tile sizes aren't changed)
+            auto edgeinfo = tile->edgeinfo(directededge->edgeinfo_offset());
+            uint32_t edge_info_offset = tilebuilder.AddEdgeInfo(directededge->edgeinfo_offset(),
+                           node_id, directededge->endnode(), edgeinfo.wayid(), edgeinfo.encoded_shape(),
+                           tile->GetNames(directededge->edgeinfo_offset()), added);
+            newedge.set_edgeinfo_offset(edge_info_offset);
+
+            // Set the superseded mask - this is the shortcut mask that
+            // supersedes this edge (outbound from the node)
+            auto s = shortcuts.find(i);
+            uint32_t supersed_idx = (s != shortcuts.end()) ? s->second : 0;
+            newedge.set_superseded(supersed_idx);
+          }
 
-        // Add directed edge
-        tilebuilder.directededges().emplace_back(std::move(newedge));
+          // Add directed edge
+          tilebuilder.directededges().emplace_back(std::move(newedge));
 
-        // Add existing edge elevation (if the tile has elevation information)
-        if (tile->header()->has_edge_elevation()) {
-          const EdgeElevation* elev = tile->edge_elevation(edgeid);
-          if (elev == nullptr) {
-            tilebuilder.edge_elevations().emplace_back(0.0f, 0.0f, 0.0f);
-          } else {
-            tilebuilder.edge_elevations().emplace_back(std::move(*elev));
+          // Add existing edge elevation (if the tile has elevation information)
+          if (tile->header()->has_edge_elevation()) {
+            const EdgeElevation* elev = tile->edge_elevation(edgeid);
+            if (elev == nullptr) {
+              tilebuilder.edge_elevations().emplace_back(0.0f, 0.0f, 0.0f);
+            } else {
+              tilebuilder.edge_elevations().emplace_back(std::move(*elev));
+            }
           }
         }
-      }
 
-      // Set the edge count for the new node
-      nodeinfo.set_edge_count(tilebuilder.directededges().size() - edge_count);
-      tilebuilder.nodes().emplace_back(std::move(nodeinfo));
-    }
+        // Set the edge count for the new node
+        nodeinfo.set_edge_count(tilebuilder.directededges().size() - edge_count);
+        tilebuilder.nodes().emplace_back(std::move(nodeinfo));
+      }
 
-    // Store the new tile
-    tilebuilder.StoreTileData();
-    LOG_DEBUG((boost::format("ShortcutBuilder created tile %1%: %2% bytes") %
-         tile % tilebuilder.header_builder().end_offset()).str());
+      // Store the new tile in the staging area
+      tilebuilder.StoreTileData(staging_dir);
+      LOG_DEBUG((boost::format("ShortcutBuilder created tile %1%: %2% bytes") %
+           new_tile % tilebuilder.header_builder().end_offset()).str());
 
-    // Check if we need to clear the tile cache.
-    if (reader.OverCommitted()) {
-      reader.Clear();
+      // Check if we need to clear the tile cache.
+      if (reader.OverCommitted()) {
+        reader.Clear();
+      }
+    }
+    catch(std::exception& e) {
+      // RunThreads hands this back to the main thread
+      LOG_ERROR((boost::format("Failed tile %1%: %2%") % new_tile % e.what()).str());
+      throw;
     }
   }
-  return shortcut_count;
+
+  // Let the main thread know how many shortcuts this thread made
+  result.set_value(shortcut_count);
 }
 
 }
@@ -688,13 +722,13 @@ namespace mjolnir {
 // only connect to 2 edges on the hierarchy level, and have compatible
 // attributes. Shortcut edges are inserted before regular edges.
 void ShortcutBuilder::Build(const boost::property_tree::ptree& pt) {
-
-  //TODO: thread this. would need to make sure we dont make shortcuts
-  //across tile boundaries so that we are only messing with one tile
-  //in one thread at a time
+  // Number of threads to work on the tiles of each level
+  unsigned int thread_count = std::max(static_cast<unsigned int>(1),
+    pt.get<unsigned int>("concurrency", std::thread::hardware_concurrency()));
 
   // Get GraphReader
-  GraphReader reader(pt.get_child("mjolnir"));
+  boost::property_tree::ptree hierarchy_properties = pt.get_child("mjolnir");
+  GraphReader reader(hierarchy_properties);
 
   // Crack open some elevation data if its there
   boost::optional<std::string> elevation = pt.get_optional<std::string>("additional_data.elevation");
@@ -703,15 +737,56 @@ void ShortcutBuilder::Build(const boost::property_tree::ptree& pt) {
     sample.reset(new skadi::sample(*elevation));
   }
 
-  auto level = TileHierarchy::levels().rbegin();
-  level++;
-  for ( ; level != TileHierarchy::levels().rend(); ++level) {
-    // Create shortcuts on this level
-    auto tile_level = level->second;
-    LOG_INFO("Creating shortcuts on level " + std::to_string(tile_level.level));
-    uint32_t count = FormShortcuts(reader, tile_level, sample);
-    LOG_INFO("Finished with " + std::to_string(count) + " shortcuts");
+  // Shortcuts walk into neighboring tiles on the same level. New tiles are
+  // staged here until every tile on the level is done and are then moved
+  // over the originals
+  std::string staging_dir = reader.tile_dir() + "/shortcut_staging";
+  boost::filesystem::remove_all(staging_dir);
+
+  // Don't leave a half built level behind in the tile directory
+  try {
+    auto level = TileHierarchy::levels().rbegin();
+    level++;
+    for ( ; level != TileHierarchy::levels().rend(); ++level) {
+      // Create a randomized queue of the tiles on this level
+      auto tile_level = level->second;
+      std::deque<GraphId> tempqueue;
+      for (uint32_t id = 0; id < tile_level.tiles.TileCount(); id++) {
+        GraphId tile_id(id, tile_level.level, 0);
+        if (GraphReader::DoesTileExist(hierarchy_properties, tile_id)) {
+          tempqueue.push_back(tile_id);
+        }
+      }
+      std::vector<GraphId> tile_ids(tempqueue.begin(), tempqueue.end());
+      std::random_shuffle(tempqueue.begin(), tempqueue.end());
+      std::queue<GraphId> tilequeue(tempqueue);
+
+      // An atomic object we can use to do the synchronization
+      std::mutex lock;
+
+      // Create shortcuts on this level and total them up
+      LOG_INFO("Creating shortcuts on level " + std::to_string(tile_level.level));
+      uint32_t count = RunThreads(thread_count, [&](std::promise<uint32_t>& result) {
+        FormShortcuts(hierarchy_properties, staging_dir, sample, tilequeue,
+                      lock, result);
+      });
+
+      // Move the new tiles over the originals
+      for (const auto& tile_id : tile_ids) {
+        std::string suffix = GraphTile::FileSuffix(tile_id);
+        boost::filesystem::path staged = staging_dir + '/' + suffix;
+        if (boost::filesystem::exists(staged)) {
+          boost::filesystem::rename(staged, reader.tile_dir() + '/' + suffix);
+        }
+      }
+      LOG_INFO("Finished with " + std::to_string(count) + " shortcuts");
+    }
+  }
+  catch(...) {
+    boost::filesystem::remove_all(staging_dir);
+    throw;
   }
+  boost::filesystem::remove_all(staging_dir);
 }
 
 }
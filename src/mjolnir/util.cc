@@ -2,6 +2,11 @@
 
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/classification.hpp>
+#include <list>
+#include <memory>
+#include <thread>
+
+#include "midgard/logging.h"
 
 namespace valhalla {
 namespace mjolnir {
@@ -29,5 +34,45 @@ std::string remove_double_quotes(const std::string& s) {
   return ret;
 }
 
+// Run the worker on the specified number of threads and wait for them to
+// finish up. Returns the sum of what the threads sent back.
+uint32_t RunThreads(const unsigned int thread_count,
+                    const std::function<void (std::promise<uint32_t>&)>& worker) {
+  std::vector<std::shared_ptr<std::thread> > threads(thread_count);
+  std::list<std::promise<uint32_t> > results;
+  for (auto& thread : threads) {
+    results.emplace_back();
+    std::promise<uint32_t>& result = results.back();
+    thread.reset(new std::thread([&worker, &result]() {
+      // Whatever happens in Vegas..
+      try {
+        worker(result);
+      }
+      catch(...) {
+        // ..gets sent back to the main thread
+        result.set_exception(std::current_exception());
+      }
+    }));
+  }
+
+  // Wait for them to finish up their work
+  for (auto& thread : threads) {
+    thread->join();
+  }
+
+  // Check all of the outcomes
+  uint32_t total = 0;
+  for (auto& result : results) {
+    try {
+      total += result.get_future().get();
+    }
+    catch(const std::exception& e) {
+      LOG_ERROR(e.what());
+      throw;
+    }
+  }
+  return total;
+}
+
 }
 }
@@ -22,11 +22,14 @@
 #include "baldr/tilehierarchy.h"
 #include "baldr/directededge.h"
 #include "baldr/edgeinfo.h"
+#include "baldr/speedprofile.h"
+#include "mjolnir/graphtilebuilder.h"
 
 namespace bpo = boost::program_options;
 
 using namespace valhalla::baldr;
 using namespace valhalla::midgard;
+using namespace valhalla::mjolnir;
 
 boost::filesystem::path config_file_path;
 std::vector<std::string> input_files;
@@ -42,6 +45,21 @@ struct WaySpeed {
   uint8_t reverse;   // Speed in reverse direction (kph)
 };
 
+/**
+ * Structure to define the weekly speed profiles along a way
+ */
+struct WaySpeedProfile {
+  bool has_forward;
+  bool has_reverse;
+  speed_profile_t forward;   // Speed profile in forward direction
+  speed_profile_t reverse;   // Speed profile in reverse direction
+
+  WaySpeedProfile()
+      : has_forward(false),
+        has_reverse(false) {
+  }
+};
+
 // Structure holding an edge Id and forward flag
 struct EdgeAndDirection {
   bool    forward;
@@ -61,7 +79,9 @@ bool ParseArguments(int argc, char *argv[]) {
     " Usage: valhalla_build_speeds [options]\n"
     "\n"
     "valhalla_build_speeds is a program that reads speed data associated to OSM ways "
-    "and creates a speed table on the local level tiles."
+    "and creates a speed table on the local level tiles. Weekly speed profiles "
+    "(traffic/way_speed_profiles.csv with lines of wayid,forward,speed,speed,... "
+    "starting Sunday at 00:00 local time) are compressed and stored in the tiles."
     "\n"
     "\n");
 
@@ -189,6 +209,145 @@ LOG_INFO("Read Way Speeds file: " + way_speeds_file);
   return way_speeds;
 }
 
+/**
+ * Resample the speeds of a week to the speed profile buckets. The speeds
+ * must be evenly spaced over the week and their count must divide (or be a
+ * multiple of) the bucket count. Missing (0) speeds are filled with the
+ * average of the others.
+ */
+bool ResampleSpeeds(const std::vector<float>& speeds, std::vector<float>& buckets) {
+  if (speeds.empty() || (kSpeedBucketCount % speeds.size() != 0 &&
+                         speeds.size() % kSpeedBucketCount != 0)) {
+    return false;
+  }
+
+  float total = 0.0f;
+  uint32_t count = 0;
+  for (auto speed : speeds) {
+    if (speed > 0.0f) {
+      total += speed;
+      count++;
+    }
+  }
+  if (count == 0) {
+    return false;
+  }
+  float average = total / count;
+
+  buckets.assign(kSpeedBucketCount, 0.0f);
+  if (speeds.size() <= kSpeedBucketCount) {
+    size_t repeat = kSpeedBucketCount / speeds.size();
+    for (uint32_t i = 0; i < kSpeedBucketCount; ++i) {
+      float speed = speeds[i / repeat];
+      buckets[i] = (speed > 0.0f) ? speed : average;
+    }
+  } else {
+    size_t group = speeds.size() / kSpeedBucketCount;
+    for (size_t i = 0; i < speeds.size(); ++i) {
+      buckets[i / group] += ((speeds[i] > 0.0f) ? speeds[i] : average) / group;
+    }
+  }
+  return true;
+}
+
+/**
+ * Read way speed profiles CSV file and return a mapping of ways to speed
+ * profiles.
+ */
+std::unordered_map<uint64_t, WaySpeedProfile> ReadWaySpeedProfiles(const std::string& tile_dir) {
+  std::string way_profiles_file = tile_dir + "/traffic/way_speed_profiles.csv";
+  std::unordered_map<uint64_t, WaySpeedProfile> way_profiles;
+  std::ifstream profiles_file(way_profiles_file);
+  if (!profiles_file.is_open()) {
+    return way_profiles;
+  }
+  LOG_INFO("Read Way Speed Profiles file: " + way_profiles_file);
+
+  // Get the first line (format)
+  std::string line;
+  std::getline(profiles_file, line);
+
+  // Get way speed profile: wayid, forward (1) or reverse (0), speeds (kph)
+  std::vector<float> speeds, buckets;
+  uint32_t skipped = 0;
+  while (std::getline(profiles_file, line)) {
+    // Split into tokens separated by ","
+    uint32_t n = 0;
+    uint64_t wayid = 0;
+    bool forward = true;
+    speeds.clear();
+    std::string num;
+    std::stringstream line_stream(line);
+    while (std::getline(line_stream, num, ',')) {
+      if (n == 0) {
+        wayid = std::stoll(num);
+      } else if (n == 1) {
+        forward = std::stoi(num) != 0;
+      } else {
+        speeds.push_back(num.empty() ? 0.0f : std::stof(num));
+      }
+      n++;
+    }
+
+    if (!ResampleSpeeds(speeds, buckets)) {
+      skipped++;
+      continue;
+    }
+    auto& profile = way_profiles[wayid];
+    if (forward) {
+      profile.has_forward = true;
+      profile.forward = compress_speed_buckets(buckets.data());
+    } else {
+      profile.has_reverse = true;
+      profile.reverse = compress_speed_buckets(buckets.data());
+    }
+  }
+  if (skipped > 0) {
+    LOG_WARN(std::to_string(skipped) + " speed profiles skipped: no speeds or " +
+             "the speed count does not divide (or is not a multiple of) " +
+             std::to_string(kSpeedBucketCount));
+  }
+  return way_profiles;
+}
+
+/**
+ * Store the speed profiles of the ways on their edges. Each tile with
+ * profiles is read, updated and written back.
+ */
+void StoreSpeedProfiles(const std::string& tile_dir,
+           const std::unordered_map<uint64_t, WaySpeedProfile>& way_profiles,
+           const std::unordered_map<uint64_t, std::vector<EdgeAndDirection>>& way_edges) {
+  // Group the edge profiles by tile
+  std::unordered_map<GraphId, std::vector<std::pair<uint32_t, const speed_profile_t*>>> tile_profiles;
+  for (const auto& way : way_profiles) {
+    auto itr = way_edges.find(way.first);
+    if (itr == way_edges.end()) {
+      continue;
+    }
+    for (const auto& edge : itr->second) {
+      if (edge.forward ? way.second.has_forward : way.second.has_reverse) {
+        tile_profiles[edge.edgeid.Tile_Base()].emplace_back(edge.edgeid.id(),
+            edge.forward ? &way.second.forward : &way.second.reverse);
+      }
+    }
+  }
+
+  uint32_t stored_profiles = 0;
+  for (const auto& tile : tile_profiles) {
+    GraphTileBuilder tilebuilder(tile_dir, tile.first, true);
+    uint32_t count = tilebuilder.header()->directededgecount();
+    for (const auto& profile : tile.second) {
+      if (profile.first < count) {
+        tilebuilder.AddSpeedProfile(profile.first, *profile.second);
+        stored_profiles++;
+      }
+    }
+    tilebuilder.StoreTileData();
+  }
+  LOG_INFO("Number of speed profile tiles = " + std::to_string(tile_profiles.size()));
+  LOG_INFO("Stored speed profiles = " + std::to_string(stored_profiles));
+}
+
 uint8_t GetSpeed(const bool forward, const uint8_t fwd, const uint8_t rev) {
   return (forward) ? fwd : rev;
 }
@@ -206,9 +365,10 @@ int main(int argc, char** argv) {
   // Get the tile directory from the config
   std::string tile_dir = pt.get<std::string>("mjolnir.tile_dir");
 
-  // Read the way speed CSV file
+  // Read the way speed CSV file and the way speed profiles CSV file
   auto way_speeds = ReadWaySpeeds(tile_dir);
-  if (way_speeds.size() == 0) {
+  auto way_profiles = ReadWaySpeedProfiles(tile_dir);
+  if (way_speeds.size() == 0 && way_profiles.size() == 0) {
     LOG_ERROR("No speeds in the way speeds csv file");
     return 0;
   }
@@ -229,6 +389,12 @@ int main(int argc, char** argv) {
   way_edges = ReadWaysToEdges(way_edges_file);
   LOG_INFO("Done reading ways to edges file");
 
+  // Store the speed profiles in the tiles
+  if (way_profiles.size() > 0) {
+    LOG_INFO(std::to_string(way_profiles.size()) + " ways with speed profiles");
+    StoreSpeedProfiles(tile_dir, way_profiles, way_edges);
+  }
+
   // Get Valhalla tiles
   auto local_level = TileHierarchy::levels().rbegin()->second.level;
   auto tiles = TileHierarchy::levels().rbegin()->second.tiles;
@@ -8,6 +8,7 @@
 #include "mjolnir/graphenhancer.h"
 #include "mjolnir/hierarchybuilder.h"
 #include "mjolnir/shortcutbuilder.h"
+#include "mjolnir/contractionbuilder.h"
 #include "mjolnir/restrictionbuilder.h"
 #include "baldr/tilehierarchy.h"
 #include "config.h"
@@ -109,6 +110,13 @@ int main(int argc, char** argv) {
     boost::filesystem::remove_all(level_dir);
   }
 
+  //a contraction hierarchy of the old tiles does not match the new ones
+  auto contraction_file = valhalla::baldr::ContractionHierarchy::FileName(tile_dir);
+  if(boost::filesystem::exists(contraction_file)) {
+    LOG_WARN(contraction_file + " will be purged");
+    boost::filesystem::remove(contraction_file);
+  }
+
   boost::filesystem::create_directories(tile_dir);
 
   // Read the OSM protocol buffer file. Callbacks for nodes, ways, and
@@ -141,6 +149,11 @@ int main(int argc, char** argv) {
   // full graph is formed.
   GraphValidator::Validate(pt);
 
+  // Contract the graph for auto routes (optional)
+  if (pt.get<bool>("mjolnir.contraction_hierarchy", false)) {
+    ContractionBuilder::Build(pt);
+  }
+
   return EXIT_SUCCESS;
 }
 
@@ -1330,6 +1330,7 @@ void AddToGraph(GraphTileBuilder& tilebuilder_transit,
                 std::vector<OneStopTest>& onestoptests,
                 bool tile_within_one_tz,
                 const std::unordered_map<uint32_t, multi_polygon_type>& tz_polys,
+                const PolygonIndex& tz_poly_index,
                 uint32_t& no_dir_edge_count) {
   auto t1 = std::chrono::high_resolution_clock::now();
 
@@ -1361,7 +1362,7 @@ void AddToGraph(GraphTileBuilder& tilebuilder_transit,
       //fallback to tz database.
       timezone = (tile_within_one_tz) ?
                   tz_polys.begin()->first :
-                  GetMultiPolyId(tz_polys, stopll);
+                  GetMultiPolyId(tz_poly_index, stopll);
       if (timezone == 0)
         LOG_WARN("Timezone not found for stop " + stop.name());
     }
@@ -1751,11 +1752,13 @@ void build_tiles(const boost::property_tree::ptree& pt, std::mutex& lock,
         tile_within_one_tz = true;
       }
     }
+    PolygonIndex tz_poly_index(tz_polys, filter);
 
     // Add nodes, directededges, and edgeinfo
     AddToGraph(tilebuilder_transit, tile_id, file, transit_dir,
                lock, all_tiles, stop_edge_map, stop_access, shapes, distances,
                route_types, onestoptests, tile_within_one_tz, tz_polys,
+               tz_poly_index,
                stats.no_dir_edge_count);
 
     LOG_INFO("Tile " + std::to_string(tile_id.tileid()) + ": added " +
@@ -1,3 +1,5 @@
+#include <cctype>
+#include <cstring>
 #include <stdexcept>
 
 #include <boost/property_tree/ptree.hpp>
@@ -330,6 +332,12 @@ void NarrativeDictionary::Load(PhraseSet& phrase_handle,
 
   phrase_handle.phrases = as_unordered_map<std::string, std::string>(
       phrase_pt, kPhrasesKey);
+
+  // Compile the phrases so instructions can be rendered in one pass
+  phrase_handle.templates.clear();
+  for (const auto& phrase : phrase_handle.phrases) {
+    phrase_handle.templates.emplace(phrase.first, PhraseTemplate(phrase.second));
+  }
 }
 
 void NarrativeDictionary::Load(
@@ -551,6 +559,62 @@ void NarrativeDictionary::Load(
 
 }
 
+PhraseTemplate::PhraseTemplate(const std::string& phrase)
+    : phrase_(phrase) {
+  // Split the phrase into literal runs and tags
+  size_t literal_begin = 0;
+  size_t pos = 0;
+  while ((pos = phrase_.find('<', pos)) != std::string::npos) {
+    // Tags are upper case letters and underscores between angle brackets
+    size_t end = pos + 1;
+    while (end < phrase_.size()
+        && (std::isupper(static_cast<unsigned char>(phrase_[end]))
+            || phrase_[end] == '_')) {
+      ++end;
+    }
+    if (end == pos + 1 || end == phrase_.size() || phrase_[end] != '>') {
+      ++pos;
+      continue;
+    }
+
+    if (pos > literal_begin) {
+      segments_.push_back({ static_cast<uint32_t>(literal_begin),
+                            static_cast<uint32_t>(pos - literal_begin), false });
+    }
+    segments_.push_back({ static_cast<uint32_t>(pos),
+                          static_cast<uint32_t>(end + 1 - pos), true });
+    pos = literal_begin = end + 1;
+  }
+  if (phrase_.size() > literal_begin) {
+    segments_.push_back({ static_cast<uint32_t>(literal_begin),
+                          static_cast<uint32_t>(phrase_.size() - literal_begin),
+                          false });
+  }
+}
+
+void PhraseTemplate::Render(std::string& output, TagValues values) const {
+  output.clear();
+  for (const auto& segment : segments_) {
+    const char* text = phrase_.data() + segment.offset;
+    if (segment.tag) {
+      // Find the value of this tag, leave the tag as is if there is none
+      const std::string* value = nullptr;
+      for (const auto& tag_value : values) {
+        if (std::strncmp(tag_value.tag, text, segment.length) == 0
+            && tag_value.tag[segment.length] == '\0') {
+          value = &tag_value.value;
+          break;
+        }
+      }
+      if (value != nullptr) {
+        output.append(*value);
+        continue;
+      }
+    }
+    output.append(text, segment.length);
+  }
+}
+
 const std::locale& NarrativeDictionary::GetLocale() const {
   return locale;
 }
@@ -576,13 +576,12 @@ std::string NarrativeBuilder::FormStartInstruction(Maneuver& maneuver) {
     phrase_id += 16;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.start_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kCardinalDirectionTag, cardinal_direction);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kBeginStreetNamesTag, begin_street_names);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.start_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kCardinalDirectionTag, cardinal_direction },
+                { kStreetNamesTag, street_names },
+                { kBeginStreetNamesTag, begin_street_names } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -634,17 +633,16 @@ std::string NarrativeBuilder::FormVerbalStartInstruction(
     phrase_id += 16;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.start_verbal_subset.phrases.at(
-      std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kCardinalDirectionTag, cardinal_direction);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kBeginStreetNamesTag, begin_street_names);
-  boost::replace_all(instruction, kLengthTag,
-      FormLength(maneuver, dictionary_.start_verbal_subset.metric_lengths,
-                 dictionary_.start_verbal_subset.us_customary_lengths));
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.start_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kCardinalDirectionTag, cardinal_direction },
+                { kStreetNamesTag, street_names },
+                { kBeginStreetNamesTag, begin_street_names },
+                { kLengthTag,
+                    FormLength(maneuver,
+                               dictionary_.start_verbal_subset.metric_lengths,
+                               dictionary_.start_verbal_subset.us_customary_lengths) } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -688,15 +686,11 @@ std::string NarrativeBuilder::FormDestinationInstruction(Maneuver& maneuver) {
     relative_direction = dictionary_.destination_subset.relative_directions.at(1);
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.destination_subset.phrases.at(
-      std::to_string(phrase_id));
-
-  if (phrase_id > 0) {
-    // Replace phrase tags with values
-    boost::replace_all(instruction, kRelativeDirectionTag, relative_direction);
-    boost::replace_all(instruction, kDestinationTag, destination);
-  }
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.destination_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kRelativeDirectionTag, relative_direction },
+                { kDestinationTag, destination } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -745,15 +739,11 @@ std::string NarrativeBuilder::FormVerbalAlertDestinationInstruction(
     relative_direction = dictionary_.destination_subset.relative_directions.at(1);
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.destination_verbal_alert_subset.phrases.at(
-      std::to_string(phrase_id));
-
-  if (phrase_id > 0) {
-    // Replace phrase tags with values
-    boost::replace_all(instruction, kRelativeDirectionTag, relative_direction);
-    boost::replace_all(instruction, kDestinationTag, destination);
-  }
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.destination_verbal_alert_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kRelativeDirectionTag, relative_direction },
+                { kDestinationTag, destination } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -802,15 +792,11 @@ std::string NarrativeBuilder::FormVerbalDestinationInstruction(
     relative_direction = dictionary_.destination_subset.relative_directions.at(1);
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.destination_verbal_subset.phrases.at(
-      std::to_string(phrase_id));
-
-  if (phrase_id > 0) {
-    // Replace phrase tags with values
-    boost::replace_all(instruction, kRelativeDirectionTag, relative_direction);
-    boost::replace_all(instruction, kDestinationTag, destination);
-  }
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.destination_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kRelativeDirectionTag, relative_direction },
+                { kDestinationTag, destination } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -835,12 +821,11 @@ std::string NarrativeBuilder::FormBecomesInstruction(Maneuver& maneuver,
   // Determine which phrase to use
   uint8_t phrase_id = 0;
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.becomes_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kPreviousStreetNamesTag, prev_street_names);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.becomes_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kPreviousStreetNamesTag, prev_street_names },
+                { kStreetNamesTag, street_names } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -871,12 +856,11 @@ std::string NarrativeBuilder::FormVerbalBecomesInstruction(
   // Determine which phrase to use
   uint8_t phrase_id = 0;
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.becomes_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kPreviousStreetNamesTag, prev_street_names);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.becomes_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kPreviousStreetNamesTag, prev_street_names },
+                { kStreetNamesTag, street_names } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -905,12 +889,10 @@ std::string NarrativeBuilder::FormContinueInstruction(Maneuver& maneuver) {
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.continue_subset.phrases.at(
-      std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.continue_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kStreetNamesTag, street_names } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -940,12 +922,10 @@ std::string NarrativeBuilder::FormVerbalAlertContinueInstruction(
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.continue_verbal_alert_subset.phrases.at(
-      std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.continue_verbal_alert_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kStreetNamesTag, street_names } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -976,15 +956,14 @@ std::string NarrativeBuilder::FormVerbalContinueInstruction(
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.continue_verbal_subset.phrases.at(
-      std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kLengthTag,
-      FormLength(maneuver, dictionary_.continue_verbal_subset.metric_lengths,
-                 dictionary_.continue_verbal_subset.us_customary_lengths));
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.continue_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kLengthTag,
+                    FormLength(maneuver,
+                               dictionary_.continue_verbal_subset.metric_lengths,
+                               dictionary_.continue_verbal_subset.us_customary_lengths) },
+                { kStreetNamesTag, street_names } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1043,14 +1022,14 @@ std::string NarrativeBuilder::FormTurnInstruction(Maneuver& maneuver,
     phrase_id = 3;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = subset->phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-      FormRelativeTwoDirection(maneuver.type(), subset->relative_directions));
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kBeginStreetNamesTag, begin_street_names);
+  // Render the determined tagged phrase with the tags replaced by values
+  subset->templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kRelativeDirectionTag,
+                    FormRelativeTwoDirection(maneuver.type(),
+                                             subset->relative_directions) },
+                { kStreetNamesTag, street_names },
+                { kBeginStreetNamesTag, begin_street_names } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1127,15 +1106,14 @@ std::string NarrativeBuilder::FormVerbalTurnInstruction(
     phrase_id = 3;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = subset->phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-      FormRelativeTwoDirection(
-          maneuver.type(), subset->relative_directions));
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kBeginStreetNamesTag, begin_street_names);
+  // Render the determined tagged phrase with the tags replaced by values
+  subset->templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kRelativeDirectionTag,
+                    FormRelativeTwoDirection(maneuver.type(),
+                                             subset->relative_directions) },
+                { kStreetNamesTag, street_names },
+                { kBeginStreetNamesTag, begin_street_names } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1178,15 +1156,14 @@ std::string NarrativeBuilder::FormUturnInstruction(Maneuver& maneuver,
     phrase_id += 3;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.uturn_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-      FormRelativeTwoDirection(maneuver.type(),
-                               dictionary_.uturn_subset.relative_directions));
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kCrossStreetNamesTag, cross_street_names);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.uturn_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kRelativeDirectionTag,
+                    FormRelativeTwoDirection(maneuver.type(),
+                                             dictionary_.uturn_subset.relative_directions) },
+                { kStreetNamesTag, street_names },
+                { kCrossStreetNamesTag, cross_street_names } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1289,14 +1266,12 @@ std::string NarrativeBuilder::FormVerbalUturnInstruction(
   std::string instruction;
   instruction.reserve(kInstructionInitialCapacity);
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.uturn_verbal_subset.phrases.at(
-      std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag, relative_dir);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kCrossStreetNamesTag, cross_street_names);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.uturn_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kRelativeDirectionTag, relative_dir },
+                { kStreetNamesTag, street_names },
+                { kCrossStreetNamesTag, cross_street_names } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1344,14 +1319,12 @@ std::string NarrativeBuilder::FormVerbalUturnInstruction(
         element_max_count, limit_by_consecutive_count);
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.ramp_straight_subset.phrases.at(
-      std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kBranchSignTag, exit_branch_sign);
-  boost::replace_all(instruction, kTowardSignTag, exit_toward_sign);
-  boost::replace_all(instruction, kNameSignTag, exit_name_sign);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.ramp_straight_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kBranchSignTag, exit_branch_sign },
+                { kTowardSignTag, exit_toward_sign },
+                { kNameSignTag, exit_name_sign } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1451,14 +1424,12 @@ std::string NarrativeBuilder::FormVerbalRampStraightInstruction(
   std::string instruction;
   instruction.reserve(kInstructionInitialCapacity);
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.ramp_straight_verbal_subset.phrases.at(
-      std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kBranchSignTag, exit_branch_sign);
-  boost::replace_all(instruction, kTowardSignTag, exit_toward_sign);
-  boost::replace_all(instruction, kNameSignTag, exit_name_sign);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.ramp_straight_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kBranchSignTag, exit_branch_sign },
+                { kTowardSignTag, exit_toward_sign },
+                { kNameSignTag, exit_name_sign } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1517,16 +1488,15 @@ std::string NarrativeBuilder::FormRampInstruction(
         element_max_count, limit_by_consecutive_count);
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.ramp_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-      FormRelativeTwoDirection(maneuver.type(),
-                               dictionary_.ramp_subset.relative_directions));
-  boost::replace_all(instruction, kBranchSignTag, exit_branch_sign);
-  boost::replace_all(instruction, kTowardSignTag, exit_toward_sign);
-  boost::replace_all(instruction, kNameSignTag, exit_name_sign);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.ramp_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kRelativeDirectionTag,
+                    FormRelativeTwoDirection(maneuver.type(),
+                                             dictionary_.ramp_subset.relative_directions) },
+                { kBranchSignTag, exit_branch_sign },
+                { kTowardSignTag, exit_toward_sign },
+                { kNameSignTag, exit_name_sign } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1650,14 +1620,13 @@ std::string NarrativeBuilder::FormVerbalRampInstruction(
   std::string instruction;
   instruction.reserve(kInstructionInitialCapacity);
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.ramp_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag, relative_dir);
-  boost::replace_all(instruction, kBranchSignTag, exit_branch_sign);
-  boost::replace_all(instruction, kTowardSignTag, exit_toward_sign);
-  boost::replace_all(instruction, kNameSignTag, exit_name_sign);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.ramp_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kRelativeDirectionTag, relative_dir },
+                { kBranchSignTag, exit_branch_sign },
+                { kTowardSignTag, exit_toward_sign },
+                { kNameSignTag, exit_name_sign } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1717,17 +1686,16 @@ std::string NarrativeBuilder::FormExitInstruction(
         element_max_count, limit_by_consecutive_count);
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.exit_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-      FormRelativeTwoDirection(maneuver.type(),
-                               dictionary_.exit_subset.relative_directions));
-  boost::replace_all(instruction, kNumberSignTag, exit_number_sign);
-  boost::replace_all(instruction, kBranchSignTag, exit_branch_sign);
-  boost::replace_all(instruction, kTowardSignTag, exit_toward_sign);
-  boost::replace_all(instruction, kNameSignTag, exit_name_sign);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.exit_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kRelativeDirectionTag,
+                    FormRelativeTwoDirection(maneuver.type(),
+                                             dictionary_.exit_subset.relative_directions) },
+                { kNumberSignTag, exit_number_sign },
+                { kBranchSignTag, exit_branch_sign },
+                { kTowardSignTag, exit_toward_sign },
+                { kNameSignTag, exit_name_sign } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1850,15 +1818,14 @@ std::string NarrativeBuilder::FormVerbalExitInstruction(
   std::string instruction;
   instruction.reserve(kInstructionInitialCapacity);
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.exit_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag, relative_dir);
-  boost::replace_all(instruction, kNumberSignTag, exit_number_sign);
-  boost::replace_all(instruction, kBranchSignTag, exit_branch_sign);
-  boost::replace_all(instruction, kTowardSignTag, exit_toward_sign);
-  boost::replace_all(instruction, kNameSignTag, exit_name_sign);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.exit_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kRelativeDirectionTag, relative_dir },
+                { kNumberSignTag, exit_number_sign },
+                { kBranchSignTag, exit_branch_sign },
+                { kTowardSignTag, exit_toward_sign },
+                { kNameSignTag, exit_name_sign } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -1914,16 +1881,15 @@ std::string NarrativeBuilder::FormKeepInstruction(
         element_max_count, limit_by_consecutive_count);
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.keep_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-      FormRelativeThreeDirection(maneuver.type(),
-                                 dictionary_.keep_subset.relative_directions));
-  boost::replace_all(instruction, kNumberSignTag, exit_number_sign);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kTowardSignTag, exit_toward_sign);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.keep_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kRelativeDirectionTag,
+                    FormRelativeThreeDirection(maneuver.type(),
+                                               dictionary_.keep_subset.relative_directions) },
+                { kNumberSignTag, exit_number_sign },
+                { kStreetNamesTag, street_names },
+                { kTowardSignTag, exit_toward_sign } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2046,14 +2012,13 @@ std::string NarrativeBuilder::FormVerbalKeepInstruction(
   std::string instruction;
   instruction.reserve(kInstructionInitialCapacity);
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.keep_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag, relative_dir);
-  boost::replace_all(instruction, kNumberSignTag, exit_number_sign);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kTowardSignTag, exit_toward_sign);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.keep_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kRelativeDirectionTag, relative_dir },
+                { kNumberSignTag, exit_number_sign },
+                { kStreetNamesTag, street_names },
+                { kTowardSignTag, exit_toward_sign } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2097,16 +2062,15 @@ std::string NarrativeBuilder::FormKeepToStayOnInstruction(
         element_max_count, limit_by_consecutive_count);
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.keep_to_stay_on_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag,
-      FormRelativeThreeDirection(maneuver.type(),
-                                 dictionary_.keep_to_stay_on_subset.relative_directions));
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kNumberSignTag, exit_number_sign);
-  boost::replace_all(instruction, kTowardSignTag, exit_toward_sign);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.keep_to_stay_on_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kRelativeDirectionTag,
+                    FormRelativeThreeDirection(maneuver.type(),
+                                               dictionary_.keep_to_stay_on_subset.relative_directions) },
+                { kStreetNamesTag, street_names },
+                { kNumberSignTag, exit_number_sign },
+                { kTowardSignTag, exit_toward_sign } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2186,15 +2150,13 @@ std::string NarrativeBuilder::FormVerbalKeepToStayOnInstruction(
   std::string instruction;
   instruction.reserve(kInstructionInitialCapacity);
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.keep_to_stay_on_verbal_subset.phrases.at(
-      std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kRelativeDirectionTag, relative_dir);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kNumberSignTag, exit_number_sign);
-  boost::replace_all(instruction, kTowardSignTag, exit_toward_sign);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.keep_to_stay_on_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kRelativeDirectionTag, relative_dir },
+                { kStreetNamesTag, street_names },
+                { kNumberSignTag, exit_number_sign },
+                { kTowardSignTag, exit_toward_sign } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2223,11 +2185,10 @@ std::string NarrativeBuilder::FormMergeInstruction(Maneuver& maneuver) {
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.merge_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.merge_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kStreetNamesTag, street_names } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2265,12 +2226,10 @@ std::string NarrativeBuilder::FormVerbalMergeInstruction(
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.merge_verbal_subset.phrases.at(
-      std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.merge_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kStreetNamesTag, street_names } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2299,11 +2258,10 @@ std::string NarrativeBuilder::FormEnterRoundaboutInstruction(Maneuver& maneuver)
         maneuver.roundabout_exit_count()-1);
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.enter_roundabout_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kOrdinalValueTag, ordinal_value);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.enter_roundabout_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kOrdinalValueTag, ordinal_value } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2333,11 +2291,10 @@ std::string NarrativeBuilder::FormVerbalAlertEnterRoundaboutInstruction(
         maneuver.roundabout_exit_count()-1);
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.enter_roundabout_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kOrdinalValueTag, ordinal_value);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.enter_roundabout_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kOrdinalValueTag, ordinal_value } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2367,11 +2324,10 @@ std::string NarrativeBuilder::FormVerbalEnterRoundaboutInstruction(
         maneuver.roundabout_exit_count()-1);
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.enter_roundabout_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kOrdinalValueTag, ordinal_value);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.enter_roundabout_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kOrdinalValueTag, ordinal_value } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2408,12 +2364,11 @@ std::string NarrativeBuilder::FormExitRoundaboutInstruction(Maneuver& maneuver)
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.exit_roundabout_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kBeginStreetNamesTag, begin_street_names);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.exit_roundabout_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kStreetNamesTag, street_names },
+                { kBeginStreetNamesTag, begin_street_names } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2453,12 +2408,11 @@ std::string NarrativeBuilder::FormVerbalExitRoundaboutInstruction(
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.exit_roundabout_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kBeginStreetNamesTag, begin_street_names);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.exit_roundabout_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kStreetNamesTag, street_names },
+                { kBeginStreetNamesTag, begin_street_names } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2493,12 +2447,11 @@ std::string NarrativeBuilder::FormEnterFerryInstruction(Maneuver& maneuver) {
     }
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.enter_ferry_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kFerryLabelTag, ferry_label);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.enter_ferry_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kStreetNamesTag, street_names },
+                { kFerryLabelTag, ferry_label } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2543,12 +2496,11 @@ std::string NarrativeBuilder::FormVerbalEnterFerryInstruction(
     }
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.enter_ferry_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kFerryLabelTag, ferry_label);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.enter_ferry_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kStreetNamesTag, street_names },
+                { kFerryLabelTag, ferry_label } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2605,13 +2557,12 @@ std::string NarrativeBuilder::FormExitFerryInstruction(Maneuver& maneuver) {
     phrase_id += 16;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.exit_ferry_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kCardinalDirectionTag, cardinal_direction);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kBeginStreetNamesTag, begin_street_names);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.exit_ferry_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kCardinalDirectionTag, cardinal_direction },
+                { kStreetNamesTag, street_names },
+                { kBeginStreetNamesTag, begin_street_names } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2689,13 +2640,12 @@ std::string NarrativeBuilder::FormVerbalExitFerryInstruction(
     phrase_id += 16;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.exit_ferry_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kCardinalDirectionTag, cardinal_direction);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kBeginStreetNamesTag, begin_street_names);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.exit_ferry_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kCardinalDirectionTag, cardinal_direction },
+                { kStreetNamesTag, street_names },
+                { kBeginStreetNamesTag, begin_street_names } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2730,12 +2680,11 @@ std::string NarrativeBuilder::FormTransitConnectionStartInstruction(
     }
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_connection_start_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitStopTag, transit_stop);
-  boost::replace_all(instruction, kStationLabelTag, station_label);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.transit_connection_start_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kTransitStopTag, transit_stop },
+                { kStationLabelTag, station_label } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2770,12 +2719,11 @@ std::string NarrativeBuilder::FormVerbalTransitConnectionStartInstruction(
     }
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_connection_start_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitStopTag, transit_stop);
-  boost::replace_all(instruction, kStationLabelTag, station_label);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.transit_connection_start_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kTransitStopTag, transit_stop },
+                { kStationLabelTag, station_label } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2810,12 +2758,11 @@ std::string NarrativeBuilder::FormTransitConnectionTransferInstruction(
     }
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_connection_transfer_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitStopTag, transit_stop);
-  boost::replace_all(instruction, kStationLabelTag, station_label);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.transit_connection_transfer_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kTransitStopTag, transit_stop },
+                { kStationLabelTag, station_label } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2850,12 +2797,11 @@ std::string NarrativeBuilder::FormVerbalTransitConnectionTransferInstruction(
     }
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_connection_transfer_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitStopTag, transit_stop);
-  boost::replace_all(instruction, kStationLabelTag, station_label);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.transit_connection_transfer_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kTransitStopTag, transit_stop },
+                { kStationLabelTag, station_label } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2890,12 +2836,11 @@ std::string NarrativeBuilder::FormTransitConnectionDestinationInstruction(
     }
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_connection_destination_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitStopTag, transit_stop);
-  boost::replace_all(instruction, kStationLabelTag, station_label);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.transit_connection_destination_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kTransitStopTag, transit_stop },
+                { kStationLabelTag, station_label } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2930,12 +2875,11 @@ std::string NarrativeBuilder::FormVerbalTransitConnectionDestinationInstruction(
     }
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_connection_destination_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitStopTag, transit_stop);
-  boost::replace_all(instruction, kStationLabelTag, station_label);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.transit_connection_destination_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kTransitStopTag, transit_stop },
+                { kStationLabelTag, station_label } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2959,13 +2903,13 @@ std::string NarrativeBuilder::FormDepartInstruction(Maneuver& maneuver) {
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.depart_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitStopTag, transit_stop_name);
-  boost::replace_all(instruction, kTimeTag,
-      get_localized_time(maneuver.GetTransitDepartureTime(), dictionary_.GetLocale()));
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.depart_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kTransitStopTag, transit_stop_name },
+                { kTimeTag,
+                    get_localized_time(maneuver.GetTransitDepartureTime(),
+                                       dictionary_.GetLocale()) } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -2988,13 +2932,13 @@ std::string NarrativeBuilder::FormVerbalDepartInstruction(Maneuver& maneuver) {
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.depart_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitStopTag, transit_stop_name);
-  boost::replace_all(instruction, kTimeTag,
-      get_localized_time(maneuver.GetTransitDepartureTime(), dictionary_.GetLocale()));
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.depart_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kTransitStopTag, transit_stop_name },
+                { kTimeTag,
+                    get_localized_time(maneuver.GetTransitDepartureTime(),
+                                       dictionary_.GetLocale()) } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3017,13 +2961,13 @@ std::string NarrativeBuilder::FormArriveInstruction(Maneuver& maneuver) {
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.arrive_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitStopTag, transit_stop_name);
-  boost::replace_all(instruction, kTimeTag,
-      get_localized_time(maneuver.GetTransitArrivalTime(), dictionary_.GetLocale()));
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.arrive_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kTransitStopTag, transit_stop_name },
+                { kTimeTag,
+                    get_localized_time(maneuver.GetTransitArrivalTime(),
+                                       dictionary_.GetLocale()) } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3046,13 +2990,13 @@ std::string NarrativeBuilder::FormVerbalArriveInstruction(Maneuver& maneuver) {
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.arrive_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitStopTag, transit_stop_name);
-  boost::replace_all(instruction, kTimeTag,
-      get_localized_time(maneuver.GetTransitArrivalTime(), dictionary_.GetLocale()));
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.arrive_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kTransitStopTag, transit_stop_name },
+                { kTimeTag,
+                    get_localized_time(maneuver.GetTransitArrivalTime(),
+                                       dictionary_.GetLocale()) } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3079,18 +3023,15 @@ std::string NarrativeBuilder::FormTransitInstruction(
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(
-      instruction,
-      kTransitNameTag,
-      FormTransitName(maneuver,
-                      dictionary_.transit_subset.empty_transit_name_labels));
-  boost::replace_all(instruction, kTransitHeadSignTag, transit_headsign);
-  boost::replace_all(instruction, kTransitStopCountTag, std::to_string(stop_count)); //TODO: locale specific numerals
-  boost::replace_all(instruction, kTransitStopCountLabelTag, stop_count_label);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.transit_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kTransitNameTag,
+                    FormTransitName(maneuver,
+                                    dictionary_.transit_subset.empty_transit_name_labels) },
+                { kTransitHeadSignTag, transit_headsign },
+                { kTransitStopCountTag, std::to_string(stop_count) },
+                { kTransitStopCountLabelTag, stop_count_label } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3113,16 +3054,13 @@ std::string NarrativeBuilder::FormVerbalTransitInstruction(Maneuver& maneuver) {
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(
-      instruction,
-      kTransitNameTag,
-      FormTransitName(maneuver,
-                      dictionary_.transit_verbal_subset.empty_transit_name_labels));
-  boost::replace_all(instruction, kTransitHeadSignTag, transit_headsign);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.transit_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kTransitNameTag,
+                    FormTransitName(maneuver,
+                                    dictionary_.transit_verbal_subset.empty_transit_name_labels) },
+                { kTransitHeadSignTag, transit_headsign } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3149,19 +3087,15 @@ std::string NarrativeBuilder::FormTransitRemainOnInstruction(
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_remain_on_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(
-      instruction,
-      kTransitNameTag,
-      FormTransitName(
-          maneuver,
-          dictionary_.transit_remain_on_subset.empty_transit_name_labels));
-  boost::replace_all(instruction, kTransitHeadSignTag, transit_headsign);
-  boost::replace_all(instruction, kTransitStopCountTag, std::to_string(stop_count)); //TODO: locale specific numerals
-  boost::replace_all(instruction, kTransitStopCountLabelTag, stop_count_label);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.transit_remain_on_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kTransitNameTag,
+                    FormTransitName(maneuver,
+                                    dictionary_.transit_remain_on_subset.empty_transit_name_labels) },
+                { kTransitHeadSignTag, transit_headsign },
+                { kTransitStopCountTag, std::to_string(stop_count) },
+                { kTransitStopCountLabelTag, stop_count_label } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3186,17 +3120,13 @@ std::string NarrativeBuilder::FormVerbalTransitRemainOnInstruction(
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_remain_on_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(
-      instruction,
-      kTransitNameTag,
-      FormTransitName(
-          maneuver,
-          dictionary_.transit_remain_on_verbal_subset.empty_transit_name_labels));
-  boost::replace_all(instruction, kTransitHeadSignTag, transit_headsign);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.transit_remain_on_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kTransitNameTag,
+                    FormTransitName(maneuver,
+                                    dictionary_.transit_remain_on_verbal_subset.empty_transit_name_labels) },
+                { kTransitHeadSignTag, transit_headsign } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3223,19 +3153,15 @@ std::string NarrativeBuilder::FormTransitTransferInstruction(
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_transfer_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(
-      instruction,
-      kTransitNameTag,
-      FormTransitName(
-          maneuver,
-          dictionary_.transit_transfer_subset.empty_transit_name_labels));
-  boost::replace_all(instruction, kTransitHeadSignTag, transit_headsign);
-  boost::replace_all(instruction, kTransitStopCountTag, std::to_string(stop_count)); //TODO: locale specific numerals
-  boost::replace_all(instruction, kTransitStopCountLabelTag, stop_count_label);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.transit_transfer_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kTransitNameTag,
+                    FormTransitName(maneuver,
+                                    dictionary_.transit_transfer_subset.empty_transit_name_labels) },
+                { kTransitHeadSignTag, transit_headsign },
+                { kTransitStopCountTag, std::to_string(stop_count) },
+                { kTransitStopCountLabelTag, stop_count_label } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3260,17 +3186,13 @@ std::string NarrativeBuilder::FormVerbalTransitTransferInstruction(
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.transit_transfer_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(
-      instruction,
-      kTransitNameTag,
-      FormTransitName(
-          maneuver,
-          dictionary_.transit_transfer_verbal_subset.empty_transit_name_labels));
-  boost::replace_all(instruction, kTransitHeadSignTag, transit_headsign);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.transit_transfer_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kTransitNameTag,
+                    FormTransitName(maneuver,
+                                    dictionary_.transit_transfer_verbal_subset.empty_transit_name_labels) },
+                { kTransitHeadSignTag, transit_headsign } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3328,14 +3250,12 @@ std::string NarrativeBuilder::FormPostTransitConnectionDestinationInstruction(
     phrase_id += 16;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.post_transit_connection_destination_subset.
-      phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kCardinalDirectionTag, cardinal_direction);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kBeginStreetNamesTag, begin_street_names);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.post_transit_connection_destination_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kCardinalDirectionTag, cardinal_direction },
+                { kStreetNamesTag, street_names },
+                { kBeginStreetNamesTag, begin_street_names } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3395,13 +3315,12 @@ std::string NarrativeBuilder::FormVerbalPostTransitConnectionDestinationInstruct
     phrase_id += 16;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.post_transit_connection_destination_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kCardinalDirectionTag, cardinal_direction);
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
-  boost::replace_all(instruction, kBeginStreetNamesTag, begin_street_names);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.post_transit_connection_destination_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kCardinalDirectionTag, cardinal_direction },
+                { kStreetNamesTag, street_names },
+                { kBeginStreetNamesTag, begin_street_names } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3432,16 +3351,14 @@ std::string NarrativeBuilder::FormVerbalPostTransitionInstruction(
     phrase_id = 1;
   }
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.post_transition_verbal_subset.phrases.at(
-      std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kLengthTag,
-      FormLength(
-          maneuver, dictionary_.post_transition_verbal_subset.metric_lengths,
-          dictionary_.post_transition_verbal_subset.us_customary_lengths));
-  boost::replace_all(instruction, kStreetNamesTag, street_names);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.post_transition_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kLengthTag,
+                    FormLength(maneuver,
+                               dictionary_.post_transition_verbal_subset.metric_lengths,
+                               dictionary_.post_transition_verbal_subset.us_customary_lengths) },
+                { kStreetNamesTag, street_names } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3464,12 +3381,11 @@ std::string NarrativeBuilder::FormVerbalPostTransitionTransitInstruction(
       dictionary_.post_transition_transit_verbal_subset
           .transit_stop_count_labels);
 
-  // Set instruction to the determined tagged phrase
-  instruction = dictionary_.post_transition_transit_verbal_subset.phrases.at(std::to_string(phrase_id));
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kTransitStopCountTag, std::to_string(stop_count)); //TODO: locale specific numerals
-  boost::replace_all(instruction, kTransitStopCountLabelTag, stop_count_label);
+  // Render the determined tagged phrase with the tags replaced by values
+  dictionary_.post_transition_transit_verbal_subset.templates.at(std::to_string(phrase_id))
+      .Render(instruction,
+              { { kTransitStopCountTag, std::to_string(stop_count) },
+                { kTransitStopCountLabelTag, stop_count_label } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -3795,11 +3711,10 @@ std::string NarrativeBuilder::FormVerbalMultiCue(Maneuver* maneuver,
 
 
   // Set instruction to the verbal multi-cue
-  instruction = dictionary_.verbal_multi_cue_subset.phrases.at("0");
-
-  // Replace phrase tags with values
-  boost::replace_all(instruction, kCurrentVerbalCueTag, current_verbal_cue);
-  boost::replace_all(instruction, kNextVerbalCueTag, next_verbal_cue);
+  dictionary_.verbal_multi_cue_subset.templates.at("0")
+      .Render(instruction,
+              { { kCurrentVerbalCueTag, current_verbal_cue },
+                { kNextVerbalCueTag, next_verbal_cue } });
 
   // If enabled, form articulated prepositions
   if (articulated_preposition_enabled_) {
@@ -4,15 +4,14 @@
 #include <vector>
 #include <unordered_map>
 #include <cstdint>
-#include <sstream>
 
 #include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/json_parser.hpp>
 
 #include "baldr/json.h"
 #include "midgard/logging.h"
 
 #include "proto/directions_options.pb.h"
+#include "proto/request.pb.h"
 #include "proto/trippath.pb.h"
 #include "odin/worker.h"
 #include "odin/util.h"
@@ -46,6 +45,14 @@ namespace valhalla {
       if(options)
         directions_options = valhalla::odin::GetDirectionsOptions(*options);
 
+      return narrate(directions_options, legs);
+    }
+
+    std::list<TripDirections> odin_worker_t::narrate(DirectionsOptions& directions_options, std::list<TripPath>& legs) const {
+      // If language is not found then set to the default language (en-US)
+      if (odin::get_locales().find(directions_options.language()) == odin::get_locales().end())
+        directions_options.set_language(odin::DirectionsOptions::default_instance().language());
+
       //get some annotated directions
       std::list<TripDirections> narrated;
       try{
@@ -66,17 +73,12 @@ namespace valhalla {
       LOG_INFO("Got Odin Request " + std::to_string(info.id));
       boost::optional<std::string> jsonp;
       try{
-        //crack open the original request
-        std::string request_str(static_cast<const char*>(job.front().data()), job.front().size());
-        std::stringstream stream(request_str);
-        boost::property_tree::ptree request;
-        try{
-          boost::property_tree::read_json(stream, request);
-          jsonp = request.get_optional<std::string>("jsonp");
-        }
-        catch(...) {
+        //crack open the request envelope from thor
+        Request request;
+        if(!request.ParseFromArray(job.front().data(), static_cast<int>(job.front().size())))
           return jsonify_error({200}, info, jsonp);
-        }
+        if(request.has_jsonp())
+          jsonp = request.jsonp();
 
         //parse each leg
         std::list<TripPath> legs;
@@ -92,9 +94,13 @@ namespace valhalla {
         }
 
         //narrate them and serialize them along
-        auto narrated = narrate(request, legs);
-        ACTION_TYPE action = static_cast<ACTION_TYPE>(request.get<int>("action"));
-        return to_response(tyr::serializeDirections(action, request, narrated), jsonp, info);
+        auto& directions_options = *request.mutable_directions_options();
+        auto narrated = narrate(directions_options, legs);
+        ACTION_TYPE action = static_cast<ACTION_TYPE>(request.action());
+        boost::optional<std::string> id;
+        if(request.has_id())
+          id = request.id();
+        return to_response(tyr::serializeDirections(action, id, directions_options, narrated), jsonp, info);
       }
       catch(const std::exception& e) {
         return jsonify_error({299, std::string(e.what())}, info, jsonp);
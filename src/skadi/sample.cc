@@ -1,13 +1,24 @@
 #include "skadi/sample.h"
 
 #include <cstddef>
+#include <algorithm>
 #include <cmath>
 #include <stdexcept>
 #include <limits>
 #include <list>
 #include <fstream>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 #include <boost/regex.hpp>
 #include <sys/stat.h>
+#include <zlib.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 #include <boost/filesystem.hpp>
 #include <boost/optional.hpp>
@@ -26,6 +37,7 @@ namespace {
   constexpr int16_t NO_DATA_HIGH = 16384;
   constexpr int16_t NO_DATA_LOW = -16384;
   constexpr size_t TILE_COUNT = 180 * 360;
+  constexpr size_t BATCH_SIZE = 512;
 
   //macro is faster than inline funciton for this..
   #define out_of_range(v) v > NO_DATA_HIGH || v < NO_DATA_LOW
@@ -57,7 +69,7 @@ namespace {
 
   uint16_t is_hgt(const std::string& name) {
     boost::smatch m;
-    boost::regex e(".*/([NS])([0-9]{2})([WE])([0-9]{3})\\.hgt$");
+    boost::regex e(".*/([NS])([0-9]{2})([WE])([0-9]{3})\\.hgt(\\.gz)?$");
     if(boost::regex_search(name, m, e)) {
       auto lon = std::stoul(m[4]) * (m[3] == "E" ? 1 : -1) + 180;
       auto lat = std::stoul(m[2]) * (m[1] == "N" ? 1 : -1) + 90;
@@ -77,37 +89,228 @@ namespace {
     return rc == 0 ? s.st_size : -1;
   }
 
+  bool is_gzipped(const std::string& name) {
+    return name.size() > 3 && name.compare(name.size() - 3, 3, ".gz") == 0;
+  }
+
+  //inflate a whole gzipped tile, false if its not exactly one tile worth of pixels
+  bool inflate_hgt(const std::string& file_name, std::vector<int16_t>& tile) {
+    gzFile file = gzopen(file_name.c_str(), "rb");
+    if(file == nullptr)
+      return false;
+    tile.resize(HGT_PIXELS);
+    auto bytes = HGT_PIXELS * sizeof(int16_t);
+    auto read = gzread(file, tile.data(), bytes);
+    //make sure there isnt anything after the pixels
+    char extra;
+    bool valid = read == static_cast<int>(bytes) && gzread(file, &extra, 1) == 0;
+    gzclose(file);
+    return valid;
+  }
+
+#ifdef __AVX2__
+  //zero the coefficients of the lanes whose pixel is out of range
+  __m256d valid_coefficient(__m128i pixel, __m256d coefficient) {
+    auto invalid = _mm_or_si128(_mm_cmpgt_epi32(pixel, _mm_set1_epi32(NO_DATA_HIGH)),
+                                _mm_cmplt_epi32(pixel, _mm_set1_epi32(NO_DATA_LOW)));
+    return _mm256_andnot_pd(_mm256_castsi256_pd(_mm256_cvtepi32_epi64(invalid)), coefficient);
+  }
+
+  //four postings at a time with the same arithmetic in the same order as the scalar
+  //interpolation so the two agree exactly, as long as the compiler does not contract the
+  //scalar one into fused multiply-adds (the build passes -ffp-contract=off for this file). returns the
+  //number of postings done so the scalar loop can finish the rest
+  size_t interpolate_avx2(const int16_t* t, double lon, double lat, const double* lons,
+    const double* lats, size_t count, double* values) {
+    size_t done = count - count % 4;
+    const __m256d plon = _mm256_set1_pd(lon);
+    const __m256d plat = _mm256_set1_pd(lat);
+    const __m256d scale = _mm256_set1_pd(HGT_DIM - 1);
+    const __m256d one = _mm256_set1_pd(1);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d no_data = _mm256_set1_pd(NO_DATA_VALUE);
+    const __m128i row = _mm_set1_epi32(HGT_DIM);
+    const __m128i last_row = _mm_set1_epi32(HGT_DIM - 1);
+    //swaps the bytes of each big endian pixel
+    const __m128i flip_bytes = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    const int* pixels = reinterpret_cast<const int*>(t);
+
+    for(size_t i = 0; i < done; i += 4) {
+      //fractional and integer pixel
+      __m256d u = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(lons + i), plon), scale);
+      __m256d v = _mm256_mul_pd(_mm256_sub_pd(one, _mm256_sub_pd(_mm256_loadu_pd(lats + i), plat)), scale);
+      __m256d fu = _mm256_floor_pd(u);
+      __m256d fv = _mm256_floor_pd(v);
+      __m128i x = _mm256_cvttpd_epi32(fu);
+      __m128i y = _mm256_cvttpd_epi32(fv);
+
+      //coefficients
+      __m256d u_ratio = _mm256_sub_pd(u, fu);
+      __m256d v_ratio = _mm256_sub_pd(v, fv);
+      __m256d u_inv = _mm256_sub_pd(one, u_ratio);
+      __m256d v_inv = _mm256_sub_pd(one, v_ratio);
+      __m256d a_coef = _mm256_mul_pd(u_inv, v_inv);
+      __m256d b_coef = _mm256_mul_pd(u_ratio, v_inv);
+      __m256d c_coef = _mm256_mul_pd(u_inv, v_ratio);
+      __m256d d_coef = _mm256_mul_pd(u_ratio, v_ratio);
+
+      //a pixel and the one to its right are adjacent so one 32bit gather gets both. on
+      //the last row the scalar code skips the second row, here we read the first row
+      //again and give it no weight
+      __m128i offset = _mm_add_epi32(_mm_mullo_epi32(y, row), x);
+      __m128i has_next = _mm_cmplt_epi32(y, last_row);
+      __m128i next = _mm_add_epi32(offset, _mm_and_si128(has_next, row));
+      __m128i ab = _mm_shuffle_epi8(_mm_i32gather_epi32(pixels, offset, 2), flip_bytes);
+      __m128i cd = _mm_shuffle_epi8(_mm_i32gather_epi32(pixels, next, 2), flip_bytes);
+      __m128i a = _mm_srai_epi32(_mm_slli_epi32(ab, 16), 16);
+      __m128i b = _mm_srai_epi32(ab, 16);
+      __m128i c = _mm_srai_epi32(_mm_slli_epi32(cd, 16), 16);
+      __m128i d = _mm_srai_epi32(cd, 16);
+      a_coef = valid_coefficient(a, a_coef);
+      b_coef = valid_coefficient(b, b_coef);
+      __m256d second_row = _mm256_castsi256_pd(_mm256_cvtepi32_epi64(has_next));
+      c_coef = _mm256_and_pd(second_row, valid_coefficient(c, c_coef));
+      d_coef = _mm256_and_pd(second_row, valid_coefficient(d, d_coef));
+
+      //values
+      __m256d value = _mm256_add_pd(_mm256_mul_pd(_mm256_cvtepi32_pd(a), a_coef),
+                                    _mm256_mul_pd(_mm256_cvtepi32_pd(b), b_coef));
+      __m256d adjust = _mm256_add_pd(a_coef, b_coef);
+      value = _mm256_add_pd(value, _mm256_add_pd(_mm256_mul_pd(_mm256_cvtepi32_pd(c), c_coef),
+                                                 _mm256_mul_pd(_mm256_cvtepi32_pd(d), d_coef)));
+      adjust = _mm256_add_pd(adjust, _mm256_add_pd(c_coef, d_coef));
+
+      //no data if we are missing everything, otherwise adjust by what we have
+      __m256d missing = _mm256_cmp_pd(adjust, zero, _CMP_EQ_OQ);
+      _mm256_storeu_pd(values + i, _mm256_blendv_pd(_mm256_div_pd(value, adjust), no_data, missing));
+    }
+    return done;
+  }
+#endif
+
 }
 
 namespace valhalla {
 namespace skadi {
 
-  sample::sample(const std::string& data_source):cache(TILE_COUNT) {
+  //a bounded list of decompressed tiles, most recently used at the front
+  struct sample::lru_t {
+    lru_t(size_t capacity):capacity(std::max<size_t>(capacity, 1)), hits(0), misses(0), decompression_ns(0) {}
+    size_t capacity;
+    std::mutex lock;
+    std::list<std::pair<uint16_t, tile_t> > tiles;
+    std::unordered_map<uint16_t, std::list<std::pair<uint16_t, tile_t> >::iterator> lookup;
+    //tiles that failed to decompress, so we dont keep trying
+    std::unordered_set<uint16_t> failed;
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> decompression_ns;
+  };
+
+  constexpr size_t sample::DEFAULT_CACHE_SIZE;
+
+  sample::sample(const std::string& data_source, size_t cache_size):
+    cache(TILE_COUNT), compressed(TILE_COUNT), lru(new lru_t(cache_size)) {
     //check the directory for files that look like what we need
     auto files = get_files(data_source);
     for(const auto& f : files) {
       auto index = is_hgt(f);
       if(index < cache.size()) {
-        if(file_size(f) == HGT_PIXELS * sizeof(int16_t))
+        //gzipped tiles are only checked when they are first used
+        if(is_gzipped(f)) {
+          //prefer the raw tile if we have both
+          if(!cache[index])
+            compressed[index] = f;
+        }
+        else if(file_size(f) == HGT_PIXELS * sizeof(int16_t)) {
           cache[index].map(f, HGT_PIXELS * sizeof(int16_t));
+          compressed[index].clear();
+        }
         else
           LOG_WARN("Corrupt elevation data: " + f);
       }
     }
   }
 
+  sample::sample(sample&&) = default;
+  sample& sample::operator=(sample&&) = default;
+  sample::~sample() = default;
+
+  const int16_t* sample::get_tile(uint16_t index, tile_t& holder) const {
+    if(index >= cache.size())
+      return nullptr;
+
+    //mapped raw tile
+    if(cache[index])
+      return cache[index].get();
+
+    //no data here at all
+    if(compressed[index].empty())
+      return nullptr;
+
+    //already decompressed, move it to the front
+    {
+      std::lock_guard<std::mutex> guard(lru->lock);
+      if(lru->failed.find(index) != lru->failed.end())
+        return nullptr;
+      auto found = lru->lookup.find(index);
+      if(found != lru->lookup.end()) {
+        lru->tiles.splice(lru->tiles.begin(), lru->tiles, found->second);
+        holder = found->second->second;
+        ++lru->hits;
+        return holder->data();
+      }
+    }
+
+    //decompress it outside of the lock so other tiles can be read meanwhile
+    ++lru->misses;
+    auto start = std::chrono::steady_clock::now();
+    auto tile = std::make_shared<std::vector<int16_t> >();
+    if(!inflate_hgt(compressed[index], *tile)) {
+      std::lock_guard<std::mutex> guard(lru->lock);
+      if(lru->failed.insert(index).second)
+        LOG_WARN("Corrupt elevation data: " + compressed[index]);
+      return nullptr;
+    }
+    lru->decompression_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start).count();
+
+    //another thread may have beaten us to it in which case we use theirs
+    std::lock_guard<std::mutex> guard(lru->lock);
+    auto found = lru->lookup.find(index);
+    if(found != lru->lookup.end()) {
+      lru->tiles.splice(lru->tiles.begin(), lru->tiles, found->second);
+      holder = found->second->second;
+      return holder->data();
+    }
+    holder = tile;
+    lru->tiles.emplace_front(index, holder);
+    lru->lookup.emplace(index, lru->tiles.begin());
+    //evict the least recently used, readers still holding it keep it alive
+    while(lru->tiles.size() > lru->capacity) {
+      lru->lookup.erase(lru->tiles.back().first);
+      lru->tiles.pop_back();
+    }
+    return holder->data();
+  }
+
   template <class coord_t>
   double sample::get(const coord_t& coord) const {
     //check the cache and load
     auto lon = std::floor(coord.first);
     auto lat = std::floor(coord.second);
     auto index = static_cast<uint16_t>(lat + 90) * 360 + static_cast<uint16_t>(lon + 180);
-    if(index > cache.size() || !cache[index])
+    tile_t holder;
+    const int16_t* t = get_tile(index, holder);
+    if(t == nullptr)
       return NO_DATA_VALUE;
+    return interpolate(t, coord, lon, lat);
+  }
 
+  template <class coord_t>
+  double sample::interpolate(const int16_t* t, const coord_t& coord, double lon, double lat) {
     //grab the data array and what row and column we need
     //NOTE: data is arranged from upper left to bottom right, so y is flipped
-    const int16_t* t = cache[index].get();
 
     //fractional pixel
     double u = (coord.first - lon) * (HGT_DIM - 1);
@@ -158,12 +361,58 @@ namespace skadi {
     return value / adjust;
   }
 
+  void sample::interpolate_all(const int16_t* t, double lon, double lat, const double* lons,
+    const double* lats, size_t count, double* values) {
+    size_t i = 0;
+#ifdef __AVX2__
+    i = interpolate_avx2(t, lon, lat, lons, lats, count, values);
+#endif
+    for(; i < count; ++i)
+      values[i] = interpolate(t, std::make_pair(lons[i], lats[i]), lon, lat);
+  }
+
   template <class coords_t>
   std::vector<double> sample::get_all(const coords_t& coords) const {
-    std::vector<double> values;
-    values.reserve(coords.size());
-    for(const auto& coord : coords)
-      values.emplace_back(get(coord));
+    std::vector<double> values(coords.size());
+    //consecutive postings of a shape are mostly in the same tile so we batch
+    //them up until the tile changes and interpolate the batch all at once
+    std::vector<double> lons, lats;
+    lons.reserve(BATCH_SIZE);
+    lats.reserve(BATCH_SIZE);
+    tile_t holder;
+    const int16_t* t = nullptr;
+    int32_t last = -1;
+    double tile_lon = 0, tile_lat = 0;
+    size_t first = 0, i = 0;
+    auto flush = [&]() {
+      if(t != nullptr)
+        interpolate_all(t, tile_lon, tile_lat, lons.data(), lats.data(), lons.size(), values.data() + first);
+      else
+        std::fill(values.begin() + first, values.begin() + i, NO_DATA_VALUE);
+      lons.clear();
+      lats.clear();
+      first = i;
+    };
+    for(const auto& coord : coords) {
+      auto lon = std::floor(coord.first);
+      auto lat = std::floor(coord.second);
+      auto index = static_cast<uint16_t>(lat + 90) * 360 + static_cast<uint16_t>(lon + 180);
+      //keep the batch small enough to stay in cache
+      if(lons.size() == BATCH_SIZE)
+        flush();
+      if(index != last) {
+        flush();
+        holder.reset();
+        t = get_tile(index, holder);
+        last = index;
+        tile_lon = lon;
+        tile_lat = lat;
+      }
+      lons.push_back(coord.first);
+      lats.push_back(coord.second);
+      ++i;
+    }
+    flush();
     return values;
   }
 
@@ -171,6 +420,10 @@ namespace skadi {
     return NO_DATA_VALUE;
   }
 
+  sample::cache_stats_t sample::get_cache_stats() const {
+    return cache_stats_t{lru->hits, lru->misses, lru->decompression_ns * 1e-9};
+  }
+
   //explicit instantiations for templated get
   template double sample::get<std::pair<double, double> >(const std::pair<double, double>&) const;
   template double sample::get<std::pair<float, float> >(const std::pair<float, float>&) const;
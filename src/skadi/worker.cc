@@ -76,7 +76,8 @@ namespace valhalla {
   namespace skadi {
 
     skadi_worker_t::skadi_worker_t (const boost::property_tree::ptree& config):
-      sample(config.get<std::string>("additional_data.elevation", "test/data/")), range(false),
+      sample(config.get<std::string>("additional_data.elevation", "test/data/"),
+             config.get<size_t>("additional_data.elevation_cache", skadi::sample::DEFAULT_CACHE_SIZE)), range(false),
       max_shape(config.get<size_t>("service_limits.skadi.max_shape")), min_resample(config.get<float>("service_limits.skadi.min_resample")),
       long_request(config.get<float>("skadi.logging.long_request")), healthcheck(false), action_str("'height'"){
     }
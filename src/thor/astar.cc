@@ -4,6 +4,7 @@
 #include "baldr/datetime.h"
 #include "midgard/logging.h"
 #include "thor/astar.h"
+#include "sif/concretecost.h"
 
 using namespace valhalla::baldr;
 using namespace valhalla::sif;
@@ -21,6 +22,7 @@ AStarPathAlgorithm::AStarPathAlgorithm()
     : PathAlgorithm(),
       mode_(TravelMode::kDrive),
       travel_type_(0),
+      origin_time_(kInvalidSecondsOfWeek),
       adjacencylist_(nullptr),
       edgestatus_(nullptr),
       max_label_count_(std::numeric_limits<uint32_t>::max()) {
@@ -36,12 +38,15 @@ void AStarPathAlgorithm::Clear() {
   // Clear the edge labels and destination list
   edgelabels_.clear();
   destinations_.clear();
+  destination_dists_.clear();
 
   // Clear elements from the adjacency list
   adjacencylist_.reset();
 
-  // Clear the edge status flags
-  edgestatus_.reset();
+  // Clear the edge status flags. The per tile arrays are kept for reuse.
+  if (edgestatus_) {
+    edgestatus_->Init();
+  }
 }
 
 // Initialize prior to finding best path
@@ -70,7 +75,11 @@ void AStarPathAlgorithm::Init(const PointLL& origll, const PointLL& destll,
   uint32_t bucketsize = costing->UnitSize();
   float range = kBucketCount * bucketsize;
   adjacencylist_.reset(new DoubleBucketQueue(mincost, range, bucketsize, edgecost));
-  edgestatus_.reset(new EdgeStatus());
+  if (edgestatus_) {
+    edgestatus_->Init();
+  } else {
+    edgestatus_.reset(new EdgeStatus());
+  }
 
   // Get hierarchy limits from the costing. Get a copy since we increment
   // transition counts (i.e., this is not a const reference).
@@ -106,31 +115,12 @@ void AStarPathAlgorithm::ModifyHierarchyLimits(const float dist,
   hierarchy_limits_[1].expansion_within_dist *= factor;
 }
 
-// Calculate best path. This method is single mode, not time-dependent.
-std::vector<PathInfo> AStarPathAlgorithm::GetBestPath(PathLocation& origin,
+// Expand until the best path to the destination is found. Every edge goes
+// through the costing so the costing type is a template parameter.
+template <class cost_t>
+std::vector<PathInfo> AStarPathAlgorithm::Search(PathLocation& origin,
              PathLocation& destination, GraphReader& graphreader,
-             const std::shared_ptr<DynamicCost>* mode_costing,
-             const TravelMode mode) {
-  // Set the mode and costing
-  mode_ = mode;
-  const auto& costing = mode_costing[static_cast<uint32_t>(mode_)];
-  travel_type_ = costing->travel_type();
-
-  // Initialize - create adjacency list, edgestatus support, A*, etc.
-  //Note: because we can correlate to more than one place for a given PathLocation
-  //using edges.front here means we are only setting the heuristics to one of them
-  //alternate paths using the other correlated points to may be harder to find
-  Init(origin.edges.front().projected, destination.edges.front().projected, costing);
-  float mindist = astarheuristic_.GetDistance(origin.edges.front().projected);
-
-  // Initialize the origin and destination locations. Initialize the
-  // destination first in case the origin edge includes a destination edge.
-  uint32_t density = SetDestination(graphreader, destination, costing);
-  SetOrigin(graphreader, origin, destination, costing);
-
-  // Update hierarchy limits
-  ModifyHierarchyLimits(mindist, density);
-
+             const ConcreteCost<cost_t>& costing, float mindist) {
   // Find shortest path
   uint32_t nc = 0;       // Count of iterations with no convergence
                          // towards destination
@@ -199,7 +189,7 @@ std::vector<PathInfo> AStarPathAlgorithm::GetBestPath(PathLocation& origin,
 
     // Check access at the node
     const NodeInfo* nodeinfo = tile->node(node);
-    if (!costing->Allowed(nodeinfo)) {
+    if (!costing.Allowed(nodeinfo)) {
       continue;
     }
 
@@ -209,6 +199,10 @@ std::vector<PathInfo> AStarPathAlgorithm::GetBestPath(PathLocation& origin,
       continue;
     }
 
+    // Time of the week when the end node is reached. Edge speeds are those
+    // at this time when there are speed profiles.
+    uint32_t seconds = offset_seconds_of_week(origin_time_, pred.cost().secs);
+
     // Expand from end node.
     uint32_t shortcuts = 0;
     uint32_t max_shortcut_length = static_cast<uint32_t>(dist2dest * 0.5f);
@@ -241,7 +235,7 @@ std::vector<PathInfo> AStarPathAlgorithm::GetBestPath(PathLocation& origin,
         continue;
       }
 
-      if (!costing->Allowed(directededge, pred, tile, edgeid)) {
+      if (!costing.Allowed(directededge, pred, tile, edgeid)) {
         continue;
       }
 
@@ -260,7 +254,7 @@ std::vector<PathInfo> AStarPathAlgorithm::GetBestPath(PathLocation& origin,
       }
 
       // Check for complex restriction
-      if (costing->Restricted(directededge, pred, edgelabels_, tile,
+      if (costing.Restricted(directededge, pred, edgelabels_, tile,
                                edgeid, true)) {
         continue;
       }
@@ -269,14 +263,16 @@ std::vector<PathInfo> AStarPathAlgorithm::GetBestPath(PathLocation& origin,
       shortcuts |= directededge->shortcut();
 
       // Compute the cost to the end of this edge
-      Cost newcost = pred.cost() + costing->EdgeCost(directededge) +
-			     costing->TransitionCost(directededge, nodeinfo, pred);
+      Cost edgecost = costing.EdgeCost(directededge, tile, seconds);
+      Cost newcost = pred.cost() + edgecost +
+			     costing.TransitionCost(directededge, nodeinfo, pred);
 
-      // If this edge is a destination, subtract the partial/remainder cost
-      // (cost from the dest. location to the end of the edge).
+      // If this edge is a destination, subtract the partial/remainder time
+      // (time from the dest. location to the end of the edge). Use the same
+      // (time dependent) edge cost so the elapsed time never decreases.
       auto p = destinations_.find(edgeid);
       if (p != destinations_.end()) {
-        newcost.secs -= p->second.secs;  // Should properly handle elapsed time
+        newcost.secs -= edgecost.secs * (1.0f - destination_dists_[edgeid]);
         newcost.cost += p->second.cost;  // Need this to handle the edge score
       }
 
@@ -317,6 +313,53 @@ std::vector<PathInfo> AStarPathAlgorithm::GetBestPath(PathLocation& origin,
   return {};      // Should never get here
 }
 
+// Calculate best path. This method is single mode. Edge speeds depend on the
+// time the edge is reached if the origin has a date and time.
+std::vector<PathInfo> AStarPathAlgorithm::GetBestPath(PathLocation& origin,
+             PathLocation& destination, GraphReader& graphreader,
+             const std::shared_ptr<DynamicCost>* mode_costing,
+             const TravelMode mode) {
+  // Set the mode and costing
+  mode_ = mode;
+  const auto& costing = mode_costing[static_cast<uint32_t>(mode_)];
+  travel_type_ = costing->travel_type();
+
+  // Initialize - create adjacency list, edgestatus support, A*, etc.
+  //Note: because we can correlate to more than one place for a given PathLocation
+  //using edges.front here means we are only setting the heuristics to one of them
+  //alternate paths using the other correlated points to may be harder to find
+  Init(origin.edges.front().projected, destination.edges.front().projected, costing);
+  float mindist = astarheuristic_.GetDistance(origin.edges.front().projected);
+
+  // Initialize the origin and destination locations. Initialize the
+  // destination first in case the origin edge includes a destination edge.
+  uint32_t density = SetDestination(graphreader, destination, costing);
+  SetOrigin(graphreader, origin, destination, costing);
+
+  // Get the time of the week at the origin (SetOrigin resolves the current
+  // time). Without one the search uses the edge speeds.
+  origin_time_ = IsTimeDependent(origin, *costing, graphreader) ?
+                     DateTime::seconds_of_week(*origin.date_time_) : kInvalidSecondsOfWeek;
+
+  // Update hierarchy limits
+  ModifyHierarchyLimits(mindist, density);
+
+  // Expand with the costing methods resolved at compile time if there is a
+  // concrete costing class for this costing, through the vtable otherwise
+  switch (GetConcreteCosting(costing.get())) {
+    case ConcreteCosting::kAuto:
+      return Search(origin, destination, graphreader, ConcreteCost<AutoCost>(costing.get()), mindist);
+    case ConcreteCosting::kTruck:
+      return Search(origin, destination, graphreader, ConcreteCost<TruckCost>(costing.get()), mindist);
+    case ConcreteCosting::kBicycle:
+      return Search(origin, destination, graphreader, ConcreteCost<BicycleCost>(costing.get()), mindist);
+    case ConcreteCosting::kPedestrian:
+      return Search(origin, destination, graphreader, ConcreteCost<PedestrianCost>(costing.get()), mindist);
+    default:
+      return Search(origin, destination, graphreader, ConcreteCost<DynamicCost>(costing.get()), mindist);
+  }
+}
+
 // Convenience method to add an edge to the adjacency list and temporarily
 // label it.
 void AStarPathAlgorithm::AddToAdjacencyList(const GraphId& edgeid,
@@ -442,6 +485,7 @@ uint32_t AStarPathAlgorithm::SetDestination(GraphReader& graphreader,
     const GraphTile* tile = graphreader.GetGraphTile(edge.id);
     destinations_[edge.id] = costing->EdgeCost(tile->directededge(edge.id)) *
                                 (1.0f - edge.dist);
+    destination_dists_[edge.id] = edge.dist;
 
     // We need to penalize this location based on its score (distance in meters from input)
     // We assume the slowest speed you could travel to cover that distance to start/end the route
@@ -35,6 +35,10 @@ BidirectionalAStar::BidirectionalAStar(): PathAlgorithm() {
   adjacencylist_reverse_ = nullptr;
   edgestatus_forward_ = nullptr;
   edgestatus_reverse_ = nullptr;
+  origin_time_ = kInvalidSecondsOfWeek;
+  destination_time_ = kInvalidSecondsOfWeek;
+  search_forward_ = true;
+  search_reverse_ = true;
 }
 
 // Destructor
@@ -48,8 +52,12 @@ void BidirectionalAStar::Clear() {
   edgelabels_reverse_.clear();
   adjacencylist_forward_.reset();
   adjacencylist_reverse_.reset();
-  edgestatus_forward_.reset();
-  edgestatus_reverse_.reset();
+  if (edgestatus_forward_) {
+    edgestatus_forward_->Init();
+  }
+  if (edgestatus_reverse_) {
+    edgestatus_reverse_->Init();
+  }
 }
 
 // Initialize the A* heuristic and adjacency lists for both the forward
@@ -80,12 +88,20 @@ void BidirectionalAStar::Init(const PointLL& origll, const PointLL& destll) {
   float mincostf  = astarheuristic_forward_.Get(origll);
   adjacencylist_forward_.reset(new DoubleBucketQueue(mincostf, range, bucketsize,
                                                  forward_edgecost));
-  edgestatus_forward_.reset(new EdgeStatus());
+  if (edgestatus_forward_) {
+    edgestatus_forward_->Init();
+  } else {
+    edgestatus_forward_.reset(new EdgeStatus());
+  }
 
   float mincostr = astarheuristic_reverse_.Get(destll);
   adjacencylist_reverse_.reset(new DoubleBucketQueue(mincostr, range, bucketsize,
                                                  reverse_edgecost));
-  edgestatus_reverse_.reset(new EdgeStatus());
+  if (edgestatus_reverse_) {
+    edgestatus_reverse_->Init();
+  } else {
+    edgestatus_reverse_.reset(new EdgeStatus());
+  }
 
   // Set the cost diff between forward and reverse searches (due to distance
   // approximator differences). This is used to "even" the forward and reverse
@@ -106,9 +122,10 @@ void BidirectionalAStar::Init(const PointLL& origll, const PointLL& destll) {
 }
 
 // Expand from a node in the forward direction
+template <class cost_t>
 void BidirectionalAStar::ExpandForward(GraphReader& graphreader,
        const GraphId& node, const EdgeLabel& pred, const uint32_t pred_idx,
-       const bool from_transition) {
+       const bool from_transition, const ConcreteCost<cost_t>& costing) {
   // Get the tile and the node info. Skip if tile is null (can happen
   // with regional data sets) or if no access at the node.
   const GraphTile* tile = graphreader.GetGraphTile(node);
@@ -116,10 +133,13 @@ void BidirectionalAStar::ExpandForward(GraphReader& graphreader,
     return;
   }
   const NodeInfo* nodeinfo = tile->node(node);
-  if (!costing_->Allowed(nodeinfo)) {
+  if (!costing.Allowed(nodeinfo)) {
     return;
   }
 
+  // Time of the week when the node is reached (for the speed profiles)
+  uint32_t seconds = offset_seconds_of_week(origin_time_, pred.cost().secs);
+
   // Expand from end node in forward direction.
   uint32_t shortcuts = 0;
   GraphId edgeid = { node.tileid(), node.level(), nodeinfo->edge_index() };
@@ -130,14 +150,14 @@ void BidirectionalAStar::ExpandForward(GraphReader& graphreader,
     if (directededge->trans_up()) {
       if (!from_transition) {
         hierarchy_limits_forward_[node.level()].up_transition_count++;
-        ExpandForward(graphreader, directededge->endnode(), pred, pred_idx, true);
+        ExpandForward(graphreader, directededge->endnode(), pred, pred_idx, true, costing);
       }
       continue;
     }
     if (directededge->trans_down()) {
       if (!from_transition &&
-          !hierarchy_limits_forward_[directededge->endnode().level()].StopExpanding()) {
-        ExpandForward(graphreader, directededge->endnode(), pred, pred_idx, true);
+          !StopExpanding(hierarchy_limits_forward_[directededge->endnode().level()], pred.distance())) {
+        ExpandForward(graphreader, directededge->endnode(), pred, pred_idx, true, costing);
       }
       continue;
     }
@@ -158,8 +178,8 @@ void BidirectionalAStar::ExpandForward(GraphReader& graphreader,
 
     // Skip this edge if no access is allowed (based on costing method)
     // or if a complex restriction prevents transition onto this edge.
-    if (!costing_->Allowed(directededge, pred, tile, edgeid) ||
-         costing_->Restricted(directededge, pred, edgelabels_forward_, tile,
+    if (!costing.Allowed(directededge, pred, tile, edgeid) ||
+         costing.Restricted(directededge, pred, edgelabels_forward_, tile,
                                      edgeid, true)) {
       continue;
     }
@@ -169,11 +189,11 @@ void BidirectionalAStar::ExpandForward(GraphReader& graphreader,
     // expanding on the next lower level (so we can still transition down to
     // that level).
     if (directededge->is_shortcut() &&
-        hierarchy_limits_forward_[edgeid.level()+1].StopExpanding()) {
+        StopExpanding(hierarchy_limits_forward_[edgeid.level()+1], pred.distance())) {
       shortcuts |= directededge->shortcut();
     }
-    Cost tc = costing_->TransitionCost(directededge, nodeinfo, pred);
-    Cost newcost = pred.cost() + tc + costing_->EdgeCost(directededge);
+    Cost tc = costing.TransitionCost(directededge, nodeinfo, pred);
+    Cost newcost = pred.cost() + tc + costing.EdgeCost(directededge, tile, seconds);
 
     // Check if edge is temporarily labeled and this path has less cost. If
     // less cost the predecessor is updated and the sort cost is decremented
@@ -213,9 +233,11 @@ void BidirectionalAStar::ExpandForward(GraphReader& graphreader,
 }
 
 // Expand from a node in reverse direction.
+template <class cost_t>
 void BidirectionalAStar::ExpandReverse(GraphReader& graphreader,
          const GraphId& node, const EdgeLabel& pred, const uint32_t pred_idx,
-         const DirectedEdge* opp_pred_edge, const bool from_transition) {
+         const DirectedEdge* opp_pred_edge, const bool from_transition,
+         const ConcreteCost<cost_t>& costing) {
   // Get the tile and the node info. Skip if tile is null (can happen
   // with regional data sets) or if no access at the node.
   const GraphTile* tile = graphreader.GetGraphTile(node);
@@ -223,10 +245,14 @@ void BidirectionalAStar::ExpandReverse(GraphReader& graphreader,
     return;
   }
   const NodeInfo* nodeinfo = tile->node(node);
-  if (!costing_->Allowed(nodeinfo)) {
+  if (!costing.Allowed(nodeinfo)) {
     return;
   }
 
+  // Time of the week when the path leaves the node towards the destination
+  // (for the speed profiles)
+  uint32_t seconds = offset_seconds_of_week(destination_time_, -pred.cost().secs);
+
   // Expand from end node in reverse direction.
   uint32_t shortcuts = 0;
   GraphId edgeid = { node.tileid(), node.level(), nodeinfo->edge_index() };
@@ -238,14 +264,14 @@ void BidirectionalAStar::ExpandReverse(GraphReader& graphreader,
       if (!from_transition) {
         hierarchy_limits_reverse_[node.level()].up_transition_count++;
         ExpandReverse(graphreader, directededge->endnode(), pred, pred_idx,
-                      opp_pred_edge, true);
+                      opp_pred_edge, true, costing);
       }
       continue;
     } else if (directededge->trans_down()) {
       if (!from_transition &&
-          !hierarchy_limits_reverse_[directededge->endnode().level()].StopExpanding()) {
+          !StopExpanding(hierarchy_limits_reverse_[directededge->endnode().level()], pred.distance())) {
         ExpandReverse(graphreader, directededge->endnode(), pred, pred_idx,
-                      opp_pred_edge, true);
+                      opp_pred_edge, true, costing);
       }
       continue;
     }
@@ -275,8 +301,8 @@ void BidirectionalAStar::ExpandReverse(GraphReader& graphreader,
 
     // Skip this edge if no access is allowed (based on costing method)
     // or if a complex restriction prevents transition onto this edge.
-    if (!costing_->AllowedReverse(directededge, pred, opp_edge, t2, oppedge) ||
-         costing_->Restricted(directededge, pred, edgelabels_reverse_, tile,
+    if (!costing.AllowedReverse(directededge, pred, opp_edge, t2, oppedge) ||
+         costing.Restricted(directededge, pred, edgelabels_reverse_, tile,
                                      edgeid, false)) {
       continue;
     }
@@ -287,12 +313,12 @@ void BidirectionalAStar::ExpandReverse(GraphReader& graphreader,
     // that level). Separate the transition seconds so we can properly recover
     // elapsed time on the reverse path.
     if (directededge->is_shortcut() &&
-        hierarchy_limits_reverse_[edgeid.level()+1].StopExpanding()) {
+        StopExpanding(hierarchy_limits_reverse_[edgeid.level()+1], pred.distance())) {
       shortcuts |= directededge->shortcut();
     }
-    Cost tc = costing_->TransitionCostReverse(directededge->localedgeidx(),
+    Cost tc = costing.TransitionCostReverse(directededge->localedgeidx(),
                              nodeinfo, opp_edge, opp_pred_edge);
-    Cost newcost = pred.cost() + costing_->EdgeCost(opp_edge);
+    Cost newcost = pred.cost() + costing.EdgeCost(opp_edge, t2, seconds);
     newcost.cost += tc.cost;
 
     // Check if edge is temporarily labeled and this path has less cost. If
@@ -324,29 +350,11 @@ void BidirectionalAStar::ExpandReverse(GraphReader& graphreader,
   }
 }
 
-// Calculate best path using bi-directional A*. No hierarchies or time
-// dependencies are used. Suitable for pedestrian routes (and bicycle?).
-std::vector<PathInfo> BidirectionalAStar::GetBestPath(PathLocation& origin,
-             PathLocation& destination, GraphReader& graphreader,
-             const std::shared_ptr<DynamicCost>* mode_costing,
-             const sif::TravelMode mode) {
-  // Set the mode and costing
-  mode_ = mode;
-  costing_ = mode_costing[static_cast<uint32_t>(mode_)];
-  travel_type_ = costing_->travel_type();
-  access_mode_ = costing_->access_mode();
-
-  // Initialize - create adjacency list, edgestatus support, A*, etc.
-  Init(origin.edges.front().projected, destination.edges.front().projected);
-
-  // Set origin and destination locations - seeds the adj. lists
-  // Note: because we can correlate to more than one place for a given
-  // PathLocation using edges.front here means we are only setting the
-  // heuristics to one of them alternate paths using the other correlated
-  // points to may be harder to find
-  SetOrigin(graphreader, origin);
-  SetDestination(graphreader, destination);
-
+// Alternate the forward and reverse expansions until the best connection is
+// found. The costing type is a template parameter as every edge goes through it.
+template <class cost_t>
+std::vector<PathInfo> BidirectionalAStar::Search(GraphReader& graphreader,
+             const ConcreteCost<cost_t>& costing) {
   // Find shortest path. Switch between a forward direction and a reverse
   // direction search based on the current costs. Alternating like this
   // prevents one tree from expanding much more quickly (if in a sparser
@@ -357,8 +365,8 @@ std::vector<PathInfo> BidirectionalAStar::GetBestPath(PathLocation& origin,
   EdgeLabel pred, pred2;
   const GraphTile* tile;
   const GraphTile* tile2;
-  bool expand_forward  = true;
-  bool expand_reverse  = true;
+  bool expand_forward  = search_forward_;
+  bool expand_reverse  = search_reverse_;
   while (true) {
     // Allow this process to be aborted
     if (interrupt && (n % kInterruptIterationsInterval) == 0) {
@@ -423,8 +431,10 @@ std::vector<PathInfo> BidirectionalAStar::GetBestPath(PathLocation& origin,
       }
     }
 
-    // Expand from the search direction with lower sort cost.
-    if ((pred.sortcost() + cost_diff_) < pred2.sortcost()) {
+    // Expand from the search direction with lower sort cost (or the only
+    // direction being searched).
+    if (!search_reverse_ ||
+        (search_forward_ && (pred.sortcost() + cost_diff_) < pred2.sortcost())) {
       // Expand forward - set to get next edge from forward adj. list
       // on the next pass
       expand_forward = true;
@@ -436,13 +446,13 @@ std::vector<PathInfo> BidirectionalAStar::GetBestPath(PathLocation& origin,
       // Prune path if predecessor is not a through edge or if the maximum
       // number of upward transitions has been exceeded on this hierarchy level.
       if ((pred.not_thru() && pred.not_thru_pruning()) ||
-          hierarchy_limits_forward_[pred.endnode().level()].StopExpanding()) {
+          StopExpanding(hierarchy_limits_forward_[pred.endnode().level()], pred.distance())) {
         continue;
       }
 
       // Expand from the end node in forward direction.
       ExpandForward(graphreader, pred.endnode(), pred,
-                    forward_pred_idx, false);
+                    forward_pred_idx, false, costing);
     } else {
       // Expand reverse - set to get next edge from reverse adj. list
       // on the next pass
@@ -454,7 +464,7 @@ std::vector<PathInfo> BidirectionalAStar::GetBestPath(PathLocation& origin,
 
       // Prune path if predecessor is not a through edge
       if ((pred2.not_thru() && pred2.not_thru_pruning()) ||
-          hierarchy_limits_reverse_[pred2.endnode().level()].StopExpanding()) {
+          StopExpanding(hierarchy_limits_reverse_[pred2.endnode().level()], pred2.distance())) {
         continue;
       }
 
@@ -465,12 +475,75 @@ std::vector<PathInfo> BidirectionalAStar::GetBestPath(PathLocation& origin,
 
       // Expand from the end node in reverse direction.
       ExpandReverse(graphreader, pred2.endnode(), pred2, reverse_pred_idx,
-                    opp_pred_edge, false);
+                    opp_pred_edge, false, costing);
     }
   }
   return {};    // If we are here the route failed
 }
 
+// Calculate best path using bi-directional A*. Suitable for pedestrian routes
+// (and bicycle?). If the origin (or else the destination) has a date and time
+// only that side is searched, so edge speeds depend on the time each edge is
+// reached.
+std::vector<PathInfo> BidirectionalAStar::GetBestPath(PathLocation& origin,
+             PathLocation& destination, GraphReader& graphreader,
+             const std::shared_ptr<DynamicCost>* mode_costing,
+             const sif::TravelMode mode) {
+  // Set the mode and costing
+  mode_ = mode;
+  costing_ = mode_costing[static_cast<uint32_t>(mode_)];
+  travel_type_ = costing_->travel_type();
+  access_mode_ = costing_->access_mode();
+
+  // Initialize - create adjacency list, edgestatus support, A*, etc.
+  Init(origin.edges.front().projected, destination.edges.front().projected);
+
+  // Set origin and destination locations - seeds the adj. lists
+  // Note: because we can correlate to more than one place for a given
+  // PathLocation using edges.front here means we are only setting the
+  // heuristics to one of them alternate paths using the other correlated
+  // points to may be harder to find
+  SetOrigin(graphreader, origin);
+  SetDestination(graphreader, destination);
+
+  // Get the times of the week at the origin and destination (SetOrigin
+  // resolves the current time) if edge costs depend on them. With a time at
+  // one end only that side is searched and the seeds of the other side are
+  // settled so the search connects to them.
+  origin_time_ = IsTimeDependent(origin, *costing_, graphreader) ?
+                     DateTime::seconds_of_week(*origin.date_time_) : kInvalidSecondsOfWeek;
+  destination_time_ = (origin_time_ == kInvalidSecondsOfWeek &&
+                       IsTimeDependent(destination, *costing_, graphreader)) ?
+                     DateTime::seconds_of_week(*destination.date_time_) : kInvalidSecondsOfWeek;
+  search_forward_ = destination_time_ == kInvalidSecondsOfWeek;
+  search_reverse_ = origin_time_ == kInvalidSecondsOfWeek;
+  if (!search_reverse_) {
+    for (const auto& label : edgelabels_reverse_) {
+      edgestatus_reverse_->Update(label.edgeid(), EdgeSet::kPermanent);
+    }
+  }
+  if (!search_forward_) {
+    for (const auto& label : edgelabels_forward_) {
+      edgestatus_forward_->Update(label.edgeid(), EdgeSet::kPermanent);
+    }
+  }
+
+  // Expand with the costing methods resolved at compile time if there is a
+  // concrete costing class for this costing, through the vtable otherwise
+  switch (GetConcreteCosting(costing_.get())) {
+    case ConcreteCosting::kAuto:
+      return Search(graphreader, ConcreteCost<AutoCost>(costing_.get()));
+    case ConcreteCosting::kTruck:
+      return Search(graphreader, ConcreteCost<TruckCost>(costing_.get()));
+    case ConcreteCosting::kBicycle:
+      return Search(graphreader, ConcreteCost<BicycleCost>(costing_.get()));
+    case ConcreteCosting::kPedestrian:
+      return Search(graphreader, ConcreteCost<PedestrianCost>(costing_.get()));
+    default:
+      return Search(graphreader, ConcreteCost<DynamicCost>(costing_.get()));
+  }
+}
+
 // The edge on the forward search connects to a reached edge on the reverse
 // search tree. Check if this is the best connection so far and set the
 // search threshold.
@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include "thor/contractionpath.h"
+#include "baldr/double_bucket_queue.h"
+#include "midgard/logging.h"
+
+using namespace valhalla::baldr;
+using namespace valhalla::sif;
+
+namespace {
+
+using queue_entry_t = std::pair<float, uint32_t>;
+
+constexpr float kNoConnection = std::numeric_limits<float>::max();
+
+}
+
+namespace valhalla {
+namespace thor {
+
+// Clear the search state
+void ContractionPathAlgorithm::Search::Clear() {
+  labels.clear();
+  status.clear();
+  queue.clear();
+  partial_secs.clear();
+  min_initial = kNoConnection;
+}
+
+// Label a vertex or lower the cost of its label
+void ContractionPathAlgorithm::Search::Add(const uint32_t vertex,
+          const float cost, const uint32_t predecessor,
+          const ContractionArc* arc) {
+  auto existing = status.find(vertex);
+  uint32_t idx;
+  if (existing == status.end()) {
+    idx = labels.size();
+    status.emplace(vertex, idx);
+    labels.push_back({ vertex, cost, predecessor, arc });
+  } else {
+    idx = existing->second;
+    Label& label = labels[idx];
+    if (cost >= label.cost) {
+      return;
+    }
+    label.cost = cost;
+    label.predecessor = predecessor;
+    label.arc = arc;
+  }
+  queue.emplace_back(cost, idx);
+  std::push_heap(queue.begin(), queue.end(), std::greater<queue_entry_t>());
+}
+
+// Constructor
+ContractionPathAlgorithm::ContractionPathAlgorithm(): PathAlgorithm() {
+  Clear();
+}
+
+// Destructor
+ContractionPathAlgorithm::~ContractionPathAlgorithm() {
+}
+
+// Set the hierarchy to search
+void ContractionPathAlgorithm::set_hierarchy(
+    const std::shared_ptr<const ContractionHierarchy>& hierarchy) {
+  hierarchy_ = hierarchy;
+}
+
+bool ContractionPathAlgorithm::has_hierarchy() const {
+  return hierarchy_ && !hierarchy_->empty();
+}
+
+// Clear the temporary information generated during path construction.
+void ContractionPathAlgorithm::Clear() {
+  forward_.Clear();
+  reverse_.Clear();
+}
+
+// Find the best path. Origin and destination edges are labeled with the
+// cost of their partial edges: the rest of the origin edge and, taken off,
+// the part of the destination edge past the destination (arcs into a
+// vertex include the cost of the whole edge).
+std::vector<PathInfo> ContractionPathAlgorithm::GetBestPath(PathLocation& origin,
+             PathLocation& dest, GraphReader& graphreader,
+             const std::shared_ptr<DynamicCost>* mode_costing,
+             const TravelMode mode) {
+  const auto& costing = mode_costing[static_cast<uint32_t>(mode)];
+  Clear();
+
+  // Only skip inbound origin edges and outbound destination edges if we
+  // have other options (same as bidirectional A*)
+  bool has_other_edges = std::any_of(origin.edges.cbegin(), origin.edges.cend(),
+    [](const PathLocation::PathEdge& e) { return !e.end_node(); });
+  for (const auto& edge : origin.edges) {
+    uint32_t vertex = hierarchy_->GetVertex(edge.id);
+    const GraphTile* tile = graphreader.GetGraphTile(edge.id);
+    if ((has_other_edges && edge.end_node()) || vertex == kInvalidVertex ||
+        tile == nullptr) {
+      continue;
+    }
+    Cost cost = costing->EdgeCost(tile->directededge(edge.id)) * (1.0f - edge.dist);
+    forward_.Add(vertex, cost.cost + edge.score, kInvalidLabel, nullptr);
+    forward_.partial_secs[vertex] = cost.secs;
+    forward_.min_initial = std::min(forward_.min_initial, cost.cost + edge.score);
+  }
+  has_other_edges = std::any_of(dest.edges.cbegin(), dest.edges.cend(),
+    [](const PathLocation::PathEdge& e) { return !e.begin_node(); });
+  for (const auto& edge : dest.edges) {
+    uint32_t vertex = hierarchy_->GetVertex(edge.id);
+    const GraphTile* tile = graphreader.GetGraphTile(edge.id);
+    if ((has_other_edges && edge.begin_node()) || vertex == kInvalidVertex ||
+        tile == nullptr) {
+      continue;
+    }
+    Cost remainder = costing->EdgeCost(tile->directededge(edge.id)) * (1.0f - edge.dist);
+    reverse_.Add(vertex, edge.score - remainder.cost, kInvalidLabel, nullptr);
+    reverse_.partial_secs[vertex] = remainder.secs;
+    reverse_.min_initial = std::min(reverse_.min_initial, edge.score - remainder.cost);
+  }
+
+  // Alternate between the searches, each stops once nothing it can still
+  // settle could lead to a cheaper connection
+  float best = kNoConnection;
+  uint32_t meeting = kInvalidVertex;
+  size_t n = 0;
+  while (true) {
+    if (interrupt && (++n % kInterruptIterationsInterval) == 0) {
+      (*interrupt)();
+    }
+    bool forward = !forward_.queue.empty() &&
+        forward_.queue.front().first + reverse_.min_initial < best;
+    bool reverse = !reverse_.queue.empty() &&
+        reverse_.queue.front().first + forward_.min_initial < best;
+    if (forward && (!reverse ||
+        forward_.queue.front().first <= reverse_.queue.front().first)) {
+      Step(forward_, reverse_, true, best, meeting);
+    } else if (reverse) {
+      Step(reverse_, forward_, false, best, meeting);
+    } else {
+      break;
+    }
+  }
+
+  LOG_DEBUG("Contraction labels::" + std::to_string(forward_.labels.size()) +
+            "," + std::to_string(reverse_.labels.size()));
+  if (meeting == kInvalidVertex) {
+    return {};
+  }
+  auto path = FormPath(meeting, mode);
+
+  // The hierarchy has no complex restrictions. Give up on paths that could
+  // violate one so the caller can use an algorithm that checks them.
+  const GraphTile* tile = nullptr;
+  for (const auto& info : path) {
+    const DirectedEdge* edge = graphreader.directededge(info.edgeid, tile);
+    if (edge == nullptr || (edge->end_restriction() & costing->access_mode())) {
+      return {};
+    }
+  }
+  return path;
+}
+
+// Settle the next vertex of a search and relax its arcs
+void ContractionPathAlgorithm::Step(Search& search, const Search& other,
+          const bool forward, float& best, uint32_t& meeting) {
+  std::pop_heap(search.queue.begin(), search.queue.end(),
+                std::greater<queue_entry_t>());
+  queue_entry_t next = search.queue.back();
+  search.queue.pop_back();
+  Label label = search.labels[next.second];
+  if (next.first > label.cost) {
+    return;
+  }
+
+  // Check for a connection with the other search
+  auto connection = other.status.find(label.vertex);
+  if (connection != other.status.end()) {
+    float cost = label.cost + other.labels[connection->second].cost;
+    if (cost < best) {
+      best = cost;
+      meeting = label.vertex;
+    }
+  }
+
+  // The forward search goes up the hierarchy and the reverse search goes
+  // up as well, against the direction of the downward arcs
+  auto arcs = forward ? hierarchy_->UpArcs(label.vertex) :
+                        hierarchy_->DownArcs(label.vertex);
+  for (const ContractionArc* arc = arcs.first; arc != arcs.second; ++arc) {
+    search.Add(arc->vertex, label.cost + arc->cost, next.second, arc);
+  }
+}
+
+// Form the path: unpack the arcs from the origin up to the meeting vertex
+// and from there down to the destination.
+std::vector<PathInfo> ContractionPathAlgorithm::FormPath(const uint32_t meeting,
+             const TravelMode mode) {
+  std::vector<std::pair<uint32_t, const ContractionArc*> > up;
+  uint32_t idx = forward_.status.find(meeting)->second;
+  for ( ; forward_.labels[idx].predecessor != kInvalidLabel;
+        idx = forward_.labels[idx].predecessor) {
+    const Label& label = forward_.labels[idx];
+    up.emplace_back(forward_.labels[label.predecessor].vertex, label.arc);
+  }
+  uint32_t first = forward_.labels[idx].vertex;
+  std::reverse(up.begin(), up.end());
+
+  std::vector<std::pair<uint32_t, const ContractionArc*> > arcs;
+  for (const auto& arc : up) {
+    hierarchy_->Unpack(arc.first, arc.second->vertex, *arc.second, arcs);
+  }
+  idx = reverse_.status.find(meeting)->second;
+  for ( ; reverse_.labels[idx].predecessor != kInvalidLabel;
+        idx = reverse_.labels[idx].predecessor) {
+    const Label& label = reverse_.labels[idx];
+    hierarchy_->Unpack(label.vertex, reverse_.labels[label.predecessor].vertex,
+                       *label.arc, arcs);
+  }
+  uint32_t last = reverse_.labels[idx].vertex;
+
+  // Elapsed time at the end of each edge. The destination edge ends at the
+  // destination rather than at its end node.
+  std::vector<PathInfo> path;
+  path.reserve(arcs.size() + 1);
+  float elapsed = forward_.partial_secs[first];
+  path.emplace_back(mode, elapsed, hierarchy_->GetEdgeId(first), 0);
+  for (const auto& arc : arcs) {
+    elapsed += arc.second->secs;
+    path.emplace_back(mode, elapsed, hierarchy_->GetEdgeId(arc.first), 0);
+  }
+  path.back().elapsed_time -= reverse_.partial_secs[last];
+  return path;
+}
+
+}
+}
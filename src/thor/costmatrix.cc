@@ -2,6 +2,7 @@
 #include <vector>
 #include <algorithm>
 #include "thor/costmatrix.h"
+#include "thor/phaserunner.h"
 #include "midgard/logging.h"
 #include "exception.h"
 
@@ -34,6 +35,12 @@ CostMatrix::CostMatrix()
       remaining_targets_(0),
       current_cost_threshold_(0) {}
 
+// Constructor with worker threads.
+CostMatrix::CostMatrix(const std::vector<std::shared_ptr<GraphReader>>& worker_readers)
+    : CostMatrix() {
+  worker_readers_ = worker_readers;
+}
+
 float CostMatrix::GetCostThreshold(const float max_matrix_distance) {
   float cost_threshold;
   switch (mode_) {
@@ -55,8 +62,11 @@ float CostMatrix::GetCostThreshold(const float max_matrix_distance) {
 // Clear the temporary information generated during time + distance matrix
 // construction.
 void CostMatrix::Clear() {
-  // Clear the target edge markings
+  // Clear the target edge markings and anything queued during a round
   targets_.clear();
+  target_reached_.clear();
+  source_updates_.clear();
+  target_updates_.clear();
 
   // Clear all source adjacency lists, edge labels, and edge status
   for (auto adj : source_adjacency_) {
@@ -69,7 +79,7 @@ void CostMatrix::Clear() {
   }
   source_edgelabel_.clear();
 
-  for (auto es : source_edgestatus_) {
+  for (auto& es : source_edgestatus_) {
     es.Init();
   }
   source_edgestatus_.clear();
@@ -85,7 +95,7 @@ void CostMatrix::Clear() {
   }
   target_edgelabel_.clear();
 
-  for (auto es : target_edgestatus_) {
+  for (auto& es : target_edgestatus_) {
     es.Init();
   }
   target_edgestatus_.clear();
@@ -121,35 +131,97 @@ std::vector<TimeDistance> CostMatrix::SourceToTarget(
   // location set.
   Initialize(source_location_list, target_location_list);
 
+  // Search with the costing methods resolved at compile time if there is a
+  // concrete costing class for this costing, through the vtable otherwise
+  switch (GetConcreteCosting(costing_.get())) {
+    case ConcreteCosting::kAuto:
+      Search(graphreader, ConcreteCost<AutoCost>(costing_.get()));
+      break;
+    case ConcreteCosting::kTruck:
+      Search(graphreader, ConcreteCost<TruckCost>(costing_.get()));
+      break;
+    case ConcreteCosting::kBicycle:
+      Search(graphreader, ConcreteCost<BicycleCost>(costing_.get()));
+      break;
+    case ConcreteCosting::kPedestrian:
+      Search(graphreader, ConcreteCost<PedestrianCost>(costing_.get()));
+      break;
+    default:
+      Search(graphreader, ConcreteCost<DynamicCost>(costing_.get()));
+      break;
+  }
+
+  // Form the time, distance matrix from the destinations list
+  uint32_t idx = 0;
+  std::vector<TimeDistance> td;
+  for (const auto& connection : best_connection_) {
+    td.emplace_back(std::round(connection.cost.secs),
+                    std::round(connection.distance));
+    idx++;
+  }
+  return td;
+}
+
+// Run the forward and backward searches until every source and target is
+// done.
+template <class cost_t>
+void CostMatrix::Search(GraphReader& graphreader,
+                        const ConcreteCost<cost_t>& costing) {
+  // Threads to run the searches on, each uses its own graph reader
+  PhaseRunner runner(worker_readers_.size() + 1);
+  auto reader = [this, &graphreader](const uint32_t thread) -> GraphReader& {
+    return (thread == 0) ? graphreader : *worker_readers_[thread - 1];
+  };
+
   // Perform backward search from all target locations. Perform forward
   // search from all source locations. Connections between the 2 search
   // spaces is checked during the forward search.
   int n = 0;
   while (true) {
     // Iterate all target locations in a backwards search
-    for (uint32_t i = 0; i < target_count_; i++) {
+    runner.Run(target_count_, [this, &reader, &costing](const uint32_t i, const uint32_t thread) {
       if (target_status_[i].threshold > 0) {
         target_status_[i].threshold--;
-        BackwardSearch(i, graphreader);
-        if (target_status_[i].threshold == 0) {
-          target_status_[i].threshold = -1;
-          if (remaining_targets_ > 0) {
-            remaining_targets_--;
-          }
+        BackwardSearch(i, reader(thread), costing);
+      }
+    });
+
+    // Apply what the backward searches queued, in target order
+    for (uint32_t i = 0; i < target_count_; i++) {
+      for (const auto& edgeid : target_reached_[i]) {
+        targets_[edgeid].push_back(i);
+      }
+      target_reached_[i].clear();
+      for (const auto& update : target_updates_[i]) {
+        UpdateStatus(update);
+      }
+      target_updates_[i].clear();
+      if (target_status_[i].threshold == 0) {
+        target_status_[i].threshold = -1;
+        if (remaining_targets_ > 0) {
+          remaining_targets_--;
         }
       }
     }
 
     // Iterate all source locations in a forward search
-    for (uint32_t i = 0; i < source_count_; i++) {
+    runner.Run(source_count_, [this, &reader, &costing, n](const uint32_t i, const uint32_t thread) {
       if (source_status_[i].threshold > 0) {
         source_status_[i].threshold--;
-        ForwardSearch(i, n, graphreader);
-        if (source_status_[i].threshold == 0) {
-          source_status_[i].threshold = -1;
-          if (remaining_sources_ > 0) {
-            remaining_sources_--;
-          }
+        ForwardSearch(i, n, reader(thread), costing);
+      }
+    });
+
+    // Apply what the forward searches queued, in source order
+    for (uint32_t i = 0; i < source_count_; i++) {
+      for (const auto& update : source_updates_[i]) {
+        UpdateStatus(update);
+      }
+      source_updates_[i].clear();
+      if (source_status_[i].threshold == 0) {
+        source_status_[i].threshold = -1;
+        if (remaining_sources_ > 0) {
+          remaining_sources_--;
         }
       }
     }
@@ -167,16 +239,6 @@ std::vector<TimeDistance> CostMatrix::SourceToTarget(
     }
     n++;
   }
-
-  // Form the time, distance matrix from the destinations list
-  uint32_t idx = 0;
-  std::vector<TimeDistance> td;
-  for (const auto& connection : best_connection_) {
-    td.emplace_back(std::round(connection.cost.secs),
-                    std::round(connection.distance));
-    idx++;
-  }
-  return td;
 }
 
 // Initialize all time distance to "not found". Any locations that
@@ -228,6 +290,7 @@ void CostMatrix::Initialize(
   }
 }
 
+template <class cost_t>
 void CostMatrix::ExpandForward(GraphReader& graphreader,
                    const GraphTile* tile,
                    const GraphId& node, const NodeInfo* nodeinfo,
@@ -236,7 +299,8 @@ void CostMatrix::ExpandForward(GraphReader& graphreader,
                    std::vector<EdgeLabel>& edgelabels,
                    EdgeStatus& edgestate,
                    std::shared_ptr<DoubleBucketQueue>& adj,
-                   const bool from_transition) {
+                   const bool from_transition,
+                   const ConcreteCost<cost_t>& costing) {
   // Expand from end node in forward direction.
   uint32_t shortcuts = 0;
   GraphId edgeid(node.tileid(), node.level(), nodeinfo->edge_index());
@@ -262,7 +326,7 @@ void CostMatrix::ExpandForward(GraphReader& graphreader,
       if (endtile != nullptr) {
         ExpandForward(graphreader, endtile, node, endtile->node(node),
                      pred, pred_idx, hierarchy_limits, edgelabels,
-                     edgestate, adj, true);
+                     edgestate, adj, true, costing);
       }
       continue;
     }
@@ -270,7 +334,7 @@ void CostMatrix::ExpandForward(GraphReader& graphreader,
     // Skip any superseded edges that match the shortcut mask. Also skip
     // if no access is allowed to this edge (based on costing method)
     if ((shortcuts & directededge->superseded()) ||
-        !costing_->Allowed(directededge, pred, tile, edgeid)) {
+        !costing.Allowed(directededge, pred, tile, edgeid)) {
       continue;
     }
 
@@ -282,15 +346,15 @@ void CostMatrix::ExpandForward(GraphReader& graphreader,
     }
 
     // Check for complex restriction
-    if (costing_->Restricted(directededge, pred, edgelabels, tile,
-                             edgeid, true)) {
+    if (costing.Restricted(directededge, pred, edgelabels, tile,
+                           edgeid, true)) {
       continue;
     }
 
     // Get cost and accumulated distance. Update the_shortcuts mask.
     shortcuts |= directededge->shortcut();
-    Cost tc = costing_->TransitionCost(directededge, nodeinfo, pred);
-    Cost newcost = pred.cost() + tc + costing_->EdgeCost(directededge);
+    Cost tc = costing.TransitionCost(directededge, nodeinfo, pred);
+    Cost newcost = pred.cost() + tc + costing.EdgeCost(directededge);
     uint32_t distance = pred.path_distance() + directededge->length();
 
     // Check if edge is temporarily labeled and this path has less cost. If
@@ -322,8 +386,9 @@ void CostMatrix::ExpandForward(GraphReader& graphreader,
 }
 
 // Iterate the forward search from the source/origin location.
+template <class cost_t>
 void CostMatrix::ForwardSearch(const uint32_t index, const uint32_t n,
-                  GraphReader& graphreader) {
+                  GraphReader& graphreader, const ConcreteCost<cost_t>& costing) {
   // Get the next edge from the adjacency list for this source location
   auto adj = source_adjacency_[index];
   auto& edgelabels = source_edgelabel_[index];
@@ -332,7 +397,7 @@ void CostMatrix::ForwardSearch(const uint32_t index, const uint32_t n,
     // Forward search is exhausted - mark this and update so we don't
     // extend searches more than we need to
     for (uint32_t target = 0; target < target_count_; target++) {
-      UpdateStatus(index, target);
+      QueueStatus(source_updates_[index], index, target);
     }
     source_status_[index].threshold = 0;
     return;
@@ -372,9 +437,9 @@ void CostMatrix::ForwardSearch(const uint32_t index, const uint32_t n,
   const GraphTile* tile = graphreader.GetGraphTile(node);
   if (tile != nullptr) {
     const NodeInfo* nodeinfo = tile->node(node);
-    if (costing_->Allowed(nodeinfo)) {
+    if (costing.Allowed(nodeinfo)) {
       ExpandForward(graphreader, tile, node, nodeinfo, pred, pred_idx,
-                hierarchy_limits, edgelabels, edgestate, adj, false);
+                hierarchy_limits, edgelabels, edgestate, adj, false, costing);
     }
   }
 }
@@ -423,6 +488,12 @@ void CostMatrix::CheckForwardConnections(const uint32_t source,
 
       // Special case - common edge for source and target are both initial edges
       if (pred.predecessor() == kInvalidLabel && predidx == kInvalidLabel) {
+        // A target behind the source on the edge is reached by going around.
+        // The (rounded) remainders only add up to the edge length when the
+        // target is ahead.
+        if (pred.path_distance() + opp_el.path_distance() + 1 < opp_el.transition_secs()) {
+          continue;
+        }
         float s = std::abs(pred.cost().secs + opp_el.cost().secs -
                            opp_el.transition_cost());
 
@@ -436,7 +507,7 @@ void CostMatrix::CheckForwardConnections(const uint32_t source,
 
         // Update status and update threshold if this is the last location
         // to find for this source or target
-        UpdateStatus(source, target);
+        QueueStatus(source_updates_[source], source, target);
       } else {
         float oppcost = (predidx == kInvalidLabel) ?
                   0 : edgelabels[predidx].cost().cost;
@@ -460,43 +531,52 @@ void CostMatrix::CheckForwardConnections(const uint32_t source,
 
           // Update status and update threshold if this is the last location
           // to find for this source or target
-          UpdateStatus(source, target);
+          QueueStatus(source_updates_[source], source, target);
         }
       }
     }
   }
 }
 
+// Queue a status update when a connection is found. The number of edge
+// labels is taken now since the searches keep going until it is applied.
+void CostMatrix::QueueStatus(std::vector<StatusUpdate>& updates,
+                             const uint32_t source, const uint32_t target) {
+  updates.emplace_back(source, target, source_edgelabel_[source].size() +
+                                       target_edgelabel_[target].size());
+}
+
 // Update status when a connection is found.
-void CostMatrix::UpdateStatus(const uint32_t source, const uint32_t target) {
+void CostMatrix::UpdateStatus(const StatusUpdate& update) {
   // Remove the target from the source status
-  auto& s = source_status_[source].remaining_locations;
-  auto it = s.find(target);
+  auto& s = source_status_[update.source].remaining_locations;
+  auto it = s.find(update.target);
   if (it != s.end()) {
     s.erase(it);
-    if (s.empty() && source_status_[source].threshold > 0) {
+    if (s.empty() && source_status_[update.source].threshold > 0) {
       // At least 1 connection has been found to each target for this source.
       // Set a threshold to continue search for a limited number of times.
-      source_status_[source].threshold = GetThreshold(mode_,
-             source_edgelabel_[source].size() + target_edgelabel_[target].size());
+      source_status_[update.source].threshold = GetThreshold(mode_,
+                                                     update.label_count);
     }
   }
 
   // Remove the source from the target status
-  auto& t = target_status_[target].remaining_locations;
-  it = t.find(source);
+  auto& t = target_status_[update.target].remaining_locations;
+  it = t.find(update.source);
   if (it != t.end()) {
     t.erase(it);
-    if (t.empty() && target_status_[target].threshold > 0) {
+    if (t.empty() && target_status_[update.target].threshold > 0) {
       // At least 1 connection has been found to each source for this target.
       // Set a threshold to continue search for a limited number of times.
-      target_status_[target].threshold = GetThreshold(mode_,
-             source_edgelabel_[source].size() + target_edgelabel_[target].size());
+      target_status_[update.target].threshold = GetThreshold(mode_,
+                                                     update.label_count);
     }
   }
 }
 
 // Expand from node in reverse direction.
+template <class cost_t>
 void CostMatrix::ExpandReverse(GraphReader& graphreader,
                    const GraphTile* tile, const GraphId& node,
                    const NodeInfo* nodeinfo, const uint32_t index,
@@ -506,7 +586,8 @@ void CostMatrix::ExpandReverse(GraphReader& graphreader,
                    std::vector<EdgeLabel>& edgelabels,
                    EdgeStatus& edgestate,
                    std::shared_ptr<DoubleBucketQueue>& adj,
-                   const bool from_transition) {
+                   const bool from_transition,
+                   const ConcreteCost<cost_t>& costing) {
   uint32_t shortcuts = 0;
   GraphId edgeid(node.tileid(), node.level(), nodeinfo->edge_index());
   const DirectedEdge* directededge = tile->directededge(nodeinfo->edge_index());
@@ -531,7 +612,7 @@ void CostMatrix::ExpandReverse(GraphReader& graphreader,
       if (endtile != nullptr) {
         ExpandReverse(graphreader, endtile, node, endtile->node(node),
                  index, pred, pred_idx, opp_pred_edge,
-                 hierarchy_limits, edgelabels, edgestate, adj, true);
+                 hierarchy_limits, edgelabels, edgestate, adj, true, costing);
       }
       continue;
     }
@@ -560,23 +641,23 @@ void CostMatrix::ExpandReverse(GraphReader& graphreader,
 
     // Get opposing directed edge and check if allowed.
     const DirectedEdge* opp_edge = t2->directededge(oppedge);
-    if (!costing_->AllowedReverse(directededge, pred, opp_edge,
+    if (!costing.AllowedReverse(directededge, pred, opp_edge,
                       t2, oppedge)) {
       continue;
     }
 
     // Check for complex restriction
-    if (costing_->Restricted(directededge, pred, edgelabels, tile,
-                             edgeid, false)) {
+    if (costing.Restricted(directededge, pred, edgelabels, tile,
+                           edgeid, false)) {
       continue;
     }
 
     // Get cost and accumulated distance. Use opposing edge for EdgeCost.
     // Update the shortcut mask
     shortcuts |= directededge->shortcut();
-    Cost tc = costing_->TransitionCostReverse(directededge->localedgeidx(),
+    Cost tc = costing.TransitionCostReverse(directededge->localedgeidx(),
                    nodeinfo, opp_edge, opp_pred_edge);
-    Cost newcost = pred.cost() + tc + costing_->EdgeCost(opp_edge);
+    Cost newcost = pred.cost() + tc + costing.EdgeCost(opp_edge);
     uint32_t distance = pred.path_distance() + directededge->length();
 
     // Check if edge is temporarily labeled and this path has less cost. If
@@ -597,14 +678,16 @@ void CostMatrix::ExpandReverse(GraphReader& graphreader,
        directededge, newcost, mode_, tc, distance,
        (pred.not_thru_pruning() || !directededge->not_thru()));
 
-    // Add to the list of targets that have reached this edge
-    targets_[edgeid].push_back(index);
+    // Add to the list of targets that have reached this edge (once the
+    // round is done)
+    target_reached_[index].push_back(edgeid);
   }
 }
 
 // Expand the backwards search trees.
+template <class cost_t>
 void CostMatrix::BackwardSearch(const uint32_t index,
-                 GraphReader& graphreader) {
+                 GraphReader& graphreader, const ConcreteCost<cost_t>& costing) {
   // Get the next edge from the adjacency list for this target location
   auto adj = target_adjacency_[index];
   auto& edgelabels = target_edgelabel_[index];
@@ -613,7 +696,7 @@ void CostMatrix::BackwardSearch(const uint32_t index,
     // Backward search is exhausted - mark this and update so we don't
     // extend searches more than we need to
     for (uint32_t source = 0; source < source_count_; source++) {
-      UpdateStatus(source, index);
+      QueueStatus(target_updates_[index], source, index);
     }
     target_status_[index].threshold = 0;
     return;
@@ -649,7 +732,7 @@ void CostMatrix::BackwardSearch(const uint32_t index,
   const GraphTile* tile = graphreader.GetGraphTile(node);
   if (tile != nullptr) {
     const NodeInfo* nodeinfo = tile->node(node);
-    if (costing_->Allowed(nodeinfo)) {
+    if (costing.Allowed(nodeinfo)) {
       // Get the opposing predecessor directed edge. Need to make sure we get
       // the correct one if a transition occurred
       const DirectedEdge* opp_pred_edge;
@@ -661,7 +744,7 @@ void CostMatrix::BackwardSearch(const uint32_t index,
       }
       ExpandReverse(graphreader, tile, node, nodeinfo, index, pred,
                     pred_idx, opp_pred_edge, hierarchy_limits, edgelabels,
-                    edgestate, adj, false);
+                    edgestate, adj, false, costing);
     }
   }
 }
@@ -676,6 +759,7 @@ void CostMatrix::SetSources(GraphReader& graphreader,
   source_edgestatus_.resize(source_count_);
   source_adjacency_.resize(source_count_);
   source_hierarchy_limits_.resize(source_count_);
+  source_updates_.resize(source_count_);
 
   // Go through each source location
   uint32_t index = 0;
@@ -747,6 +831,8 @@ void CostMatrix::SetTargets(baldr::GraphReader& graphreader,
   target_edgestatus_.resize(targets.size());
   target_adjacency_.resize(targets.size());
   target_hierarchy_limits_.resize(targets.size());
+  target_reached_.resize(targets.size());
+  target_updates_.resize(targets.size());
 
   // Go through each target location
   uint32_t index = 0;
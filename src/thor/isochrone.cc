@@ -3,6 +3,7 @@
 #include <algorithm>
 #include "thor/isochrone.h"
 #include "baldr/datetime.h"
+#include "baldr/tilehierarchy.h"
 #include "midgard/distanceapproximator.h"
 #include "midgard/logging.h"
 
@@ -62,7 +63,9 @@ void Isochrone::Clear() {
   // Clear the edge labels, edge status flags, and adjacency list
   edgelabels_.clear();
   adjacencylist_.reset();
-  edgestatus_.reset();
+  if (edgestatus_) {
+    edgestatus_->Init();
+  }
 }
 
 // Construct the isotile. Use a fixed grid size. Convert time in minutes to
@@ -159,13 +162,18 @@ void Isochrone::Initialize(const uint32_t bucketsize) {
 
   float range = kBucketCount * bucketsize;
   adjacencylist_.reset(new DoubleBucketQueue(0.0f, range, bucketsize, edgecost));
-  edgestatus_.reset(new EdgeStatus());
+  if (edgestatus_) {
+    edgestatus_->Init();
+  } else {
+    edgestatus_.reset(new EdgeStatus());
+  }
 }
 
 // Expand from a node in the forward direction
+template <class cost_t>
 void Isochrone::ExpandForward(GraphReader& graphreader, const GraphId& node,
                     const EdgeLabel& pred, const uint32_t pred_idx,
-                    const bool from_transition) {
+                    const bool from_transition, const ConcreteCost<cost_t>& costing) {
   // Get the tile and the node info. Skip if tile is null (can happen
   // with regional data sets) or if no access at the node.
   const GraphTile* tile = graphreader.GetGraphTile(node);
@@ -178,7 +186,7 @@ void Isochrone::ExpandForward(GraphReader& graphreader, const GraphId& node,
   if (!from_transition) {
     UpdateIsoTile(pred, graphreader, nodeinfo->latlng());
   }
-  if (!costing_->Allowed(nodeinfo)) {
+  if (!costing.Allowed(nodeinfo)) {
     return;
   }
 
@@ -190,13 +198,13 @@ void Isochrone::ExpandForward(GraphReader& graphreader, const GraphId& node,
     // (unless this is called from a transition).
     if (directededge->trans_up()) {
       if (!from_transition) {
-        ExpandForward(graphreader, directededge->endnode(), pred, pred_idx, true);
+        ExpandForward(graphreader, directededge->endnode(), pred, pred_idx, true, costing);
       }
       continue;
     }
     if (directededge->trans_down()) {
       if (!from_transition) {
-        ExpandForward(graphreader, directededge->endnode(), pred, pred_idx, true);
+        ExpandForward(graphreader, directededge->endnode(), pred, pred_idx, true, costing);
       }
       continue;
     }
@@ -216,15 +224,15 @@ void Isochrone::ExpandForward(GraphReader& graphreader, const GraphId& node,
 
     // Skip if no access is allowed to this edge (based on the costing
     // method) or if a complex restriction exists for this path.
-    if (!costing_->Allowed(directededge, pred, tile, edgeid) ||
-         costing_->Restricted(directededge, pred, edgelabels_, tile,
-                             edgeid, true)) {
+    if (!costing.Allowed(directededge, pred, tile, edgeid) ||
+         costing.Restricted(directededge, pred, edgelabels_, tile,
+                            edgeid, true)) {
       continue;
     }
 
     // Compute the cost to the end of this edge
-    Cost newcost = pred.cost() + costing_->EdgeCost(directededge) +
-         costing_->TransitionCost(directededge, nodeinfo, pred);
+    Cost newcost = pred.cost() + costing.EdgeCost(directededge) +
+         costing.TransitionCost(directededge, nodeinfo, pred);
 
     // Check if edge is temporarily labeled and this path has less cost. If
     // less cost the predecessor is updated and the sort cost is decremented
@@ -268,15 +276,40 @@ std::shared_ptr<const GriddedData<PointLL> > Isochrone::Compute(
   // Set the origin locations
   SetOriginLocations(graphreader, origin_locations, costing_);
 
-  // Compute the isotile
+  // Compute the isotile. Expand with the costing methods resolved at compile
+  // time if there is a concrete costing class for this costing, through the
+  // vtable otherwise
+  switch (GetConcreteCosting(costing_.get())) {
+    case ConcreteCosting::kAuto:
+      SearchForward(graphreader, max_seconds, ConcreteCost<AutoCost>(costing_.get()));
+      break;
+    case ConcreteCosting::kTruck:
+      SearchForward(graphreader, max_seconds, ConcreteCost<TruckCost>(costing_.get()));
+      break;
+    case ConcreteCosting::kBicycle:
+      SearchForward(graphreader, max_seconds, ConcreteCost<BicycleCost>(costing_.get()));
+      break;
+    case ConcreteCosting::kPedestrian:
+      SearchForward(graphreader, max_seconds, ConcreteCost<PedestrianCost>(costing_.get()));
+      break;
+    default:
+      SearchForward(graphreader, max_seconds, ConcreteCost<DynamicCost>(costing_.get()));
+      break;
+  }
+  return isotile_;
+}
+
+// Expand the forward search until the time limit is exceeded.
+template <class cost_t>
+void Isochrone::SearchForward(GraphReader& graphreader, const uint32_t max_seconds,
+                              const ConcreteCost<cost_t>& costing) {
   uint32_t n = 0;
-  const GraphTile* tile;
   while (true) {
     // Get next element from adjacency list. Check that it is valid. An
     // invalid label indicates there are no edges that can be expanded.
     uint32_t predindex = adjacencylist_->pop();
     if (predindex == kInvalidLabel) {
-      return isotile_;
+      return;
     }
 
     // Copy the EdgeLabel for use in costing and settle the edge.
@@ -284,22 +317,23 @@ std::shared_ptr<const GriddedData<PointLL> > Isochrone::Compute(
     edgestatus_->Update(pred.edgeid(), EdgeSet::kPermanent);
 
     // Expand from the end node in forward direction.
-    ExpandForward(graphreader, pred.endnode(), pred, predindex, false);
+    ExpandForward(graphreader, pred.endnode(), pred, predindex, false, costing);
     n++;
 
     // Return after the time interval has been met
     if (pred.cost().secs > max_seconds || pred.cost().cost > max_seconds * 4) {
       LOG_DEBUG("Exceed time interval: n = " + std::to_string(n));
-      return isotile_;
+      return;
     }
   }
-  return isotile_;      // Should never get here
 }
 
 // Expand from a node in reverse direction.
+template <class cost_t>
 void Isochrone::ExpandReverse(GraphReader& graphreader,
          const GraphId& node, const EdgeLabel& pred, const uint32_t pred_idx,
-         const DirectedEdge* opp_pred_edge, const bool from_transition) {
+         const DirectedEdge* opp_pred_edge, const bool from_transition,
+         const ConcreteCost<cost_t>& costing) {
   // Get the tile and the node info. Skip if tile is null (can happen
   // with regional data sets) or if no access at the node.
   const GraphTile* tile = graphreader.GetGraphTile(node);
@@ -312,7 +346,7 @@ void Isochrone::ExpandReverse(GraphReader& graphreader,
   if (!from_transition) {
     UpdateIsoTile(pred, graphreader, nodeinfo->latlng());
   }
-  if (!costing_->Allowed(nodeinfo)) {
+  if (!costing.Allowed(nodeinfo)) {
     return;
   }
 
@@ -325,13 +359,13 @@ void Isochrone::ExpandReverse(GraphReader& graphreader,
     if (directededge->trans_up()) {
       if (!from_transition) {
         ExpandReverse(graphreader, directededge->endnode(), pred, pred_idx,
-                      opp_pred_edge, true);
+                      opp_pred_edge, true, costing);
       }
       continue;
     } else if (directededge->trans_down()) {
       if (!from_transition) {
         ExpandReverse(graphreader, directededge->endnode(), pred, pred_idx,
-                      opp_pred_edge, true);
+                      opp_pred_edge, true, costing);
       }
       continue;
     }
@@ -361,16 +395,16 @@ void Isochrone::ExpandReverse(GraphReader& graphreader,
 
     // Skip this edge if no access is allowed (based on costing method)
     // or if a complex restriction prevents transition onto this edge.
-    if (!costing_->AllowedReverse(directededge, pred, opp_edge, t2, oppedge) ||
-         costing_->Restricted(directededge, pred, edgelabels_, tile,
+    if (!costing.AllowedReverse(directededge, pred, opp_edge, t2, oppedge) ||
+         costing.Restricted(directededge, pred, edgelabels_, tile,
                                      edgeid, false)) {
       continue;
     }
 
     // Compute the cost to the end of this edge with separate transition cost
-    Cost tc = costing_->TransitionCostReverse(directededge->localedgeidx(),
+    Cost tc = costing.TransitionCostReverse(directededge->localedgeidx(),
                                nodeinfo, opp_edge, opp_pred_edge);
-    Cost newcost = pred.cost() + costing_->EdgeCost(opp_edge);
+    Cost newcost = pred.cost() + costing.EdgeCost(opp_edge);
     newcost.cost += tc.cost;
 
     // Check if edge is temporarily labeled and this path has less cost. If
@@ -396,6 +430,96 @@ void Isochrone::ExpandReverse(GraphReader& graphreader,
   }
 }
 
+// Compute iso-tile with a sweep over a contraction hierarchy. The sweep
+// has the time at the end of every edge, edges ending within the time
+// limit are marked (the graph search marks up to the edge that exceeds it).
+// Only edges in the graph tiles the isotile covers can be marked, so unless
+// those are most of the hierarchy the sweep is restricted to the vertices
+// leading down to them (RPHAST) rather than sweeping the whole hierarchy.
+std::shared_ptr<const GriddedData<PointLL> > Isochrone::ComputeSweep(
+             std::vector<PathLocation>& origin_locations,
+             const unsigned int max_minutes,
+             GraphReader& graphreader,
+             const std::shared_ptr<DynamicCost>* mode_costing,
+             const TravelMode mode,
+             const Phast& sweep) {
+  // Set the mode and costing
+  mode_ = mode;
+  costing_ = mode_costing[static_cast<uint32_t>(mode_)];
+  access_mode_ = costing_->access_mode();
+
+  // Create the isotile
+  auto max_seconds = max_minutes * 60;
+  ConstructIsoTile(false, max_minutes, origin_locations);
+
+  // Vertices of the graph tiles within reach of the isotile
+  const auto& hierarchy = sweep.hierarchy();
+  std::vector<uint32_t> targets;
+  for (const auto& level : TileHierarchy::levels()) {
+    for (auto tileid : level.second.tiles.TileList(isotile_->TileBounds())) {
+      auto vertices = hierarchy.GetTileVertices(GraphId(tileid, level.first, 0));
+      for (uint32_t v = 0; v < vertices.second; ++v) {
+        targets.push_back(vertices.first + v);
+      }
+    }
+  }
+  std::unique_ptr<Phast> restricted;
+  if (targets.size() * 2 < hierarchy.vertex_count()) {
+    restricted.reset(new Phast(sweep.Restrict(targets)));
+  }
+  const Phast& search = restricted ? *restricted : sweep;
+  LOG_DEBUG("Sweep of " + std::to_string(search.size()) + " vertices");
+
+  // Seed the sweep with the rest of each origin edge
+  std::vector<Phast::Seed> seeds;
+  for (auto& origin : origin_locations) {
+    // Set time at the origin lat, lon grid to 0
+    isotile_->Set(origin.latlng_, 0);
+
+    // Only skip inbound edges if we have other options
+    bool has_other_edges = std::any_of(origin.edges.cbegin(), origin.edges.cend(),
+      [](const PathLocation::PathEdge& e) { return !e.end_node(); });
+    for (const auto& edge : origin.edges) {
+      uint32_t vertex = hierarchy.GetVertex(edge.id);
+      const GraphTile* tile = graphreader.GetGraphTile(edge.id);
+      if ((has_other_edges && edge.end_node()) || vertex == kInvalidVertex ||
+          tile == nullptr) {
+        continue;
+      }
+      const DirectedEdge* directededge = tile->directededge(edge.id);
+      Cost cost = costing_->EdgeCost(directededge) * (1.0f - edge.dist);
+      seeds.push_back({ vertex, { cost.cost + edge.score, cost.secs,
+                        directededge->length() * (1.0f - edge.dist) } });
+    }
+  }
+
+  std::vector<Phast::Label> labels;
+  search.Search(seeds, labels);
+
+  // Mark the edges reached within the time limit
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < labels.size(); ++i) {
+    float secs1 = labels[i].secs;
+    if (labels[i].cost == kMaxCost || secs1 > max_seconds) {
+      continue;
+    }
+    // The opposing edge is in the tile of the end node
+    GraphId edgeid = hierarchy.GetEdgeId(search.vertex(i));
+    const GraphTile* t2 = nullptr;
+    GraphId opp = graphreader.GetOpposingEdgeId(edgeid, t2);
+    if (!opp.Is_Valid()) {
+      continue;
+    }
+    const DirectedEdge* edge = graphreader.GetGraphTile(edgeid)->directededge(edgeid);
+    float secs0 = std::max(secs1 - costing_->EdgeCost(edge).secs, 0.0f);
+    UpdateIsoTile(edgeid, opp, t2, secs0, secs1, graphreader,
+                  t2->node(edge->endnode())->latlng());
+    n++;
+  }
+  LOG_DEBUG("Sweep marked " + std::to_string(n) + " edges");
+  return isotile_;
+}
+
 // Compute iso-tile that we can use to generate isochrones.
 std::shared_ptr<const GriddedData<PointLL> > Isochrone::ComputeReverse(
              std::vector<PathLocation>& dest_locations,
@@ -416,15 +540,40 @@ std::shared_ptr<const GriddedData<PointLL> > Isochrone::ComputeReverse(
   // Set the origin locations
   SetDestinationLocations(graphreader, dest_locations, costing_);
 
-  // Compute the isotile
+  // Compute the isotile. Expand with the costing methods resolved at compile
+  // time if there is a concrete costing class for this costing, through the
+  // vtable otherwise
+  switch (GetConcreteCosting(costing_.get())) {
+    case ConcreteCosting::kAuto:
+      SearchReverse(graphreader, max_seconds, ConcreteCost<AutoCost>(costing_.get()));
+      break;
+    case ConcreteCosting::kTruck:
+      SearchReverse(graphreader, max_seconds, ConcreteCost<TruckCost>(costing_.get()));
+      break;
+    case ConcreteCosting::kBicycle:
+      SearchReverse(graphreader, max_seconds, ConcreteCost<BicycleCost>(costing_.get()));
+      break;
+    case ConcreteCosting::kPedestrian:
+      SearchReverse(graphreader, max_seconds, ConcreteCost<PedestrianCost>(costing_.get()));
+      break;
+    default:
+      SearchReverse(graphreader, max_seconds, ConcreteCost<DynamicCost>(costing_.get()));
+      break;
+  }
+  return isotile_;
+}
+
+// Expand the reverse search until the time limit is exceeded.
+template <class cost_t>
+void Isochrone::SearchReverse(GraphReader& graphreader, const uint32_t max_seconds,
+                              const ConcreteCost<cost_t>& costing) {
   uint32_t n = 0;
-  const GraphTile* tile;
   while (true) {
     // Get next element from adjacency list. Check that it is valid. An
     // invalid label indicates there are no edges that can be expanded.
     uint32_t predindex = adjacencylist_->pop();
     if (predindex == kInvalidLabel) {
-      return isotile_;
+      return;
     }
 
     // Copy the EdgeLabel for use in costing and settle the edge.
@@ -437,16 +586,16 @@ std::shared_ptr<const GriddedData<PointLL> > Isochrone::ComputeReverse(
       graphreader.GetGraphTile(pred.opp_edgeid())->directededge(pred.opp_edgeid());
 
     // Expand from the end node in forward direction.
-    ExpandReverse(graphreader, pred.endnode(), pred, predindex, opp_pred_edge, false);
+    ExpandReverse(graphreader, pred.endnode(), pred, predindex, opp_pred_edge,
+                  false, costing);
     n++;
 
     // Return after the time interval has been met
     if (pred.cost().secs > max_seconds || pred.cost().cost > max_seconds * 4) {
       LOG_DEBUG("Exceed time interval: n = " + std::to_string(n));
-      return isotile_;
+      return;
     }
   }
-  return isotile_;      // Should never get here
 }
 
 // Compute isochrone for mulit-modal route.
@@ -804,9 +953,22 @@ void Isochrone::UpdateIsoTile(const EdgeLabel& pred, GraphReader& graphreader,
     return;
   }
 
+  // Get the time at the begin node and end node of the predecessor
+  // TODO - do we need partial shape from origin location to end of edge?
+  uint32_t idx = pred.predecessor();
+  float secs0 = (idx == kInvalidLabel) ? 0 : edgelabels_[idx].cost().secs;
+  float secs1 = pred.cost().secs;
+  UpdateIsoTile(pred.edgeid(), opp, t2, secs0, secs1, graphreader, ll);
+}
+
+// Mark the cells along an edge with the times at its begin and end node
+void Isochrone::UpdateIsoTile(const GraphId& edgeid, const GraphId& opp,
+                              const GraphTile* t2, const float secs0,
+                              const float secs1, GraphReader& graphreader,
+                              const PointLL& ll) {
   // Get the DirectedEdge because we'll need its shape
-  const GraphTile* tile = graphreader.GetGraphTile(pred.edgeid().Tile_Base());
-  const DirectedEdge* edge = tile->directededge(pred.edgeid());
+  const GraphTile* tile = graphreader.GetGraphTile(edgeid.Tile_Base());
+  const DirectedEdge* edge = tile->directededge(edgeid);
 
   // Transit lines and ferries can't really be "reached" you really just
   // pass through those cells.
@@ -814,12 +976,6 @@ void Isochrone::UpdateIsoTile(const EdgeLabel& pred, GraphReader& graphreader,
     return;
   }
 
-  // Get the time at the begin node and end node of the predecessor
-  // TODO - do we need partial shape from origin location to end of edge?
-  uint32_t idx = pred.predecessor();
-  float secs0 = (idx == kInvalidLabel) ? 0 : edgelabels_[idx].cost().secs;
-  float secs1 = pred.cost().secs;
-
   // Avoid getting the shape for short edges
   if (edge->length() < shape_interval_) {
     // Mark the cell at the begin node
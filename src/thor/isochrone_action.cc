@@ -35,8 +35,11 @@ namespace valhalla {
       //Cost (including penalties) is used when adding to the adjacency list but the elapsed
       //time in seconds is used when terminating the search. The + 10 minutes adds a buffer for edges
       //where there has been a higher cost that might still be marked in the isochrone
+      //Requests with the costing of the contraction hierarchy can use a sweep over it instead
       auto grid = (costing == "multimodal" || costing == "transit") ?
         isochrone_gen.ComputeMultiModal(correlated, contours.back()+10, reader, mode_costing, mode) :
+        (use_contraction && isochrone_sweep) ?
+        isochrone_gen.ComputeSweep(correlated, contours.back()+10, reader, mode_costing, mode, *isochrone_sweep) :
         isochrone_gen.Compute(correlated, contours.back()+10, reader, mode_costing, mode);
 
       //turn it into geojson
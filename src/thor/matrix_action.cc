@@ -8,6 +8,7 @@
 #include "sif/bicyclecost.h"
 #include "sif/pedestriancost.h"
 #include "thor/costmatrix.h"
+#include "thor/phast.h"
 #include "thor/timedistancematrix.h"
 #include "tyr/actor.h"
 
@@ -21,63 +22,71 @@ using namespace valhalla::thor;
 namespace {
 
   constexpr double kMilePerMeter = 0.000621371;
-  json::ArrayPtr locations(const std::vector<baldr::PathLocation>& correlated) {
-    auto input_locs = json::array({});
+  void locations(json::Jwriter& writer, const std::vector<baldr::PathLocation>& correlated) {
+    writer.start_array();
     for(size_t i = 0; i < correlated.size(); i++) {
-      input_locs->emplace_back(
-        json::map({
-          {"lat", json::fp_t{correlated[i].latlng_.lat(), 6}},
-          {"lon", json::fp_t{correlated[i].latlng_.lng(), 6}}
-        })
-      );
+      writer.start_object();
+      writer("lat", json::fp_t{correlated[i].latlng_.lat(), 6});
+      writer("lon", json::fp_t{correlated[i].latlng_.lng(), 6});
+      writer.end_object();
     }
-    return input_locs;
+    writer.end_array();
   }
 
-  json::ArrayPtr serialize_row(const std::vector<TimeDistance>& tds,
+  void serialize_row(json::Jwriter& writer, const std::vector<TimeDistance>& tds,
       size_t start_td, const size_t td_count, const size_t source_index, const size_t target_index, double distance_scale) {
-    auto row = json::array({});
+    writer.start_array();
     for(size_t i = start_td; i < start_td + td_count; ++i) {
+      writer.start_object();
+      writer("from_index", static_cast<uint64_t>(source_index));
+      writer("to_index", static_cast<uint64_t>(target_index + (i - start_td)));
       //check to make sure a route was found; if not, return null for distance & time in matrix result
       if (tds[i].time != kMaxCost) {
-        row->emplace_back(json::map({
-          {"from_index", static_cast<uint64_t>(source_index)},
-          {"to_index", static_cast<uint64_t>(target_index + (i - start_td))},
-          {"time", static_cast<uint64_t>(tds[i].time)},
-          {"distance", json::fp_t{tds[i].dist * distance_scale, 3}}
-        }));
+        writer("time", static_cast<uint64_t>(tds[i].time));
+        writer("distance", json::fp_t{tds[i].dist * distance_scale, 3});
       } else {
-        row->emplace_back(json::map({
-          {"from_index", static_cast<uint64_t>(source_index)},
-          {"to_index", static_cast<uint64_t>(target_index + (i - start_td))},
-          {"time", static_cast<std::nullptr_t>(nullptr)},
-          {"distance", static_cast<std::nullptr_t>(nullptr)}
-        }));
+        writer("time", nullptr);
+        writer("distance", nullptr);
       }
+      writer.end_object();
     }
-    return row;
+    writer.end_array();
   }
 
-  json::MapPtr serialize(const std::string action, const boost::optional<std::string>& id, const std::vector<PathLocation>& correlated_s, const std::vector<PathLocation>& correlated_t, const std::vector<TimeDistance>& tds, std::string& units, double distance_scale) {
-    json::ArrayPtr matrix = json::array({});
+  //the matrix is written out as it goes rather than built up as a json tree first,
+  //for large matrices most of the time was spent allocating the tree
+  std::string serialize(const std::string action, const boost::optional<std::string>& id, const std::vector<PathLocation>& correlated_s, const std::vector<PathLocation>& correlated_t, const std::vector<TimeDistance>& tds, std::string& units, double distance_scale) {
+    std::string text;
+    text.reserve(128 + tds.size() * 64);
+    json::Jwriter writer(text);
+    writer.start_object();
+    writer.key(action);
+    writer.start_array();
     for(size_t source_index = 0; source_index < correlated_s.size(); ++source_index) {
-        matrix->emplace_back(
-          serialize_row(tds, source_index * correlated_t.size(), correlated_t.size(),
-                        source_index, action == "many_to_one" ? correlated_s.size()-1 : 0, distance_scale));
+        serialize_row(writer, tds, source_index * correlated_t.size(), correlated_t.size(),
+                      source_index, action == "many_to_one" ? correlated_s.size()-1 : 0, distance_scale);
     }
-    auto json = json::map({
-      {action, matrix},
-      {"units", units},
-    });
+    writer.end_array();
+    writer("units", units);
     if (action == "sources_to_targets") {
-      json->emplace("targets", json::array({locations(correlated_t)}));
-      json->emplace("sources", json::array({locations(correlated_s)}));
+      writer.key("targets");
+      writer.start_array();
+      locations(writer, correlated_t);
+      writer.end_array();
+      writer.key("sources");
+      writer.start_array();
+      locations(writer, correlated_s);
+      writer.end_array();
     } else {
-      json->emplace("locations", json::array({locations(correlated_s.size() > correlated_t.size() ? correlated_s : correlated_t)}));
+      writer.key("locations");
+      writer.start_array();
+      locations(writer, correlated_s.size() > correlated_t.size() ? correlated_s : correlated_t);
+      writer.end_array();
     }
     if (id)
-      json->emplace("id", *id);
-    return json;
+      writer("id", *id);
+    writer.end_object();
+    return text;
   }
 
 }
@@ -85,7 +94,7 @@ namespace {
 namespace valhalla {
   namespace thor {
 
-    json::MapPtr thor_worker_t::matrix(ACTION_TYPE action, const boost::property_tree::ptree &request) {
+    std::string thor_worker_t::matrix(ACTION_TYPE action, const boost::property_tree::ptree &request) {
       parse_locations(request);
       auto costing = parse_costing(request);
 
@@ -99,20 +108,32 @@ namespace valhalla {
       if (units == "mi")
         distance_scale = kMilePerMeter;
 
-      json::MapPtr json;
       //do the real work
       std::vector<TimeDistance> time_distances;
       auto costmatrix = [&]() {
-        thor::CostMatrix matrix;
+        thor::CostMatrix matrix(matrix_readers);
         return matrix.SourceToTarget(correlated_s, correlated_t, reader, mode_costing,
                                     mode, max_matrix_distance.find(costing)->second);
       };
       auto timedistancematrix = [&]() {
-        thor::TimeDistanceMatrix matrix;
+        thor::TimeDistanceMatrix matrix(matrix_readers);
         return matrix.SourceToTarget(correlated_s, correlated_t, reader, mode_costing,
                                     mode, max_matrix_distance.find(costing)->second);
       };
-      switch (source_to_target_algorithm) {
+      auto phastmatrix = [&]() {
+        thor::PhastMatrix matrix(contraction_hierarchy, matrix_readers.size() + 1);
+        return matrix.SourceToTarget(correlated_s, correlated_t, reader, mode_costing,
+                                    mode, max_matrix_distance.find(costing)->second);
+      };
+      // The hierarchy only has the default auto costing, other requests
+      // use the optimal algorithm
+      auto algorithm = source_to_target_algorithm;
+      if (algorithm == PHAST && !(use_contraction && contraction.has_hierarchy()))
+        algorithm = SELECT_OPTIMAL;
+      switch (algorithm) {
+        case PHAST:
+          time_distances = phastmatrix();
+          break;
         case SELECT_OPTIMAL:
           //TODO - Do further performance testing to pick the best algorithm for the job
           switch (mode) {
@@ -132,10 +153,8 @@ namespace valhalla {
           time_distances = timedistancematrix();
           break;
       }
-      json = serialize(matrix_type, request.get_optional<std::string>("id"), correlated_s, correlated_t,
+      return serialize(matrix_type, request.get_optional<std::string>("id"), correlated_s, correlated_t,
         time_distances, units, distance_scale);
-
-      return json;
     }
   }
 }
@@ -72,7 +72,11 @@ void MultiModalPathAlgorithm::Init(const PointLL& origll,
   uint32_t bucketsize = costing->UnitSize();
   float range = kBucketCount * bucketsize;
   adjacencylist_.reset(new DoubleBucketQueue(0.0f, range, bucketsize, edgecost));
-  edgestatus_.reset(new EdgeStatus());
+  if (edgestatus_) {
+    edgestatus_->Init();
+  } else {
+    edgestatus_.reset(new EdgeStatus());
+  }
 
   // Get hierarchy limits from the costing. Get a copy since we increment
   // transition counts (i.e., this is not a const reference).
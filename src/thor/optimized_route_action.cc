@@ -25,7 +25,7 @@ namespace valhalla {
       valhalla::midgard::logging::Log("matrix_type::optimized_route", " [ANALYTICS] ");
 
     // Use CostMatrix to find costs from each location to every other location
-    CostMatrix costmatrix;
+    CostMatrix costmatrix(matrix_readers);
     std::vector<thor::TimeDistance> td = costmatrix.SourceToTarget(correlated_s, correlated_t, reader,
                                                                   mode_costing, mode,
                                                                   max_matrix_distance.find(costing)->second);
@@ -48,9 +48,14 @@ namespace valhalla {
       time_costs.emplace_back(static_cast<float>(td[i].time));
     }
 
-    Optimizer optimizer;
     //returns the optimal order of the path_locations
-    optimal_order = optimizer.Solve(correlated.size(), time_costs);
+    if (tour_algorithm == LOCAL_SEARCH) {
+      LocalSearchOptimizer optimizer;
+      optimal_order = optimizer.Solve(correlated.size(), time_costs);
+    } else {
+      Optimizer optimizer;
+      optimal_order = optimizer.Solve(correlated.size(), time_costs);
+    }
     std::vector<PathLocation> best_order;
     for (size_t i = 0; i< optimal_order.size(); i++)
       best_order.emplace_back(correlated[optimal_order[i]]);
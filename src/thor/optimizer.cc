@@ -1,6 +1,8 @@
 #include "thor/optimizer.h"
 #include "midgard/logging.h"
 
+#include <limits>
+
 namespace valhalla {
 namespace thor {
 
@@ -178,5 +180,249 @@ float Optimizer::TourCost(const std::vector<float>& costs,
   return c;
 }
 
+// Smallest change in cost counted as an improvement, so rounding cannot
+// make moves go back and forth
+constexpr double kMinImprovement = 1e-3;
+
+constexpr uint32_t LocalSearchOptimizer::kNeighborCount;
+
+LocalSearchOptimizer::LocalSearchOptimizer(const TourType type,
+                                           const uint32_t perturbations)
+    : type_(type), perturbations_(perturbations), costs_(nullptr), count_(0),
+      end_(0) {
+}
+
+// Optimize the tour through a set of locations given the cost matrix
+// among all locations.
+std::vector<uint32_t> LocalSearchOptimizer::Solve(const uint32_t count,
+                                       const std::vector<float>& costs) {
+  if (count < 2) {
+    return std::vector<uint32_t>(count, 0);
+  }
+  costs_ = &costs;
+  count_ = count;
+  end_ = (type_ == TourType::kFixedEnds) ? count_ - 1 : count_;
+
+  // Start with the nearest neighbor tour and improve it until no move
+  // helps
+  NearestNeighborTour();
+  UpdateTour();
+  FindNeighbors();
+  queued_.assign(count_ + 1, false);
+  active_.clear();
+  for (uint32_t i = 0; i < tour_.size(); i++) {
+    Activate(i);
+  }
+  LocalSearch();
+  std::vector<uint32_t> best_tour = tour_;
+  double best_cost = TourCost();
+
+  // Perturb the best tour and improve it again, keeping it if it is better
+  if (tour_.size() > 4) {
+    for (uint32_t i = 0; i < perturbations_; i++) {
+      tour_ = best_tour;
+      Perturb();
+      LocalSearch();
+      if (TourCost() < best_cost - kMinImprovement) {
+        best_cost = TourCost();
+        best_tour = tour_;
+      }
+    }
+  }
+  LOG_DEBUG("Best tour cost = " + std::to_string(best_cost));
+
+  // The extra location at the end of open tours and round trips is not
+  // part of the result
+  if (end_ == count_) {
+    best_tour.pop_back();
+  }
+  return best_tour;
+}
+
+// Build the tour by going to the nearest location not yet visited.
+void LocalSearchOptimizer::NearestNeighborTour() {
+  std::vector<bool> visited(count_ + 1, false);
+  visited[0] = visited[end_] = true;
+  tour_.assign(1, 0);
+  for (uint32_t n = 0; n < count_ + 1; n++) {
+    uint32_t next = end_;
+    float next_cost = std::numeric_limits<float>::max();
+    for (uint32_t loc = 0; loc < count_; loc++) {
+      if (!visited[loc] && Cost(tour_.back(), loc) < next_cost) {
+        next = loc;
+        next_cost = Cost(tour_.back(), loc);
+      }
+    }
+    if (next == end_) {
+      break;
+    }
+    visited[next] = true;
+    tour_.push_back(next);
+  }
+  tour_.push_back(end_);
+}
+
+// Find the nearest neighbors of each location. Costs may not be symmetric
+// so the cheaper direction is used.
+void LocalSearchOptimizer::FindNeighbors() {
+  neighbors_.assign(count_ + 1, {});
+  for (uint32_t loc = 0; loc < count_; loc++) {
+    auto& neighbors = neighbors_[loc];
+    for (uint32_t other = 0; other < count_; other++) {
+      if (other != loc) {
+        neighbors.push_back(other);
+      }
+    }
+    auto distance = [this, loc](const uint32_t other) {
+      return std::min(Cost(loc, other), Cost(other, loc));
+    };
+    uint32_t n = std::min(kNeighborCount, static_cast<uint32_t>(neighbors.size()));
+    std::partial_sort(neighbors.begin(), neighbors.begin() + n, neighbors.end(),
+        [&distance](const uint32_t a, const uint32_t b) {
+          return distance(a) < distance(b);
+        });
+    neighbors.resize(n);
+  }
+}
+
+// Update positions and running costs after the tour changed.
+void LocalSearchOptimizer::UpdateTour() {
+  position_.resize(count_ + 1);
+  forward_.resize(tour_.size());
+  backward_.resize(tour_.size());
+  forward_[0] = backward_[0] = 0.0;
+  position_[tour_[0]] = 0;
+  for (uint32_t i = 1; i < tour_.size(); i++) {
+    position_[tour_[i]] = i;
+    forward_[i] = forward_[i - 1] + Cost(tour_[i - 1], tour_[i]);
+    backward_[i] = backward_[i - 1] + Cost(tour_[i], tour_[i - 1]);
+  }
+}
+
+// Make a location and the locations next to it in the tour active.
+void LocalSearchOptimizer::Activate(const uint32_t position) {
+  uint32_t first = (position > 0) ? position - 1 : 0;
+  uint32_t last = std::min(position + 1, static_cast<uint32_t>(tour_.size()) - 1);
+  for (uint32_t i = first; i <= last; i++) {
+    uint32_t loc = tour_[i];
+    if (loc != count_ && !queued_[loc]) {
+      queued_[loc] = true;
+      active_.push_back(loc);
+    }
+  }
+}
+
+// Run moves until none of the active locations improve the tour.
+void LocalSearchOptimizer::LocalSearch() {
+  while (!active_.empty()) {
+    uint32_t loc = active_.back();
+    active_.pop_back();
+    queued_[loc] = false;
+    ImproveLocation(loc);
+  }
+}
+
+// Try the moves that connect a location to its neighbors.
+bool LocalSearchOptimizer::ImproveLocation(const uint32_t location) {
+  for (uint32_t neighbor : neighbors_[location]) {
+    uint32_t i = position_[location];
+    uint32_t j = position_[neighbor];
+
+    // Reverse part of the tour to connect the location to a neighbor after
+    // it or a neighbor before it to the location
+    if ((j > i && (TwoOpt(i + 1, j) || TwoOpt(i, j - 1))) ||
+        (j < i && (TwoOpt(j + 1, i) || TwoOpt(j, i - 1)))) {
+      return true;
+    }
+
+    // Move a run starting at the neighbor to after the location or a run
+    // ending at the neighbor to before the location
+    for (uint32_t length = 1; length <= 3; length++) {
+      if (OrOpt(j, j + length - 1, i) ||
+          (i > 0 && j + 1 >= length && OrOpt(j + 1 - length, j, i - 1))) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Try to reverse the tour between positions p and q.
+bool LocalSearchOptimizer::TwoOpt(const uint32_t p, const uint32_t q) {
+  // The first and last locations stay where they are
+  if (p < 1 || p >= q || q + 2 > tour_.size()) {
+    return false;
+  }
+  double delta = Cost(tour_[p - 1], tour_[q]) + Cost(tour_[p], tour_[q + 1]) -
+                 Cost(tour_[p - 1], tour_[p]) - Cost(tour_[q], tour_[q + 1]) +
+                 ReversedCost(p, q);
+  if (delta > -kMinImprovement) {
+    return false;
+  }
+  std::reverse(tour_.begin() + p, tour_.begin() + q + 1);
+  UpdateTour();
+  Activate(p);
+  Activate(q);
+  return true;
+}
+
+// Try to move the run between positions p and q after position i, as it
+// is or reversed.
+bool LocalSearchOptimizer::OrOpt(const uint32_t p, const uint32_t q,
+                                 const uint32_t i) {
+  // The first and last locations stay where they are and the run cannot
+  // go next to itself
+  if (p < 1 || p > q || q + 2 > tour_.size() || i + 2 > tour_.size() ||
+      (i + 1 >= p && i <= q)) {
+    return false;
+  }
+  double removed = Cost(tour_[p - 1], tour_[p]) + Cost(tour_[q], tour_[q + 1]) +
+                   Cost(tour_[i], tour_[i + 1]);
+  double added = Cost(tour_[p - 1], tour_[q + 1]);
+  double forward = Cost(tour_[i], tour_[p]) + Cost(tour_[q], tour_[i + 1]);
+  double reversed = Cost(tour_[i], tour_[q]) + Cost(tour_[p], tour_[i + 1]) +
+                    ReversedCost(p, q);
+  bool reverse = reversed < forward;
+  double delta = added + std::min(forward, reversed) - removed;
+  if (delta > -kMinImprovement) {
+    return false;
+  }
+
+  // Take the run out and put it back after the location at position i
+  uint32_t before_run = tour_[p - 1];
+  uint32_t after = tour_[i];
+  std::vector<uint32_t> run(tour_.begin() + p, tour_.begin() + q + 1);
+  if (reverse) {
+    std::reverse(run.begin(), run.end());
+  }
+  tour_.erase(tour_.begin() + p, tour_.begin() + q + 1);
+  auto at = std::find(tour_.begin(), tour_.end(), after) + 1;
+  tour_.insert(at, run.begin(), run.end());
+  UpdateTour();
+  Activate(position_[run.front()]);
+  Activate(position_[run.back()]);
+  Activate(position_[before_run]);
+  return true;
+}
+
+// Exchange two random neighboring parts of the tour (double bridge). The
+// parts keep their direction so this works when costs are not symmetric.
+void LocalSearchOptimizer::Perturb() {
+  std::uniform_int_distribution<uint32_t> cut(1, tour_.size() - 1);
+  uint32_t cuts[3];
+  do {
+    cuts[0] = cut(random_generator_);
+    cuts[1] = cut(random_generator_);
+    cuts[2] = cut(random_generator_);
+  } while (cuts[0] == cuts[1] || cuts[0] == cuts[2] || cuts[1] == cuts[2]);
+  std::sort(cuts, cuts + 3);
+  std::rotate(tour_.begin() + cuts[0], tour_.begin() + cuts[1],
+              tour_.begin() + cuts[2]);
+  UpdateTour();
+  Activate(cuts[0]);
+  Activate(cuts[0] + cuts[2] - cuts[1]);
+  Activate(cuts[2]);
+}
+
 }
 }
@@ -0,0 +1,110 @@
+#include "thor/phaserunner.h"
+
+namespace {
+
+// Number of times to check for a change before yielding the processor
+constexpr uint32_t kSpinCount = 1024;
+
+}
+
+namespace valhalla {
+namespace thor {
+
+// Constructor, starts the worker threads
+PhaseRunner::PhaseRunner(const uint32_t thread_count)
+    : work_(nullptr),
+      count_(0),
+      next_(0),
+      finished_(0),
+      phase_(0),
+      stop_(false) {
+  for (uint32_t thread = 1; thread < thread_count; ++thread) {
+    threads_.emplace_back(&PhaseRunner::Work, this, thread);
+  }
+}
+
+// Destructor, stops the worker threads
+PhaseRunner::~PhaseRunner() {
+  stop_.store(true, std::memory_order_release);
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+uint32_t PhaseRunner::thread_count() const {
+  return threads_.size() + 1;
+}
+
+// Run a phase
+void PhaseRunner::Run(const uint32_t count, const work_t& work) {
+  // Nobody to share the work with
+  if (threads_.empty()) {
+    for (uint32_t index = 0; index < count; ++index) {
+      work(index, 0);
+    }
+    return;
+  }
+
+  // Publish the phase, the workers pick it up when the phase changes
+  work_ = &work;
+  count_ = count;
+  error_ = nullptr;
+  next_.store(0, std::memory_order_relaxed);
+  finished_.store(0, std::memory_order_relaxed);
+  phase_.fetch_add(1, std::memory_order_release);
+
+  // Help out and then wait for every worker to be done with the phase so
+  // none of them is still looking at it when the next one is published
+  RunItems(0);
+  for (uint32_t spins = 0;
+       finished_.load(std::memory_order_acquire) < threads_.size(); ++spins) {
+    if (spins >= kSpinCount) {
+      std::this_thread::yield();
+    }
+  }
+
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+}
+
+// Worker thread loop
+void PhaseRunner::Work(const uint32_t thread) {
+  uint32_t seen = 0;
+  while (true) {
+    // Wait for the next phase
+    uint32_t phase;
+    for (uint32_t spins = 0;
+         (phase = phase_.load(std::memory_order_acquire)) == seen; ++spins) {
+      if (stop_.load(std::memory_order_acquire)) {
+        return;
+      }
+      if (spins >= kSpinCount) {
+        std::this_thread::yield();
+      }
+    }
+    seen = phase;
+
+    RunItems(thread);
+    finished_.fetch_add(1, std::memory_order_release);
+  }
+}
+
+// Run items of the current phase until there are none left
+void PhaseRunner::RunItems(const uint32_t thread) {
+  uint32_t index;
+  while ((index = next_.fetch_add(1, std::memory_order_relaxed)) < count_) {
+    try {
+      (*work_)(index, thread);
+    }
+    catch (...) {
+      std::lock_guard<std::mutex> lock(error_lock_);
+      if (!error_) {
+        error_ = std::current_exception();
+      }
+    }
+  }
+}
+
+}
+}
@@ -0,0 +1,381 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include "thor/phast.h"
+#include "thor/phaserunner.h"
+#include "midgard/logging.h"
+
+using namespace valhalla::baldr;
+using namespace valhalla::sif;
+
+namespace {
+
+// An edge a matrix target is on, with the part of the edge past the
+// target (arcs into a vertex include the whole edge)
+struct TargetEdge {
+  uint32_t vertex;
+  float dist;
+  float score;
+  valhalla::thor::Phast::Label remainder;
+};
+
+// An edge a matrix source is on
+struct SourceEdge {
+  uint32_t vertex;
+  float dist;
+  GraphId id;
+};
+
+// Find the arc between two vertices of the hierarchy, it is an upward arc
+// of the lower ranked one or a downward arc into it
+const ContractionArc* find_arc(const ContractionHierarchy& hierarchy,
+                               const uint32_t from, const uint32_t to) {
+  bool up = hierarchy.rank(to) > hierarchy.rank(from);
+  auto arcs = up ? hierarchy.UpArcs(from) : hierarchy.DownArcs(to);
+  uint32_t other = up ? to : from;
+  for (const ContractionArc* arc = arcs.first; arc != arcs.second; ++arc) {
+    if (arc->vertex == other) {
+      return arc;
+    }
+  }
+  return nullptr;
+}
+
+// Seeds on the edges that follow an edge, at the cost of the hierarchy arcs
+// onto them. A search from these comes back around onto the edge rather than
+// starting on it (the hierarchy has no arcs from a vertex back to itself).
+void add_next_seeds(const ContractionHierarchy& hierarchy, GraphReader& graphreader,
+                    const GraphId& edgeid, const uint32_t vertex,
+                    const valhalla::thor::Phast::Label& label,
+                    std::vector<valhalla::thor::Phast::Seed>& seeds) {
+  // The end node and the same node on the other levels
+  const GraphTile* tile = graphreader.GetGraphTile(edgeid);
+  const DirectedEdge* edge = tile->directededge(edgeid);
+  const GraphTile* endtile = graphreader.GetGraphTile(edge->endnode());
+  if (endtile == nullptr) {
+    return;
+  }
+  std::vector<GraphId> nodes = { edge->endnode() };
+  const NodeInfo* endnode = endtile->node(edge->endnode());
+  const DirectedEdge* trans = endtile->directededge(endnode->edge_index());
+  for (uint32_t i = 0; i < endnode->edge_count(); ++i, ++trans) {
+    if (trans->trans_up() || trans->trans_down()) {
+      nodes.push_back(trans->endnode());
+    }
+  }
+
+  for (const auto& node : nodes) {
+    const GraphTile* nodetile = graphreader.GetGraphTile(node);
+    if (nodetile == nullptr) {
+      continue;
+    }
+    const NodeInfo* nodeinfo = nodetile->node(node);
+    GraphId toid = { node.tileid(), node.level(), nodeinfo->edge_index() };
+    for (uint32_t i = 0; i < nodeinfo->edge_count(); ++i, ++toid) {
+      uint32_t to = hierarchy.GetVertex(toid);
+      if (to == kInvalidVertex || to == vertex) {
+        continue;
+      }
+      const ContractionArc* arc = find_arc(hierarchy, vertex, to);
+      if (arc != nullptr) {
+        seeds.push_back({ to, { label.cost + arc->cost, label.secs + arc->secs,
+                                label.length + arc->length } });
+      }
+    }
+  }
+}
+
+}
+
+namespace valhalla {
+namespace thor {
+
+// Constructor. All vertices in descending rank.
+Phast::Phast(const std::shared_ptr<const ContractionHierarchy>& hierarchy)
+    : hierarchy_(hierarchy),
+      restricted_(false) {
+  uint32_t count = hierarchy_->vertex_count();
+  vertices_.resize(count);
+  for (uint32_t vertex = 0; vertex < count; ++vertex) {
+    vertices_[count - 1 - hierarchy_->rank(vertex)] = vertex;
+  }
+  BuildArcs();
+}
+
+// Constructor. The vertices a downward path to a target can pass through
+// are the ones the targets reach going up against the downward arcs.
+Phast::Phast(const std::shared_ptr<const ContractionHierarchy>& hierarchy,
+             const std::vector<uint32_t>& targets)
+    : hierarchy_(hierarchy),
+      restricted_(true) {
+  std::vector<uint32_t> stack;
+  for (auto target : targets) {
+    if (target != kInvalidVertex && positions_.emplace(target, 0).second) {
+      stack.push_back(target);
+    }
+  }
+  while (!stack.empty()) {
+    uint32_t vertex = stack.back();
+    stack.pop_back();
+    auto arcs = hierarchy_->DownArcs(vertex);
+    for (const ContractionArc* arc = arcs.first; arc != arcs.second; ++arc) {
+      if (positions_.emplace(arc->vertex, 0).second) {
+        stack.push_back(arc->vertex);
+      }
+    }
+  }
+
+  vertices_.reserve(positions_.size());
+  for (const auto& position : positions_) {
+    vertices_.push_back(position.first);
+  }
+  std::sort(vertices_.begin(), vertices_.end(),
+    [this](const uint32_t a, const uint32_t b) {
+      return hierarchy_->rank(a) > hierarchy_->rank(b);
+    });
+  for (uint32_t i = 0; i < vertices_.size(); ++i) {
+    positions_[vertices_[i]] = i;
+  }
+  BuildArcs();
+}
+
+// Copy the downward arcs into each vertex in the order of the sweep. The
+// arcs come from higher ranked vertices, which are earlier in the sweep.
+void Phast::BuildArcs() {
+  offsets_.reserve(vertices_.size() + 1);
+  for (auto vertex : vertices_) {
+    offsets_.push_back(arcs_.size());
+    auto arcs = hierarchy_->DownArcs(vertex);
+    for (const ContractionArc* arc = arcs.first; arc != arcs.second; ++arc) {
+      arcs_.push_back({ index(arc->vertex), arc->cost, arc->secs, arc->length });
+    }
+  }
+  offsets_.push_back(arcs_.size());
+}
+
+Phast Phast::Restrict(const std::vector<uint32_t>& targets) const {
+  return Phast(hierarchy_, targets);
+}
+
+const ContractionHierarchy& Phast::hierarchy() const {
+  return *hierarchy_;
+}
+
+uint32_t Phast::size() const {
+  return vertices_.size();
+}
+
+uint32_t Phast::vertex(const uint32_t index) const {
+  return vertices_[index];
+}
+
+// Get the position of a vertex within the sweep
+uint32_t Phast::index(const uint32_t vertex) const {
+  if (!restricted_) {
+    return vertices_.size() - 1 - hierarchy_->rank(vertex);
+  }
+  auto position = positions_.find(vertex);
+  return (position == positions_.end()) ? kInvalidVertex : position->second;
+}
+
+// Search from the seeds. The upward search has no stopping rule: every
+// vertex above the seeds can start a downward path.
+void Phast::Search(const std::vector<Seed>& seeds,
+                   std::vector<Label>& labels) const {
+  using entry_t = std::pair<float, uint32_t>;
+  std::unordered_map<uint32_t, Label> up;
+  std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t> > queue;
+  auto add = [&up, &queue](const uint32_t vertex, const Label& label) {
+    auto existing = up.find(vertex);
+    if (existing == up.end()) {
+      up.emplace(vertex, label);
+    } else if (label.cost < existing->second.cost) {
+      existing->second = label;
+    } else {
+      return;
+    }
+    queue.emplace(label.cost, vertex);
+  };
+  for (const auto& seed : seeds) {
+    add(seed.vertex, seed.label);
+  }
+  while (!queue.empty()) {
+    entry_t next = queue.top();
+    queue.pop();
+    Label label = up[next.second];
+    if (next.first > label.cost) {
+      continue;
+    }
+    auto arcs = hierarchy_->UpArcs(next.second);
+    for (const ContractionArc* arc = arcs.first; arc != arcs.second; ++arc) {
+      add(arc->vertex, { label.cost + arc->cost, label.secs + arc->secs,
+                         label.length + arc->length });
+    }
+  }
+
+  labels.assign(vertices_.size(), { kMaxCost, 0.0f, 0.0f });
+  for (const auto& label : up) {
+    uint32_t idx = index(label.first);
+    if (idx != kInvalidVertex) {
+      labels[idx] = label.second;
+    }
+  }
+
+  // Sweep down the hierarchy. Every arc into a position comes from an
+  // earlier position, which is final by the time it is read.
+  const SweepArc* arc = arcs_.data();
+  for (uint32_t i = 0; i < vertices_.size(); ++i) {
+    Label& label = labels[i];
+    for (const SweepArc* end = arcs_.data() + offsets_[i + 1]; arc != end; ++arc) {
+      const Label& source = labels[arc->source];
+      float cost = source.cost + arc->cost;
+      if (cost < label.cost) {
+        label = { cost, source.secs + arc->secs, source.length + arc->length };
+      }
+    }
+  }
+}
+
+// Constructor
+PhastMatrix::PhastMatrix(const std::shared_ptr<const ContractionHierarchy>& hierarchy,
+                         const uint32_t thread_count)
+    : hierarchy_(hierarchy),
+      thread_count_(thread_count) {
+}
+
+// Time and distance from each source to each target. Locations are turned
+// into vertices the same way the contraction path algorithm does it.
+std::vector<TimeDistance> PhastMatrix::SourceToTarget(
+        const std::vector<PathLocation>& source_location_list,
+        const std::vector<PathLocation>& target_location_list,
+        GraphReader& graphreader,
+        const std::shared_ptr<DynamicCost>* mode_costing,
+        const TravelMode mode,
+        const float max_matrix_distance) {
+  const auto& costing = mode_costing[static_cast<uint32_t>(mode)];
+
+  // Seeds of each source: the cost of the rest of each origin edge
+  std::vector<std::vector<Phast::Seed> > seeds(source_location_list.size());
+  std::vector<std::vector<SourceEdge> > source_edges(source_location_list.size());
+  for (uint32_t i = 0; i < source_location_list.size(); ++i) {
+    const auto& edges = source_location_list[i].edges;
+    bool has_other_edges = std::any_of(edges.cbegin(), edges.cend(),
+      [](const PathLocation::PathEdge& e) { return !e.end_node(); });
+    for (const auto& edge : edges) {
+      uint32_t vertex = hierarchy_->GetVertex(edge.id);
+      const GraphTile* tile = graphreader.GetGraphTile(edge.id);
+      if ((has_other_edges && edge.end_node()) || vertex == kInvalidVertex ||
+          tile == nullptr) {
+        continue;
+      }
+      const DirectedEdge* directededge = tile->directededge(edge.id);
+      Cost cost = costing->EdgeCost(directededge) * (1.0f - edge.dist);
+      seeds[i].push_back({ vertex, { cost.cost + edge.score, cost.secs,
+                           directededge->length() * (1.0f - edge.dist) } });
+      source_edges[i].push_back({ vertex, edge.dist, edge.id });
+    }
+  }
+
+  // Target edges and the vertices the sweep has to reach
+  std::vector<std::vector<TargetEdge> > target_edges(target_location_list.size());
+  std::vector<uint32_t> targets;
+  for (uint32_t i = 0; i < target_location_list.size(); ++i) {
+    const auto& edges = target_location_list[i].edges;
+    bool has_other_edges = std::any_of(edges.cbegin(), edges.cend(),
+      [](const PathLocation::PathEdge& e) { return !e.begin_node(); });
+    for (const auto& edge : edges) {
+      uint32_t vertex = hierarchy_->GetVertex(edge.id);
+      const GraphTile* tile = graphreader.GetGraphTile(edge.id);
+      if ((has_other_edges && edge.begin_node()) || vertex == kInvalidVertex ||
+          tile == nullptr) {
+        continue;
+      }
+      const DirectedEdge* directededge = tile->directededge(edge.id);
+      Cost remainder = costing->EdgeCost(directededge) * (1.0f - edge.dist);
+      target_edges[i].push_back({ vertex, edge.dist, edge.score,
+          { remainder.cost, remainder.secs,
+            directededge->length() * (1.0f - edge.dist) } });
+      targets.push_back(vertex);
+    }
+  }
+  Phast sweep(hierarchy_, targets);
+  LOG_DEBUG("PHAST sweep of " + std::to_string(sweep.size()) + " vertices");
+
+  // A target behind a source on the same edge cannot use the label of that
+  // edge, which may be the seed and would go backwards along the edge. It
+  // is reached by a second search that leaves the end of the edge instead,
+  // along with the other seeds of the source.
+  std::vector<std::vector<std::pair<uint32_t, std::vector<Phast::Seed> > > > loop_seeds(
+      source_location_list.size());
+  for (uint32_t i = 0; i < source_location_list.size(); ++i) {
+    for (uint32_t k = 0; k < source_edges[i].size(); ++k) {
+      const SourceEdge& source = source_edges[i][k];
+      bool behind = std::any_of(target_edges.cbegin(), target_edges.cend(),
+        [&source](const std::vector<TargetEdge>& edges) {
+          return std::any_of(edges.cbegin(), edges.cend(), [&source](const TargetEdge& e) {
+            return e.vertex == source.vertex && source.dist > e.dist;
+          });
+        });
+      if (!behind) {
+        continue;
+      }
+      std::vector<Phast::Seed> loop;
+      for (const auto& seed : seeds[i]) {
+        if (seed.vertex != source.vertex) {
+          loop.push_back(seed);
+        }
+      }
+      add_next_seeds(*hierarchy_, graphreader, source.id, source.vertex,
+                     seeds[i][k].label, loop);
+      loop_seeds[i].emplace_back(source.vertex, std::move(loop));
+    }
+  }
+
+  // One search per source. Like the other matrices, pairs with a path
+  // longer than the maximum distance have no path.
+  std::vector<TimeDistance> many_to_many(
+      source_location_list.size() * target_location_list.size(),
+      TimeDistance(kMaxCost, kMaxCost));
+  PhaseRunner runner(thread_count_);
+  std::vector<std::vector<Phast::Label> > labels(runner.thread_count());
+  std::vector<std::vector<Phast::Label> > around_labels(runner.thread_count());
+  runner.Run(source_location_list.size(), [&](const uint32_t i, const uint32_t thread) {
+    auto& sweep_labels = labels[thread];
+    sweep.Search(seeds[i], sweep_labels);
+    std::unordered_map<uint32_t, Phast::Label> around;
+    for (const auto& loop : loop_seeds[i]) {
+      sweep.Search(loop.second, around_labels[thread]);
+      around.emplace(loop.first, around_labels[thread][sweep.index(loop.first)]);
+    }
+    for (uint32_t j = 0; j < target_edges.size(); ++j) {
+      Phast::Label best = { kMaxCost, 0.0f, 0.0f };
+      for (const auto& target : target_edges[j]) {
+        bool behind = std::any_of(source_edges[i].cbegin(), source_edges[i].cend(),
+          [&target](const SourceEdge& e) {
+            return e.vertex == target.vertex && e.dist > target.dist;
+          });
+        const Phast::Label& label = behind ? around[target.vertex] :
+            sweep_labels[sweep.index(target.vertex)];
+        if (label.cost == kMaxCost) {
+          continue;
+        }
+        float cost = label.cost - target.remainder.cost + target.score;
+        if (cost < best.cost) {
+          best = { cost, label.secs - target.remainder.secs,
+                   label.length - target.remainder.length };
+        }
+      }
+      if (best.cost != kMaxCost && best.length <= max_matrix_distance) {
+        many_to_many[i * target_edges.size() + j] =
+            TimeDistance(std::round(std::max(best.secs, 0.0f)),
+                         std::round(std::max(best.length, 0.0f)));
+      }
+    }
+  });
+  return many_to_many;
+}
+
+}
+}
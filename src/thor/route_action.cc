@@ -1,14 +1,17 @@
 #include "thor/worker.h"
+#include <algorithm>
 #include <cstdint>
 
 #include "midgard/logging.h"
 #include "midgard/constants.h"
+#include "baldr/datetime.h"
 #include "baldr/json.h"
 #include "sif/autocost.h"
 #include "sif/bicyclecost.h"
 #include "sif/pedestriancost.h"
 #include "proto/trippath.pb.h"
 #include "thor/attributes_controller.h"
+#include "thor/phaserunner.h"
 
 using namespace valhalla;
 using namespace valhalla::midgard;
@@ -16,45 +19,58 @@ using namespace valhalla::baldr;
 using namespace valhalla::sif;
 using namespace valhalla::thor;
 
-namespace valhalla {
-  namespace thor {
-
-  std::list<valhalla::odin::TripPath> thor_worker_t::route(const boost::property_tree::ptree& request, const boost::optional<int> &date_time_type){
-    parse_locations(request);
-    auto costing = parse_costing(request);
-
-    auto trippaths = (date_time_type && *date_time_type == 2) ?
-        path_arrive_by(correlated, costing) :
-        path_depart_at(correlated, costing, date_time_type);
-
-    return trippaths;
-  }
-
-  thor::PathAlgorithm* thor_worker_t::get_path_algorithm(const std::string& routetype,
-        const baldr::PathLocation& origin, const baldr::PathLocation& destination) {
-    if (routetype == "multimodal" || routetype == "transit") {
-      return &multi_modal_astar;
-    } else {
-      // Use A* if any origin and destination edges are the same - otherwise
-      // use bidirectional A*. Bidirectional A* does not handle trivial cases
-      // with oneways.
-      for (auto& edge1 : origin.edges) {
-        for (auto& edge2 : destination.edges) {
-          if (edge1.id == edge2.id) {
-            return &astar;
-          }
+namespace {
+
+  // Use A* if any origin and destination edges are the same - otherwise
+  // use bidirectional A*. Bidirectional A* does not handle trivial cases
+  // with oneways.
+  PathAlgorithm* select_path_algorithm(const PathLocation& origin,
+        const PathLocation& destination, AStarPathAlgorithm& astar,
+        BidirectionalAStar& bidir_astar, ContractionPathAlgorithm& contraction,
+        const bool use_contraction, const bool time_dependent) {
+    for (auto& edge1 : origin.edges) {
+      for (auto& edge2 : destination.edges) {
+        if (edge1.id == edge2.id) {
+          return &astar;
         }
       }
-      return &bidir_astar;
     }
+    // Use the contraction hierarchy if the request has the costs it was
+    // built with. Its shortcuts have fixed costs so it cannot be used when
+    // edge speeds depend on the time.
+    if (use_contraction && contraction.has_hierarchy() && !time_dependent) {
+      return &contraction;
+    }
+    return &bidir_astar;
   }
 
-  std::vector<thor::PathInfo> thor_worker_t::get_path(PathAlgorithm* path_algorithm, baldr::PathLocation& origin,
-      baldr::PathLocation& destination) {
-    // Find the path. If bidirectional A* disable use of destination only
-    // edges on the first pass. If there is a failure, we allow them on the
-    // second pass.
-    valhalla::sif::cost_ptr_t cost = mode_costing[static_cast<uint32_t>(mode)];
+  // Do edge costs at either end of a leg depend on the time
+  bool is_time_dependent(const PathLocation& origin, const PathLocation& destination,
+        const DynamicCost& costing, GraphReader& reader) {
+    return PathAlgorithm::IsTimeDependent(origin, costing, reader) ||
+           PathAlgorithm::IsTimeDependent(destination, costing, reader);
+  }
+
+  // Find the path. If bidirectional A* disable use of destination only
+  // edges on the first pass. If there is a failure, we allow them on the
+  // second pass.
+  std::vector<PathInfo> find_path(PathAlgorithm* path_algorithm, PathLocation& origin,
+        PathLocation& destination, GraphReader& reader, const cost_ptr_t* mode_costing,
+        const TravelMode mode, AStarPathAlgorithm& astar, BidirectionalAStar& bidir_astar,
+        ContractionPathAlgorithm& contraction) {
+    cost_ptr_t cost = mode_costing[static_cast<uint32_t>(mode)];
+
+    // The contraction hierarchy has nothing to relax on a second pass. If
+    // it finds no path (or one it cannot check) use bidirectional A*.
+    if (path_algorithm == &contraction) {
+      auto path = contraction.GetBestPath(origin, destination, reader,
+                                          mode_costing, mode);
+      if (!path.empty()) {
+        return path;
+      }
+      path_algorithm = &bidir_astar;
+      path_algorithm->Clear();
+    }
     if (path_algorithm == &bidir_astar) {
       cost->set_allow_destination_only(false);
     }
@@ -81,12 +97,93 @@ namespace valhalla {
     return path;
   }
 
+}
+
+namespace valhalla {
+  namespace thor {
+
+  std::list<valhalla::odin::TripPath> thor_worker_t::route(const boost::property_tree::ptree& request, const boost::optional<int> &date_time_type){
+    parse_locations(request);
+    auto costing = parse_costing(request);
+
+    auto trippaths = (date_time_type && *date_time_type == 2) ?
+        path_arrive_by(correlated, costing) :
+        path_depart_at(correlated, costing, date_time_type);
+
+    return trippaths;
+  }
+
+  thor::PathAlgorithm* thor_worker_t::get_path_algorithm(const std::string& routetype,
+        const baldr::PathLocation& origin, const baldr::PathLocation& destination) {
+    if (routetype == "multimodal" || routetype == "transit") {
+      return &multi_modal_astar;
+    } else {
+      return select_path_algorithm(origin, destination, astar, bidir_astar,
+          contraction, use_contraction, is_time_dependent(origin, destination,
+          *mode_costing[static_cast<uint32_t>(mode)], reader));
+    }
+  }
+
+  std::vector<thor::PathInfo> thor_worker_t::get_path(PathAlgorithm* path_algorithm, baldr::PathLocation& origin,
+      baldr::PathLocation& destination) {
+    return find_path(path_algorithm, origin, destination, reader, mode_costing,
+                     mode, astar, bidir_astar, contraction);
+  }
+
+  // A leg from a break does not depend on the legs before it. When every
+  // location is a break all of the legs can be routed at once. When edge
+  // costs depend on the time each leg starts (or ends) at the time the leg
+  // before it ends.
+  bool thor_worker_t::can_route_legs_concurrently(const std::string& costing,
+        const std::vector<PathLocation>& correlated) {
+    if (leg_searchers.size() < 2 || correlated.size() < 3 ||
+        costing == "multimodal" || costing == "transit" ||
+        is_time_dependent(correlated.front(), correlated.back(),
+                          *mode_costing[static_cast<uint32_t>(mode)], reader)) {
+      return false;
+    }
+    return std::all_of(correlated.begin(), correlated.end(),
+        [](const PathLocation& location) {
+          return location.stoptype_ == Location::StopType::BREAK;
+        });
+  }
+
+  // Route every leg, leg i going from location i to location i + 1. Each
+  // thread has its own path algorithms and graph reader. Each leg gets
+  // fresh costing, so relaxing the limits for one leg does not change the
+  // legs after it.
+  std::vector<std::vector<thor::PathInfo>> thor_worker_t::get_leg_paths(
+        const std::string& costing, std::vector<PathLocation>& correlated) {
+    std::vector<std::vector<thor::PathInfo>> paths(correlated.size() - 1);
+    PhaseRunner runner(leg_searchers.size());
+    runner.Run(paths.size(), [&](const uint32_t leg, const uint32_t thread) {
+      auto& searcher = *leg_searchers[thread];
+      auto& graphreader = (thread == 0) ? reader : *matrix_readers[thread - 1];
+      searcher.mode_costing[static_cast<uint32_t>(mode)] =
+          factory.Create(costing, costing_options);
+      auto* path_algorithm = select_path_algorithm(correlated[leg], correlated[leg + 1],
+          searcher.astar, searcher.bidir_astar, searcher.contraction, use_contraction,
+          is_time_dependent(correlated[leg], correlated[leg + 1],
+                            *searcher.mode_costing[static_cast<uint32_t>(mode)], graphreader));
+      path_algorithm->Clear();
+      paths[leg] = find_path(path_algorithm, correlated[leg], correlated[leg + 1],
+          graphreader, searcher.mode_costing, mode, searcher.astar,
+          searcher.bidir_astar, searcher.contraction);
+    });
+    return paths;
+  }
+
   std::list<valhalla::odin::TripPath> thor_worker_t::path_arrive_by(std::vector<PathLocation>& correlated, const std::string &costing) {
     // Things we'll need
     std::vector<thor::PathInfo> path;
     std::list<valhalla::odin::TripPath> trip_paths;
     correlated.front().stoptype_ = correlated.back().stoptype_ = Location::StopType::BREAK;
 
+    // Route all of the legs at once when they do not depend on each other
+    std::vector<std::vector<thor::PathInfo>> leg_paths;
+    if (can_route_legs_concurrently(costing, correlated))
+      leg_paths = get_leg_paths(costing, correlated);
+
     // For each pair of locations
     for(auto origin = ++correlated.rbegin(); origin != correlated.rend(); ++origin) {
       // Get the algorithm type for this location pair
@@ -105,9 +202,21 @@ namespace valhalla {
       }
 
       // Get best path and keep it
-      auto temp_path = get_path(path_algorithm, *origin, *destination);
+      auto temp_path = leg_paths.empty() ? get_path(path_algorithm, *origin, *destination) :
+          std::move(leg_paths[std::distance(origin, correlated.rend()) - 1]);
       temp_path.swap(path);
 
+      // The time at a through location is the time at the destination less
+      // the time of this leg, so the leg before it arrives on time. Breaks
+      // get their time when the trip path is built.
+      if (origin->stoptype_ != Location::StopType::BREAK &&
+          destination->date_time_ && !path.empty()) {
+        auto date_time = DateTime::offset_date_time(*destination->date_time_,
+            -static_cast<int32_t>(path.back().elapsed_time));
+        if (!date_time.empty())
+          origin->date_time_ = date_time;
+      }
+
       // Merge through legs by updating the time and splicing the lists
       if(!temp_path.empty()) {
         auto offset = path.back().elapsed_time;
@@ -152,6 +261,11 @@ namespace valhalla {
     std::list<valhalla::odin::TripPath> trip_paths;
     correlated.front().stoptype_ = correlated.back().stoptype_ = Location::StopType::BREAK;
 
+    // Route all of the legs at once when they do not depend on each other
+    std::vector<std::vector<thor::PathInfo>> leg_paths;
+    if (can_route_legs_concurrently(costing, correlated))
+      leg_paths = get_leg_paths(costing, correlated);
+
     // For each pair of locations
     for(auto destination = ++correlated.begin(); destination != correlated.end(); ++destination) {
       // Get the algorithm type for this location pair
@@ -170,7 +284,19 @@ namespace valhalla {
       }
 
       // Get best path and keep it
-      auto temp_path = get_path(path_algorithm, *origin, *destination);
+      auto temp_path = leg_paths.empty() ? get_path(path_algorithm, *origin, *destination) :
+          std::move(leg_paths[std::distance(correlated.begin(), origin)]);
+
+      // The time at a through location is the time at the origin plus the
+      // time of this leg, so the leg after it departs at that time. Breaks
+      // get their time when the trip path is built.
+      if (destination->stoptype_ != Location::StopType::BREAK &&
+          origin->date_time_ && !temp_path.empty()) {
+        auto date_time = DateTime::offset_date_time(*origin->date_time_,
+            static_cast<int32_t>(temp_path.back().elapsed_time));
+        if (!date_time.empty())
+          destination->date_time_ = date_time;
+      }
 
       // Merge through legs by updating the time and splicing the lists
       if(!path.empty()) {
@@ -1,6 +1,7 @@
 #include <vector>
 #include <algorithm>
 #include "thor/timedistancematrix.h"
+#include "thor/phaserunner.h"
 #include "midgard/logging.h"
 
 using namespace valhalla::baldr;
@@ -32,6 +33,13 @@ TimeDistanceMatrix::TimeDistanceMatrix()
       settled_count_(0),
       current_cost_threshold_(0) {}
 
+// Constructor with worker threads.
+TimeDistanceMatrix::TimeDistanceMatrix(
+            const std::vector<std::shared_ptr<GraphReader>>& worker_readers)
+    : TimeDistanceMatrix() {
+  worker_readers_ = worker_readers;
+}
+
 float TimeDistanceMatrix::GetCostThreshold(const float max_matrix_distance) {
   float cost_threshold;
   switch (mode_) {
@@ -61,8 +69,10 @@ void TimeDistanceMatrix::Clear() {
   // Clear elements from the adjacency list
   adjacencylist_.reset();
 
-  // Clear the edge status flags
-  edgestatus_.reset();
+  // Clear the edge status flags. The per tile arrays are kept for reuse.
+  if (edgestatus_) {
+    edgestatus_->Init();
+  }
 }
 
 // Calculate time and distance from one origin location to many destination
@@ -90,7 +100,11 @@ std::vector<TimeDistance> TimeDistanceMatrix::OneToMany(
   };
   adjacencylist_.reset(new DoubleBucketQueue(0.0f, current_cost_threshold_,
                                              bucketsize, edgecost));
-  edgestatus_.reset(new EdgeStatus());
+  if (edgestatus_) {
+    edgestatus_->Init();
+  } else {
+    edgestatus_.reset(new EdgeStatus());
+  }
 
   // Initialize the origin and destination locations
   settled_count_ = 0;
@@ -239,7 +253,11 @@ std::vector<TimeDistance> TimeDistanceMatrix::ManyToOne(
   };
   adjacencylist_.reset(new DoubleBucketQueue(0.0f, current_cost_threshold_,
                                          bucketsize, edgecost));
-  edgestatus_.reset(new EdgeStatus());
+  if (edgestatus_) {
+    edgestatus_->Init();
+  } else {
+    edgestatus_.reset(new EdgeStatus());
+  }
 
   // Initialize the origin and destination locations
   settled_count_ = 0;
@@ -390,24 +408,40 @@ std::vector<TimeDistance> TimeDistanceMatrix::SourceToTarget(
         baldr::GraphReader& graphreader,
         const std::shared_ptr<sif::DynamicCost>* mode_costing,
         const sif::TravelMode mode, const float max_matrix_distance) {
-  // Run a series of one to many calls and concatenate the results.
-  std::vector<TimeDistance> many_to_many;
+  // Run a series of one to many calls and concatenate the results in
+  // location order. Each thread uses its own matrix and graph reader.
+  PhaseRunner runner(worker_readers_.size() + 1);
+  std::vector<TimeDistanceMatrix> matrices(runner.thread_count() - 1);
+  auto matrix = [this, &matrices](const uint32_t thread) -> TimeDistanceMatrix& {
+    return (thread == 0) ? *this : matrices[thread - 1];
+  };
+  auto reader = [this, &graphreader](const uint32_t thread) -> GraphReader& {
+    return (thread == 0) ? graphreader : *worker_readers_[thread - 1];
+  };
+
+  std::vector<std::vector<TimeDistance>> results;
   if (source_location_list.size() <= target_location_list.size()) {
-    for (const auto& origin: source_location_list) {
-      std::vector<TimeDistance> td = OneToMany(origin, target_location_list,
-                                               graphreader, mode_costing,
-                                               mode, max_matrix_distance);
-      many_to_many.insert(many_to_many.end(), td.begin(), td.end());
-      Clear();
-    }
+    results.resize(source_location_list.size());
+    runner.Run(results.size(), [&](const uint32_t i, const uint32_t thread) {
+      results[i] = matrix(thread).OneToMany(source_location_list[i],
+                               target_location_list, reader(thread),
+                               mode_costing, mode, max_matrix_distance);
+      matrix(thread).Clear();
+    });
   } else {
-    for (const auto& destination: target_location_list) {
-      std::vector<TimeDistance> td = ManyToOne(destination, source_location_list,
-                                               graphreader, mode_costing,
-                                               mode, max_matrix_distance);
-      many_to_many.insert(many_to_many.end(), td.begin(), td.end());
-      Clear();
-    }
+    results.resize(target_location_list.size());
+    runner.Run(results.size(), [&](const uint32_t i, const uint32_t thread) {
+      results[i] = matrix(thread).ManyToOne(target_location_list[i],
+                               source_location_list, reader(thread),
+                               mode_costing, mode, max_matrix_distance);
+      matrix(thread).Clear();
+    });
+  }
+
+  std::vector<TimeDistance> many_to_many;
+  many_to_many.reserve(source_location_list.size() * target_location_list.size());
+  for (const auto& td : results) {
+    many_to_many.insert(many_to_many.end(), td.begin(), td.end());
   }
   return many_to_many;
 }
@@ -24,6 +24,13 @@ TrafficAlgorithm::~TrafficAlgorithm() {
   Clear();
 }
 
+// Clear the temporary information generated during path construction.
+void TrafficAlgorithm::Clear() {
+  AStarPathAlgorithm::Clear();
+  tile_speeds_.clear();
+  speeds_.reset();
+}
+
 // Calculate best path. This method is single mode, not time-dependent.
 std::vector<PathInfo> TrafficAlgorithm::GetBestPath(PathLocation& origin,
              PathLocation& destination, GraphReader& graphreader,
@@ -33,6 +40,13 @@ std::vector<PathInfo> TrafficAlgorithm::GetBestPath(PathLocation& origin,
   mode_ = mode;
   const auto& costing = mode_costing[static_cast<uint32_t>(mode_)];
 
+  // Pin the current generation of real-time speeds for this route
+  if (!traffic_) {
+    traffic_ = TrafficSpeeds::get_instance(graphreader.tile_dir());
+  }
+  speeds_ = traffic_->Current();
+  tile_speeds_.clear();
+
   // Initialize - create adjacency list, edgestatus support, A*, etc.
   Init(origin.edges.front().projected, destination.edges.front().projected, costing);
   float mindist = astarheuristic_.GetDistance(origin.edges.front().projected);
@@ -103,7 +117,7 @@ std::vector<PathInfo> TrafficAlgorithm::GetBestPath(PathLocation& origin,
     }
 
     // Check if this tile has real-time speeds
-    std::vector<uint8_t>& speeds = GetRealTimeSpeeds(node.tileid(), graphreader);
+    const TrafficSpeeds::speeds_t& speeds = GetRealTimeSpeeds(node.tileid());
 
     // Expand from end node.
     GraphId edgeid(node.tileid(), node.level(), nodeinfo->edge_index());
@@ -131,12 +145,12 @@ std::vector<PathInfo> TrafficAlgorithm::GetBestPath(PathLocation& origin,
       // TODO - want to add a traffic costing method in sif
       Cost edge_cost;
       Cost tc = costing->TransitionCost(directededge, nodeinfo, pred);
-      if (speeds.size() == 0 || speeds[edgeid.id()] == 0) {
+      if (edgeid.id() >= speeds.size() || speeds.get()[edgeid.id()] == 0) {
         edge_cost = costing->EdgeCost(directededge);
       } else {
         // Traffic exists for this edge
         float sec = directededge->length() * (kSecPerHour * 0.001f) /
-                static_cast<float>(speeds[edgeid.id()]);
+                static_cast<float>(speeds.get()[edgeid.id()]);
         edge_cost = { sec, sec };
 
         // For now reduce transition cost by half...thought is that traffic
@@ -192,30 +206,16 @@ std::vector<PathInfo> TrafficAlgorithm::GetBestPath(PathLocation& origin,
   return {};      // Should never get here
 }
 
-std::vector<uint8_t>& TrafficAlgorithm::GetRealTimeSpeeds(const uint32_t tileid,
-                               GraphReader& graphreader) {
-  // Check if this tile has real-time speeds
-  auto rts = real_time_speeds_.find(tileid);
-  if (rts == real_time_speeds_.end()) {
-    // Try to load the speeds file
-    std::ifstream rtsfile;
-    std::string traffic_dir = graphreader.tile_dir() + "/traffic/";
-    std::string fname = traffic_dir + std::to_string(tileid) + ".spd";
-    rtsfile.open(fname, std::ios::binary | std::ios::in | std::ios::ate);
-    if (rtsfile.is_open()) {
-      uint32_t count = rtsfile.tellg();
-      LOG_INFO("Load real time speeds: count = " + std::to_string(count));
-      rtsfile.seekg(0, rtsfile.beg);
-      std::vector<uint8_t> spds(count);
-      rtsfile.read((char*)(&spds.front()), count);
-      rtsfile.close();
-      real_time_speeds_[tileid] = spds;
-      return real_time_speeds_[tileid];
-    } else {
-      return empty_speeds_;
-    }
+const TrafficSpeeds::speeds_t& TrafficAlgorithm::GetRealTimeSpeeds(
+                const uint32_t tileid) {
+  // Check if this tile has been used by the route already
+  auto rts = tile_speeds_.find(tileid);
+  if (rts == tile_speeds_.end()) {
+    const TrafficSpeeds::speeds_t& speeds = speeds_->GetSpeeds(tileid);
+    tile_speeds_.emplace(tileid, &speeds);
+    return speeds;
   } else {
-    return rts->second;
+    return *rts->second;
   }
 }
 
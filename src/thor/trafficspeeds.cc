@@ -0,0 +1,198 @@
+#include <fstream>
+#include <sys/stat.h>
+
+#include "thor/trafficspeeds.h"
+#include "midgard/logging.h"
+
+namespace {
+
+// Name of the file pointing at the current generation of speeds
+const std::string kGenerationFile = "generation";
+
+// Speeds returned for tiles without any
+const valhalla::thor::TrafficSpeeds::speeds_t kNoSpeeds;
+
+}
+
+namespace valhalla {
+namespace thor {
+
+TrafficSpeeds::speeds_t::speeds_t() {
+}
+
+// Map the file if it can never change underneath us, otherwise copy it
+TrafficSpeeds::speeds_t::speeds_t(const std::string& fname, const size_t size,
+                                  const bool map) {
+  if (map) {
+    mapped_.map(fname, size, true);
+    return;
+  }
+  std::ifstream file(fname, std::ios::in | std::ios::binary);
+  if (!file.is_open()) {
+    throw std::runtime_error("Could not open file");
+  }
+  copied_.resize(size);
+  file.read(reinterpret_cast<char*>(copied_.data()), size);
+  // It may have been truncated since we looked at its size
+  copied_.resize(file.gcount());
+}
+
+size_t TrafficSpeeds::speeds_t::size() const {
+  return mapped_.size() ? mapped_.size() : copied_.size();
+}
+
+const uint8_t* TrafficSpeeds::speeds_t::get() const {
+  return mapped_.size() ? mapped_.get() : copied_.data();
+}
+
+TrafficSpeeds::Generation::Generation(const std::string& speeds_dir,
+                                      const bool published)
+    : speeds_dir_(speeds_dir),
+      published_(published) {
+}
+
+// Get the speeds for a tile. Read on first use and cached (including
+// tiles that have no speeds) so each file is only looked at once.
+const TrafficSpeeds::speeds_t& TrafficSpeeds::Generation::GetSpeeds(
+                const uint32_t tileid) const {
+  std::lock_guard<std::mutex> guard(lock_);
+  auto tile = tiles_.find(tileid);
+  if (tile != tiles_.end()) {
+    return tile->second ? *tile->second : kNoSpeeds;
+  }
+
+  // Remember what legacy files looked like so we can tell when they change
+  std::unique_ptr<speeds_t> speeds;
+  std::string fname = speeds_dir_ + std::to_string(tileid) + ".spd";
+  file_id_t id = file_id(fname);
+  if (!published_) {
+    files_.emplace(tileid, id);
+  }
+  if (id.size > 0) {
+    try {
+      speeds.reset(new speeds_t(fname, id.size, published_));
+      LOG_INFO(std::string(published_ ? "Mapped" : "Loaded") +
+               " real time speeds: count = " + std::to_string(speeds->size()));
+    }
+    catch (const std::exception& e) {
+      LOG_ERROR("Failed to read real time speeds " + fname + ": " + e.what());
+      speeds.reset();
+    }
+  }
+  const speeds_t& result = speeds ? *speeds : kNoSpeeds;
+  tiles_.emplace(tileid, std::move(speeds));
+  return result;
+}
+
+const std::string& TrafficSpeeds::Generation::speeds_dir() const {
+  return speeds_dir_;
+}
+
+bool TrafficSpeeds::Generation::Changed() const {
+  if (published_) {
+    return false;
+  }
+  std::lock_guard<std::mutex> guard(lock_);
+  for (const auto& file : files_) {
+    file_id_t id = file_id(speeds_dir_ + std::to_string(file.first) + ".spd");
+    if (id.inode != file.second.inode || id.mtime != file.second.mtime ||
+        id.mtime_nsec != file.second.mtime_nsec || id.size != file.second.size) {
+      return true;
+    }
+  }
+  return false;
+}
+
+TrafficSpeeds::Generation::file_id_t TrafficSpeeds::Generation::file_id(
+                const std::string& fname) {
+  struct stat s;
+  if (stat(fname.c_str(), &s) != 0) {
+    return {0, 0, 0, 0};
+  }
+  return {s.st_ino, s.st_mtim.tv_sec, s.st_mtim.tv_nsec, s.st_size};
+}
+
+constexpr uint32_t TrafficSpeeds::kLegacyCheckSecs;
+
+TrafficSpeeds::TrafficSpeeds(const std::string& tile_dir, const uint32_t check_secs)
+    : traffic_dir_(tile_dir + "/traffic/"),
+      check_interval_(std::chrono::seconds(check_secs)),
+      current_(new Generation(traffic_dir_, false)),
+      inode_(0),
+      mtime_(0),
+      mtime_nsec_(0),
+      next_check_(std::chrono::steady_clock::now() + check_interval_) {
+}
+
+std::shared_ptr<TrafficSpeeds> TrafficSpeeds::get_instance(
+                const std::string& tile_dir) {
+  static std::mutex lock;
+  static std::unordered_map<std::string, std::shared_ptr<TrafficSpeeds> > instances;
+  std::lock_guard<std::mutex> guard(lock);
+  auto& instance = instances[tile_dir];
+  if (!instance) {
+    instance.reset(new TrafficSpeeds(tile_dir));
+  }
+  return instance;
+}
+
+// Switch generations if the generation file was replaced (a new inode) or
+// rewritten (a new modification time) since it was last read. Without a
+// generation file take a new copy of the speeds once any of them change,
+// which is checked at most once per check interval and outside of the lock
+// so other routes are not held up by the stats.
+std::shared_ptr<const TrafficSpeeds::Generation> TrafficSpeeds::Current() {
+  struct stat s;
+  ino_t inode = 0;
+  time_t mtime = 0;
+  long mtime_nsec = 0;
+  std::string fname = traffic_dir_ + kGenerationFile;
+  if (stat(fname.c_str(), &s) == 0) {
+    inode = s.st_ino;
+    mtime = s.st_mtim.tv_sec;
+    mtime_nsec = s.st_mtim.tv_nsec;
+  }
+
+  std::unique_lock<std::mutex> guard(lock_);
+  if (inode == inode_ && mtime == mtime_ && mtime_nsec == mtime_nsec_) {
+    auto now = std::chrono::steady_clock::now();
+    if (inode != 0 || now < next_check_) {
+      return current_;
+    }
+    next_check_ = now + check_interval_;
+    auto current = current_;
+    guard.unlock();
+    if (!current->Changed()) {
+      return current;
+    }
+    // Someone else may have switched while we were checking
+    guard.lock();
+    if (current_ != current) {
+      return current_;
+    }
+  }
+
+  // Read the name of the new generation. Without a generation file the
+  // speeds are read straight from the traffic directory
+  std::string speeds_dir = traffic_dir_;
+  if (inode != 0) {
+    std::ifstream file(fname);
+    std::string name;
+    if (!(file >> name) || name.empty()) {
+      // Partially written, keep using what we have and check again later
+      LOG_WARN("Could not read traffic generation from " + fname);
+      return current_;
+    }
+    speeds_dir += name + '/';
+  }
+  LOG_INFO("Using real time speeds from " + speeds_dir);
+
+  current_.reset(new Generation(speeds_dir, inode != 0));
+  inode_ = inode;
+  mtime_ = mtime;
+  mtime_nsec_ = mtime_nsec;
+  return current_;
+}
+
+}
+}
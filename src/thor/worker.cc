@@ -9,12 +9,15 @@
 
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/json_parser.hpp>
+#include <boost/filesystem/operations.hpp>
 #include "midgard/logging.h"
 #include "midgard/constants.h"
 #include "baldr/json.h"
 #include "baldr/geojson.h"
 #include "exception.h"
 
+#include "odin/util.h"
+#include "proto/request.pb.h"
 #include "thor/worker.h"
 #include "thor/isochrone.h"
 #include "tyr/actor.h"
@@ -30,6 +33,20 @@ using namespace valhalla::thor;
 namespace {
   constexpr double kMilePerMeter = 0.000621371;
 
+   //scores are relative to the best scoring edge of the location
+   void normalize_scores(baldr::PathLocation& location) {
+     if(location.edges.empty())
+       return;
+     auto minScoreEdge = *std::min_element (location.edges.begin(), location.edges.end(),
+        [](PathLocation::PathEdge i, PathLocation::PathEdge j)->bool {
+          return i.score < j.score;
+        });
+
+     for(auto& e : location.edges) {
+       e.score -= minScoreEdge.score;
+     }
+   }
+
    std::vector<baldr::PathLocation> store_correlated_locations(const boost::property_tree::ptree& request, const std::vector<baldr::Location>& locations) {
    //we require correlated locations
    std::vector<baldr::PathLocation> correlated;
@@ -41,22 +58,52 @@ namespace {
        break;
        try {
          correlated.emplace_back(PathLocation::FromPtree(locations, *path_location));
+         normalize_scores(correlated.back());
+       }
+       catch (...) {
+         throw valhalla_exception_t{420};
+       }
+   }while(++i);
+     return correlated;
+   }
 
-         auto minScoreEdge = *std::min_element (correlated.back().edges.begin(), correlated.back().edges.end(),
-            [](PathLocation::PathEdge i, PathLocation::PathEdge j)->bool {
-              return i.score < j.score;
-            });
-
-         for(auto& e : correlated.back().edges) {
-           e.score -= minScoreEdge.score;
+   //correlated locations as sent along by loki in the request envelope
+   std::vector<baldr::PathLocation> store_correlated_locations(const Request& envelope, const std::vector<baldr::Location>& locations) {
+     std::vector<baldr::PathLocation> correlated;
+     correlated.reserve(envelope.correlated_size());
+     for(const auto& path_location : envelope.correlated()) {
+       try {
+         correlated.emplace_back(locations.at(path_location.location_index()));
+         auto& edges = correlated.back().edges;
+         edges.reserve(path_location.edges_size());
+         for(const auto& edge : path_location.edges()) {
+           edges.emplace_back(GraphId(edge.graph_id()), edge.dist(), midgard::PointLL(edge.lon(), edge.lat()),
+             edge.score(), static_cast<PathLocation::SideOfStreet>(edge.sos()), edge.minimum_reachability());
          }
+         normalize_scores(correlated.back());
        }
        catch (...) {
          throw valhalla_exception_t{420};
        }
-   }while(++i);
+     }
      return correlated;
    }
+
+   //what odin needs to narrate and serialize the legs we send it
+   std::string serialize_request(ACTION_TYPE action, const boost::property_tree::ptree& request) {
+     Request envelope;
+     envelope.set_action(action);
+     auto id = request.get_optional<std::string>("id");
+     if(id)
+       envelope.set_id(*id);
+     auto jsonp = request.get_optional<std::string>("jsonp");
+     if(jsonp)
+       envelope.set_jsonp(*jsonp);
+     auto options = request.get_child_optional("directions_options");
+     if(options)
+       *envelope.mutable_directions_options() = odin::GetDirectionsOptions(*options);
+     return envelope.SerializeAsString();
+   }
 }
 
 namespace valhalla {
@@ -100,14 +147,60 @@ namespace valhalla {
         }
       }
 
+      // Graph readers for the extra threads that compute matrices and the
+      // legs of routes
+      auto matrix_concurrency = config.get<unsigned int>("thor.matrix_concurrency", 1);
+      for (unsigned int i = 1; i < matrix_concurrency; ++i) {
+        matrix_readers.emplace_back(new baldr::GraphReader(config.get_child("mjolnir")));
+      }
+
+      // Contraction hierarchy for auto routes if one was built with the tiles
+      auto contraction_file = baldr::ContractionHierarchy::FileName(
+          config.get<std::string>("mjolnir.tile_dir", ""));
+      if (boost::filesystem::exists(contraction_file)) {
+        auto hierarchy = std::make_shared<const baldr::ContractionHierarchy>(contraction_file);
+        if (hierarchy->Matches(reader)) {
+          contraction_hierarchy = hierarchy;
+          contraction.set_hierarchy(contraction_hierarchy);
+        } else {
+          LOG_WARN(contraction_file + " was built from other tiles and will not be used");
+        }
+      }
+      use_contraction = false;
+
+      // Search state for each thread that routes legs, including this one
+      if (!matrix_readers.empty()) {
+        for (size_t i = 0; i <= matrix_readers.size(); ++i) {
+          leg_searchers.emplace_back(new leg_searcher_t());
+          if (contraction.has_hierarchy()) {
+            leg_searchers.back()->contraction.set_hierarchy(contraction_hierarchy);
+          }
+        }
+      }
+
+      // The isochrone sweep is laid out once as it covers the whole hierarchy
+      if (contraction.has_hierarchy() &&
+          config.get<std::string>("thor.isochrone_algorithm", "") == "phast") {
+        isochrone_sweep = std::make_shared<const Phast>(contraction_hierarchy);
+      }
+
       if (conf_algorithm == "timedistancematrix") {
         source_to_target_algorithm = TIME_DISTANCE_MATRIX;
       } else if (conf_algorithm == "costmatrix") {
         source_to_target_algorithm = COST_MATRIX;
+      } else if (conf_algorithm == "phast") {
+        source_to_target_algorithm = PHAST;
       } else {
         source_to_target_algorithm = SELECT_OPTIMAL;
       }
 
+      // Select the optimized route solver (defaults to simulated annealing)
+      if (config.get<std::string>("thor.tour_algorithm", "") == "local_search") {
+        tour_algorithm = LOCAL_SEARCH;
+      } else {
+        tour_algorithm = ANNEALING;
+      }
+
       interrupt_callback = nullptr;
     }
 
@@ -123,10 +216,11 @@ namespace valhalla {
       try{
         //get some info about what we need to do
         boost::property_tree::ptree request;
-        std::string request_str(static_cast<const char*>(job.front().data()), job.front().size());
-        std::stringstream stream(request_str);
         boost::optional<std::string> jsonp;
         try {
+          if(!envelope.ParseFromArray(job.front().data(), static_cast<int>(job.front().size())))
+            throw std::runtime_error("Failed to parse request envelope");
+          std::stringstream stream(envelope.options());
           boost::property_tree::read_json(stream, request);
           jsonp = request.get_optional<std::string>("jsonp");
         }
@@ -145,12 +239,33 @@ namespace valhalla {
         //flag healthcheck requests; do not send to logstash
         healthcheck = request.get<bool>("healthcheck", false);
         // Initialize request - get the PathALgorithm to use
-        ACTION_TYPE action = static_cast<ACTION_TYPE>(request.get<int>("action"));
+        ACTION_TYPE action = static_cast<ACTION_TYPE>(envelope.action());
         boost::optional<int> date_time_type = request.get_optional<int>("date_time.type");
         // Allow the request to be aborted
         astar.set_interrupt(&interrupt);
         bidir_astar.set_interrupt(&interrupt);
         multi_modal_astar.set_interrupt(&interrupt);
+        contraction.set_interrupt(&interrupt);
+        // Every thread routing legs checks the interrupt
+        leg_interruption = nullptr;
+        leg_interrupt = [this, &interrupt]() {
+          std::lock_guard<std::mutex> guard(leg_interrupt_lock);
+          if (leg_interruption) {
+            std::rethrow_exception(leg_interruption);
+          }
+          try {
+            interrupt();
+          }
+          catch(...) {
+            leg_interruption = std::current_exception();
+            throw;
+          }
+        };
+        for (auto& searcher : leg_searchers) {
+          searcher->astar.set_interrupt(&leg_interrupt);
+          searcher->bidir_astar.set_interrupt(&leg_interrupt);
+          searcher->contraction.set_interrupt(&leg_interrupt);
+        }
 
         worker_t::result_t result{true};
         double denominator = 0;
@@ -165,8 +280,8 @@ namespace valhalla {
             denominator = correlated_s.size() * correlated_t.size();
             break;
           case OPTIMIZED_ROUTE:
-            // Forward the original request
-            result.messages.emplace_back(std::move(request_str));
+            // Forward what odin needs from the request
+            result.messages.emplace_back(serialize_request(action, request));
             for (auto& trippath : optimized_route(request)) {
               for (auto& location : *trippath.mutable_location())
                 location.set_original_index(optimal_order[order_index++]);
@@ -181,15 +296,15 @@ namespace valhalla {
             break;
           case ROUTE:
           case VIAROUTE:
-            // Forward the original request
-            result.messages.emplace_back(std::move(request_str));
+            // Forward what odin needs from the request
+            result.messages.emplace_back(serialize_request(action, request));
             for (const auto& trippath : route(request, date_time_type))
               result.messages.emplace_back(trippath.SerializeAsString());
             denominator = correlated.size();
             break;
           case TRACE_ROUTE:
-            // Forward the original request
-            result.messages.emplace_back(std::move(request_str));
+            // Forward what odin needs from the request
+            result.messages.emplace_back(serialize_request(action, request));
             result.messages.emplace_back(trace_route(request).SerializeAsString());
             denominator = shape.size() / 1100;
             break;
@@ -266,10 +381,16 @@ namespace valhalla {
         mode_costing[3] = get_costing(request, "transit");
         mode = valhalla::sif::TravelMode::kPedestrian;
       } else {
+        costing_options = request.get_child("costing_options." + costing, {});
         valhalla::sif::cost_ptr_t cost = get_costing(request, costing);
         mode = cost->travel_mode();
         mode_costing[static_cast<uint32_t>(mode)] = cost;
       }
+
+      // The contraction hierarchy only has the costs of the default auto
+      // costing (avoids are passed along as costing options too)
+      auto auto_options = request.get_child_optional("costing_options.auto");
+      use_contraction = costing == "auto" && (!auto_options || auto_options->empty());
       valhalla::midgard::logging::Log("travel_mode::" + std::to_string(static_cast<uint32_t>(mode)), " [ANALYTICS] ");
       return costing;
     }
@@ -284,7 +405,8 @@ namespace valhalla {
           try{ locations.push_back(baldr::Location::FromPtree(location.second)); }
           catch (...) { throw valhalla_exception_t{421}; }
         }
-        correlated = store_correlated_locations(request, locations);
+        correlated = envelope.correlated_size() ? store_correlated_locations(envelope, locations) :
+                                                  store_correlated_locations(request, locations);
       }//if we have a sources and targets request here we will divy up the correlated amongst them
       else if(request_sources && request_targets) {
         for(const auto& s : *request_sources) {
@@ -295,7 +417,8 @@ namespace valhalla {
           try{ locations.push_back(baldr::Location::FromPtree(t.second)); }
           catch (...) { throw valhalla_exception_t{423}; }
         }
-        correlated = store_correlated_locations(request, locations);
+        correlated = envelope.correlated_size() ? store_correlated_locations(envelope, locations) :
+                                                  store_correlated_locations(request, locations);
 
         correlated_s.insert(correlated_s.begin(), correlated.begin(), correlated.begin() + request_sources->size());
         correlated_t.insert(correlated_t.begin(), correlated.begin() + request_sources->size(), correlated.end());
@@ -384,15 +507,24 @@ namespace valhalla {
       astar.Clear();
       bidir_astar.Clear();
       multi_modal_astar.Clear();
+      contraction.Clear();
+      for (auto& searcher : leg_searchers) {
+        searcher->astar.Clear();
+        searcher->bidir_astar.Clear();
+        searcher->contraction.Clear();
+      }
       locations.clear();
       shape.clear();
       correlated.clear();
       correlated_s.clear();
       correlated_t.clear();
+      envelope.Clear();
       isochrone_gen.Clear();
       matcher_factory.ClearFullCache();
-      if(reader.OverCommitted())
-        reader.Clear();
+      reader.Trim();
+      for (auto& matrix_reader : matrix_readers) {
+        matrix_reader->Trim();
+      }
     }
 
   }
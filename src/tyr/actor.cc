@@ -24,6 +24,13 @@ namespace {
     return pt;
   }
 
+  //the in process thor reads the locations loki correlated from the request
+  boost::property_tree::ptree to_ptree(rapidjson::Document& rj, const std::vector<baldr::PathLocation>& correlated) {
+    for(size_t i = 0; i < correlated.size(); ++i)
+      rapidjson::Pointer("/correlated_" + std::to_string(i)).Set(rj, correlated[i].ToRapidJson(i, rj.GetAllocator()));
+    return to_ptree(rj);
+  }
+
   //TODO: delete this and move everything to rapidjson
   boost::property_tree::ptree to_ptree(const std::string str) {
     std::stringstream ss;
@@ -67,7 +74,7 @@ namespace valhalla {
       pimpl->loki_worker.route(request);
       //route between the locations in the graph to find the best path
       auto date_time_type = GetOptionalFromRapidJson<int>(request, "/date_time.type");
-      auto request_pt = to_ptree(request);
+      auto request_pt = to_ptree(request, pimpl->loki_worker.correlated_locations());
       auto legs = pimpl->thor_worker.route(request_pt, date_time_type);
       //get some directions back from them
       auto directions = pimpl->odin_worker.narrate(request_pt, legs);
@@ -93,12 +100,9 @@ namespace valhalla {
       auto request = to_document(request_str);
       //check the request and locate the locations in the graph
       pimpl->loki_worker.matrix(action, request);
-      auto request_pt = to_ptree(request);
+      auto request_pt = to_ptree(request, pimpl->loki_worker.correlated_locations());
       //compute the matrix
-      auto json = pimpl->thor_worker.matrix(action, request_pt);
-      std::stringstream ss;
-      ss << *json;
-      return ss.str();
+      return pimpl->thor_worker.matrix(action, request_pt);
     }
 
     std::string actor_t::optimized_route(const std::string& request_str) {
@@ -106,7 +110,7 @@ namespace valhalla {
       auto request = to_document(request_str);
       //check the request and locate the locations in the graph
       pimpl->loki_worker.matrix(OPTIMIZED_ROUTE, request);
-      auto request_pt = to_ptree(request);
+      auto request_pt = to_ptree(request, pimpl->loki_worker.correlated_locations());
       //compute compute all pairs and then the shortest path through them all
       auto legs = pimpl->thor_worker.optimized_route(request_pt);
       //get some directions back from them
@@ -123,7 +127,7 @@ namespace valhalla {
       auto request = to_document(request_str);
       //check the request and locate the locations in the graph
       pimpl->loki_worker.isochrones(request);
-      auto request_pt = to_ptree(request);
+      auto request_pt = to_ptree(request, pimpl->loki_worker.correlated_locations());
       //compute the isochrones
       auto json = pimpl->thor_worker.isochrones(request_pt);
       std::stringstream ss;
@@ -137,7 +141,7 @@ namespace valhalla {
       //check the request and locate the locations in the graph
       pimpl->loki_worker.trace(TRACE_ROUTE, request);
       //route between the locations in the graph to find the best path
-      auto request_pt = to_ptree(request);
+      auto request_pt = to_ptree(request, pimpl->loki_worker.correlated_locations());
       std::list<TripPath> legs{pimpl->thor_worker.trace_route(request_pt)};
       //get some directions back from them
       auto directions = pimpl->odin_worker.narrate(request_pt, legs);
@@ -154,7 +158,7 @@ namespace valhalla {
       //check the request and locate the locations in the graph
       pimpl->loki_worker.trace(TRACE_ATTRIBUTES, request);
       //get the path and turn it into attribution along it
-      auto request_pt = to_ptree(request);
+      auto request_pt = to_ptree(request, pimpl->loki_worker.correlated_locations());
       auto json = pimpl->thor_worker.trace_attributes(request_pt);
       std::stringstream ss;
       ss << *json;
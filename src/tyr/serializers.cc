@@ -1251,11 +1251,16 @@ namespace valhalla {
       if(options)
         directions_options = valhalla::odin::GetDirectionsOptions(*options);
 
+      return serializeDirections(action, request.get_optional<std::string>("id"), directions_options, legs);
+    }
+
+    json::MapPtr serializeDirections(ACTION_TYPE action, const boost::optional<std::string>& id,
+        const valhalla::odin::DirectionsOptions& directions_options, const std::list<TripDirections>& legs) {
       //serialize them
       if(action == VIAROUTE)
         return osrm_serializers::serialize(directions_options, legs);
       else
-        return valhalla_serializers::serialize(request.get_optional<std::string>("id"), directions_options, legs);
+        return valhalla_serializers::serialize(id, directions_options, legs);
     }
 
     void jsonToProtoRoute (const std::string& json_route, Route& proto_route) {
@@ -110,6 +110,75 @@ int Benchmark(const uint32_t n, const float maxcost,
   return 0;
 }
 
+/**
+ * Benchmark of decreasing costs within the adjacency list. Adds labels with
+ * random costs, then decreases the cost of a random subset of them before
+ * removing them all. Path algorithms decrease labels whenever a shorter path
+ * to an edge already in the adjacency list is found, so this should stay
+ * close to the cost of the add/remove benchmark.
+ */
+int BenchmarkDecrease(const uint32_t n, const uint32_t ndecrease,
+                      const float maxcost, const float bucketsize) {
+  // Create a set of random costs and random labels to decrease
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_real_distribution<> dis(0, 1);
+  std::vector<float> costs(n);
+  for (uint32_t i = 0; i < n; i++) {
+    costs[i] = static_cast<uint32_t>(dis(gen) * maxcost);
+  }
+  std::vector<std::pair<uint32_t, float>> decreases(ndecrease);
+  for (auto& d : decreases) {
+    d.first = static_cast<uint32_t>(dis(gen) * (n - 1));
+    d.second = static_cast<uint32_t>(dis(gen) * maxcost);
+  }
+
+  // Set the bucket maxcost such that the overflow bucket is used and
+  // some decreases move labels out of it
+  const auto edgecost = [&costs](const uint32_t label) {
+    return costs[label];
+  };
+  std::clock_t start = std::clock();
+  DoubleBucketQueue adjlist(0, maxcost / 2, bucketsize, edgecost);
+  for (uint32_t i = 0; i < n; i++) {
+    adjlist.add(i, costs[i]);
+  }
+
+  // Only decrease to lower costs, as the path algorithms do
+  uint32_t decreased = 0;
+  for (const auto& d : decreases) {
+    if (d.second < costs[d.first]) {
+      adjlist.decrease(d.first, d.second);
+      costs[d.first] = d.second;
+      decreased++;
+    }
+  }
+
+  // Remove all labels and make sure they come out in (bucket) order
+  uint32_t count = 0;
+  uint32_t unordered = 0;
+  float prevcost = 0.0f;
+  while (true) {
+    uint32_t idx = adjlist.pop();
+    if (idx == kInvalidLabel) {
+      break;
+    }
+    if (costs[idx] + bucketsize <= prevcost) {
+      unordered++;
+    }
+    prevcost = costs[idx];
+    count++;
+  }
+  uint32_t ms = (std::clock() - start) / static_cast<double>(CLOCKS_PER_SEC / 1000);
+  LOG_INFO("Bucketed Adj. List: Added " + std::to_string(n) + ", decreased " +
+           std::to_string(decreased) + " and removed " + std::to_string(count) +
+           " edgelabels in " + std::to_string(ms) + " ms");
+  if (unordered > 0) {
+    LOG_INFO(std::to_string(unordered) + " labels removed out of order");
+  }
+  return 0;
+}
+
 int main(int argc, char *argv[]) {
 
   bpo::options_description options(
@@ -150,6 +219,10 @@ int main(int argc, char *argv[]) {
 
   // Benchmark with count, maxcost, and bucketsize
   Benchmark(1000000, 50000, 1);
+
+  // Benchmark decreasing costs with count, decrease count, maxcost, and
+  // bucketsize
+  BenchmarkDecrease(1000000, 500000, 50000, 1);
   LOG_INFO("Done Benchmark!");
 
   return EXIT_SUCCESS;
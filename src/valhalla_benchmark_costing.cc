@@ -0,0 +1,129 @@
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include "baldr/directededge.h"
+#include "baldr/double_bucket_queue.h"
+#include "baldr/graphconstants.h"
+#include "baldr/graphid.h"
+#include "baldr/nodeinfo.h"
+#include "midgard/logging.h"
+#include "sif/concretecost.h"
+#include "sif/edgelabel.h"
+
+using namespace valhalla::baldr;
+using namespace valhalla::sif;
+
+namespace {
+
+// Random edges with access for every mode so that most of them make it
+// through the access checks and get costed the way an expansion would
+struct edges_t {
+  std::vector<DirectedEdge> edges;
+  std::vector<NodeInfo> nodes;
+  std::vector<EdgeLabel> preds;
+};
+
+edges_t random_edges(const uint32_t count, std::mt19937& generator) {
+  std::uniform_int_distribution<uint32_t> length(10, 2000);
+  std::uniform_int_distribution<uint32_t> speed(10, 120);
+  std::uniform_int_distribution<uint32_t> index(0, 7);
+  std::uniform_int_distribution<uint32_t> density(0, 15);
+  std::uniform_int_distribution<uint32_t> roadclass(0, 7);
+  std::uniform_int_distribution<uint32_t> grade(0, 15);
+  edges_t random;
+  random.edges.resize(count);
+  random.nodes.resize(count);
+  random.preds.reserve(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    auto& edge = random.edges[i];
+    edge.set_length(length(generator));
+    edge.set_speed(speed(generator));
+    edge.set_truck_speed(edge.speed());
+    edge.set_density(density(generator));
+    edge.set_weighted_grade(grade(generator));
+    edge.set_classification(static_cast<RoadClass>(roadclass(generator)));
+    edge.set_use(Use::kRoad);
+    edge.set_surface(Surface::kPavedSmooth);
+    edge.set_localedgeidx(index(generator));
+    edge.set_all_forward_access();
+    edge.set_reverseaccess(kAllAccess);
+    for (uint32_t j = 0; j < 8; ++j) {
+      edge.set_stopimpact(j, index(generator) % 5);
+      edge.set_turntype(j, static_cast<Turn::Type>(index(generator)));
+    }
+    random.nodes[i].set_access(kAllAccess);
+    random.nodes[i].set_edge_count(index(generator) + 1);
+  }
+  // Each edge is expanded from the one before it
+  for (uint32_t i = 0; i < count; ++i) {
+    const auto& pred = random.edges[(i + count - 1) % count];
+    random.preds.emplace_back(kInvalidLabel, GraphId(0, 2, i), &pred, Cost(), 0.0f, 0.0f,
+                              TravelMode::kDrive, 0);
+  }
+  return random;
+}
+
+// What a forward expansion does with each edge it comes across
+template <class cost_t>
+double expand(const ConcreteCost<cost_t>& costing, const edges_t& random, const uint32_t passes,
+              float& total) {
+  const GraphTile* tile = nullptr;
+  auto start = std::chrono::high_resolution_clock::now();
+  for (uint32_t pass = 0; pass < passes; ++pass) {
+    for (size_t i = 0; i < random.edges.size(); ++i) {
+      const DirectedEdge* edge = &random.edges[i];
+      const NodeInfo* node = &random.nodes[i];
+      GraphId edgeid(0, 2, i);
+      if (!costing.Allowed(node) ||
+          !costing.Allowed(edge, random.preds[i], tile, edgeid)) {
+        continue;
+      }
+      Cost cost = costing.EdgeCost(edge) + costing.TransitionCost(edge, node, random.preds[i]);
+      total += cost.cost;
+    }
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::high_resolution_clock::now() - start;
+  return elapsed.count() / (static_cast<double>(passes) * random.edges.size());
+}
+
+// Expand the same edges through the vtable and through the concrete class
+template <class cost_t>
+void compare(const std::string& name, const cost_ptr_t& costing, const edges_t& random,
+             const uint32_t passes) {
+  if (GetConcreteCosting(costing.get()) == ConcreteCosting::kDynamic)
+    throw std::logic_error(name + " costing has no concrete expansion");
+  float dynamic_total = 0.0f, concrete_total = 0.0f;
+  auto dynamic = expand(ConcreteCost<DynamicCost>(costing.get()), random, passes, dynamic_total);
+  auto concrete = expand(ConcreteCost<cost_t>(costing.get()), random, passes, concrete_total);
+  if (std::abs(dynamic_total - concrete_total) > 1e-4f * std::abs(dynamic_total))
+    throw std::logic_error(name + " concrete costs differ from the dynamic costs");
+  LOG_INFO(name + ": dynamic " + std::to_string(dynamic) + "ns, concrete " + std::to_string(concrete) +
+           "ns per expansion (" + std::to_string(100.0 * (dynamic - concrete) / dynamic) + "% faster)");
+}
+
+}
+
+int main(int argc, char** argv) {
+  // Usage: valhalla_benchmark_costing [edges] [passes]
+  uint32_t count = argc > 1 ? std::stoul(argv[1]) : 4096;
+  uint32_t passes = argc > 2 ? std::stoul(argv[2]) : 1000;
+
+  std::mt19937 generator(17);
+  auto random = random_edges(count, generator);
+
+  boost::property_tree::ptree config;
+  compare<AutoCost>("auto", CreateAutoCost(config), random, passes);
+  compare<TruckCost>("truck", CreateTruckCost(config), random, passes);
+  compare<BicycleCost>("bicycle", CreateBicycleCost(config), random, passes);
+  compare<PedestrianCost>("pedestrian", CreatePedestrianCost(config), random, passes);
+
+  return EXIT_SUCCESS;
+}
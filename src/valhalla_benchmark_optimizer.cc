@@ -0,0 +1,103 @@
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "midgard/logging.h"
+#include "thor/optimizer.h"
+
+using namespace valhalla::thor;
+
+namespace {
+
+// Random locations in a square. Costs are the distances between them, made
+// a bit different in each direction the way one way streets and turns do
+std::vector<float> random_costs(const uint32_t count, std::mt19937& generator) {
+  std::uniform_real_distribution<float> coordinate(0.0f, 10000.0f);
+  std::uniform_real_distribution<float> direction(1.0f, 1.3f);
+  std::vector<std::pair<float, float> > points(count);
+  for (auto& point : points)
+    point = std::make_pair(coordinate(generator), coordinate(generator));
+  std::vector<float> costs(count * count, 0.0f);
+  for (uint32_t i = 0; i < count; ++i) {
+    for (uint32_t j = 0; j < count; ++j) {
+      if (i != j)
+        costs[i * count + j] = std::hypot(points[i].first - points[j].first,
+                                          points[i].second - points[j].second) * direction(generator);
+    }
+  }
+  return costs;
+}
+
+// A cost matrix from a file: the number of locations followed by the costs
+// from each location to every location, for example the times of a matrix
+// request
+std::vector<float> read_costs(const std::string& file_name, uint32_t& count) {
+  std::ifstream file(file_name);
+  if (!(file >> count))
+    throw std::runtime_error("Could not read the location count from " + file_name);
+  std::vector<float> costs(count * count);
+  for (auto& cost : costs) {
+    if (!(file >> cost))
+      throw std::runtime_error("Could not read " + std::to_string(count * count) + " costs from " + file_name);
+  }
+  return costs;
+}
+
+float tour_cost(const uint32_t count, const std::vector<float>& costs, const std::vector<uint32_t>& tour) {
+  float cost = 0.0f;
+  for (size_t i = 1; i < tour.size(); ++i)
+    cost += costs[tour[i - 1] * count + tour[i]];
+  return cost;
+}
+
+// Solve with both optimizers and report the tour costs and solve times
+template <typename optimizer_t>
+std::pair<float, double> run(optimizer_t& optimizer, const uint32_t count, const std::vector<float>& costs) {
+  auto start = std::chrono::high_resolution_clock::now();
+  auto tour = optimizer.Solve(count, costs);
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+  return std::make_pair(tour_cost(count, costs, tour), elapsed.count());
+}
+
+void compare(const std::string& name, const uint32_t count, const std::vector<float>& costs) {
+  Optimizer annealing;
+  annealing.Seed(111111);
+  LocalSearchOptimizer local_search;
+  local_search.Seed(111111);
+  auto annealed = run(annealing, count, costs);
+  auto searched = run(local_search, count, costs);
+  LOG_INFO(name + " " + std::to_string(count) + " locations: annealing cost " +
+           std::to_string(annealed.first) + " in " + std::to_string(annealed.second) + "ms, local search cost " +
+           std::to_string(searched.first) + " in " + std::to_string(searched.second) + "ms (" +
+           std::to_string(100.0f * (searched.first - annealed.first) / annealed.first) + "%)");
+}
+
+}
+
+int main(int argc, char** argv) {
+  // Usage: valhalla_benchmark_optimizer [trials] [matrix files...]
+  uint32_t trials = argc > 1 ? std::stoul(argv[1]) : 5;
+
+  // Random matrices of growing size
+  std::mt19937 generator(17);
+  for (uint32_t count : { 10, 20, 50, 100, 200 }) {
+    for (uint32_t trial = 0; trial < trials; ++trial)
+      compare("random", count, random_costs(count, generator));
+  }
+
+  // Cost matrices from real requests
+  for (int i = 2; i < argc; ++i) {
+    uint32_t count;
+    auto costs = read_costs(argv[i], count);
+    compare(argv[i], count, costs);
+  }
+
+  return EXIT_SUCCESS;
+}
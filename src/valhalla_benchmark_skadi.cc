@@ -5,13 +5,22 @@
 #include <utility>
 #include <thread>
 #include <chrono>
+#include <string>
 
 #include "midgard/logging.h"
 #include "skadi/sample.h"
 
-void get_samples(const valhalla::skadi::sample& sample, const std::list<std::pair<double, double> >& postings, size_t id) {
+void get_samples(const valhalla::skadi::sample& sample, const std::list<std::pair<double, double> >& postings, size_t id, bool batch) {
   LOG_INFO("Thread" + std::to_string(id) + " sampling " + std::to_string(postings.size()) + " postings");
-  auto values = sample.get_all(postings);
+  std::vector<double> values;
+  if(batch) {
+    values = sample.get_all(postings);
+  }
+  else {
+    values.reserve(postings.size());
+    for(const auto& posting : postings)
+      values.push_back(sample.get(posting));
+  }
   size_t no_data_value = 0;
   for(auto v : values)
     no_data_value += v == sample.get_no_data_value();
@@ -30,6 +39,8 @@ int main(int argc, char** argv) {
     thread_count = std::stoul(argv[3]);
   else
     thread_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  //batch samples all of a thread's postings with get_all, single one by one with get
+  bool batch = argc < 5 || std::string(argv[4]) != "single";
 
   LOG_INFO("Loading elevation data");
   valhalla::skadi::sample sample(argv[1]);
@@ -54,11 +65,15 @@ int main(int argc, char** argv) {
   std::list<std::thread> threads;
   size_t id = 0;
   for(const auto& p : postings)
-    threads.emplace_back(get_samples, std::cref(sample), std::cref(p), id++);
+    threads.emplace_back(get_samples, std::cref(sample), std::cref(p), id++, batch);
   for(auto& t : threads)
     t.join();
   std::chrono::duration<double> elapsed = std::chrono::system_clock::now() - start;
-  LOG_INFO(std::to_string(posting_count / elapsed.count()) + " postings per second");
+  LOG_INFO(std::to_string(posting_count / elapsed.count()) + " postings per second " + (batch ? "batched" : "one by one"));
+  auto stats = sample.get_cache_stats();
+  if(stats.hits + stats.misses > 0)
+    LOG_INFO("Compressed tile cache hit rate " + std::to_string(100.0 * stats.hits / (stats.hits + stats.misses)) +
+             "%, " + std::to_string(stats.misses) + " decompressions took " + std::to_string(stats.decompression_seconds) + "s");
 
   return EXIT_SUCCESS;
 }
@@ -305,6 +305,21 @@ namespace valhalla {
     return result;
   }
 
+  worker_t::result_t to_response(const std::string& json, const boost::optional<std::string>& jsonp, http_request_info_t& request_info) {
+    //jsonp callback if need be
+    std::string body;
+    if(jsonp) {
+      body.reserve(jsonp->size() + json.size() + 2);
+      body.append(*jsonp).append(1, '(').append(json).append(1, ')');
+    }
+
+    worker_t::result_t result{false};
+    http_response_t response(200, "OK", jsonp ? body : json, headers_t{CORS, jsonp ? JS_MIME : JSON_MIME});
+    response.from_info(request_info);
+    result.messages.emplace_back(response.to_string());
+    return result;
+  }
+
 #endif
 
 }
@@ -0,0 +1,111 @@
+#include "test.h"
+
+#include "loki/batch_projector.h"
+#include "midgard/constants.h"
+#include "midgard/distanceapproximator.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace valhalla::midgard;
+using namespace valhalla::loki;
+
+namespace {
+
+// Project a point onto one segment at a time
+projection_t reference(const PointLL& p, const std::vector<PointLL>& shape) {
+  float lon_scale = cosf(p.lat() * kRadPerDeg);
+  DistanceApproximator approx(p);
+  projection_t best{std::numeric_limits<float>::max(), PointLL(), 0};
+  for (size_t i = 0; i + 1 < shape.size(); ++i) {
+    const auto& u = shape[i];
+    const auto& v = shape[i + 1];
+    PointLL point;
+    auto bx = v.first - u.first;
+    auto by = v.second - u.second;
+    auto bx2 = bx * lon_scale;
+    auto sq = bx2 * bx2 + by * by;
+    auto scale = (p.lng() - u.lng()) * lon_scale * bx2 + (p.lat() - u.lat()) * by;
+    if (u == v || scale <= 0.f)
+      point = u;
+    else if (scale >= sq)
+      point = v;
+    else {
+      scale /= sq;
+      point = PointLL(u.first + bx * scale, u.second + by * scale);
+    }
+    auto sq_distance = approx.DistanceSquared(point);
+    if (sq_distance < best.sq_distance)
+      best = {sq_distance, point, i};
+  }
+  return best;
+}
+
+void TestMatchesReference() {
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<float> offset(-0.01f, 0.01f);
+  std::uniform_int_distribution<int> repeat(0, 9);
+  for (size_t size = 0; size < 40; ++size) {
+    // Shapes of every length so both the vector loop and the remainder are used,
+    // with some repeated points for zero length segments
+    batch_projector_t projector;
+    std::vector<PointLL> shape;
+    PointLL point(-76.3f, 40.1f);
+    for (size_t i = 0; i < size; ++i) {
+      if (i == 0 || repeat(generator) > 0)
+        point = PointLL(point.lng() + offset(generator), point.lat() + offset(generator));
+      shape.push_back(point);
+      projector.add_shape_point(point);
+    }
+    if (projector.shape_size() != shape.size())
+      throw std::runtime_error("Unexpected shape size");
+
+    std::vector<PointLL> locations;
+    for (int i = 0; i < 5; ++i) {
+      locations.emplace_back(-76.3f + offset(generator) * 5.f, 40.1f + offset(generator) * 5.f);
+      projector.add_location(locations.back());
+    }
+    std::vector<projection_t> closest;
+    projector.project(closest);
+    if (closest.size() != locations.size())
+      throw std::runtime_error("Expected a projection per location");
+    for (size_t i = 0; i < locations.size(); ++i) {
+      auto expected = reference(locations[i], shape);
+      if (closest[i].sq_distance != expected.sq_distance || closest[i].index != expected.index ||
+          (size > 1 && !(closest[i].point == expected.point)))
+        throw std::runtime_error("Batch projection does not match projecting one segment at a time");
+    }
+  }
+}
+
+void TestClear() {
+  batch_projector_t projector;
+  projector.add_location(PointLL(1.f, 1.f));
+  projector.add_shape_point(PointLL(0.f, 0.f));
+  projector.add_shape_point(PointLL(2.f, 0.f));
+  projector.clear_locations();
+  projector.clear_shape();
+  if (projector.location_count() != 0 || projector.shape_size() != 0)
+    throw std::runtime_error("Expected an empty projector");
+
+  // A single point has no segments
+  projector.add_location(PointLL(1.f, 1.f));
+  projector.add_shape_point(PointLL(0.f, 0.f));
+  std::vector<projection_t> closest;
+  projector.project(closest);
+  if (closest.size() != 1 || closest.front().sq_distance != std::numeric_limits<float>::max())
+    throw std::runtime_error("Expected no projection without segments");
+}
+
+}
+
+int main() {
+  test::suite suite("batch_projector");
+
+  suite.test(TEST_CASE(TestMatchesReference));
+  suite.test(TEST_CASE(TestClear));
+
+  return suite.tear_down();
+}
@@ -0,0 +1,507 @@
+#include "test.h"
+
+#include "baldr/contractionhierarchy.h"
+#include "mjolnir/contractionbuilder.h"
+#include "mjolnir/graphtilebuilder.h"
+#include "mjolnir/directededgebuilder.h"
+#include "thor/phast.h"
+#include "thor/costmatrix.h"
+#include "thor/timedistancematrix.h"
+#include "sif/autocost.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <map>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+using namespace valhalla::baldr;
+using namespace valhalla::mjolnir;
+using namespace valhalla::thor;
+
+namespace {
+
+const std::string test_dir = "test/contraction";
+
+constexpr float kUnreached = std::numeric_limits<float>::max();
+
+struct Arc {
+  uint32_t to;
+  float cost;
+};
+using graph_t = std::vector<std::vector<Arc> >;
+
+// Random graph where vertices mostly connect to nearby vertices, like
+// edges of a road network
+graph_t make_graph(const uint32_t vertex_count, std::mt19937& generator) {
+  graph_t graph(vertex_count);
+  std::uniform_int_distribution<int> offset(-8, 8);
+  std::uniform_int_distribution<uint32_t> degree(1, 4);
+  std::uniform_real_distribution<float> cost(1.0f, 100.0f);
+  for (uint32_t from = 0; from < vertex_count; ++from) {
+    for (uint32_t i = degree(generator); i > 0; --i) {
+      uint32_t to = (from + vertex_count + offset(generator)) % vertex_count;
+      if (to != from) {
+        graph[from].push_back({ to, cost(generator) });
+      }
+    }
+  }
+  return graph;
+}
+
+// Plain Dijkstra on the original graph
+std::vector<float> dijkstra(const graph_t& graph, const uint32_t source) {
+  using entry_t = std::pair<float, uint32_t>;
+  std::vector<float> costs(graph.size(), kUnreached);
+  std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t> > queue;
+  costs[source] = 0.0f;
+  queue.emplace(0.0f, source);
+  while (!queue.empty()) {
+    auto next = queue.top();
+    queue.pop();
+    if (next.first > costs[next.second])
+      continue;
+    for (const auto& arc : graph[next.second]) {
+      if (next.first + arc.cost < costs[arc.to]) {
+        costs[arc.to] = next.first + arc.cost;
+        queue.emplace(costs[arc.to], arc.to);
+      }
+    }
+  }
+  return costs;
+}
+
+// Search of one direction of the hierarchy: the cost and the arc that
+// reached each vertex (and the vertex the arc came from)
+struct Search {
+  std::map<uint32_t, float> costs;
+  std::map<uint32_t, std::pair<uint32_t, const ContractionArc*> > arcs;
+};
+
+Search search(const ContractionHierarchy& ch, const uint32_t source,
+              const bool forward) {
+  using entry_t = std::pair<float, uint32_t>;
+  Search result;
+  std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t> > queue;
+  result.costs[source] = 0.0f;
+  queue.emplace(0.0f, source);
+  while (!queue.empty()) {
+    auto next = queue.top();
+    queue.pop();
+    if (next.first > result.costs[next.second])
+      continue;
+    auto arcs = forward ? ch.UpArcs(next.second) : ch.DownArcs(next.second);
+    for (auto arc = arcs.first; arc != arcs.second; ++arc) {
+      if (ch.rank(arc->vertex) <= ch.rank(next.second))
+        throw std::runtime_error("Arc does not lead up the hierarchy");
+      auto cost = result.costs.find(arc->vertex);
+      if (cost == result.costs.end() || next.first + arc->cost < cost->second) {
+        result.costs[arc->vertex] = next.first + arc->cost;
+        result.arcs[arc->vertex] = std::make_pair(next.second, arc);
+        queue.emplace(next.first + arc->cost, arc->vertex);
+      }
+    }
+  }
+  return result;
+}
+
+// Unpack the path found by the searches and check it only uses original
+// arcs with the expected cost
+void check_path(const graph_t& graph, const ContractionHierarchy& ch,
+                const Search& forward, const Search& reverse,
+                const uint32_t source, const uint32_t target,
+                const uint32_t meeting, const float expected) {
+  std::vector<std::pair<uint32_t, const ContractionArc*> > up;
+  for (uint32_t vertex = meeting; vertex != source; ) {
+    auto arc = forward.arcs.at(vertex);
+    up.emplace_back(arc);
+    vertex = arc.first;
+  }
+  std::vector<std::pair<uint32_t, const ContractionArc*> > arcs;
+  for (auto arc = up.rbegin(); arc != up.rend(); ++arc)
+    ch.Unpack(arc->first, arc->second->vertex, *arc->second, arcs);
+  for (uint32_t vertex = meeting; vertex != target; ) {
+    auto arc = reverse.arcs.at(vertex);
+    ch.Unpack(vertex, arc.first, *arc.second, arcs);
+    vertex = arc.first;
+  }
+
+  float cost = 0.0f;
+  uint32_t vertex = source;
+  for (const auto& arc : arcs) {
+    if (arc.second->middle != kInvalidVertex)
+      throw std::runtime_error("Unpacked path has a shortcut");
+    bool found = false;
+    for (const auto& original : graph[vertex])
+      found = found || (original.to == arc.first && original.cost == arc.second->cost);
+    if (!found)
+      throw std::runtime_error("Unpacked path has an arc that is not in the graph");
+    cost += arc.second->cost;
+    vertex = arc.first;
+  }
+  if (vertex != target || std::fabs(cost - expected) > 0.01f)
+    throw std::runtime_error("Unpacked path does not match the shortest path");
+}
+
+void TestShortestPaths() {
+  boost::filesystem::remove_all(test_dir);
+  boost::filesystem::create_directories(test_dir);
+
+  std::mt19937 generator(11);
+  const uint32_t vertex_count = 2000;
+  auto graph = make_graph(vertex_count, generator);
+  Contractor contractor(vertex_count);
+  for (uint32_t from = 0; from < vertex_count; ++from)
+    for (const auto& arc : graph[from])
+      contractor.AddArc(from, arc.to, arc.cost, arc.cost * 2.0f,
+                        static_cast<uint32_t>(arc.cost * 10.0f));
+  contractor.Contract();
+
+  // Split the vertices over two tiles
+  std::vector<ContractionTile> tiles = {
+    { GraphId(5, 0, 0).value, 0, 1500 },
+    { GraphId(17, 2, 0).value, 1500, 500 }
+  };
+  std::string file_name = ContractionHierarchy::FileName(test_dir);
+  contractor.Write(file_name, tiles);
+  ContractionHierarchy ch(file_name);
+  if (ch.empty() || ch.vertex_count() != vertex_count)
+    throw std::runtime_error("Unexpected vertex count");
+
+  // Every pair the search compares has to match Dijkstra
+  std::uniform_int_distribution<uint32_t> random_vertex(0, vertex_count - 1);
+  for (int i = 0; i < 50; ++i) {
+    uint32_t source = random_vertex(generator);
+    auto expected = dijkstra(graph, source);
+    Search forward = search(ch, source, true);
+    for (int j = 0; j < 20; ++j) {
+      uint32_t target = random_vertex(generator);
+      Search reverse = search(ch, target, false);
+      float best = kUnreached;
+      uint32_t meeting = kInvalidVertex;
+      for (const auto& cost : forward.costs) {
+        auto other = reverse.costs.find(cost.first);
+        if (other != reverse.costs.end() && cost.second + other->second < best) {
+          best = cost.second + other->second;
+          meeting = cost.first;
+        }
+      }
+      if (expected[target] == kUnreached) {
+        if (best != kUnreached)
+          throw std::runtime_error("Found a path where there is none");
+        continue;
+      }
+      if (std::fabs(best - expected[target]) > 0.01f)
+        throw std::runtime_error("Path cost does not match Dijkstra");
+      check_path(graph, ch, forward, reverse, source, target, meeting, best);
+    }
+  }
+
+  boost::filesystem::remove_all(test_dir);
+}
+
+void TestSweep() {
+  boost::filesystem::remove_all(test_dir);
+  boost::filesystem::create_directories(test_dir);
+
+  std::mt19937 generator(17);
+  const uint32_t vertex_count = 2000;
+  auto graph = make_graph(vertex_count, generator);
+  Contractor contractor(vertex_count);
+  for (uint32_t from = 0; from < vertex_count; ++from)
+    for (const auto& arc : graph[from])
+      contractor.AddArc(from, arc.to, arc.cost, arc.cost * 2.0f, 1);
+  contractor.Contract();
+  std::vector<ContractionTile> tiles = { { GraphId(5, 0, 0).value, 0, vertex_count } };
+  std::string file_name = ContractionHierarchy::FileName(test_dir);
+  contractor.Write(file_name, tiles);
+  auto ch = std::make_shared<const ContractionHierarchy>(file_name);
+
+  // A sweep over all vertices and one restricted to some targets
+  std::uniform_int_distribution<uint32_t> random_vertex(0, vertex_count - 1);
+  std::vector<uint32_t> targets;
+  for (int i = 0; i < 30; ++i)
+    targets.push_back(random_vertex(generator));
+  Phast all(ch);
+  Phast restricted = all.Restrict(targets);
+  if (all.size() != vertex_count || restricted.size() >= vertex_count)
+    throw std::runtime_error("Unexpected sweep size");
+
+  std::vector<Phast::Label> labels, restricted_labels;
+  for (int i = 0; i < 20; ++i) {
+    uint32_t source = random_vertex(generator);
+    auto expected = dijkstra(graph, source);
+    all.Search({ { source, { 0.0f, 0.0f, 0.0f } } }, labels);
+    restricted.Search({ { source, { 0.0f, 0.0f, 0.0f } } }, restricted_labels);
+    for (uint32_t vertex = 0; vertex < vertex_count; ++vertex) {
+      const auto& label = labels[all.index(vertex)];
+      if (expected[vertex] == kUnreached) {
+        if (label.cost != valhalla::thor::kMaxCost)
+          throw std::runtime_error("Sweep reached a vertex that cannot be reached");
+        continue;
+      }
+      if (std::fabs(label.cost - expected[vertex]) > 0.01f ||
+          std::fabs(label.secs - 2.0f * label.cost) > 0.01f)
+        throw std::runtime_error("Sweep cost does not match Dijkstra");
+    }
+    for (auto target : targets) {
+      const auto& label = restricted_labels[restricted.index(target)];
+      if (label.cost != labels[all.index(target)].cost)
+        throw std::runtime_error("Restricted sweep does not match the full sweep");
+    }
+  }
+
+  boost::filesystem::remove_all(test_dir);
+}
+
+void TestVertices() {
+  boost::filesystem::remove_all(test_dir);
+  boost::filesystem::create_directories(test_dir);
+
+  Contractor contractor(30);
+  contractor.AddArc(0, 1, 1.0f, 1.0f, 1);
+  contractor.AddArc(1, 29, 1.0f, 1.0f, 1);
+  contractor.Contract();
+  std::vector<ContractionTile> tiles = {
+    { GraphId(5, 0, 0).value, 0, 10 },
+    { GraphId(17, 2, 0).value, 10, 20 }
+  };
+  std::string file_name = ContractionHierarchy::FileName(test_dir);
+  contractor.Write(file_name, tiles);
+  ContractionHierarchy ch(file_name);
+
+  if (ch.GetVertex(GraphId(5, 0, 3)) != 3 || ch.GetVertex(GraphId(17, 2, 19)) != 29)
+    throw std::runtime_error("Unexpected vertex");
+  if (ch.GetVertex(GraphId(5, 0, 10)) != kInvalidVertex ||
+      ch.GetVertex(GraphId(6, 0, 0)) != kInvalidVertex ||
+      ch.GetVertex(GraphId(17, 1, 0)) != kInvalidVertex)
+    throw std::runtime_error("Expected no vertex");
+  if (!(ch.GetEdgeId(0) == GraphId(5, 0, 0)) || !(ch.GetEdgeId(9) == GraphId(5, 0, 9)) ||
+      !(ch.GetEdgeId(10) == GraphId(17, 2, 0)) || !(ch.GetEdgeId(29) == GraphId(17, 2, 19)))
+    throw std::runtime_error("Unexpected edge id");
+  if (ch.GetTileVertices(GraphId(5, 0, 0)) != std::make_pair(0u, 10u) ||
+      ch.GetTileVertices(GraphId(17, 2, 7)) != std::make_pair(10u, 20u) ||
+      ch.GetTileVertices(GraphId(6, 0, 0)).second != 0)
+    throw std::runtime_error("Unexpected tile vertices");
+
+  ContractionHierarchy none;
+  if (!none.empty() || none.GetVertex(GraphId(5, 0, 3)) != kInvalidVertex)
+    throw std::runtime_error("Expected an empty hierarchy");
+
+  boost::filesystem::remove_all(test_dir);
+}
+
+void TestArcLists() {
+  // Enough arcs that blocks move and the array gets compacted, checked
+  // against a vector per vertex
+  std::mt19937 generator(3);
+  const uint32_t vertex_count = 1000;
+  std::uniform_int_distribution<uint32_t> vertex(0, vertex_count - 1);
+  std::uniform_int_distribution<uint32_t> operation(0, 99);
+  ArcLists lists(vertex_count);
+  std::vector<std::vector<uint32_t> > expected(vertex_count);
+  for (uint32_t i = 0; i < 3000000; ++i) {
+    uint32_t v = vertex(generator);
+    uint32_t op = operation(generator);
+    if (op < 70) {
+      uint32_t other = vertex(generator);
+      lists.Add(v, { other, 1.0f, 1.0f, 1, kInvalidVertex });
+      expected[v].push_back(other);
+    } else if (op < 99) {
+      if (!expected[v].empty()) {
+        uint32_t other = expected[v][operation(generator) % expected[v].size()];
+        lists.Remove(v, other);
+        expected[v].erase(std::find(expected[v].begin(), expected[v].end(), other));
+      }
+    } else {
+      lists.Clear(v);
+      expected[v].clear();
+    }
+  }
+
+  uint64_t count = 0;
+  for (uint32_t v = 0; v < vertex_count; ++v) {
+    std::vector<uint32_t> others;
+    for (const auto& arc : lists[v])
+      others.push_back(arc.vertex);
+    std::sort(others.begin(), others.end());
+    std::sort(expected[v].begin(), expected[v].end());
+    if (others != expected[v])
+      throw std::runtime_error("Unexpected arcs of vertex " + std::to_string(v));
+    count += others.size();
+  }
+  if (lists.arc_count() != count)
+    throw std::runtime_error("Unexpected arc count");
+
+  // Copies of the arcs of a vertex
+  ArcLists copies(vertex_count);
+  copies.Assign(7, lists[3]);
+  if (copies[7].size() != lists[3].size() || copies.arc_count() != lists[3].size())
+    throw std::runtime_error("Expected a copy of the arcs");
+}
+
+}
+
+// Write a tile with a node and the given number of edges
+void write_tile(const GraphId& id, const uint32_t edge_count) {
+  GraphTileBuilder builder(test_dir, id, false);
+  builder.nodes().emplace_back();
+  for (uint32_t i = 0; i < edge_count; ++i)
+    builder.directededges().emplace_back();
+  builder.StoreTileData();
+}
+
+void TestTileFingerprint() {
+  boost::filesystem::remove_all(test_dir);
+  boost::filesystem::create_directories(test_dir);
+  boost::property_tree::ptree pt;
+  pt.put("tile_dir", test_dir);
+
+  // A hierarchy matches the tiles it was built from
+  write_tile(GraphId(5, 0, 0), 2);
+  write_tile(GraphId(17, 2, 0), 3);
+  GraphReader reader(pt);
+  uint64_t fingerprint = ContractionHierarchy::TileFingerprint(reader);
+  Contractor contractor(5);
+  contractor.AddArc(0, 1, 1.0f, 1.0f, 1);
+  contractor.Contract();
+  std::vector<ContractionTile> tiles = {
+    { GraphId(5, 0, 0).value, 0, 2 },
+    { GraphId(17, 2, 0).value, 2, 3 }
+  };
+  std::string file_name = ContractionHierarchy::FileName(test_dir);
+  contractor.Write(file_name, tiles, fingerprint);
+  ContractionHierarchy ch(file_name);
+  if (!ch.Matches(reader))
+    throw std::runtime_error("Hierarchy should match the tiles it was built from");
+
+  // Rebuilt or added tiles do not match
+  write_tile(GraphId(17, 2, 0), 4);
+  GraphReader rebuilt(pt);
+  if (ch.Matches(rebuilt))
+    throw std::runtime_error("Hierarchy should not match a rebuilt tile");
+  write_tile(GraphId(17, 2, 0), 3);
+  write_tile(GraphId(6, 0, 0), 1);
+  GraphReader added(pt);
+  if (ch.Matches(added))
+    throw std::runtime_error("Hierarchy should not match an added tile");
+
+  boost::filesystem::remove_all(test_dir);
+}
+
+// Write a tile with a square of two way roads:
+//
+//   a ---- b
+//   |      |
+//   c ---- d
+//
+// The directed edges leave a (0 to b, 1 to c), b (2 to a, 3 to d),
+// c (4 to a, 5 to d) and d (6 to c, 7 to b) in that order.
+GraphId write_square_tile() {
+  GraphId tile_id = TileHierarchy::GetGraphId({ .125, .125 }, 2);
+  std::vector<valhalla::midgard::PointLL> points = {
+    { 0.01, 0.10 }, { 0.10, 0.10 }, { 0.01, 0.01 }, { 0.10, 0.01 } };
+  // End node, local index of the edge at its node and of its opposing edge
+  std::vector<std::vector<std::array<uint32_t, 3> > > edges = {
+    { { 1, 0, 0 }, { 2, 1, 0 } },
+    { { 0, 0, 0 }, { 3, 1, 1 } },
+    { { 0, 0, 1 }, { 3, 1, 0 } },
+    { { 2, 0, 1 }, { 1, 1, 1 } } };
+
+  GraphTileBuilder tile(test_dir, tile_id, false);
+  for (uint32_t node = 0; node < points.size(); ++node) {
+    for (const auto& e : edges[node]) {
+      GraphId end(tile_id.tileid(), tile_id.level(), e[0]);
+      bool forward = node < e[0];
+      DirectedEdgeBuilder edge({}, end, forward, points[node].Distance(points[e[0]]), 50, 50, 50,
+                               Use::kRoad, RoadClass::kPrimary, e[1], false, 0, 0);
+      edge.set_opp_index(e[2]);
+      edge.set_opp_local_idx(e[2]);
+      edge.set_forwardaccess(kAllAccess);
+      edge.set_reverseaccess(kAllAccess);
+      std::vector<valhalla::midgard::PointLL> shape = { points[node], points[e[0]] };
+      bool added;
+      uint32_t a = std::min(node, e[0]), b = std::max(node, e[0]);
+      edge.set_edgeinfo_offset(tile.AddEdgeInfo(a * 4 + b,
+          GraphId(tile_id.tileid(), tile_id.level(), a), GraphId(tile_id.tileid(), tile_id.level(), b),
+          a * 4 + b, forward ? shape : std::vector<valhalla::midgard::PointLL>(shape.rbegin(), shape.rend()),
+          { std::to_string(a * 4 + b) }, added));
+      tile.directededges().emplace_back(std::move(edge));
+    }
+    NodeInfo nodeinfo;
+    nodeinfo.set_latlng(points[node]);
+    nodeinfo.set_access(kAllAccess);
+    nodeinfo.set_edge_index(node * 2);
+    nodeinfo.set_edge_count(2);
+    tile.nodes().emplace_back(std::move(nodeinfo));
+  }
+  tile.StoreTileData();
+  return tile_id;
+}
+
+void TestMatrixAroundTheBlock() {
+  // A hierarchy of the square
+  boost::filesystem::remove_all(test_dir);
+  boost::filesystem::create_directories(test_dir);
+  GraphId tile_id = write_square_tile();
+  boost::property_tree::ptree pt;
+  pt.put("mjolnir.tile_dir", test_dir);
+  ContractionBuilder::Build(pt);
+  auto ch = std::make_shared<const ContractionHierarchy>(
+      ContractionHierarchy::FileName(test_dir));
+  GraphReader reader(pt.get_child("mjolnir"));
+
+  // Source and target on the edge from a to b, the target behind the
+  // source. Only that direction is used, as on a one way road, so the
+  // path goes around the block.
+  valhalla::midgard::PointLL s(0.0775, 0.10), t(0.0325, 0.10);
+  PathLocation source(s), target(t);
+  source.edges.emplace_back(tile_id, 0.75f, s, 0.0f);
+  target.edges.emplace_back(tile_id, 0.25f, t, 0.0f);
+  std::vector<PathLocation> sources = { source }, targets = { target };
+
+  valhalla::sif::cost_ptr_t costing[static_cast<int>(valhalla::sif::TravelMode::kMaxTravelMode)];
+  auto mode = valhalla::sif::TravelMode::kDrive;
+  costing[static_cast<int>(mode)] = valhalla::sif::CreateAutoCost(boost::property_tree::ptree());
+  PhastMatrix phast_matrix(ch, 1);
+  auto result = phast_matrix.SourceToTarget(sources, targets, reader, costing, mode, 1e7f);
+  CostMatrix cost_matrix;
+  auto cost_result = cost_matrix.SourceToTarget(sources, targets, reader, costing, mode, 1e7f);
+  TimeDistanceMatrix time_distance_matrix;
+  auto time_distance_result = time_distance_matrix.SourceToTarget(
+      sources, targets, reader, costing, mode, 1e7f);
+
+  // Around the block is three sides and a half, the matrices only differ
+  // in how they round
+  if (result.front().dist < 35000 || result.front().dist > 35100)
+    throw std::runtime_error("PHAST matrix should go around the block: " +
+                             std::to_string(result.front().dist) + "m");
+  for (const auto& expected : { cost_result.front(), time_distance_result.front() }) {
+    if (std::abs(static_cast<int>(result.front().time) - static_cast<int>(expected.time)) > 2 ||
+        std::abs(static_cast<int>(result.front().dist) - static_cast<int>(expected.dist)) > 2)
+      throw std::runtime_error("PHAST matrix does not match: " +
+          std::to_string(result.front().time) + "s " + std::to_string(result.front().dist) + "m vs " +
+          std::to_string(expected.time) + "s " + std::to_string(expected.dist) + "m");
+  }
+
+  boost::filesystem::remove_all(test_dir);
+}
+
+int main() {
+  test::suite suite("contraction");
+
+  suite.test(TEST_CASE(TestShortestPaths));
+  suite.test(TEST_CASE(TestSweep));
+  suite.test(TEST_CASE(TestVertices));
+  suite.test(TEST_CASE(TestArcLists));
+  suite.test(TEST_CASE(TestTileFingerprint));
+  suite.test(TEST_CASE(TestMatrixAroundTheBlock));
+
+  return suite.tear_down();
+}
@@ -6,6 +6,7 @@
 
 #include "baldr/datetime.h"
 #include "baldr/graphconstants.h"
+#include "baldr/speedprofile.h"
 
 using namespace std;
 using namespace valhalla::baldr;
@@ -273,6 +274,38 @@ void TestIsoDateTime() {
   TryIsoDateTime();
 }
 
+void TryGetSecondsOfWeek(std::string date_time, uint32_t value) {
+  if (DateTime::seconds_of_week(date_time) != value)
+    throw std::runtime_error("Seconds of week failed for " + date_time + " expected " +
+                             std::to_string(value));
+}
+
+void TestSecondsOfWeek() {
+  // 2017-01-01 is a Sunday
+  TryGetSecondsOfWeek("2017-01-01T00:00", 0);
+  TryGetSecondsOfWeek("2017-01-01T08:30", 30600);
+  TryGetSecondsOfWeek("2017-01-04T17:15", 3 * 86400 + 62100);
+  TryGetSecondsOfWeek("2017-01-07T23:59", 6 * 86400 + 86340);
+  TryGetSecondsOfWeek("2016-07-14T08:00-04:00", 4 * 86400 + 28800);
+  TryGetSecondsOfWeek("1999-01-01T08:00", kInvalidSecondsOfWeek);
+  TryGetSecondsOfWeek("20170101", kInvalidSecondsOfWeek);
+}
+
+void TryOffsetDateTime(std::string date_time, int32_t seconds, std::string value) {
+  std::string result = DateTime::offset_date_time(date_time, seconds);
+  if (result != value)
+    throw std::runtime_error("Offset date time failed for " + date_time + " got " + result +
+                             " expected " + value);
+}
+
+void TestOffsetDateTime() {
+  TryOffsetDateTime("2017-01-01T08:00", 90, "2017-01-01T08:01");
+  TryOffsetDateTime("2017-01-01T08:00", -3600, "2017-01-01T07:00");
+  TryOffsetDateTime("2017-01-01T00:30", -3600, "2016-12-31T23:30");
+  TryOffsetDateTime("2016-07-14T23:00-04:00", 7200, "2016-07-15T01:00");
+  TryOffsetDateTime("1999-01-01T08:00", 60, "");
+}
+
 void TestGetSecondsFromMidnight() {
   TryGetSecondsFromMidnight("00:00:00", 0);
   TryGetSecondsFromMidnight("01:00:00", 3600);
@@ -497,6 +530,8 @@ int main(void) {
   suite.test(TEST_CASE(TestDOW));
   suite.test(TEST_CASE(TestDuration));
   suite.test(TEST_CASE(TestIsoDateTime));
+  suite.test(TEST_CASE(TestSecondsOfWeek));
+  suite.test(TEST_CASE(TestOffsetDateTime));
   suite.test(TEST_CASE(TestServiceDays));
   suite.test(TEST_CASE(TestIsServiceAvailable));
   suite.test(TEST_CASE(TestIsValid));
@@ -55,6 +55,26 @@ namespace {
       throw runtime_error("DirectedEdge stopimpact for localidx 1 test failed");
     }
   }
+
+  void TestReach() {
+    // Reach is unknown until it is set and is capped at kMaxReach
+    DirectedEdge directededge;
+    if (directededge.reach(kAutoAccess) != -1 ||
+        directededge.reach(kPedestrianAccess) != -1) {
+      throw runtime_error("DirectedEdge reach should be unknown by default");
+    }
+    directededge.set_reach(kAutoAccess, 0);
+    directededge.set_reach(kPedestrianAccess, 1000);
+    if (directededge.reach(kAutoAccess) != 0) {
+      throw runtime_error("DirectedEdge auto reach test failed");
+    }
+    if (directededge.reach(kPedestrianAccess) != static_cast<int32_t>(kMaxReach)) {
+      throw runtime_error("DirectedEdge pedestrian reach test failed");
+    }
+    if (directededge.reach(kBicycleAccess) != -1) {
+      throw runtime_error("DirectedEdge reach should not be stored for bicycles");
+    }
+  }
 }
 
 int main(void)
@@ -66,5 +86,7 @@ int main(void)
   // Write to file and read into DirectedEdge
   suite.test(TEST_CASE(TestWriteRead));
 
+  suite.test(TEST_CASE(TestReach));
+
   return suite.tear_down();
 }
@@ -81,6 +81,38 @@ void TestClear() {
    }
 */
 
+void TestDecrease() {
+  std::vector<float> costs = { 67, 325, 25, 466, 1000, 100005, 758, 167,
+                               258, 16442, 278, 111111000 };
+  DoubleBucketQueue adjlist(0, 10000, 5, [&costs](const uint32_t label) {
+      return costs[label];
+    });
+  for (uint32_t i = 0; i < costs.size(); i++) {
+    adjlist.add(i, costs[i]);
+  }
+
+  // Decrease labels within the low level buckets, from the overflow bucket
+  // into the low level buckets and within the overflow bucket. Costs are kept
+  // in separate buckets since order within a bucket is not defined. The queue
+  // reads the old cost so update the cost after the decrease.
+  std::vector<std::pair<uint32_t, float>> decreases = { {3, 30}, {1, 324},
+      {5, 5000}, {11, 20000}, {9, 16400}, {4, 999} };
+  for (const auto& d : decreases) {
+    adjlist.decrease(d.first, d.second);
+    costs[d.first] = d.second;
+  }
+
+  std::vector<float> expected = costs;
+  std::sort(expected.begin(), expected.end());
+  for (auto cost : expected) {
+    uint32_t label = adjlist.pop();
+    if (label == kInvalidLabel || costs[label] != cost)
+      throw runtime_error("TestDecrease: expected order test failed");
+  }
+  if (adjlist.pop() != kInvalidLabel)
+    throw runtime_error("TestDecrease: expected queue to be empty");
+}
+
 void TryRemove(DoubleBucketQueue &dbqueue, size_t num_to_remove, const std::vector<float>& costs)
 {
   auto previous_cost = -std::numeric_limits<float>::infinity();
@@ -199,6 +231,8 @@ int main() {
 
   //  suite.test(TEST_CASE(TestDecreaseCost));
 
+  suite.test(TEST_CASE(TestDecrease));
+
   suite.test(TEST_CASE(TestSimulation));
 
   return suite.tear_down();
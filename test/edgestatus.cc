@@ -54,6 +54,42 @@ void TestStatus() {
   TryGet(edgestatus, GraphId(555, 3, 1), EdgeSet::kUnreached);
 }
 
+void TestReuse() {
+  // Retain few entries so that growing past them releases the arrays
+  EdgeStatus edgestatus(4096);
+
+  // Set edges across tiles and at indexes that need the arrays to grow
+  for (uint32_t i = 0; i < 3; ++i) {
+    edgestatus.Set(GraphId(100, 2, 0), EdgeSet::kTemporary, 1);
+    edgestatus.Set(GraphId(100, 2, 2000), EdgeSet::kTemporary, 2);
+    edgestatus.Update(GraphId(100, 2, 2000), EdgeSet::kPermanent);
+    edgestatus.Update(GraphId(101, 2, 5), EdgeSet::kPermanent);
+    TryGet(edgestatus, GraphId(100, 2, 0), EdgeSet::kTemporary);
+    TryGet(edgestatus, GraphId(100, 2, 2000), EdgeSet::kPermanent);
+    TryGet(edgestatus, GraphId(101, 2, 5), EdgeSet::kPermanent);
+    TryGet(edgestatus, GraphId(100, 1, 0), EdgeSet::kUnreached);
+    TryGet(edgestatus, GraphId(101, 2, 6), EdgeSet::kUnreached);
+    if (edgestatus.Get(GraphId(100, 2, 2000)).index() != 2 ||
+        edgestatus.Get(GraphId(101, 2, 5)).index() != 0)
+      throw runtime_error("EdgeStatus index test failed");
+
+    // Copies are independent of the original
+    EdgeStatus copy = edgestatus;
+    copy.Init();
+    TryGet(copy, GraphId(100, 2, 0), EdgeSet::kUnreached);
+    TryGet(edgestatus, GraphId(100, 2, 0), EdgeSet::kTemporary);
+
+    // Nothing set before Init should be visible after it, whether the arrays
+    // were kept or released
+    edgestatus.Init();
+    TryGet(edgestatus, GraphId(100, 2, 0), EdgeSet::kUnreached);
+    TryGet(edgestatus, GraphId(100, 2, 2000), EdgeSet::kUnreached);
+    TryGet(edgestatus, GraphId(101, 2, 5), EdgeSet::kUnreached);
+    if (i == 1)
+      edgestatus.Set(GraphId(102, 2, 100000), EdgeSet::kPermanent, 3);
+  }
+}
+
 }
 
 int main() {
@@ -62,5 +98,8 @@ int main() {
   // Test setting status, getting status, and clearing
   suite.test(TEST_CASE(TestStatus));
 
+  // Test that status does not leak across Init as the arrays are reused
+  suite.test(TEST_CASE(TestReuse));
+
   return suite.tear_down();
 }
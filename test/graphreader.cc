@@ -59,6 +59,73 @@ void TestCacheLimits() {
     throw std::runtime_error("Cache should be over committed");
 }
 
+void TestCacheLRU() {
+  TileCacheLRU cache(3);
+  GraphTile tile;
+  GraphId a(0, 2, 0), b(1, 2, 0), c(2, 2, 0), d(3, 2, 0);
+  cache.Put(a, tile, 1);
+  cache.Put(b, tile, 1);
+  cache.Put(c, tile, 1);
+  if(cache.OverCommitted())
+    throw std::runtime_error("Cache should be under committed");
+
+  // Using a makes b the least recently used
+  if(!cache.Get(a))
+    throw std::runtime_error("Tile a should be cached");
+  if(cache.Get(d))
+    throw std::runtime_error("Tile d should not be cached");
+  const GraphTile* put = cache.Put(d, tile, 1);
+  if(!cache.OverCommitted())
+    throw std::runtime_error("Cache should be over committed");
+
+  // Trimming should only evict b
+  cache.Trim();
+  if(cache.OverCommitted())
+    throw std::runtime_error("Cache should be under committed after trim");
+  if(cache.Contains(b))
+    throw std::runtime_error("Least recently used tile b should have been evicted");
+  if(!cache.Contains(a) || !cache.Contains(c) || !cache.Contains(d))
+    throw std::runtime_error("Recently used tiles should not have been evicted");
+  if(cache.Get(d) != put)
+    throw std::runtime_error("Cached tiles should not move in memory");
+
+  if(cache.hits() != 2 || cache.misses() != 1 || cache.evictions() != 1)
+    throw std::runtime_error("Wrong cache statistics");
+
+  cache.Clear();
+  if(cache.Contains(a) || cache.OverCommitted())
+    throw std::runtime_error("Cache should be empty");
+}
+
+void TestSharedCache() {
+  // All instances share one store whose size is set by the first
+  SharedTileCache worker_a(2), worker_b(100);
+  GraphTile tile;
+  GraphId a(0, 2, 0), b(1, 2, 0), c(2, 2, 0);
+  const GraphTile* put = worker_a.Put(a, tile, 1);
+  if(worker_b.Get(a) != put || !worker_b.Contains(a))
+    throw std::runtime_error("Tiles should be shared between caches");
+  if(worker_b.Put(a, tile, 1) != put)
+    throw std::runtime_error("Putting a tile twice should give back the first copy");
+
+  // Overfill the store and make sure trimming gets it back under the limit
+  worker_b.Put(b, tile, 1);
+  worker_b.Put(c, tile, 1);
+  if(!worker_a.OverCommitted())
+    throw std::runtime_error("Shared store should be over committed");
+  worker_a.Trim();
+  worker_b.Trim();
+  if(worker_a.OverCommitted() || worker_b.OverCommitted())
+    throw std::runtime_error("Shared store should be under committed after trim");
+  size_t cached = worker_a.Contains(a) + worker_a.Contains(b) + worker_a.Contains(c);
+  if(cached == 0 || cached > 2)
+    throw std::runtime_error("Trim should only have evicted the tiles over the limit");
+
+  worker_b.Clear();
+  if(worker_a.Contains(a) || worker_a.Contains(b) || worker_a.Contains(c))
+    throw std::runtime_error("Shared store should be empty");
+}
+
 void touch_tile(const uint32_t tile_id, const std::string& tile_dir) {
   auto suffix = GraphTile::FileSuffix({tile_id, 2, 0});
   auto fullpath = tile_dir + '/' + suffix;
@@ -136,6 +203,11 @@ int main() {
 
   suite.test(TEST_CASE(TestCacheLimits));
 
+  suite.test(TEST_CASE(TestCacheLRU));
+
+
+  suite.test(TEST_CASE(TestSharedCache));
+
   suite.test(TEST_CASE(TestConnectivityMap));
 
   return suite.tear_down();
@@ -4,6 +4,10 @@
 #include "baldr/graphtile.h"
 
 #include <vector>
+#include <fstream>
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
 
 using namespace valhalla::baldr;
 
@@ -118,6 +122,90 @@ void bin() {
   }
 }
 
+// Write out an otherwise empty tile, optionally gzipped
+void write_tile(const std::string& tile_dir, const GraphId& id, bool gzip = false) {
+  auto path = tile_dir + "/" + GraphTile::FileSuffix(id) + (gzip ? ".gz" : "");
+  boost::filesystem::create_directories(boost::filesystem::path(path).parent_path());
+  GraphTileHeader header;
+  header.set_graphid(id);
+  header.set_end_offset(sizeof(GraphTileHeader));
+  std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+  boost::iostreams::filtering_ostream os;
+  if(gzip)
+    os.push(boost::iostreams::gzip_compressor());
+  os.push(file);
+  os.write(reinterpret_cast<const char*>(&header), sizeof(GraphTileHeader));
+}
+
+void mmap_tile() {
+  std::string tile_dir = "test/graphtile_test";
+  GraphId id(2, 2, 0);
+  write_tile(tile_dir, id);
+
+  // Reading and mapping should give the same tile
+  GraphTile read(tile_dir, id), mapped(tile_dir, id, true);
+  if(!read.header() || !mapped.header())
+    throw std::logic_error("Tile should have been loaded");
+  if(read.id() != id || mapped.id() != id || mapped.header()->end_offset() != read.header()->end_offset())
+    throw std::logic_error("Mapped tile does not match the tile read into memory");
+
+  // Copies share the mapping
+  GraphTile copy = mapped;
+  if(copy.header() != mapped.header())
+    throw std::logic_error("Copies of a mapped tile should share the mapping");
+
+  // Missing tiles are missing either way
+  if(GraphTile(tile_dir, {4, 2, 0}, true).header())
+    throw std::logic_error("Tile should not exist");
+
+  boost::filesystem::remove_all(tile_dir);
+}
+
+void gzipped_tile() {
+  std::string tile_dir = "test/graphtile_test";
+  GraphId id(2, 2, 0);
+  write_tile(tile_dir, id, true);
+
+  // Should be inflated to exactly the size of the tile
+  GraphTile tile(tile_dir, id);
+  if(!tile.header() || tile.id() != id || tile.header()->end_offset() != sizeof(GraphTileHeader))
+    throw std::logic_error("Gzipped tile should have been loaded");
+
+  // Corrupt tiles should not load
+  auto path = tile_dir + "/" + GraphTile::FileSuffix(id) + ".gz";
+  boost::filesystem::resize_file(path, boost::filesystem::file_size(path) / 2);
+  if(GraphTile(tile_dir, id).header())
+    throw std::logic_error("Truncated tile should not have been loaded");
+
+  boost::filesystem::remove_all(tile_dir);
+}
+
+}
+
+void old_layout() {
+  // Tiles built before the speed profiles only have the end offset in the
+  // slot the speed profile offset now takes
+  std::string tile_dir = "test/graphtile_test";
+  GraphId id(2, 2, 0);
+  auto path = tile_dir + "/" + GraphTile::FileSuffix(id);
+  boost::filesystem::create_directories(boost::filesystem::path(path).parent_path());
+  GraphTileHeader header;
+  header.set_graphid(id);
+  header.set_speed_profile_offset(sizeof(GraphTileHeader));
+  if(header.end_offset() != sizeof(GraphTileHeader))
+    throw std::logic_error("End offset of the old layout should come from its slot");
+  {
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(GraphTileHeader));
+  }
+
+  GraphTile tile(tile_dir, id);
+  if(!tile.header() || tile.header()->end_offset() != sizeof(GraphTileHeader))
+    throw std::logic_error("Old tile should have been loaded with its size");
+  if(tile.has_speed_profiles())
+    throw std::logic_error("Old tile should not have speed profiles");
+
+  boost::filesystem::remove_all(tile_dir);
 }
 
 int main() {
@@ -129,5 +217,11 @@ int main() {
 
   suite.test(TEST_CASE(bin));
 
+  suite.test(TEST_CASE(mmap_tile));
+
+  suite.test(TEST_CASE(gzipped_tile));
+
+  suite.test(TEST_CASE(old_layout));
+
   return suite.tear_down();
 }
@@ -4,10 +4,14 @@
 #include "baldr/graphid.h"
 #include "midgard/pointll.h"
 #include "baldr/tilehierarchy.h"
+#include "sif/truckcost.h"
 #include <string>
 #include <vector>
 #include <fstream>
 #include <streambuf>
+#include <algorithm>
+#include <cmath>
+#include <boost/filesystem/operations.hpp>
 using namespace std;
 using namespace valhalla::mjolnir;
 
@@ -197,6 +201,84 @@ void TestAddBins() {
   }
 }
 
+void TestSpeedProfiles() {
+  //write a tile with a couple of edges
+  GraphId id(744881,2,0);
+  std::string speed_dir = "test/data/speed_tiles";
+  {
+    GraphTileBuilder builder(speed_dir, id, false);
+    builder.nodes().emplace_back();
+    for(uint32_t i = 0; i < 3; ++i) {
+      DirectedEdge edge;
+      edge.set_length(1000);
+      edge.set_speed(40 + i * 10);
+      edge.set_truck_speed(70);
+      builder.directededges().push_back(edge);
+    }
+    builder.StoreTileData();
+  }
+
+  //tiles without profiles use the edge speed
+  GraphTile before(speed_dir, id);
+  if(before.has_speed_profiles() || before.speed_profile(0) != nullptr)
+    throw std::logic_error("Test tile should not have speed profiles");
+  if(before.GetSpeed(before.directededge(0), 3600) != before.directededge(0)->speed())
+    throw std::logic_error("Edges without speed profiles should use the edge speed");
+
+  //slow on week day mornings
+  std::vector<float> speeds(kSpeedBucketCount, 50.0f);
+  for(uint32_t day = 1; day < 6; ++day)
+    for(uint32_t b = 28; b < 40; ++b)
+      speeds[day * 96 + b] = 20.0f;
+  auto profile = compress_speed_buckets(speeds.data());
+  {
+    GraphTileBuilder builder(speed_dir, id, true);
+    builder.AddSpeedProfile(1, profile);
+    builder.StoreTileData();
+  }
+
+  //reading and storing the tile again keeps the profiles
+  {
+    GraphTileBuilder builder(speed_dir, id, true);
+    builder.StoreTileData();
+  }
+
+  GraphTile after(speed_dir, id);
+  if(after.header()->end_offset() - after.header()->speed_profile_offset() !=
+     after.header()->directededgecount() * sizeof(uint32_t) + sizeof(speed_profile_t))
+    throw std::logic_error("Tile with speed profiles has the wrong size");
+  if(!after.has_speed_profiles() || after.speed_profile(0) != nullptr ||
+     after.speed_profile(1) == nullptr)
+    throw std::logic_error("Only the second edge should have a speed profile");
+  if(!std::equal(profile.begin(), profile.end(), after.speed_profile(1)))
+    throw std::logic_error("Speed profile did not survive the round trip");
+  const DirectedEdge* edge = after.directededge(1);
+  uint32_t tuesday_morning = after.GetSpeed(edge, 2 * 86400 + 8 * 3600);
+  uint32_t tuesday_night = after.GetSpeed(edge, 2 * 86400 + 23 * 3600);
+  if(tuesday_morning >= tuesday_night || tuesday_night < 45 || tuesday_night > 55)
+    throw std::logic_error("Unexpected speeds from the speed profile: " +
+                           std::to_string(tuesday_morning) + ", " + std::to_string(tuesday_night));
+  if(after.GetSpeed(edge, kInvalidSecondsOfWeek) != edge->speed())
+    throw std::logic_error("Without a time the edge speed should be used");
+
+  //trucks cost the same as before without a time or a speed profile and go
+  //no faster than the truck speed with one
+  auto truck = valhalla::sif::CreateTruckCost(boost::property_tree::ptree());
+  for(uint32_t i = 0; i < 3; ++i) {
+    const DirectedEdge* e = after.directededge(i);
+    if(truck->EdgeCost(e, &after, kInvalidSecondsOfWeek).secs != truck->EdgeCost(e).secs)
+      throw std::logic_error("Truck cost without a time should not change");
+  }
+  const DirectedEdge* unprofiled = after.directededge(2);
+  if(truck->EdgeCost(unprofiled, &after, 2 * 86400 + 8 * 3600).secs != truck->EdgeCost(unprofiled).secs)
+    throw std::logic_error("Truck cost without a speed profile should not change");
+  if(truck->EdgeCost(edge, &after, 2 * 86400 + 8 * 3600).secs <= truck->EdgeCost(edge).secs)
+    throw std::logic_error("Truck should be slower in the morning rush");
+  if(std::abs(truck->EdgeCost(edge, &after, 2 * 86400 + 23 * 3600).secs -
+               3600.0f / static_cast<float>(tuesday_night)) > 0.01f)
+    throw std::logic_error("Truck at night should go the profile speed");
+}
+
 }
 
 int main() {
@@ -208,5 +290,8 @@ int main() {
   // Add bins to a tile and see if its still ok
   suite.test(TEST_CASE(TestAddBins));
 
+  // Add speed profiles to a tile and read them back
+  suite.test(TEST_CASE(TestSpeedProfiles));
+
   return suite.tear_down();
 }
@@ -2,6 +2,7 @@
 #include "test.h"
 #include "baldr/json.h"
 #include <set>
+#include <random>
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/property_tree/ptree.hpp>
 
@@ -81,6 +82,54 @@ void TestJsonSerialize() {
       throw std::runtime_error("Wrong json!");
 }
 
+void TestJwriter() {
+  using namespace valhalla::baldr;
+  //written straight out it should be the same as a tree
+  std::string text;
+  json::Jwriter writer(text);
+  writer.start_array();
+  writer.start_object();
+  writer("name", std::string("West/26th \"Street\"\t\a"));
+  writer("points", json::array({json::fp_t{40.744377, 3}, json::fp_t{-73.990433, 0}}));
+  writer.end_object();
+  writer.value(static_cast<int64_t>(-12));
+  writer.value(static_cast<uint64_t>(2875622111));
+  writer.value(nullptr);
+  writer.start_array();
+  writer.end_array();
+  writer.value(false);
+  writer.end_array();
+
+  std::stringstream tree;
+  tree << *json::array({
+    json::map({{"name", std::string("West/26th \"Street\"\t\a")}}),
+    int64_t(-12), uint64_t(2875622111), nullptr, json::array({}), false});
+  auto expected = "[{\"name\":\"West\\/26th \\\"Street\\\"\\t\\u0007\",\"points\":[40.744,-74]},-12,2875622111,null,[],false]";
+  if(text != expected)
+    throw std::runtime_error("Wrong json from writer: " + text);
+  auto without_points = "[{\"name\":\"West\\/26th \\\"Street\\\"\\t\\u0007\"},-12,2875622111,null,[],false]";
+  if(tree.str() != without_points)
+    throw std::runtime_error("Wrong json from tree: " + tree.str());
+}
+
+void TestFixed() {
+  using namespace valhalla::baldr;
+  //should format just like a stream does
+  std::mt19937 generator(17);
+  std::uniform_real_distribution<double> values(-200000.0, 200000.0);
+  std::uniform_int_distribution<int> precisions(0, 12);
+  for(int i = 0; i < 100000; ++i) {
+    long double value = i < 4 ? (i < 2 ? -0.0001 : 1e12 + .5) : values(generator);
+    size_t precision = precisions(generator);
+    std::string text;
+    json::Jwriter::fixed(text, value, precision);
+    std::stringstream stream;
+    stream << std::setprecision(precision) << std::fixed << value;
+    if(text != stream.str())
+      throw std::runtime_error("Wrong fixed point text: " + text + " should be " + stream.str());
+  }
+}
+
 }
 
 int main() {
@@ -88,5 +137,9 @@ int main() {
 
   suite.test(TEST_CASE(TestJsonSerialize));
 
+  suite.test(TEST_CASE(TestJwriter));
+
+  suite.test(TEST_CASE(TestFixed));
+
   return suite.tear_down();
 }
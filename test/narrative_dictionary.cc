@@ -1447,6 +1447,35 @@ void test_en_US_verbal_multi_cue() {
   validate(phrase_0, "<CURRENT_VERBAL_CUE> Then <NEXT_VERBAL_CUE>");
 }
 
+void test_phrase_template() {
+  const NarrativeDictionary& dictionary = GetNarrativeDictionary("en-US");
+
+  // Every phrase is compiled
+  const auto& start = dictionary.start_subset;
+  if (start.templates.size() != start.phrases.size())
+    throw std::runtime_error("Expected a template for every phrase");
+
+  // "1": "Head <CARDINAL_DIRECTION> on <STREET_NAMES>."
+  std::string instruction = "left over from a prior instruction";
+  std::string cardinal_direction = "north";
+  start.templates.at("1").Render(instruction,
+      { { kCardinalDirectionTag, cardinal_direction },
+        { kStreetNamesTag, "Main Street" } });
+  validate(instruction, "Head north on Main Street.");
+
+  // Tags without a value are left as is, values are not searched for tags
+  // and anything that is not a tag is literal text
+  PhraseTemplate phrase("<A> <B_C><B_C> <<lower> <> <A");
+  phrase.Render(instruction, { { "<B_C>", "<A>" } });
+  validate(instruction, "<A> <A><A> <<lower> <> <A");
+  phrase.Render(instruction, { { "<A>", "1" }, { "<B>", "2" } });
+  validate(instruction, "1 <B_C><B_C> <<lower> <> <A");
+
+  // Empty phrase
+  PhraseTemplate().Render(instruction, { { "<A>", "1" } });
+  validate(instruction, "");
+}
+
 }
 
 int main() {
@@ -1629,5 +1658,8 @@ int main() {
   // test the en-US verbal_multi_cue phrases
   suite.test(TEST_CASE(test_en_US_verbal_multi_cue));
 
+  // test rendering compiled phrases
+  suite.test(TEST_CASE(test_phrase_template));
+
   return suite.tear_down();
 }
@@ -3,6 +3,8 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <limits>
+#include <random>
 #include "config.h"
 #include "thor/optimizer.h"
 
@@ -40,6 +42,73 @@ void TestOptimizer() {
   TryOptimizer(11, costs, expected_order);
 }
 
+float TourCost(const uint32_t nlocs, const std::vector<float>& costs,
+               const std::vector<uint32_t>& tour, const bool round_trip) {
+  float cost = 0.0f;
+  for (uint32_t i = 1; i < tour.size(); i++) {
+    cost += costs[tour[i - 1] * nlocs + tour[i]];
+  }
+  return round_trip ? cost + costs[tour.back() * nlocs] : cost;
+}
+
+// Cheapest tour by trying every order of the locations that can move
+float BestTourCost(const uint32_t nlocs, const std::vector<float>& costs,
+                   const LocalSearchOptimizer::TourType type) {
+  bool fixed_end = type == LocalSearchOptimizer::TourType::kFixedEnds;
+  std::vector<uint32_t> tour(nlocs);
+  for (uint32_t i = 0; i < nlocs; i++) {
+    tour[i] = i;
+  }
+  float best = std::numeric_limits<float>::max();
+  do {
+    best = std::min(best, TourCost(nlocs, costs, tour,
+                    type == LocalSearchOptimizer::TourType::kRoundTrip));
+  } while (std::next_permutation(tour.begin() + 1, tour.end() - (fixed_end ? 1 : 0)));
+  return best;
+}
+
+void TestLocalSearch() {
+  // Random costs that are not symmetric, small enough to check every tour
+  std::mt19937 generator(3);
+  std::uniform_real_distribution<float> cost(1.0f, 100.0f);
+  for (auto type : { LocalSearchOptimizer::TourType::kFixedEnds,
+                     LocalSearchOptimizer::TourType::kOpen,
+                     LocalSearchOptimizer::TourType::kRoundTrip }) {
+    for (uint32_t nlocs = 2; nlocs < 9; nlocs++) {
+      std::vector<float> costs(nlocs * nlocs, 0.0f);
+      for (uint32_t i = 0; i < nlocs; i++) {
+        for (uint32_t j = 0; j < nlocs; j++) {
+          if (i != j) {
+            costs[i * nlocs + j] = cost(generator);
+          }
+        }
+      }
+      LocalSearchOptimizer optimizer(type);
+      optimizer.Seed(111111);
+      auto order = optimizer.Solve(nlocs, costs);
+
+      // Every location once, starting (and maybe ending) where it should
+      auto sorted = order;
+      std::sort(sorted.begin(), sorted.end());
+      for (uint32_t i = 0; i < nlocs; i++) {
+        if (sorted[i] != i) {
+          throw runtime_error("TestLocalSearch: tour does not visit every location once");
+        }
+      }
+      if (order.front() != 0 ||
+          (type == LocalSearchOptimizer::TourType::kFixedEnds && order.back() != nlocs - 1)) {
+        throw runtime_error("TestLocalSearch: tour does not keep its fixed locations");
+      }
+
+      float found = TourCost(nlocs, costs, order, type == LocalSearchOptimizer::TourType::kRoundTrip);
+      if (found > BestTourCost(nlocs, costs, type) + 0.01f) {
+        throw runtime_error("TestLocalSearch: did not find the best tour of " +
+                            std::to_string(nlocs) + " locations");
+      }
+    }
+  }
+}
+
 }
 
 int main() {
@@ -47,5 +116,7 @@ int main() {
 
   suite.test(TEST_CASE(TestOptimizer));
 
+  suite.test(TEST_CASE(TestLocalSearch));
+
   return suite.tear_down();
 }
@@ -0,0 +1,81 @@
+#include "test.h"
+
+#include "thor/phaserunner.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace valhalla::thor;
+
+namespace {
+
+void TestPhases() {
+  for (uint32_t thread_count : { 1, 2, 4 }) {
+    PhaseRunner runner(thread_count);
+    if (runner.thread_count() != thread_count)
+      throw std::runtime_error("Wrong thread count");
+
+    // Each phase reads what the previous phase wrote so a phase must be
+    // complete before Run returns
+    std::vector<uint32_t> values(100), expected(100), previous;
+    for (uint32_t i = 0; i < values.size(); ++i) {
+      values[i] = expected[i] = i;
+    }
+    for (uint32_t phase = 0; phase < 1000; ++phase) {
+      previous = values;
+      std::atomic<uint32_t> bad_thread(0);
+      runner.Run(values.size(), [&](const uint32_t i, const uint32_t thread) {
+        if (thread >= thread_count)
+          bad_thread++;
+        values[i] = (previous[i] + previous[(i + 1) % previous.size()]) % 1000;
+      });
+      if (bad_thread != 0)
+        throw std::runtime_error("Unexpected thread number");
+
+      previous = expected;
+      for (uint32_t i = 0; i < expected.size(); ++i) {
+        expected[i] = (previous[i] + previous[(i + 1) % previous.size()]) % 1000;
+      }
+      if (values != expected)
+        throw std::runtime_error("Phase did not match the serial result");
+    }
+
+    // Empty phases are fine too
+    runner.Run(0, [](const uint32_t, const uint32_t) {
+      throw std::runtime_error("Should not be called");
+    });
+  }
+}
+
+void TestErrors() {
+  for (uint32_t thread_count : { 1, 3 }) {
+    PhaseRunner runner(thread_count);
+    try {
+      runner.Run(50, [](const uint32_t i, const uint32_t) {
+        if (i == 17)
+          throw std::logic_error("item failed");
+      });
+      throw std::runtime_error("Expected the error to be rethrown");
+    }
+    catch (const std::logic_error& e) {
+    }
+
+    // The runner is still usable
+    std::atomic<uint32_t> count(0);
+    runner.Run(50, [&count](const uint32_t, const uint32_t) { count++; });
+    if (count != 50)
+      throw std::runtime_error("Expected every item to run after an error");
+  }
+}
+
+}
+
+int main() {
+  test::suite suite("phaserunner");
+
+  suite.test(TEST_CASE(TestPhases));
+  suite.test(TEST_CASE(TestErrors));
+
+  return suite.tear_down();
+}
@@ -0,0 +1,81 @@
+#include "test.h"
+
+#include "mjolnir/admin.h"
+
+#include <random>
+#include <string>
+#include <unordered_map>
+
+using namespace valhalla::mjolnir;
+
+namespace {
+
+std::unordered_map<uint32_t,multi_polygon_type> make_polys() {
+  std::unordered_map<uint32_t,multi_polygon_type> polys;
+  auto add = [&polys](const uint32_t id, const std::string& wkt) {
+    multi_polygon_type multi_poly;
+    boost::geometry::read_wkt(wkt, multi_poly);
+    boost::geometry::correct(multi_poly);
+    polys.emplace(id, multi_poly);
+  };
+  // Two parts, one with a hole
+  add(1, "MULTIPOLYGON(((0 0,0 1,0.5 1,0.5 0,0 0),(0.1 0.1,0.1 0.3,0.3 0.3,0.3 0.1,0.1 0.1)),"
+         "((0.9 0.85,0.9 0.98,0.98 0.98,0.98 0.85,0.9 0.85)))");
+  // Neighbor sharing a border, crossing the tile bounds
+  add(2, "MULTIPOLYGON(((0.5 0,0.5 1,1.5 0.5,0.5 0)))");
+  // Enclave in the hole
+  add(3, "MULTIPOLYGON(((0.15 0.15,0.15 0.25,0.25 0.25,0.25 0.15,0.15 0.15)))");
+  return polys;
+}
+
+void TestKnownPoints() {
+  auto polys = make_polys();
+  PolygonIndex index(polys, AABB2<PointLL>(0.0, 0.0, 1.0, 1.0), 8);
+  std::vector<std::pair<PointLL, uint32_t> > expected = {
+    { { 0.05, 0.05 }, 1 }, { { 0.12, 0.12 }, 0 }, { { 0.2, 0.2 }, 3 },
+    { { 0.95, 0.9 }, 1 }, { { 0.6, 0.5 }, 2 }, { { 0.99, 0.1 }, 0 },
+    { { 1.2, 0.5 }, 2 }, { { 2.0, 2.0 }, 0 }, { { -0.5, 0.5 }, 0 }
+  };
+  for (const auto& point : expected) {
+    if (GetMultiPolyId(index, point.first) != point.second)
+      throw std::runtime_error("Wrong polygon for " +
+                               std::to_string(point.first.lng()) + "," +
+                               std::to_string(point.first.lat()));
+  }
+}
+
+void TestMatchesLinearSearch() {
+  // Every point (including ones outside of the bounds and ones repeated
+  // in classified cells) has to match the linear search
+  auto polys = make_polys();
+  std::mt19937 generator(17);
+  std::uniform_real_distribution<float> distribution(-0.25f, 1.25f);
+  for (uint32_t divisions : { 1, 3, 16, 64 }) {
+    PolygonIndex index(polys, AABB2<PointLL>(0.0, 0.0, 1.0, 1.0), divisions);
+    for (int i = 0; i < 20000; ++i) {
+      PointLL ll(distribution(generator), distribution(generator));
+      if (GetMultiPolyId(index, ll) != GetMultiPolyId(polys, ll))
+        throw std::runtime_error("Index does not match linear search");
+    }
+  }
+}
+
+void TestEmpty() {
+  std::unordered_map<uint32_t,multi_polygon_type> polys;
+  PolygonIndex index(polys, AABB2<PointLL>(0.0, 0.0, 1.0, 1.0));
+  if (GetMultiPolyId(index, PointLL(0.5, 0.5)) != 0 ||
+      GetMultiPolyId(index, PointLL(5.0, 5.0)) != 0)
+    throw std::runtime_error("Expected no polygon");
+}
+
+}
+
+int main() {
+  test::suite suite("polygonindex");
+
+  suite.test(TEST_CASE(TestKnownPoints));
+  suite.test(TEST_CASE(TestMatchesLinearSearch));
+  suite.test(TEST_CASE(TestEmpty));
+
+  return suite.tear_down();
+}
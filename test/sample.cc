@@ -8,8 +8,11 @@
 using namespace valhalla;
 
 #include <cmath>
+#include <cstdio>
 #include <list>
 #include <fstream>
+#include <random>
+#include <zlib.h>
 
 namespace {
 
@@ -70,6 +73,117 @@ void get() {
     throw std::runtime_error("Area under discretized curve isn't right");
 }
 
+void compressed() {
+  //gzip the tile we made and pretend its the one just north of it
+  {
+    std::ifstream raw("test/data/sample/N40W077.hgt", std::ios::binary);
+    std::vector<char> tile((std::istreambuf_iterator<char>(raw)), std::istreambuf_iterator<char>());
+    for(const auto& name : {"test/data/sample/N41W077.hgt.gz", "test/data/sample/N42W077.hgt.gz"}) {
+      gzFile file = gzopen(name, "wb");
+      gzwrite(file, tile.data(), tile.size());
+      gzclose(file);
+    }
+  }
+
+  //the compressed tile should have the same heights as the raw one
+  skadi::sample s("test/data/sample", 1);
+  std::vector<std::pair<double, double> > raw = {
+    {-76.503915, 40.678783}, {-76.9, 40.0}, {-76.537011, 40.723872}, {-76.537011, 40.735872}
+  };
+  auto gzipped = raw;
+  for(auto& coord : gzipped)
+    coord.second += 1;
+  auto raw_heights = s.get_all(raw);
+  auto gzipped_heights = s.get_all(gzipped);
+  if(raw_heights != gzipped_heights)
+    throw std::runtime_error("Compressed tile should have the same heights as the raw one");
+  if(s.get(gzipped.front()) != raw_heights.front())
+    throw std::runtime_error("Compressed tile should have the same height as the raw one");
+
+  //one decompression for the batch and a hit for the single one
+  auto stats = s.get_cache_stats();
+  if(stats.misses != 1 || stats.hits != 1)
+    throw std::runtime_error("Compressed tile should have been decompressed only once");
+
+  //raw tiles dont touch the cache
+  s.get(raw.front());
+  if(s.get_cache_stats().hits != 1)
+    throw std::runtime_error("Raw tiles should not go through the cache");
+
+  //only one tile fits so going back and forth evicts each time
+  s.get(std::make_pair(-76.5, 42.5));
+  s.get(std::make_pair(-76.5, 41.5));
+  stats = s.get_cache_stats();
+  if(stats.misses != 3 || stats.hits != 1)
+    throw std::runtime_error("Least recently used tile should have been evicted");
+}
+
+void corrupt() {
+  //a gzipped tile that is too short to be a tile
+  {
+    gzFile file = gzopen("test/data/sample/N43W077.hgt.gz", "wb");
+    gzwrite(file, "not a tile", 10);
+    gzclose(file);
+  }
+
+  //it has no data and we only try to decompress it once
+  skadi::sample s("test/data/sample", 1);
+  for(int i = 0; i < 3; ++i)
+    if(s.get(std::make_pair(-76.5, 43.5)) != s.get_no_data_value())
+      throw std::runtime_error("Corrupt tile should have no data");
+  auto stats = s.get_cache_stats();
+  if(stats.misses != 1 || stats.hits != 0)
+    throw std::runtime_error("Corrupt tile should only be decompressed once");
+  std::remove("test/data/sample/N43W077.hgt.gz");
+}
+
+void batch() {
+  //a tile of random heights so every interpolation mixes four different pixels
+  std::mt19937 generator(7);
+  {
+    std::uniform_int_distribution<int16_t> height(-500, 4000);
+    std::vector<int16_t> tile(3601 * 3601);
+    for(auto& pixel : tile)
+      pixel = ((height(generator) & 0xFF) << 8) | ((height(generator) >> 8) & 0xFF);
+    std::ofstream file("test/data/sample/N39W077.hgt", std::ios::binary | std::ios::trunc);
+    file.write(static_cast<const char*>(static_cast<void*>(tile.data())),
+      sizeof(int16_t) * tile.size());
+  }
+
+  //postings all over the raw and compressed tiles, the edges of them and where we have no data
+  skadi::sample s("test/data/sample");
+  std::uniform_real_distribution<double> lon(-77.0, -76.0), lat(38.5, 42.5);
+  std::vector<std::pair<double, double> > postings;
+  for(size_t i = 0; i < 1000; ++i)
+    postings.emplace_back(lon(generator), lat(generator));
+  std::uniform_real_distribution<double> random_lat(39.0, 40.0);
+  for(size_t i = 0; i < 1000; ++i)
+    postings.emplace_back(lon(generator), random_lat(generator));
+  for(size_t i = 0; i < 50; ++i) {
+    postings.emplace_back(lon(generator), 40.0);
+    postings.emplace_back(lon(generator), 41.0);
+    postings.emplace_back(-77.0, lat(generator));
+  }
+  postings.emplace_back(-77.0, 40.0);
+  postings.emplace_back(200.0, 200.0);
+
+  //the batch has to give exactly what we get one at a time
+  auto heights = s.get_all(postings);
+  for(size_t i = 0; i < postings.size(); ++i)
+    if(heights[i] != s.get(postings[i]))
+      throw std::runtime_error("Batch height doesnt match single height at posting " + std::to_string(i));
+
+  //and the same for single precision
+  std::list<std::pair<float, float> > floats;
+  for(const auto& posting : postings)
+    floats.emplace_back(posting.first, posting.second);
+  heights = s.get_all(floats);
+  auto height = heights.cbegin();
+  for(const auto& posting : floats)
+    if(*height++ != s.get(posting))
+      throw std::runtime_error("Batch height doesnt match single height for floats");
+}
+
 struct testable_sample_t : public skadi::sample {
   testable_sample_t(const std::string& dir):sample(dir){
     {
@@ -115,6 +229,12 @@ int main() {
 
   suite.test(TEST_CASE(get));
 
+  suite.test(TEST_CASE(compressed));
+
+  suite.test(TEST_CASE(corrupt));
+
+  suite.test(TEST_CASE(batch));
+
   suite.test(TEST_CASE(edges));
 
   return suite.tear_down();
@@ -0,0 +1,74 @@
+#include "test.h"
+#include <cmath>
+#include <vector>
+
+#include "baldr/speedprofile.h"
+
+using namespace std;
+using namespace valhalla::baldr;
+
+namespace {
+
+  void TestConstantProfile() {
+    // A constant speed survives compression
+    std::vector<float> speeds(kSpeedBucketCount, 55.0f);
+    auto profile = compress_speed_buckets(speeds.data());
+    for (uint32_t b = 0; b < kSpeedBucketCount; ++b) {
+      float speed = decompress_speed_bucket(profile.data(), b);
+      if (std::abs(speed - 55.0f) > 0.5f)
+        throw runtime_error("Constant speed profile bucket " + std::to_string(b) +
+                            " decompressed to " + std::to_string(speed));
+    }
+  }
+
+  void TestDailyProfile() {
+    // Slower during the morning and evening rush hours on week days
+    std::vector<float> speeds(kSpeedBucketCount);
+    for (uint32_t b = 0; b < kSpeedBucketCount; ++b) {
+      uint32_t day = b / 96;
+      float hour = (b % 96) / 4.0f;
+      float rush = std::exp(-std::pow(hour - 8.0f, 2.0f) / 4.0f) +
+                   std::exp(-std::pow(hour - 17.5f, 2.0f) / 4.0f);
+      speeds[b] = (day == 0 || day == 6) ? 60.0f : 60.0f - 10.0f * rush;
+    }
+    auto profile = compress_speed_buckets(speeds.data());
+
+    // Compare the average error and the speeds at 8:00 on a week day and on
+    // a Sunday
+    float error = 0.0f;
+    for (uint32_t b = 0; b < kSpeedBucketCount; ++b)
+      error += std::abs(decompress_speed_bucket(profile.data(), b) - speeds[b]);
+    error /= kSpeedBucketCount;
+    if (error > 2.0f)
+      throw runtime_error("Daily speed profile average error " + std::to_string(error));
+
+    float tuesday = decompress_speed_bucket(profile.data(), 2 * 96 + 32);
+    float sunday = decompress_speed_bucket(profile.data(), 32);
+    if (tuesday >= sunday - 5.0f)
+      throw runtime_error("Daily speed profile lost the rush hour: " + std::to_string(tuesday) +
+                          " vs " + std::to_string(sunday));
+  }
+
+  void TestOffsetSecondsOfWeek() {
+    if (offset_seconds_of_week(3600, 1800.0f) != 5400)
+      throw runtime_error("Offset seconds of week failed");
+    if (offset_seconds_of_week(kSecondsPerWeek - 60, 120.0f) != 60)
+      throw runtime_error("Offset seconds of week should wrap to the start of the week");
+    if (offset_seconds_of_week(60, -120.0f) != kSecondsPerWeek - 60)
+      throw runtime_error("Offset seconds of week should wrap to the end of the week");
+    if (offset_seconds_of_week(kInvalidSecondsOfWeek, 60.0f) != kInvalidSecondsOfWeek)
+      throw runtime_error("Offset seconds of week should keep an invalid time");
+  }
+
+}
+
+int main(void)
+{
+  test::suite suite("speedprofile");
+
+  suite.test(TEST_CASE(TestConstantProfile));
+  suite.test(TEST_CASE(TestDailyProfile));
+  suite.test(TEST_CASE(TestOffsetSecondsOfWeek));
+
+  return suite.tear_down();
+}
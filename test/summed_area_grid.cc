@@ -0,0 +1,101 @@
+#include "test.h"
+#include "midgard/summed_area_grid.h"
+#include "midgard/pointll.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace valhalla::midgard;
+
+namespace {
+
+  void test_sums() {
+    //random values in the cells of a 10x10 grid
+    SummedAreaGrid<PointLL> g({-5,-5,5,5}, 1);
+    std::mt19937 generator(17);
+    std::uniform_real_distribution<float> value(0, 10);
+    std::vector<float> cells(100);
+    for(int row = 0; row < 10; ++row) {
+      for(int col = 0; col < 10; ++col) {
+        cells[row * 10 + col] = value(generator);
+        if(!g.Add(PointLL(col - 4.5f, row - 4.5f), cells[row * 10 + col]))
+          throw std::logic_error("Should have been able to add to this cell");
+      }
+    }
+    if(g.Add(PointLL(6, 0), 1) || g.Add(PointLL(0, -6), 1))
+      throw std::logic_error("Should not be able to add outside the grid");
+    g.Build();
+
+    //compare against brute force sums over every box of cells
+    for(int row0 = 0; row0 < 10; ++row0) {
+      for(int row1 = row0; row1 < 10; ++row1) {
+        for(int col0 = 0; col0 < 10; ++col0) {
+          for(int col1 = col0; col1 < 10; ++col1) {
+            double expected = 0;
+            for(int row = row0; row <= row1; ++row)
+              for(int col = col0; col <= col1; ++col)
+                expected += cells[row * 10 + col];
+            AABB2<PointLL> box(col0 - 4.9f, row0 - 4.9f, col1 - 4.1f, row1 - 4.1f);
+            if(std::abs(g.Sum(box) - expected) > 1e-3)
+              throw std::logic_error("Wrong sum over a box of cells");
+          }
+        }
+      }
+    }
+  }
+
+  void test_clipping() {
+    SummedAreaGrid<PointLL> g({0,0,4,4}, 1);
+    g.Add(PointLL(0.5f, 0.5f), 1);
+    g.Add(PointLL(3.5f, 3.5f), 2);
+    g.Add(PointLL(3.5f, 0.5f), 4);
+    g.Build();
+
+    //boxes hanging off the grid are clipped to it
+    if(g.Sum({-10,-10,10,10}) != 7)
+      throw std::logic_error("Sum over the whole grid should include every cell");
+    if(g.Sum({-10,-10,1.5f,1.5f}) != 1)
+      throw std::logic_error("Sum over the lower left should include only that cell");
+    if(g.Sum({3.2f,-10,10,3.6f}) != 6)
+      throw std::logic_error("Sum over the right edge should include both cells");
+
+    //boxes outside the grid are empty
+    if(g.Sum({5,5,6,6}) != 0 || g.Sum({-2,0,-1,4}) != 0)
+      throw std::logic_error("Sum outside the grid should be 0");
+  }
+
+  void test_cell_centers() {
+    SummedAreaGrid<PointLL> g({0,0,4,4}, 1);
+    for(int row = 0; row < 4; ++row)
+      for(int col = 0; col < 4; ++col)
+        g.Add(PointLL(col + 0.5f, row + 0.5f), 1);
+    g.Build();
+
+    //only cells with their centers in the box count, not every cell it touches
+    if(g.Sum({3.2f,-10,10,3.2f}) != 3)
+      throw std::logic_error("Cell with its center outside the box should not count");
+    if(g.Sum({0.9f,0.9f,3.1f,3.1f}) != 4)
+      throw std::logic_error("Box should only count the four cells centered in it");
+    if(g.Sum({0.5f,0.5f,1.5f,1.5f}) != 1)
+      throw std::logic_error("Only cell centers on the min edges of the box should count");
+    if(g.Sum({0.6f,0.6f,1.4f,1.4f}) != 0 || g.Sum({3.6f,3.6f,4,4}) != 0)
+      throw std::logic_error("Box without a cell center should be empty");
+
+    //a box of the grid size centered anywhere covers the area of that many cells
+    for(float x = 0.5f; x < 1.5f; x += 0.125f)
+      if(g.Sum({x,x,x + 2,x + 2}) != 4)
+        throw std::logic_error("Sum should not be biased by where the box lies");
+  }
+
+}
+
+int main() {
+  test::suite suite("summed_area_grid");
+
+  suite.test(TEST_CASE(test_sums));
+  suite.test(TEST_CASE(test_clipping));
+  suite.test(TEST_CASE(test_cell_centers));
+
+  return suite.tear_down();
+}
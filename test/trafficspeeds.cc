@@ -0,0 +1,134 @@
+#include "test.h"
+
+#include "thor/trafficspeeds.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+using namespace valhalla::thor;
+
+namespace {
+
+const std::string tile_dir = "test/traffic_speeds_tiles";
+
+void write_speeds(const std::string& dir, const uint32_t tileid,
+                  const std::vector<uint8_t>& speeds) {
+  boost::filesystem::create_directories(dir);
+  std::ofstream file(dir + "/" + std::to_string(tileid) + ".spd",
+                     std::ios::out | std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(speeds.data()), speeds.size());
+}
+
+// Publish a generation the way a traffic updater would, write the name to a
+// temporary file and rename it over the generation file
+void publish(const std::string& name) {
+  std::string traffic_dir = tile_dir + "/traffic/";
+  {
+    std::ofstream file(traffic_dir + "generation.tmp");
+    file << name << std::endl;
+  }
+  if (std::rename((traffic_dir + "generation.tmp").c_str(),
+                  (traffic_dir + "generation").c_str()) != 0)
+    throw std::runtime_error("Could not publish traffic generation");
+}
+
+void check_speeds(const TrafficSpeeds::speeds_t& speeds,
+                  const std::vector<uint8_t>& expected) {
+  if (speeds.size() != expected.size())
+    throw std::logic_error("Unexpected number of speeds");
+  for (size_t i = 0; i < expected.size(); ++i)
+    if (speeds.get()[i] != expected[i])
+      throw std::logic_error("Unexpected speed");
+}
+
+void generations() {
+  boost::filesystem::remove_all(tile_dir);
+
+  // Without a generation file speeds come straight from the traffic dir
+  write_speeds(tile_dir + "/traffic", 5, {10, 0, 30});
+  TrafficSpeeds traffic(tile_dir, 0);
+  auto original = traffic.Current();
+  check_speeds(original->GetSpeeds(5), {10, 0, 30});
+  if (original->GetSpeeds(6).size() != 0)
+    throw std::logic_error("Tile without speeds should have no speeds");
+  if (traffic.Current() != original)
+    throw std::logic_error("Generation should not change until published");
+
+  // Legacy files are copied so rewriting one in place does not touch routes
+  // that already read it, later routes get a fresh copy
+  write_speeds(tile_dir + "/traffic", 5, {20, 40});
+  check_speeds(original->GetSpeeds(5), {10, 0, 30});
+  auto rewritten = traffic.Current();
+  if (rewritten == original)
+    throw std::logic_error("Rewritten legacy speeds were not picked up");
+  check_speeds(rewritten->GetSpeeds(5), {20, 40});
+  if (traffic.Current() != rewritten)
+    throw std::logic_error("Legacy speeds should not change until rewritten");
+
+  // Publish a new generation, routes that pinned the old one keep seeing
+  // the old speeds
+  write_speeds(tile_dir + "/traffic/1", 5, {50, 60, 70, 80});
+  write_speeds(tile_dir + "/traffic/1", 6, {90});
+  publish("1");
+  auto first = traffic.Current();
+  if (first == original)
+    throw std::logic_error("Published generation was not picked up");
+  check_speeds(first->GetSpeeds(5), {50, 60, 70, 80});
+  check_speeds(first->GetSpeeds(6), {90});
+  check_speeds(original->GetSpeeds(5), {10, 0, 30});
+  if (traffic.Current() != first)
+    throw std::logic_error("Generation should not change until published");
+
+  // And another one
+  write_speeds(tile_dir + "/traffic/2", 5, {1});
+  publish("2");
+  auto second = traffic.Current();
+  check_speeds(second->GetSpeeds(5), {1});
+  if (second->GetSpeeds(6).size() != 0)
+    throw std::logic_error("Tile without speeds should have no speeds");
+  check_speeds(first->GetSpeeds(5), {50, 60, 70, 80});
+
+  // One store per tile dir
+  if (TrafficSpeeds::get_instance(tile_dir) != TrafficSpeeds::get_instance(tile_dir))
+    throw std::logic_error("Expected a single store per tile dir");
+
+  boost::filesystem::remove_all(tile_dir);
+}
+
+void legacy_check_interval() {
+  boost::filesystem::remove_all(tile_dir);
+
+  // Legacy files are not looked at again until the interval has passed
+  write_speeds(tile_dir + "/traffic", 5, {10, 0, 30});
+  TrafficSpeeds traffic(tile_dir, 3600);
+  auto original = traffic.Current();
+  check_speeds(original->GetSpeeds(5), {10, 0, 30});
+  write_speeds(tile_dir + "/traffic", 5, {20, 40});
+  if (traffic.Current() != original)
+    throw std::logic_error("Legacy speeds should not be checked before the interval");
+
+  // A published generation is still picked up right away
+  write_speeds(tile_dir + "/traffic/1", 5, {50});
+  publish("1");
+  auto first = traffic.Current();
+  if (first == original)
+    throw std::logic_error("Published generation was not picked up");
+  check_speeds(first->GetSpeeds(5), {50});
+
+  boost::filesystem::remove_all(tile_dir);
+}
+
+}
+
+int main() {
+  test::suite suite("trafficspeeds");
+
+  suite.test(TEST_CASE(generations));
+
+  suite.test(TEST_CASE(legacy_check_interval));
+
+  return suite.tear_down();
+}
@@ -0,0 +1,185 @@
+#ifndef VALHALLA_BALDR_CONTRACTIONHIERARCHY_H_
+#define VALHALLA_BALDR_CONTRACTIONHIERARCHY_H_
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <valhalla/baldr/graphid.h>
+#include <valhalla/baldr/graphreader.h>
+#include <valhalla/midgard/sequence.h>
+
+namespace valhalla {
+namespace baldr {
+
+// Vertex id used to mark no vertex (and arcs that are not shortcuts)
+constexpr uint32_t kInvalidVertex = std::numeric_limits<uint32_t>::max();
+
+// Identifies the file and the version of its layout
+constexpr char kContractionMagic[8] = { 'v', 'a', 'l', 'h', 'a', 'c', 'h', '\0' };
+constexpr uint32_t kContractionVersion = 3;
+
+/**
+ * An arc of the contraction hierarchy. Vertices of the hierarchy are the
+ * directed edges of the routing graph and an arc is an allowed transition
+ * from one directed edge onto the next. The cost of an arc is the cost of
+ * the transition plus the cost of the edge it leads to. Shortcut arcs skip
+ * over a contracted vertex that is lower in the hierarchy than either end.
+ */
+struct ContractionArc {
+  uint32_t vertex;  // Vertex at the other end of the arc
+  float cost;       // Cost of the arc
+  float secs;       // Elapsed time along the arc
+  uint32_t length;  // Length along the arc (meters)
+  uint32_t middle;  // Contracted vertex a shortcut skips (kInvalidVertex if
+                    // the arc is a transition between adjacent edges)
+};
+
+/**
+ * Directed edges of a graph tile. Vertices of a tile are consecutive so
+ * the vertex of a directed edge is the first vertex plus the edge index.
+ */
+struct ContractionTile {
+  uint64_t tile;    // Graph Id (value) of the tile, edge index 0
+  uint32_t first;   // First vertex of the tile
+  uint32_t count;   // Number of directed edges in the tile
+};
+
+/**
+ * Layout of the contraction file. The header is followed by the tiles
+ * (sorted by graph Id), the rank of each vertex, the offsets (one per
+ * vertex plus one) of the upward and of the downward graph and then the
+ * arcs of the upward and of the downward graph.
+ */
+struct ContractionHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t tile_count;
+  uint64_t vertex_count;
+  uint64_t up_arc_count;
+  uint64_t down_arc_count;
+  uint64_t tile_fingerprint;  // TileFingerprint of the tiles it was built from
+};
+
+/**
+ * Read access to a contraction hierarchy built by mjolnir. The file is
+ * memory mapped so processes on the same machine share a single copy.
+ * Upward arcs of a vertex lead to higher ranked vertices, downward arcs
+ * of a vertex come from higher ranked vertices.
+ */
+class ContractionHierarchy {
+ public:
+  /**
+   * Constructor of an empty hierarchy.
+   */
+  ContractionHierarchy();
+
+  /**
+   * Constructor. Maps the contraction file.
+   * @param  file_name  Contraction file.
+   */
+  explicit ContractionHierarchy(const std::string& file_name);
+
+  /**
+   * Get the name of the contraction file within the tile directory.
+   * @param  tile_dir  Tile directory.
+   */
+  static std::string FileName(const std::string& tile_dir);
+
+  /**
+   * Get a fingerprint of the tiles of the routing levels. It changes when
+   * a tile is added, removed or rebuilt with different edges or data.
+   * Reads every tile, clearing the cache of the reader as it goes.
+   * @param  reader  Graph reader of the tiles.
+   */
+  static uint64_t TileFingerprint(GraphReader& reader);
+
+  /**
+   * Was the hierarchy built from the tiles the reader reads.
+   * @param  reader  Graph reader of the tiles.
+   */
+  bool Matches(GraphReader& reader) const;
+
+  /**
+   * Is there a hierarchy.
+   */
+  bool empty() const;
+
+  /**
+   * Get the number of vertices.
+   */
+  uint32_t vertex_count() const;
+
+  /**
+   * Get the vertex of a directed edge.
+   * @param  edgeid  Directed edge Id.
+   * @return Returns the vertex or kInvalidVertex if the edge is not part of
+   *         the hierarchy.
+   */
+  uint32_t GetVertex(const GraphId& edgeid) const;
+
+  /**
+   * Get the directed edge of a vertex.
+   * @param  vertex  Vertex.
+   */
+  GraphId GetEdgeId(const uint32_t vertex) const;
+
+  /**
+   * Get the vertices of the directed edges of a graph tile.
+   * @param  tileid  Graph Id of the tile.
+   * @return Returns the first vertex and the number of vertices (0 if the
+   *         tile is not part of the hierarchy).
+   */
+  std::pair<uint32_t, uint32_t> GetTileVertices(const GraphId& tileid) const;
+
+  /**
+   * Get the rank of a vertex (the order in which it was contracted).
+   * @param  vertex  Vertex.
+   */
+  uint32_t rank(const uint32_t vertex) const;
+
+  /**
+   * Get the upward arcs leaving a vertex.
+   * @param  vertex  Vertex.
+   * @return Returns the begin and end of the arcs.
+   */
+  std::pair<const ContractionArc*, const ContractionArc*> UpArcs(
+          const uint32_t vertex) const;
+
+  /**
+   * Get the downward arcs entering a vertex. The vertex of these arcs is
+   * the vertex the arc starts from.
+   * @param  vertex  Vertex.
+   * @return Returns the begin and end of the arcs.
+   */
+  std::pair<const ContractionArc*, const ContractionArc*> DownArcs(
+          const uint32_t vertex) const;
+
+  /**
+   * Expand an arc into the transitions between adjacent edges it is made of.
+   * @param  from    Vertex the arc starts from.
+   * @param  to      Vertex the arc leads to.
+   * @param  arc     Arc (upward or downward).
+   * @param  arcs    Transitions in path order are appended to this, each
+   *                 with the vertex it leads to.
+   */
+  void Unpack(const uint32_t from, const uint32_t to, const ContractionArc& arc,
+              std::vector<std::pair<uint32_t, const ContractionArc*> >& arcs) const;
+
+ protected:
+  midgard::mem_map<char> file_;
+  const ContractionHeader* header_;
+  const ContractionTile* tiles_;
+  const uint32_t* ranks_;
+  const uint64_t* up_offsets_;
+  const ContractionArc* up_arcs_;
+  const uint64_t* down_offsets_;
+  const ContractionArc* down_arcs_;
+};
+
+}
+}
+
+#endif  // VALHALLA_BALDR_CONTRACTIONHIERARCHY_H_
@@ -185,6 +185,26 @@ namespace DateTime {
   std::string get_duration(const std::string& date_time, const uint32_t seconds,
                            const boost::local_time::time_zone_ptr& tz);
 
+  /**
+   * Get the number of seconds elapsed from the start of the week (Sunday
+   * at midnight) for the speed profiles.
+   * @param   date_time in the format of 2015-05-06T08:00 (any utc offset
+   *                    after the time is ignored)
+   * @return  Returns the seconds of the week or kInvalidSecondsOfWeek if
+   *          the date is invalid.
+   */
+  uint32_t seconds_of_week(const std::string& date_time);
+
+  /**
+   * Add x seconds (or subtract, when negative) to a local date_time.
+   * @param   date_time   in the format of 2015-05-06T08:00 (any utc offset
+   *                      after the time is ignored)
+   * @param   seconds     seconds to add to the date_time.
+   * @return  Returns the date_time in the format of 2015-05-06T08:00 or an
+   *          empty string if the date is invalid.
+   */
+  std::string offset_date_time(const std::string& date_time, const int32_t seconds);
+
   /**
    * checks if string is in the format of %Y-%m-%dT%H:%M
    * @param   date_time should be in the format of 2015-05-06T08:00
@@ -347,6 +347,31 @@ class DirectedEdge {
    * */
   void set_opp_index(const uint32_t opp_index);
 
+  /**
+   * Get the number of nodes that can be reached from the end node of this
+   * directed edge by the specified mode (up to kMaxReach). Only auto and
+   * pedestrian access are stored.
+   * @param  access  Access mode.
+   * @return  Returns the reach or -1 if it is not known for the mode.
+   */
+  int32_t reach(const uint32_t access) const {
+    if (access == kAutoAccess) {
+      return static_cast<int32_t>(auto_reach_) - 1;
+    } else if (access == kPedestrianAccess) {
+      return static_cast<int32_t>(pedestrian_reach_) - 1;
+    }
+    return -1;
+  }
+
+  /**
+   * Set the number of nodes that can be reached from the end node of this
+   * directed edge by the specified mode. Values above kMaxReach are stored
+   * as kMaxReach.
+   * @param  access  Access mode (auto or pedestrian).
+   * @param  reach   Number of reachable nodes.
+   */
+  void set_reach(const uint32_t access, const uint32_t reach);
+
   /**
    * Get the cycle lane type along this edge.
    * @returns   Returns the type (if any) of bicycle lane along this edge.
@@ -972,7 +997,9 @@ class DirectedEdge {
  protected:
 
   uint64_t endnode_             : 46; // End node of the directed edge
-  uint64_t spare1_              : 18;
+  uint64_t auto_reach_          : 8;  // Reach from the end node by auto + 1
+  uint64_t pedestrian_reach_    : 8;  // Reach from the end node on foot + 1
+  uint64_t spare1_              : 2;
 
   // Data offsets and flags for extended data. Where a flag exists the actual
   // data can be indexed by the directed edge Id within the tile.
@@ -2,6 +2,8 @@
 #define VALHALLA_BALDR_DOUBLE_BUCKET_QUEUE_H_
 
 #include <cstdint>
+#include <functional>
+#include <limits>
 #include <vector>
 #include <valhalla/midgard/util.h>
 
@@ -61,13 +63,14 @@ class DoubleBucketQueue {
    * @param   cost   Cost for this label.
    */
   void add(const uint32_t label, const float cost) {
-    get_bucket(cost).push_back(label);
+    push(get_bucket(cost), label);
   }
 
   /**
    * The specified label index now has a smaller cost.  Reorders it in the
    * sorted bucket list. Uses the labelcost_ function to get the bucket that
-   * the label is currently within.
+   * the label is currently within. The label's position within that bucket
+   * is tracked so this is constant time.
    * @param  label        Label index to reorder.
    * @param  newcost      New sort cost.
    */
@@ -101,6 +104,30 @@ class DoubleBucketQueue {
   // Cost function to get cost given the label index.
   LabelCost labelcost_;
 
+  // Position of each label within the bucket that holds it
+  std::vector<uint32_t> positions_;
+
+  /**
+   * Appends a label to a bucket, recording its position.
+   * @param  bucket  Bucket to add the label to.
+   * @param  label   Label index.
+   */
+  void push(bucket_t& bucket, const uint32_t label) {
+    if (label >= positions_.size()) {
+      positions_.resize(label + 1);
+    }
+    positions_[label] = bucket.size();
+    bucket.push_back(label);
+  }
+
+  /**
+   * Removes a label from a bucket by moving the last label in the bucket
+   * into its place.
+   * @param  bucket  Bucket holding the label.
+   * @param  label   Label index.
+   */
+  void remove(bucket_t& bucket, const uint32_t label);
+
   /**
    * Returns the bucket given the cost.
    * @param  cost  Cost.
@@ -119,7 +146,7 @@ class DoubleBucketQueue {
    * @return  Returns true if the low-level buckets are all empty.
    */
   bool empty() {
-    while (currentbucket_->empty() && currentbucket_ != buckets_.end()) {
+    while (currentbucket_ != buckets_.end() && currentbucket_->empty()) {
       currentbucket_++;
       currentcost_ += bucketsize_;
     }
@@ -148,6 +148,10 @@ constexpr uint32_t kMaxCurvatureFactor = 15;
 // Maximum added time along shortcuts to approximate transition costs
 constexpr uint32_t kMaxAddedTime = 255;
 
+// Maximum reach (nodes reachable from the end of a directed edge) stored in
+// the tiles
+constexpr uint32_t kMaxReach = 254;
+
 // Node types.
 enum class NodeType : uint8_t {
   kStreetIntersection = 0,    // Regular intersection of 2 roads
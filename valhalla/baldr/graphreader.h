@@ -4,7 +4,11 @@
 #include <cstdint>
 #include <string>
 #include <unordered_map>
+#include <list>
+#include <vector>
+#include <memory>
 #include <mutex>
+#include <atomic>
 
 #include <valhalla/baldr/graphid.h>
 #include <valhalla/baldr/graphtile.h>
@@ -70,6 +74,14 @@ class TileCache {
    */
   virtual void Clear();
 
+  /**
+   * Brings an over committed cache back under its limit. This cache does not
+   * know which tiles are in use so it simply clears itself if over committed.
+   * Like Clear() this must only be called when no pointers returned by Get or
+   * Put are held.
+   */
+  virtual void Trim();
+
  protected:
   // The actual cached GraphTile objects
   std::unordered_map<GraphId, GraphTile> cache_;
@@ -175,6 +187,186 @@ class CopyForwardingTileCache final : public SynchronizedTileCache {
   static std::unordered_set<CopyForwardingTileCache*> members_;
 };
 
+/**
+ * Tile cache that keeps tiles in least recently used order. Instead of being
+ * cleared wholesale it evicts the least recently used tiles when it is trimmed
+ * so that the hot working set survives. Tiles are never evicted on Put so the
+ * pointers handed out stay valid until the next Trim or Clear.
+ * It is NOT thread-safe!
+ */
+class TileCacheLRU : public TileCache {
+ public:
+  /**
+  * Constructor.
+  * @param max_size  maximum size of the cache
+  */
+  TileCacheLRU(size_t max_size);
+
+  /**
+   * Reserves enough cache to hold (max_cache_size / tile_size) items.
+   * @param tile_size appeoximate size of one tile
+   */
+  void Reserve(size_t tile_size) override;
+
+  /**
+   * Checks if tile exists in the cache.
+   * @param graphid  the graphid of the tile
+   * @return true if tile exists in the cache
+   */
+  bool Contains(const GraphId& graphid) const override;
+
+  /**
+   * Puts a copy of a tile of into the cache and marks it most recently used.
+   * @param graphid  the graphid of the tile
+   * @param tile the graph tile
+   * @param size size of the tile in memory
+   */
+  const GraphTile* Put(const GraphId& graphid, const GraphTile& tile, size_t size) override;
+
+  /**
+   * Get a pointer to a graph tile object given a GraphId and mark it as the
+   * most recently used tile.
+   * @param graphid  the graphid of the tile
+   * @return GraphTile* a pointer to the graph tile
+   */
+  const GraphTile* Get(const GraphId& graphid) const override;
+
+  /**
+   * Clears the cache.
+   */
+  void Clear() override;
+
+  /**
+   * Evicts least recently used tiles until the cache is within its limit.
+   */
+  void Trim() override;
+
+  /**
+   * Number of lookups that found their tile in the cache.
+   * @return the hit count
+   */
+  size_t hits() const { return hits_; }
+
+  /**
+   * Number of lookups that did not find their tile in the cache.
+   * @return the miss count
+   */
+  size_t misses() const { return misses_; }
+
+  /**
+   * Number of tiles evicted by Trim.
+   * @return the eviction count
+   */
+  size_t evictions() const { return evictions_; }
+
+ protected:
+  struct entry_t {
+    GraphId id;
+    GraphTile tile;
+    size_t size;
+  };
+  using entry_list_t = std::list<entry_t>;
+
+  // Cached tiles, the most recently used is at the front. Being a list the
+  // tiles never move in memory while they are cached
+  mutable entry_list_t entries_;
+
+  // Lookup of the cached tiles by their graphid
+  std::unordered_map<GraphId, entry_list_t::iterator> index_;
+
+  // Statistics
+  mutable size_t hits_;
+  mutable size_t misses_;
+  size_t evictions_;
+};
+
+/**
+ * Tile cache backed by a single tile store shared by every graph reader in
+ * the process, so N worker threads hold one copy of the working set instead
+ * of N. Tiles in the store are immutable and lookups are lock-free. When the
+ * store is over committed, tiles are evicted in CLOCK order but a tile is
+ * only freed once every reader that could still hold a pointer to it has
+ * been trimmed (ie. finished its request) since the eviction.
+ * It is thread-safe.
+ */
+class SharedTileCache final : public TileCache {
+ public:
+  /**
+  * Constructor.
+  * @param max_size  maximum size of the shared store, the first reader's
+  *                  configuration determines it for the whole process
+  */
+  SharedTileCache(size_t max_size);
+
+  /**
+  * Destructor.
+  */
+  ~SharedTileCache();
+
+  /**
+   * The shared store has a slot for every tile so there is nothing to reserve.
+   * @param tile_size appeoximate size of one tile
+   */
+  void Reserve(size_t tile_size) override;
+
+  /**
+   * Checks if tile exists in the shared store.
+   * @param graphid  the graphid of the tile
+   * @return true if tile exists in the cache
+   */
+  bool Contains(const GraphId& graphid) const override;
+
+  /**
+   * Puts a copy of a tile into the shared store. If another reader stored the
+   * same tile first its copy is returned instead.
+   * @param graphid  the graphid of the tile
+   * @param tile the graph tile
+   * @param size size of the tile in memory
+   */
+  const GraphTile* Put(const GraphId& graphid, const GraphTile& tile, size_t size) override;
+
+  /**
+   * Get a pointer to a graph tile object given a GraphId.
+   * @param graphid  the graphid of the tile
+   * @return GraphTile* a pointer to the graph tile
+   */
+  const GraphTile* Get(const GraphId& graphid) const override;
+
+  /**
+   * Lets you know if the shared store is too large.
+   * @return true if the cache is over committed with respect to the limit
+   */
+  bool OverCommitted() const override;
+
+  /**
+   * Evicts every tile from the shared store.
+   */
+  void Clear() override;
+
+  /**
+   * Marks this reader as holding no tiles, evicts tiles from the shared store
+   * if it is over committed and frees evicted tiles no reader can still hold.
+   */
+  void Trim() override;
+
+ private:
+  struct store_t;
+
+  // Let the store know this reader may hold tiles from now on
+  void Acquire() const;
+
+  // The store shared by all readers in the process
+  static std::shared_ptr<store_t> get_store_instance(size_t max_size);
+  std::shared_ptr<store_t> store_;
+
+  // Store epoch at which this reader started using tiles, 0 while it holds none
+  mutable std::atomic<uint64_t> epoch_;
+  mutable bool holding_;
+
+  // Tiles outside of the hierarchy have no slot in the store
+  TileCache overflow_;
+};
+
 /**
  * Creates tile caches.
  */
@@ -264,6 +456,16 @@ class GraphReader {
     return cache_->OverCommitted();
   }
 
+  /**
+   * Lets the cache know that no tiles are held by the caller anymore and
+   * brings the cache back under its limit if it is over committed. Depending
+   * on the type of cache this evicts some or all of the tiles so only call it
+   * between requests
+   */
+  void Trim() {
+    cache_->Trim();
+  }
+
   /**
    * Convenience method to get an opposing directed edge.
    * @param  edgeid  Graph Id of the directed edge.
@@ -524,6 +726,9 @@ class GraphReader {
   // Information about where the tiles are kept
   std::string tile_dir_;
 
+  // Whether tile files are memory mapped rather than read into memory
+  bool mmap_tiles_;
+
   std::unique_ptr<TileCache> cache_;
 };
 
@@ -17,11 +17,13 @@
 #include <valhalla/baldr/transitschedule.h>
 #include <valhalla/baldr/transittransfer.h>
 #include <valhalla/baldr/sign.h>
+#include <valhalla/baldr/speedprofile.h>
 #include <valhalla/baldr/edgeinfo.h>
 #include <valhalla/baldr/admininfo.h>
 
 #include <valhalla/midgard/util.h>
 #include <valhalla/midgard/aabb2.h>
+#include <valhalla/midgard/sequence.h>
 
 #include <boost/shared_array.hpp>
 #include <memory>
@@ -45,11 +47,14 @@ class GraphTile {
 
   /**
    * Constructor given a GraphId. Reads the graph tile from file
-   * into memory.
+   * into memory or, if requested, memory maps the file read only so that
+   * the kernel pages it in as needed and shares it across processes.
+   * Compressed tiles are always read into memory.
    * @param  tile_dir   Tile directory.
    * @param  graphid    GraphId (tileid and level)
+   * @param  mmap       Memory map the tile file instead of reading it
    */
-  GraphTile(const std::string& tile_dir, const GraphId& graphid);
+  GraphTile(const std::string& tile_dir, const GraphId& graphid, bool mmap = false);
 
   /**
    * Constructor given the graph Id, pointer to the tile data, and the
@@ -401,11 +406,69 @@ class GraphTile {
     }
   }
 
+  /**
+   * Does the tile have speed profiles.
+   * @return  Returns true if the tile has a speed profile section.
+   */
+  bool has_speed_profiles() const {
+    return speed_profile_offsets_ != nullptr;
+  }
+
+  /**
+   * Get the speed profile of a directed edge.
+   * @param  idx  Directed edge index within the tile.
+   * @return  Returns a pointer to the kSpeedCoefficientCount coefficients
+   *          of the speed profile. Returns nullptr if the edge has none.
+   */
+  const int16_t* speed_profile(const uint32_t idx) const {
+    if (speed_profile_offsets_ == nullptr ||
+        idx >= header_->directededgecount() ||
+        speed_profile_offsets_[idx] == kNoSpeedProfile) {
+      return nullptr;
+    }
+    return speed_profiles_ + speed_profile_offsets_[idx] * kSpeedCoefficientCount;
+  }
+
+  /**
+   * Does the directed edge have a speed profile.
+   * @param  de  Directed edge in this tile.
+   * @return  Returns true if the edge has a speed profile.
+   */
+  bool has_speed_profile(const DirectedEdge* de) const {
+    return speed_profile_offsets_ != nullptr &&
+           speed_profile_offsets_[de - directededges_] != kNoSpeedProfile;
+  }
+
+  /**
+   * Get the speed along a directed edge at a time of the week. Uses the
+   * speed profile of the edge if it has one, else the speed of the edge.
+   * @param  de       Directed edge in this tile.
+   * @param  seconds  Seconds from the start of the week (local time) or
+   *                  kInvalidSecondsOfWeek if no time is known.
+   * @return  Returns the speed in kph.
+   */
+  uint32_t GetSpeed(const DirectedEdge* de, const uint32_t seconds) const {
+    if (seconds == kInvalidSecondsOfWeek || speed_profile_offsets_ == nullptr) {
+      return de->speed();
+    }
+    uint32_t profile = speed_profile_offsets_[de - directededges_];
+    if (profile == kNoSpeedProfile) {
+      return de->speed();
+    }
+    float speed = decompress_speed_bucket(speed_profiles_ + profile * kSpeedCoefficientCount,
+                                          seconds / kSpeedBucketSeconds);
+    return (speed < 1.0f) ? 1 : (speed > kMaxSpeedKph) ? kMaxSpeedKph :
+            static_cast<uint32_t>(speed + 0.5f);
+  }
+
  protected:
 
   // Graph tile memory, this must be shared so that we can put it into cache
   boost::shared_ptr<std::vector<char>> graphtile_;
 
+  // Memory mapped graph tile file, shared for the same reason
+  boost::shared_ptr<midgard::mem_map<char>> memmap_;
+
   // Header information for the tile
   GraphTileHeader* header_;
 
@@ -492,6 +555,11 @@ class GraphTile {
   // Edge elevation data
   EdgeElevation* edge_elevation_;
 
+  // Speed profile index of each directed edge and the speed profiles. Both
+  // are nullptr if the tile has no speed profiles.
+  uint32_t* speed_profile_offsets_;
+  int16_t* speed_profiles_;
+
   // Map of stop one stops in this tile.
   std::unordered_map<std::string, tile_index_pair> stop_one_stops;
 
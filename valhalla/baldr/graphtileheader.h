@@ -14,7 +14,7 @@ namespace baldr {
 // something to the tile simply subtract one from this number and add it
 // just before the empty_slots_ array below. NOTE that it can ONLY be an
 // offset in bytes and NOT a bitfield or union or anything of that sort
-constexpr size_t kEmptySlots = 13;
+constexpr size_t kEmptySlots = 12;
 
 // Maximum size of the version string (stored as a fixed size
 // character array so the GraphTileHeader size remains fixed).
@@ -458,6 +458,20 @@ class GraphTileHeader {
    */
   void set_edge_elevation_offset(const uint32_t offset);
 
+  /**
+   * Gets the offset to the speed profiles.
+   * @return  Returns the number of bytes to offset to the speed profiles.
+   */
+  uint32_t speed_profile_offset() const {
+    return speed_profile_offset_;
+  }
+
+  /**
+   * Sets the offset to the speed profiles.
+   * @param offset Offset in bytes to the start of the speed profiles.
+   */
+  void set_speed_profile_offset(const uint32_t offset);
+
   /**
    * Get the offset to the end of the tile
    * @return the number of bytes in the tile, unless the last slot is used
@@ -532,6 +546,12 @@ class GraphTileHeader {
   // Offset to the beginning of the edge elevation data.
   uint32_t edge_elevation_offset_;
 
+  // Offset to the beginning of the speed profiles. Tiles with speed profiles
+  // have a profile index for every directed edge followed by the profiles.
+  // Tiles built before this offset was added hold their end offset here, so
+  // an offset at the end of the tile means there are no speed profiles
+  uint32_t speed_profile_offset_;
+
   // Marks the end of this version of the tile with the rest of the slots
   // being available for growth. If you want to use one of the empty slots,
   // simply add a uint32_t some_offset_; just above empty_slots_ and decrease
@@ -11,6 +11,7 @@
 #include <list>
 #include <sstream>
 #include <iomanip>
+#include <cmath>
 
 namespace valhalla {
 namespace baldr {
@@ -50,87 +51,175 @@ class Jarray : public std::list<Value> {
   friend std::ostream& operator<<(std::ostream&, const Jarray&);
 };
 
-//how we serialize the different primitives to string
-class OstreamVisitor : public boost::static_visitor<std::ostream&>
-{
+//writes json text straight into a string as it goes without building a tree first. inside of
+//objects each value needs a key before it. numbers are formatted by hand rather than through
+//a stream so large responses dont pay for iostream formatting on every element
+class Jwriter {
  public:
-  OstreamVisitor(std::ostream& o):ostream_(o), fill(o.fill()){}
-
-  std::ostream& operator()(const std::string& value) const {
-    ostream_ << '"';
-    //TODO: this may need to get more complicated
-    for (const auto& c : value) {
-      switch (c) {
-      case '\\': ostream_ << "\\\\"; break;
-      case '"': ostream_ << "\\\""; break;
-      case '/': ostream_ << "\\/"; break;
-      case '\b': ostream_ << "\\b"; break;
-      case '\f': ostream_ << "\\f"; break;
-      case '\n': ostream_ << "\\n"; break;
-      case '\r': ostream_ << "\\r"; break;
-      case '\t': ostream_ << "\\t"; break;
+  explicit Jwriter(std::string& buffer):buffer_(buffer), separate_(false){}
+
+  void start_object() { separator(); buffer_.push_back('{'); separate_ = false; }
+  void end_object() { buffer_.push_back('}'); separate_ = true; }
+  void start_array() { separator(); buffer_.push_back('['); separate_ = false; }
+  void end_array() { buffer_.push_back(']'); separate_ = true; }
+
+  void key(const std::string& key) {
+    separator();
+    quote(key.data(), key.size());
+    buffer_.push_back(':');
+    separate_ = false;
+  }
+
+  void value(const std::string& value) { separator(); quote(value.data(), value.size()); separate_ = true; }
+  void value(const char* value) { separator(); quote(value, std::char_traits<char>::length(value)); separate_ = true; }
+  void value(uint64_t value) { separator(); integer(value, false); separate_ = true; }
+  void value(int64_t value) {
+    separator();
+    integer(value < 0 ? ~static_cast<uint64_t>(value) + 1 : static_cast<uint64_t>(value), value < 0);
+    separate_ = true;
+  }
+  void value(const fp_t& value) { separator(); fixed(value); separate_ = true; }
+  void value(bool value) { separator(); buffer_.append(value ? "true" : "false"); separate_ = true; }
+  void value(std::nullptr_t) { separator(); buffer_.append("null"); separate_ = true; }
+  void value(const Jmap& value);
+  void value(const Jarray& value);
+  void value(const MapPtr& value) { this->value(*value); }
+  void value(const ArrayPtr& value) { this->value(*value); }
+  void value(const Value& value);
+
+  //a key and its value in one go
+  template <typename T>
+  void operator()(const std::string& key, const T& value) { this->key(key); this->value(value); }
+
+  //the same text std::fixed with a precision would give for a floating point number
+  static void fixed(std::string& buffer, long double value, size_t precision) {
+    static const long double powers[] = {1e0L, 1e1L, 1e2L, 1e3L, 1e4L, 1e5L, 1e6L, 1e7L, 1e8L, 1e9L};
+    //the common case is rounded to an integer of all the digits we want and written out
+    if(precision < 10 && std::isfinite(value) && std::fabs(value) < 1e9L) {
+      auto digits = static_cast<uint64_t>(std::nearbyint(std::fabs(value) * powers[precision]));
+      char text[32];
+      char* end = text + sizeof(text);
+      char* begin = end;
+      for(size_t i = 0; i < precision; ++i, digits /= 10)
+        *--begin = '0' + digits % 10;
+      if(precision)
+        *--begin = '.';
+      do { *--begin = '0' + digits % 10; digits /= 10; } while(digits);
+      if(std::signbit(value))
+        *--begin = '-';
+      buffer.append(begin, end - begin);
+      return;
+    }
+    //anything else goes the slow way
+    std::ostringstream stream;
+    stream << std::setprecision(precision) << std::fixed << value;
+    buffer.append(stream.str());
+  }
+
+ private:
+  void separator() {
+    if(separate_)
+      buffer_.push_back(',');
+  }
+
+  void integer(uint64_t value, bool negative) {
+    char text[24];
+    char* end = text + sizeof(text);
+    char* begin = end;
+    do { *--begin = '0' + value % 10; value /= 10; } while(value);
+    if(negative)
+      *--begin = '-';
+    buffer_.append(begin, end - begin);
+  }
+
+  void fixed(const fp_t& value) { fixed(buffer_, value.value, value.precision); }
+
+  void quote(const char* text, size_t size) {
+    static const char hex[] = "0123456789ABCDEF";
+    buffer_.push_back('"');
+    //copy runs of characters that dont need escaping all at once
+    const char* run = text;
+    const char* end = text + size;
+    for(const char* c = text; c < end; ++c) {
+      const char* escaped = nullptr;
+      switch(*c) {
+      case '\\': escaped = "\\\\"; break;
+      case '"': escaped = "\\\""; break;
+      case '/': escaped = "\\/"; break;
+      case '\b': escaped = "\\b"; break;
+      case '\f': escaped = "\\f"; break;
+      case '\n': escaped = "\\n"; break;
+      case '\r': escaped = "\\r"; break;
+      case '\t': escaped = "\\t"; break;
       default:
-        if(c >= 0 && c < 32) {
-          //format changes for json hex
-          ostream_.setf(std::ios::hex, std::ios::basefield);
-          ostream_.setf(std::ios::uppercase);
-          ostream_.fill('0');
-          //output hex
-          ostream_ << "\\u" << std::setw(4) << static_cast<int>(c);
-          //tear down format changes
-          ostream_.unsetf(std::ios::basefield);
-          ostream_.unsetf(std::ios::uppercase);
-          ostream_.fill(fill);
+        if(*c >= 0 && *c < 32) {
+          buffer_.append(run, c - run);
+          buffer_.append("\\u00");
+          buffer_.push_back(hex[*c >> 4]);
+          buffer_.push_back(hex[*c & 15]);
+          run = c + 1;
         }
-        else
-          ostream_ << c;
-        break;
+        continue;
       }
+      buffer_.append(run, c - run);
+      buffer_.append(escaped);
+      run = c + 1;
     }
-    return ostream_ << '"';
+    buffer_.append(run, end - run);
+    buffer_.push_back('"');
   }
-  std::ostream& operator()(uint64_t value) const { return ostream_ << value; }
-  std::ostream& operator()(int64_t value) const { return ostream_ << value; }
-  std::ostream& operator()(fp_t value) const { return ostream_ << value; }
-  std::ostream& operator()(bool value) const { return ostream_ << (value ? "true" : "false"); }
-  std::ostream& operator()(std::nullptr_t value) const { return ostream_ << "null"; }
-  std::ostream& operator()(const MapPtr& value) const { return ostream_ << *value; }
-  std::ostream& operator()(const ArrayPtr& value) const { return ostream_ << *value; }
+
+  std::string& buffer_;
+  bool separate_;
+};
+
+//how we serialize the different primitives to the writer
+class WriterVisitor : public boost::static_visitor<>
+{
+ public:
+  WriterVisitor(Jwriter& writer):writer_(writer){}
+  template <typename T>
+  void operator()(const T& value) const { writer_.value(value); }
  private:
-  std::ostream& ostream_;
-  char fill;
+  Jwriter& writer_;
 };
 
+inline void Jwriter::value(const Jmap& value) {
+  start_object();
+  for(const auto& key_value : value) {
+    key(key_value.first);
+    this->value(key_value.second);
+  }
+  end_object();
+}
+
+inline void Jwriter::value(const Jarray& value) {
+  start_array();
+  for(const auto& element : value)
+    this->value(element);
+  end_array();
+}
+
+inline void Jwriter::value(const Value& value) {
+  boost::apply_visitor(WriterVisitor(*this), value);
+}
+
 inline std::ostream& operator<<(std::ostream& stream, const fp_t& fp){
-  stream << std::setprecision(fp.precision) << std::fixed << fp.value;
-  return stream;
+  std::string text;
+  Jwriter::fixed(text, fp.value, fp.precision);
+  return stream << text;
 }
 
 inline std::ostream& operator<<(std::ostream& stream, const Jmap& json){
-  stream << '{';
-  bool seprator = false;
-  for(const auto& key_value : json) {
-    if(seprator)
-      stream << ',';
-    seprator = true;
-    stream << '"' << key_value.first << "\":";
-    boost::apply_visitor(OstreamVisitor(stream), key_value.second);
-  }
-  stream << '}';
-  return stream;
+  std::string text;
+  Jwriter(text).value(json);
+  return stream << text;
 }
 
 inline std::ostream& operator<<(std::ostream& stream, const Jarray& json){
-  stream << '[';
-  bool seprator = false;
-  for(const auto& element : json) {
-    if(seprator)
-      stream << ',';
-    seprator = true;
-    boost::apply_visitor(OstreamVisitor(stream), element);
-  }
-  stream << ']';
-  return stream;
+  std::string text;
+  Jwriter(text).value(json);
+  return stream << text;
 }
 
 inline MapPtr map(std::initializer_list<Jmap::value_type> list) {
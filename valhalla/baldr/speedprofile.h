@@ -0,0 +1,62 @@
+#ifndef VALHALLA_BALDR_SPEEDPROFILE_H_
+#define VALHALLA_BALDR_SPEEDPROFILE_H_
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace valhalla {
+namespace baldr {
+
+// Historical speeds are given for each 15 minute bucket of the week, starting
+// Sunday at 00:00 local time. Each profile is stored as the first DCT-II
+// coefficients of the bucket speeds, scaled and rounded to 16 bit integers.
+constexpr uint32_t kSecondsPerWeek = 7 * 24 * 3600;
+constexpr uint32_t kSpeedBucketSeconds = 15 * 60;
+constexpr uint32_t kSpeedBucketCount = kSecondsPerWeek / kSpeedBucketSeconds;
+constexpr uint32_t kSpeedCoefficientCount = 48;
+constexpr float kSpeedCoefficientScale = 4.0f;
+
+// Time of the week when no time is known (no date time in the request)
+constexpr uint32_t kInvalidSecondsOfWeek = std::numeric_limits<uint32_t>::max();
+
+// Profile index of directed edges without a speed profile
+constexpr uint32_t kNoSpeedProfile = std::numeric_limits<uint32_t>::max();
+
+using speed_profile_t = std::array<int16_t, kSpeedCoefficientCount>;
+
+/**
+ * Compress the speeds of a week into a speed profile.
+ * @param  speeds  Speeds (kph) for each of the kSpeedBucketCount buckets.
+ * @return Returns the speed profile coefficients.
+ */
+speed_profile_t compress_speed_buckets(const float* speeds);
+
+/**
+ * Get the speed in one bucket of the week from a speed profile.
+ * @param  coefficients  Speed profile coefficients.
+ * @param  bucket        Bucket of the week (0 to kSpeedBucketCount - 1).
+ * @return Returns the speed in kph.
+ */
+float decompress_speed_bucket(const int16_t* coefficients, const uint32_t bucket);
+
+/**
+ * Get the time of the week some seconds after (or before, when negative)
+ * a time of the week.
+ * @param  seconds  Seconds from the start of the week or kInvalidSecondsOfWeek.
+ * @param  offset   Seconds to add.
+ * @return Returns the seconds from the start of the week, kInvalidSecondsOfWeek
+ *         if the time is not known.
+ */
+inline uint32_t offset_seconds_of_week(const uint32_t seconds, const float offset) {
+  if (seconds == kInvalidSecondsOfWeek) {
+    return kInvalidSecondsOfWeek;
+  }
+  int64_t s = (static_cast<int64_t>(seconds) + static_cast<int64_t>(offset)) % kSecondsPerWeek;
+  return static_cast<uint32_t>(s < 0 ? s + kSecondsPerWeek : s);
+}
+
+}
+}
+
+#endif  // VALHALLA_BALDR_SPEEDPROFILE_H_
@@ -0,0 +1,58 @@
+#ifndef VALHALLA_LOKI_BATCH_PROJECTOR_H_
+#define VALHALLA_LOKI_BATCH_PROJECTOR_H_
+
+#include <cstddef>
+#include <vector>
+#include <valhalla/midgard/pointll.h>
+
+namespace valhalla{
+namespace loki{
+
+//the closest point of a shape to a location
+struct projection_t {
+  float sq_distance;
+  midgard::PointLL point;
+  size_t index; //segment of the shape the point is on
+};
+
+/**
+ * Projects a batch of locations onto every segment of an edge shape. The
+ * locations and the shape are kept as structures of arrays so that when the
+ * library is built for AVX2 eight segments are projected at once, otherwise
+ * a scalar loop is used. Both give the same results as projecting one
+ * location onto one segment at a time with a DistanceApproximator.
+ */
+class batch_projector_t {
+ public:
+  void clear_locations();
+  void add_location(const midgard::PointLL& ll);
+  size_t location_count() const;
+
+  void clear_shape();
+  void add_shape_point(const midgard::PointLL& ll);
+  size_t shape_size() const;
+
+  /**
+   * Find the closest point of the shape to each location. A shape without
+   * segments leaves every location at the maximum float distance.
+   *
+   * @param closest  set to the projection of each location, in the order
+   *                 the locations were added
+   */
+  void project(std::vector<projection_t>& closest) const;
+
+ protected:
+  //locations and the scales the projection and distance approximation use
+  std::vector<float> lngs;
+  std::vector<float> lats;
+  std::vector<float> lon_scales;
+  std::vector<float> m_per_lng_degrees;
+
+  std::vector<float> shape_lngs;
+  std::vector<float> shape_lats;
+};
+
+}
+}
+
+#endif  // VALHALLA_LOKI_BATCH_PROJECTOR_H_
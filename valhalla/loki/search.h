@@ -38,11 +38,15 @@ const sif::NodeFilter PassThroughNodeFilter = [](const baldr::NodeInfo* node){ r
  * @param reader         and object used to access tiled route data TODO: switch this out for a proper cache
  * @param edge_filter    a function/functor to be used in the rejection of edges. defaults to a pass through filter
  * @param node_filter    a function/functor to be used in the rejection of nodes used in graph traversal. defaults to a pass through filter
+ * @param access_mode    access mode of the costing the filters came from. when the tiles store reachability for the mode it is
+ *                       used instead of expanding the graph, which is only right if the filters are the ones the costing gives.
+ *                       defaults to 0 which always expands the graph
  * @return pathLocations the correlated data with in the tile that matches the inputs. If a projection is not found, it will not have any entry in the returned value.
  */
 std::unordered_map<baldr::Location, baldr::PathLocation>
 Search(const std::vector<baldr::Location>& locations, baldr::GraphReader& reader,
-  const sif::EdgeFilter& edge_filter = PassThroughEdgeFilter, const sif::NodeFilter& node_filter = PassThroughNodeFilter);
+  const sif::EdgeFilter& edge_filter = PassThroughEdgeFilter, const sif::NodeFilter& node_filter = PassThroughNodeFilter,
+  uint32_t access_mode = 0);
 
 }
 }
@@ -9,6 +9,7 @@
 #include <valhalla/worker.h>
 #include <valhalla/midgard/pointll.h>
 #include <valhalla/baldr/location.h>
+#include <valhalla/baldr/pathlocation.h>
 #include <valhalla/baldr/graphreader.h>
 #include <valhalla/baldr/connectivity_map.h>
 #include <valhalla/sif/costfactory.h>
@@ -35,6 +36,8 @@ namespace valhalla {
       void matrix(tyr::ACTION_TYPE action, rapidjson::Document& request);
       void isochrones(rapidjson::Document& request);
       void trace(tyr::ACTION_TYPE action, rapidjson::Document& request);
+      //the locations correlated by the last request, indexed like its locations
+      const std::vector<baldr::PathLocation>& correlated_locations() const;
 
      protected:
 
@@ -55,9 +58,11 @@ namespace valhalla {
       std::vector<baldr::Location> sources;
       std::vector<baldr::Location> targets;
       std::vector<midgard::PointLL> shape;
+      std::vector<baldr::PathLocation> correlated;
       sif::CostFactory<sif::DynamicCost> factory;
       sif::EdgeFilter edge_filter;
       sif::NodeFilter node_filter;
+      uint32_t access_mode;
       valhalla::baldr::GraphReader reader;
       valhalla::baldr::connectivity_map_t connectivity_map;
       std::unordered_set<std::string> actions;
@@ -44,8 +44,8 @@ class mem_map {
   mem_map(): ptr(nullptr), count(0), file_name("") { }
 
   //construct with file
-  mem_map(const std::string& file_name, size_t size): ptr(nullptr), count(0), file_name("") {
-    map(file_name, size);
+  mem_map(const std::string& file_name, size_t size, bool read_only = false): ptr(nullptr), count(0), file_name("") {
+    map(file_name, size, read_only);
   }
 
   //unmap when done
@@ -53,17 +53,17 @@ class mem_map {
     unmap();
   }
 
-  //reset to another file or another size
-  void map(const std::string& new_file_name, size_t new_count) {
+  //reset to another file or another size, read only maps can be of files we cant write to
+  void map(const std::string& new_file_name, size_t new_count, bool read_only = false) {
     //just in case there was already something
     unmap();
 
     //has to be something to map
     if(new_count > 0) {
-      auto fd = open(new_file_name.c_str(), O_RDWR, 0);
+      auto fd = open(new_file_name.c_str(), read_only ? O_RDONLY : O_RDWR, 0);
       if(fd == -1)
         throw std::runtime_error(new_file_name + "(open): " + strerror(errno));
-      ptr = mmap(nullptr, new_count * sizeof(T), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      ptr = mmap(nullptr, new_count * sizeof(T), read_only ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
       if(ptr == MAP_FAILED)
         throw std::runtime_error(new_file_name + "(mmap): " + strerror(errno));
       auto cl = close(fd);
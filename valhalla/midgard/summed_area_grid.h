@@ -0,0 +1,69 @@
+#ifndef VALHALLA_MIDGARD_SUMMEDAREAGRID_H_
+#define VALHALLA_MIDGARD_SUMMEDAREAGRID_H_
+
+#include <valhalla/midgard/tiles.h>
+#include <vector>
+
+namespace valhalla {
+namespace midgard {
+
+/**
+ * Class to sum values over rectangular areas of a grid in constant time.
+ * Values are added to the grid cells and then the grid is converted into
+ * a summed-area table, where each entry holds the sum of all cells below
+ * and to the left of it (inclusive).
+ */
+template <class coord_t>
+class SummedAreaGrid : public Tiles<coord_t> {
+ public:
+  /**
+   * Constructor.
+   * @param   bounds    Bounding box
+   * @param   cellsize  Grid cell size
+   */
+  SummedAreaGrid(const AABB2<coord_t>& bounds, const float cellsize);
+
+  /**
+   * Add a value to the grid cell at a specified point. Verifies that the
+   * point is within the grid. Values can only be added before Build is called.
+   * @param  pt     Coordinate within the grid.
+   * @param  value  Value to add to the grid cell.
+   * @return whether or not the value was added
+   */
+  bool Add(const coord_t& pt, const float value);
+
+  /**
+   * Convert the cell values into the summed-area table.
+   */
+  void Build();
+
+  /**
+   * Get the sum of the values in all grid cells whose centers are within a
+   * bounding box, including its min edges and excluding its max edges, so
+   * the cells counted cover the same area as the box. Counting every cell
+   * the box touches would overstate the sum by up to a cell along each side.
+   * The bounding box is clipped to the grid. Only valid after Build is called.
+   * @param  box  Bounding box.
+   * @return Returns the sum of the cell values.
+   */
+  double Sum(const AABB2<coord_t>& box) const;
+
+ protected:
+  // Get the first column or row with its cell center at or after a
+  // coordinate, or the last one with its cell center before it, clamped to
+  // the grid. The last is less than the first when no cell center lies
+  // between them.
+  int32_t FirstCol(const float x) const;
+  int32_t LastCol(const float x) const;
+  int32_t FirstRow(const float y) const;
+  int32_t LastRow(const float y) const;
+
+  // Summed-area table with an extra leading row and column of zeros so that
+  // sums along the left and bottom edges need no special cases
+  std::vector<double> sums_;
+};
+
+}
+}
+
+#endif  // VALHALLA_MIDGARD_SUMMEDAREAGRID_H_
@@ -10,9 +10,11 @@
 #include <boost/geometry/geometries/polygon.hpp>
 #include <boost/geometry/multi/geometries/multi_polygon.hpp>
 #include <boost/geometry/io/wkt/wkt.hpp>
+#include <boost/geometry/index/rtree.hpp>
 #include <sqlite3.h>
 #include <spatialite.h>
 #include <unordered_map>
+#include <vector>
 
 #include "mjolnir/graphtilebuilder.h"
 
@@ -26,6 +28,80 @@ namespace mjolnir {
 typedef boost::geometry::model::d2::point_xy<double> point_type;
 typedef boost::geometry::model::polygon<point_type> polygon_type;
 typedef boost::geometry::model::multi_polygon<polygon_type> multi_polygon_type;
+typedef boost::geometry::model::box<point_type> box_type;
+
+/**
+ * Spatial index over the admin or timezone polygons of a tile used to find
+ * the polygon covering a point. Polygons are filtered by bounding box with
+ * an R-tree. In addition the bounds of the tile are divided into a grid and
+ * each cell is classified the first time a point falls within it: cells
+ * covered by a single polygon and cells outside of all polygons answer
+ * lookups without any point in polygon tests, only points in cells crossed
+ * by a polygon boundary are tested against the candidate polygons of the
+ * cell. The result is the same as GetMultiPolyId with the same polygons.
+ *
+ * The index refers to the polygons passed to the constructor, which must
+ * outlive it. It is not thread-safe since cells are classified lazily.
+ */
+class PolygonIndex {
+ public:
+  /**
+   * Constructor.
+   * @param  polys      unordered map of polys (by admin or timezone index).
+   * @param  bounds     Bounds that most lookups fall within (the tile bounds).
+   * @param  divisions  Number of grid cells along each side of the bounds.
+   */
+  PolygonIndex(const std::unordered_map<uint32_t,multi_polygon_type>& polys,
+               const AABB2<PointLL>& bounds, const uint32_t divisions = 16);
+
+  /**
+   * Get the index of the polygon that covers the point.
+   * @param  ll  point that needs to be checked.
+   * @return Returns the index of the polygon, 0 if none covers the point.
+   */
+  uint32_t GetId(const PointLL& ll) const;
+
+ protected:
+  // A single polygon of a multi polygon. Parts are kept in the iteration
+  // order of the map so that the first covering part matches GetMultiPolyId
+  struct Part {
+    uint32_t id;
+    const polygon_type* polygon;
+    box_type box;
+  };
+
+  // Grid cell, resolved cells have an id (0 if outside of all polygons)
+  // while the others list the parts that intersect the cell
+  struct Cell {
+    bool classified = false;
+    bool resolved = false;
+    uint32_t id = 0;
+    std::vector<uint32_t> candidates;
+  };
+
+  typedef std::pair<box_type, uint32_t> value_type;
+  typedef boost::geometry::index::rtree<value_type,
+              boost::geometry::index::quadratic<16> > rtree_type;
+
+  // Get the parts whose bounding box intersects the box, in part order
+  std::vector<uint32_t> Candidates(const box_type& box) const;
+
+  // Get the id of the first of the candidate parts that covers the point
+  uint32_t Find(const std::vector<uint32_t>& candidates,
+                const point_type& p) const;
+
+  // Classify a cell
+  void Classify(const uint32_t row, const uint32_t col, Cell& cell) const;
+
+  std::vector<Part> parts_;
+  rtree_type rtree_;
+
+  AABB2<PointLL> bounds_;
+  uint32_t divisions_;
+  double cell_width_;
+  double cell_height_;
+  mutable std::vector<Cell> cells_;
+};
 
 /**
  * Get the dbhandle of a sqlite db.  Used for timezones and admins DBs.
@@ -41,6 +117,14 @@ sqlite3 * GetDBHandle(const std::string& database);
 uint32_t GetMultiPolyId(const std::unordered_map<uint32_t,multi_polygon_type>& polys,
                         const PointLL& ll);
 
+/**
+ * Get the polygon index using a spatial index of the polys. Equivalent to
+ * GetMultiPolyId with the polys the index was created from.
+ * @param  index   spatial index of the polys.
+ * @param  ll      point that needs to be checked.
+ */
+uint32_t GetMultiPolyId(const PolygonIndex& index, const PointLL& ll);
+
 /**
  * Get the timezone polys from the db
  * @param  db_handle    sqlite3 db handle
@@ -0,0 +1,204 @@
+#ifndef VALHALLA_MJOLNIR_CONTRACTIONBUILDER_H
+#define VALHALLA_MJOLNIR_CONTRACTIONBUILDER_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/property_tree/ptree.hpp>
+
+#include <valhalla/baldr/contractionhierarchy.h>
+
+namespace valhalla {
+namespace mjolnir {
+
+/**
+ * Arcs of every vertex of a graph kept in one flat array. The arcs of a
+ * vertex are together in a block. A block that is full moves to the end of
+ * the array with twice the room, and the array is compacted when most of it
+ * is no longer used.
+ */
+class ArcLists {
+ public:
+  // Arcs of one vertex, invalidated when arcs are added to any vertex
+  template <class arc_t>
+  struct range_t {
+    arc_t* first;
+    arc_t* last;
+    arc_t* begin() const { return first; }
+    arc_t* end() const { return last; }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+  };
+
+  /**
+   * Constructor.
+   * @param  vertex_count  Number of vertices.
+   */
+  explicit ArcLists(const uint32_t vertex_count);
+
+  /**
+   * Get the arcs of a vertex.
+   * @param  vertex  Vertex.
+   * @return Returns the range of arcs of the vertex.
+   */
+  range_t<baldr::ContractionArc> operator[](const uint32_t vertex) {
+    baldr::ContractionArc* first = arcs_.data() + blocks_[vertex].offset;
+    return { first, first + blocks_[vertex].size };
+  }
+  range_t<const baldr::ContractionArc> operator[](const uint32_t vertex) const {
+    const baldr::ContractionArc* first = arcs_.data() + blocks_[vertex].offset;
+    return { first, first + blocks_[vertex].size };
+  }
+
+  /**
+   * Get the number of vertices.
+   */
+  uint32_t vertex_count() const {
+    return blocks_.size();
+  }
+
+  /**
+   * Get the number of arcs of all vertices.
+   */
+  uint64_t arc_count() const {
+    return arc_count_;
+  }
+
+  /**
+   * Add an arc to a vertex.
+   * @param  vertex  Vertex.
+   * @param  arc     Arc to add.
+   */
+  void Add(const uint32_t vertex, const baldr::ContractionArc& arc);
+
+  /**
+   * Remove the arc of a vertex that leads to another vertex.
+   * @param  vertex  Vertex.
+   * @param  other   Vertex at the other end of the arc.
+   */
+  void Remove(const uint32_t vertex, const uint32_t other);
+
+  /**
+   * Replace the arcs of a vertex with a copy of arcs from another list.
+   * @param  vertex  Vertex.
+   * @param  arcs    Arcs to copy.
+   */
+  void Assign(const uint32_t vertex, const range_t<baldr::ContractionArc>& arcs);
+
+  /**
+   * Remove all arcs of a vertex.
+   * @param  vertex  Vertex.
+   */
+  void Clear(const uint32_t vertex);
+
+ protected:
+  struct block_t {
+    uint64_t offset;
+    uint32_t size;
+    uint32_t capacity;
+  };
+
+  // Move the arcs of a vertex to a new block at the end of the array
+  void Move(const uint32_t vertex, const uint32_t capacity);
+
+  // Keep only the arcs in use, each block just large enough for its arcs
+  void Compact();
+
+  std::vector<block_t> blocks_;
+  std::vector<baldr::ContractionArc> arcs_;
+  uint64_t arc_count_;
+};
+
+/**
+ * Contracts a directed graph one vertex at a time. Vertices are ordered by
+ * the number of shortcuts their contraction adds less the arcs it removes
+ * (the edge difference) plus the number of neighbors already contracted,
+ * with priorities updated lazily. A shortcut is only added when a bounded
+ * search (the witness search) finds no path around the vertex that is as
+ * cheap.
+ */
+class Contractor {
+ public:
+  /**
+   * Constructor.
+   * @param  vertex_count  Number of vertices.
+   */
+  explicit Contractor(const uint32_t vertex_count);
+
+  /**
+   * Add an arc. Only the cheapest arc between two vertices is kept.
+   * @param  from  Vertex the arc leaves.
+   * @param  to    Vertex the arc enters.
+   * @param  cost  Cost of the arc.
+   * @param  secs  Elapsed time along the arc.
+   * @param  length  Length along the arc (meters).
+   */
+  void AddArc(const uint32_t from, const uint32_t to, const float cost,
+              const float secs, const uint32_t length);
+
+  /**
+   * Contract all vertices.
+   */
+  void Contract();
+
+  /**
+   * Write the hierarchy. Must be called after Contract.
+   * @param  file_name  Output file.
+   * @param  tiles      Tiles the vertices belong to, sorted by graph Id.
+   * @param  tile_fingerprint  ContractionHierarchy::TileFingerprint of the
+   *                           tiles the hierarchy is built from.
+   */
+  void Write(const std::string& file_name,
+             const std::vector<baldr::ContractionTile>& tiles,
+             const uint64_t tile_fingerprint = 0) const;
+
+ protected:
+  // Shortcut needed to contract a vertex: the vertex it leaves and the arc
+  using shortcut_t = std::pair<uint32_t, baldr::ContractionArc>;
+
+  // Add an arc to the remaining graph or lower the cost of the existing one
+  void AddOrUpdate(const uint32_t from, const baldr::ContractionArc& arc);
+
+  // Find the shortcuts needed to contract a vertex
+  void FindShortcuts(const uint32_t vertex, std::vector<shortcut_t>& shortcuts);
+
+  // Priority of a vertex, lower priorities are contracted first
+  int32_t Priority(const uint32_t vertex, std::vector<shortcut_t>& shortcuts);
+
+  // Arcs of the remaining (not yet contracted) graph. The vertex of an
+  // incoming arc is the vertex the arc leaves.
+  ArcLists out_;
+  ArcLists in_;
+
+  // Arcs of contracted vertices to higher ranked vertices
+  ArcLists up_;
+  ArcLists down_;
+
+  std::vector<uint32_t> ranks_;
+  std::vector<uint32_t> contracted_neighbors_;
+
+  // Witness search costs, kept between searches and reset for the
+  // vertices touched
+  std::vector<float> witness_cost_;
+  std::vector<uint32_t> witness_touched_;
+};
+
+/**
+ * Builds a contraction hierarchy of the routing graph for the default auto
+ * costing. Vertices of the hierarchy are directed edges so turn costs and
+ * simple turn restrictions are part of the arcs. Used by thor to route
+ * auto requests that do not customize the costing.
+ */
+class ContractionBuilder {
+ public:
+  /**
+   * Build the contraction hierarchy of the tiles.
+   */
+  static void Build(const boost::property_tree::ptree& pt);
+};
+
+}
+}
+
+#endif  // VALHALLA_MJOLNIR_CONTRACTIONBUILDER_H
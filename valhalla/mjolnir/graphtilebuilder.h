@@ -62,6 +62,14 @@ class GraphTileBuilder : public baldr::GraphTile {
    */
   void StoreTileData();
 
+  /**
+   * Output the tile to file under a different base directory than the one
+   * it was read from. Lets builders that run in parallel stage their output
+   * while other threads are still reading the original tiles.
+   * @param  tile_dir  Base directory path to write the tile under.
+   */
+  void StoreTileData(const std::string& tile_dir);
+
   /**
    * Update a graph tile with new nodes and directed edges. Assumes no new
    * nodes or edges are added. Attributes within existing nodes and edges
@@ -377,6 +385,14 @@ class GraphTileBuilder : public baldr::GraphTile {
     */
    std::vector<EdgeElevation>& edge_elevations();
 
+  /**
+   * Add a speed profile to a directed edge. Replaces any profile the edge
+   * already has.
+   * @param  idx      Directed edge index within the tile.
+   * @param  profile  Speed profile coefficients.
+   */
+  void AddSpeedProfile(const uint32_t idx, const baldr::speed_profile_t& profile);
+
  protected:
 
   struct EdgeTupleHasher {
@@ -489,6 +505,11 @@ class GraphTileBuilder : public baldr::GraphTile {
   // List of edge elevation records. Index with directed edge Id.
   std::vector<EdgeElevation> edge_elevation_builder_;
 
+  // Speed profile index of each directed edge (empty if there are no speed
+  // profiles) and the speed profile coefficients.
+  std::vector<uint32_t> speed_profile_offsets_builder_;
+  std::vector<int16_t> speed_profile_builder_;
+
   // lane connectivity list offset
   uint32_t lane_connectivity_offset_ = 0;
 };
@@ -33,6 +33,7 @@
 
 #include <string>
 #include <fstream>
+#include <memory>
 
 // this describes the low-level blob storage
 #include "proto/fileformat.pb.h"
@@ -65,14 +66,24 @@ struct Callback {
   virtual void way_callback(const uint64_t osmid, const Tags& tags, const std::vector<uint64_t>& nodes) = 0;
   virtual void relation_callback(const uint64_t osmid, const Tags &tags, const std::vector<Member> &members) = 0;
   virtual void changeset_callback(const uint64_t changeset_id) = 0;
+
+  //optional support for running the callbacks in parallel. if this returns a worker the parser
+  //makes its callbacks on the worker from a parsing thread for a contiguous run of blocks, the
+  //worker should buffer whatever it works out. each worker is then handed back to merge on the
+  //calling thread in file order, which should apply and clear its buffer. workers are reused
+  virtual std::unique_ptr<Callback> worker() { return nullptr; }
+  virtual void merge(Callback& worker) { }
 };
 
 //the parser used to get data out of the osmpbf file
 class Parser {
  public:
   Parser() = delete;
-  //parse the pbf file for the things you are interested in
-  static void parse(std::ifstream& file, const Interest interest, Callback& callback);
+  //parse the pbf file for the things you are interested in. blobs are decompressed
+  //and decoded using the given number of threads. callbacks are made in file order
+  //from the calling thread unless the callback provides workers, in which case the
+  //workers get the callbacks in parallel and their results are merged in file order
+  static void parse(std::ifstream& file, const Interest interest, Callback& callback, const unsigned int threads = 1);
   //clean up (mainly pbf memory)
   static void free();
 };
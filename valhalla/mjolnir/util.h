@@ -1,6 +1,9 @@
 #ifndef VALHALLA_MJOLNIR_UTIL_H_
 #define VALHALLA_MJOLNIR_UTIL_H_
 
+#include <cstdint>
+#include <functional>
+#include <future>
 #include <vector>
 #include <string>
 
@@ -23,6 +26,17 @@ std::vector<std::string> GetTagTokens(const std::string& tag_value,
  * @return string string with no quotes.
 */std::string remove_double_quotes(const std::string& s);
 
+/**
+ * Run the worker on the specified number of threads and wait for them to
+ * finish up. Whatever the worker throws is handed back through its promise.
+ * @param  thread_count  number of threads to run the worker on
+ * @param  worker        work to do, sets the promise with its result
+ * @return the sum of what the threads sent back. If something bad went down
+ *         in any of them it is rethrown here.
+*/
+uint32_t RunThreads(const unsigned int thread_count,
+                    const std::function<void (std::promise<uint32_t>&)>& worker);
+
 }
 }
 #endif  // VALHALLA_MJOLNIR_UTIL_H_
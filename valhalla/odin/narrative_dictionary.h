@@ -1,9 +1,11 @@
 #ifndef VALHALLA_ODIN_NARRATIVE_DICTIONARY_H_
 #define VALHALLA_ODIN_NARRATIVE_DICTIONARY_H_
 
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <initializer_list>
 #include <locale>
 
 #include <boost/property_tree/ptree.hpp>
@@ -148,8 +150,59 @@ constexpr auto kTransitStopCountLabelTag = "<TRANSIT_STOP_COUNT_LABEL>";
 namespace valhalla {
 namespace odin {
 
+/**
+ * A phrase compiled into runs of literal text and tag slots when the
+ * dictionary is loaded. Rendering fills in all of the tags in one pass
+ * instead of copying the phrase and searching it once per tag.
+ */
+class PhraseTemplate {
+ public:
+  // Tag and the value to put in its place. Values are converted at the
+  // call site so temporaries live until the phrase is rendered
+  struct TagValue {
+    TagValue(const char* tag, const std::string& value)
+        : tag(tag), value(value) {
+    }
+    const char* tag;
+    const std::string& value;
+  };
+  using TagValues = std::initializer_list<TagValue>;
+
+  PhraseTemplate() = default;
+
+  /**
+   * Compiles the specified phrase. Tags are upper case names (and
+   * underscores) in angle brackets, anything else is literal text.
+   *
+   * @param  phrase  The tagged phrase.
+   */
+  explicit PhraseTemplate(const std::string& phrase);
+
+  /**
+   * Renders the phrase with the tags replaced by their values. Tags
+   * without a value are rendered as is.
+   *
+   * @param  output  Replaced with the rendered phrase, its capacity is reused.
+   * @param  values  Tags and the values to put in their place.
+   */
+  void Render(std::string& output, TagValues values) const;
+
+ protected:
+  // A run of literal text or a tag (including the angle brackets) within
+  // the phrase
+  struct Segment {
+    uint32_t offset;
+    uint32_t length;
+    bool tag;
+  };
+
+  std::string phrase_;
+  std::vector<Segment> segments_;
+};
+
 struct PhraseSet {
   std::unordered_map<std::string, std::string> phrases;
+  std::unordered_map<std::string, PhraseTemplate> templates;
 };
 
 struct StartSubset : PhraseSet {
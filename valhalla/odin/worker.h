@@ -4,6 +4,7 @@
 #include <valhalla/worker.h>
 #include <valhalla/proto/tripdirections.pb.h>
 #include <valhalla/proto/trippath.pb.h>
+#include <valhalla/proto/directions_options.pb.h>
 
 namespace valhalla {
   namespace odin {
@@ -22,6 +23,7 @@ namespace valhalla {
       virtual void cleanup() override;
 
       std::list<TripDirections> narrate(boost::property_tree::ptree& request, std::list<TripPath>& legs) const;
+      std::list<TripDirections> narrate(DirectionsOptions& directions_options, std::list<TripPath>& legs) const;
     };
   }
 }
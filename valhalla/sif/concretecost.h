@@ -0,0 +1,165 @@
+#ifndef VALHALLA_SIF_CONCRETECOST_H_
+#define VALHALLA_SIF_CONCRETECOST_H_
+
+#include <cstdint>
+#include <typeinfo>
+#include <vector>
+
+#include <valhalla/sif/dynamiccost.h>
+#include <valhalla/sif/autocost.h>
+#include <valhalla/sif/bicyclecost.h>
+#include <valhalla/sif/pedestriancost.h>
+#include <valhalla/sif/truckcost.h>
+
+namespace valhalla {
+namespace sif {
+
+/**
+ * Costing classes that graph expansions can be compiled for. Anything else
+ * (including the classes derived from these) uses the dynamic costing.
+ */
+enum class ConcreteCosting : uint8_t {
+  kDynamic = 0,
+  kAuto = 1,
+  kTruck = 2,
+  kBicycle = 3,
+  kPedestrian = 4
+};
+
+/**
+ * Get the concrete costing class of a costing method. Only an exact type
+ * match counts since derived classes override the costing methods.
+ * @param  costing  Costing method.
+ * @return Returns the concrete costing or kDynamic if there is none.
+ */
+inline ConcreteCosting GetConcreteCosting(const DynamicCost* costing) {
+  const std::type_info& type = typeid(*costing);
+  if (type == typeid(AutoCost)) {
+    return ConcreteCosting::kAuto;
+  } else if (type == typeid(TruckCost)) {
+    return ConcreteCosting::kTruck;
+  } else if (type == typeid(BicycleCost)) {
+    return ConcreteCosting::kBicycle;
+  } else if (type == typeid(PedestrianCost)) {
+    return ConcreteCosting::kPedestrian;
+  }
+  return ConcreteCosting::kDynamic;
+}
+
+/**
+ * Wraps a costing method whose type is exactly cost_t and exposes the methods
+ * a graph expansion calls for every edge. The calls are qualified with the
+ * costing class so they do not go through the vtable and the small ones are
+ * inlined into the expansion loop.
+ */
+template <class cost_t>
+class ConcreteCost {
+ public:
+  ConcreteCost(const DynamicCost* costing)
+      : costing_(static_cast<const cost_t*>(costing)) {
+  }
+
+  bool Allowed(const baldr::NodeInfo* node) const {
+    return costing_->cost_t::Allowed(node);
+  }
+
+  bool Allowed(const baldr::DirectedEdge* edge, const EdgeLabel& pred,
+               const baldr::GraphTile*& tile, const baldr::GraphId& edgeid) const {
+    return costing_->cost_t::Allowed(edge, pred, tile, edgeid);
+  }
+
+  bool AllowedReverse(const baldr::DirectedEdge* edge, const EdgeLabel& pred,
+                      const baldr::DirectedEdge* opp_edge, const baldr::GraphTile*& tile,
+                      const baldr::GraphId& opp_edgeid) const {
+    return costing_->cost_t::AllowedReverse(edge, pred, opp_edge, tile, opp_edgeid);
+  }
+
+  bool Restricted(const baldr::DirectedEdge* edge, const EdgeLabel& pred,
+                  const std::vector<EdgeLabel>& edgelabels, const baldr::GraphTile*& tile,
+                  const baldr::GraphId& edgeid, const bool forward) const {
+    return costing_->cost_t::Restricted(edge, pred, edgelabels, tile, edgeid, forward);
+  }
+
+  Cost EdgeCost(const baldr::DirectedEdge* edge) const {
+    return costing_->cost_t::EdgeCost(edge);
+  }
+
+  Cost EdgeCost(const baldr::DirectedEdge* edge, const baldr::GraphTile* tile,
+                const uint32_t seconds) const {
+    return costing_->cost_t::EdgeCost(edge, tile, seconds);
+  }
+
+  Cost TransitionCost(const baldr::DirectedEdge* edge, const baldr::NodeInfo* node,
+                      const EdgeLabel& pred) const {
+    return costing_->cost_t::TransitionCost(edge, node, pred);
+  }
+
+  Cost TransitionCostReverse(const uint32_t idx, const baldr::NodeInfo* node,
+                             const baldr::DirectedEdge* opp_edge,
+                             const baldr::DirectedEdge* opp_pred_edge) const {
+    return costing_->cost_t::TransitionCostReverse(idx, node, opp_edge, opp_pred_edge);
+  }
+
+ protected:
+  const cost_t* costing_;
+};
+
+/**
+ * The fallback for any other costing, makes the usual virtual calls.
+ */
+template <>
+class ConcreteCost<DynamicCost> {
+ public:
+  ConcreteCost(const DynamicCost* costing)
+      : costing_(costing) {
+  }
+
+  bool Allowed(const baldr::NodeInfo* node) const {
+    return costing_->Allowed(node);
+  }
+
+  bool Allowed(const baldr::DirectedEdge* edge, const EdgeLabel& pred,
+               const baldr::GraphTile*& tile, const baldr::GraphId& edgeid) const {
+    return costing_->Allowed(edge, pred, tile, edgeid);
+  }
+
+  bool AllowedReverse(const baldr::DirectedEdge* edge, const EdgeLabel& pred,
+                      const baldr::DirectedEdge* opp_edge, const baldr::GraphTile*& tile,
+                      const baldr::GraphId& opp_edgeid) const {
+    return costing_->AllowedReverse(edge, pred, opp_edge, tile, opp_edgeid);
+  }
+
+  bool Restricted(const baldr::DirectedEdge* edge, const EdgeLabel& pred,
+                  const std::vector<EdgeLabel>& edgelabels, const baldr::GraphTile*& tile,
+                  const baldr::GraphId& edgeid, const bool forward) const {
+    return costing_->Restricted(edge, pred, edgelabels, tile, edgeid, forward);
+  }
+
+  Cost EdgeCost(const baldr::DirectedEdge* edge) const {
+    return costing_->EdgeCost(edge);
+  }
+
+  Cost EdgeCost(const baldr::DirectedEdge* edge, const baldr::GraphTile* tile,
+                const uint32_t seconds) const {
+    return costing_->EdgeCost(edge, tile, seconds);
+  }
+
+  Cost TransitionCost(const baldr::DirectedEdge* edge, const baldr::NodeInfo* node,
+                      const EdgeLabel& pred) const {
+    return costing_->TransitionCost(edge, node, pred);
+  }
+
+  Cost TransitionCostReverse(const uint32_t idx, const baldr::NodeInfo* node,
+                             const baldr::DirectedEdge* opp_edge,
+                             const baldr::DirectedEdge* opp_pred_edge) const {
+    return costing_->TransitionCostReverse(idx, node, opp_edge, opp_pred_edge);
+  }
+
+ protected:
+  const DynamicCost* costing_;
+};
+
+}
+}
+
+#endif  // VALHALLA_SIF_CONCRETECOST_H_
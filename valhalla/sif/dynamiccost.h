@@ -69,6 +69,13 @@ class DynamicCost {
    */
   virtual bool AllowMultiPass() const;
 
+  /**
+   * Does the costing method use speed profiles, i.e. do its edge costs
+   * depend on the time of the week.
+   * @return  Returns true if EdgeCost at a time uses speed profiles.
+   */
+  virtual bool UsesSpeedProfiles() const;
+
   /**
    * Returns the maximum transfer distance between stops that you are willing
    * to travel for this mode.  It is the max distance you are willing to
@@ -161,6 +168,20 @@ class DynamicCost {
                         const baldr::TransitDeparture* departure,
                         const uint32_t curr_time) const;
 
+  /**
+   * Get the cost to traverse the specified directed edge at a time of the
+   * week. Defaults to the cost without time. Costing models whose speeds
+   * depend on the time (speed profiles) must override this method.
+   * @param   edge     Pointer to a directed edge.
+   * @param   tile     Graph tile that contains the directed edge.
+   * @param   seconds  Seconds from the start of the week (local time) or
+   *                   kInvalidSecondsOfWeek if no time is known.
+   * @return  Returns the cost and time (seconds)
+   */
+  virtual Cost EdgeCost(const baldr::DirectedEdge* edge,
+                        const baldr::GraphTile* tile,
+                        const uint32_t seconds) const;
+
   /**
    * Returns the cost to make the transition from the predecessor edge.
    * Defaults to 0. Costing models that wish to include edge transition
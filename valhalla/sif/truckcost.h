@@ -2,7 +2,10 @@
 #define VALHALLA_SIF_TRUCKCOST_H_
 
 #include <cstdint>
+#include <vector>
+
 #include <valhalla/sif/dynamiccost.h>
+#include <boost/property_tree/ptree.hpp>
 
 namespace valhalla {
 namespace sif {
@@ -13,6 +16,262 @@ namespace sif {
  */
 cost_ptr_t CreateTruckCost(const boost::property_tree::ptree& config);
 
+/**
+ * Derived class providing dynamic edge costing for truck routes.
+ */
+class TruckCost : public DynamicCost {
+ public:
+  /**
+   * Construct truck costing. Pass in configuration using property tree.
+   * @param  config  Property tree with configuration/options.
+   */
+  TruckCost(const boost::property_tree::ptree& config);
+
+  virtual ~TruckCost();
+
+  /**
+   * Does the costing allow hierarchy transitions. Truck costing will allow
+   * transitions by default.
+   * @return  Returns true if the costing model allows hierarchy transitions).
+   */
+   virtual bool AllowTransitions() const;
+
+  /**
+   * Does the costing method allow multiple passes (with relaxed hierarchy
+   * limits).
+   * @return  Returns true if the costing model allows multiple passes.
+   */
+  virtual bool AllowMultiPass() const;
+
+  /**
+   * Does the costing method use speed profiles.
+   * @return  Returns true, edge speeds come from the speed profiles.
+   */
+  virtual bool UsesSpeedProfiles() const;
+
+  /**
+   * Get the access mode used by this costing method.
+   * @return  Returns access mode.
+   */
+  uint32_t access_mode() const;
+
+  /**
+   * Checks if access is allowed for the provided directed edge.
+   * This is generally based on mode of travel and the access modes
+   * allowed on the edge. However, it can be extended to exclude access
+   * based on other parameters.
+   * @param  edge     Pointer to a directed edge.
+   * @param  pred     Predecessor edge information.
+   * @param  tile     current tile
+   * @param  edgeid   edgeid that we care about
+   * @return Returns true if access is allowed, false if not.
+   */
+  virtual bool Allowed(const baldr::DirectedEdge* edge,
+                       const EdgeLabel& pred,
+                       const baldr::GraphTile*& tile,
+                       const baldr::GraphId& edgeid) const;
+
+  /**
+   * Checks if access is allowed for an edge on the reverse path
+   * (from destination towards origin). Both opposing edges are
+   * provided.
+   * @param  edge           Pointer to a directed edge.
+   * @param  pred           Predecessor edge information.
+   * @param  opp_edge       Pointer to the opposing directed edge.
+   * @param  tile           Tile for the opposing edge (for looking
+   *                        up restrictions).
+   * @param  opp_edgeid     Opposing edge Id
+   * @return  Returns true if access is allowed, false if not.
+   */
+  virtual bool AllowedReverse(const baldr::DirectedEdge* edge,
+                 const EdgeLabel& pred,
+                 const baldr::DirectedEdge* opp_edge,
+                 const baldr::GraphTile*& tile,
+                 const baldr::GraphId& opp_edgeid) const;
+
+  /**
+   * Checks if access is allowed for the provided node. Node access can
+   * be restricted if bollards or gates are present.
+   * @param  edge  Pointer to node information.
+   * @return  Returns true if access is allowed, false if not.
+   */
+  virtual bool Allowed(const baldr::NodeInfo* node) const;
+
+  /**
+   * Get the cost to traverse the specified directed edge. Cost includes
+   * the time (seconds) to traverse the edge.
+   * @param   edge  Pointer to a directed edge.
+   * @return  Returns the cost and time (seconds)
+   */
+  virtual Cost EdgeCost(const baldr::DirectedEdge* edge) const;
+
+  /**
+   * Get the cost to traverse the specified directed edge at a time of the
+   * week, using the speed profile of the edge if it has one.
+   * @param   edge     Pointer to a directed edge.
+   * @param   tile     Graph tile that contains the directed edge.
+   * @param   seconds  Seconds from the start of the week (local time).
+   * @return  Returns the cost and time (seconds)
+   */
+  virtual Cost EdgeCost(const baldr::DirectedEdge* edge,
+                        const baldr::GraphTile* tile,
+                        const uint32_t seconds) const;
+
+  /**
+   * Returns the cost to make the transition from the predecessor edge.
+   * Defaults to 0. Costing models that wish to include edge transition
+   * costs (i.e., intersection/turn costs) must override this method.
+   * @param  edge  Directed edge (the to edge)
+   * @param  node  Node (intersection) where transition occurs.
+   * @param  pred  Predecessor edge information.
+   * @return  Returns the cost and time (seconds)
+   */
+  virtual Cost TransitionCost(const baldr::DirectedEdge* edge,
+                              const baldr::NodeInfo* node,
+                              const EdgeLabel& pred) const;
+
+  /**
+   * Returns the cost to make the transition from the predecessor edge
+   * when using a reverse search (from destination towards the origin).
+   * @param  idx   Directed edge local index
+   * @param  node  Node (intersection) where transition occurs.
+   * @param  pred  the opposing current edge in the reverse tree.
+   * @param  edge  the opposing predecessor in the reverse tree
+   * @return  Returns the cost and time (seconds)
+   */
+  virtual Cost TransitionCostReverse(
+      const uint32_t idx, const baldr::NodeInfo* node,
+      const baldr::DirectedEdge* pred,
+      const baldr::DirectedEdge* edge) const;
+
+  /**
+   * Get the cost factor for A* heuristics. This factor is multiplied
+   * with the distance to the destination to produce an estimate of the
+   * minimum cost to the destination. The A* heuristic must underestimate the
+   * cost to the destination. So a time based estimate based on speed should
+   * assume the maximum speed is used to the destination such that the time
+   * estimate is less than the least possible time along roads.
+   */
+  virtual float AStarCostFactor() const;
+
+  /**
+   * Get the current travel type.
+   * @return  Returns the current travel type.
+   */
+  virtual uint8_t travel_type() const;
+
+  /**
+   * Returns a function/functor to be used in location searching which will
+   * exclude and allow ranking results from the search by looking at each
+   * edges attribution and suitability for use as a location by the travel
+   * mode used by the costing method. Function/functor is also used to filter
+   * edges not usable / inaccessible by truck.
+   */
+  virtual const EdgeFilter GetEdgeFilter() const {
+    // Throw back a lambda that checks the access for this type of costing
+    return [](const baldr::DirectedEdge* edge) {
+      if (edge->trans_up() || edge->trans_down() || edge->is_shortcut() ||
+         !(edge->forwardaccess() & baldr::kTruckAccess))
+        return 0.0f;
+      else {
+        // TODO - use classification/use to alter the factor
+        return 1.0f;
+      }
+    };
+  }
+
+  /**
+   * Returns a function/functor to be used in location searching which will
+   * exclude results from the search by looking at each node's attribution
+   * @return Function/functor to be used in filtering out nodes
+   */
+  virtual const NodeFilter GetNodeFilter() const {
+    //throw back a lambda that checks the access for this type of costing
+    return [](const baldr::NodeInfo* node){
+      return !(node->access() & baldr::kTruckAccess);
+    };
+  }
+
+ public:
+  VehicleType type_;                // Vehicle type: tractor trailer
+  float speedfactor_[baldr::kMaxSpeedKph + 1];
+  float density_factor_[16];        // Density factor
+  float maneuver_penalty_;          // Penalty (seconds) when inconsistent names
+  float destination_only_penalty_;  // Penalty (seconds) using a driveway or parking aisle
+  float gate_cost_;                 // Cost (seconds) to go through gate
+  float gate_penalty_;              // Penalty (seconds) to go through gate
+  float tollbooth_cost_;            // Cost (seconds) to go through toll booth
+  float tollbooth_penalty_;         // Penalty (seconds) to go through a toll booth
+  float alley_penalty_;             // Penalty (seconds) to use a alley
+  float country_crossing_cost_;     // Cost (seconds) to go through toll booth
+  float country_crossing_penalty_;  // Penalty (seconds) to go across a country border
+  float low_class_penalty_;         // Penalty (seconds) to go to residential or service road
+
+  // Vehicle attributes (used for special restrictions and costing)
+  bool  hazmat_;        // Carrying hazardous materials
+  float weight_;        // Vehicle weight in metric tons
+  float axle_load_;     // Axle load weight in metric tons
+  float height_;        // Vehicle height in meters
+  float width_;         // Vehicle width in meters
+  float length_;        // Vehicle length in meters
+
+  // Density factor used in edge transition costing
+  std::vector<float> trans_density_factor_;
+
+  // How much to favor truck routes.
+  static constexpr float kTruckRouteFactor = 0.85f;
+};
+
+// The methods called on every edge of a graph expansion that are small enough
+// to be inlined when the costing is known at compile time
+
+// Check if access is allowed at the specified node.
+inline bool TruckCost::Allowed(const baldr::NodeInfo* node) const  {
+  return (node->access() & baldr::kTruckAccess);
+}
+
+// Get the cost to traverse the edge in seconds
+inline Cost TruckCost::EdgeCost(const baldr::DirectedEdge* edge) const {
+
+  float factor = density_factor_[edge->density()];
+
+  if (edge->truck_route() > 0) {
+    factor *= kTruckRouteFactor;
+  }
+
+  float sec = 0.0f;
+  if (edge->truck_speed() > 0)
+    sec = (edge->length() * speedfactor_[edge->truck_speed()]);
+  else
+    sec = (edge->length() * speedfactor_[edge->speed()]);
+
+  return { sec * factor, sec };
+}
+
+// Get the cost to traverse the edge in seconds at a time of the week. Without
+// a time or a speed profile this is the cost without a time. Trucks go no
+// faster than the truck speed when the traffic is faster.
+inline Cost TruckCost::EdgeCost(const baldr::DirectedEdge* edge,
+                                const baldr::GraphTile* tile,
+                                const uint32_t seconds) const {
+  if (seconds == baldr::kInvalidSecondsOfWeek || !tile->has_speed_profile(edge)) {
+    return TruckCost::EdgeCost(edge);
+  }
+
+  float factor = density_factor_[edge->density()];
+
+  if (edge->truck_route() > 0) {
+    factor *= kTruckRouteFactor;
+  }
+
+  uint32_t speed = tile->GetSpeed(edge, seconds);
+  if (edge->truck_speed() > 0 && edge->truck_speed() < speed)
+    speed = edge->truck_speed();
+  float sec = (edge->length() * speedfactor_[speed]);
+
+  return { sec * factor, sec };
+}
+
 }
 }
 
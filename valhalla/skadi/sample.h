@@ -17,16 +17,21 @@ namespace valhalla {
      public:
       //non-default-constructable and non-copyable
       sample() = delete;
-      sample(sample&&) = default;
-      sample& operator=(sample&&) = default;
+      sample(sample&&);
+      sample& operator=(sample&&);
       sample(const sample&) = delete;
       sample& operator=(const sample&) = delete;
+      ~sample();
+
+      //default number of decompressed tiles kept in memory, about 26MB each
+      static constexpr size_t DEFAULT_CACHE_SIZE = 16;
 
       /**
        * Constructor
        * @param data_source  directory name of the datasource from which to sample
+       * @param cache_size   how many gzipped tiles to keep decompressed at once
        */
-      sample(const std::string& data_source);
+      sample(const std::string& data_source, size_t cache_size = DEFAULT_CACHE_SIZE);
 
       /**
        * Get a single sample from the datasource
@@ -47,9 +52,43 @@ namespace valhalla {
        */
       double get_no_data_value() const;
 
+      //counters for the decompressed tile cache
+      struct cache_stats_t {
+        uint64_t hits;
+        uint64_t misses;
+        double decompression_seconds;
+      };
+
+      /**
+       * @return how often compressed tiles were found decompressed in the
+       *         cache and how long it took to decompress the others
+       */
+      cache_stats_t get_cache_stats() const;
+
      protected:
 
+      //decompressed tile, shared so eviction cant pull it out from under a reader
+      using tile_t = std::shared_ptr<const std::vector<int16_t> >;
+
+      //get the pixels of the tile at this index or nullptr if we have no data there
+      const int16_t* get_tile(uint16_t index, tile_t& holder) const;
+
+      //bilinear filtering of the pixels around the coordinate in this tile
+      template <class coord_t>
+      static double interpolate(const int16_t* tile, const coord_t& coord, double lon, double lat);
+
+      //bilinear filtering of a batch of postings that are all in the tile whose
+      //lower left corner is at lon, lat. gives the same values as interpolate
+      static void interpolate_all(const int16_t* tile, double lon, double lat, const double* lons,
+        const double* lats, size_t count, double* values);
+
+      //raw tiles are mapped into memory
       std::vector<midgard::mem_map<int16_t> > cache;
+      //gzipped tiles are decompressed on demand, this is where they are
+      std::vector<std::string> compressed;
+      //least recently used decompressed tiles
+      struct lru_t;
+      std::unique_ptr<lru_t> lru;
     };
 
   }
@@ -13,6 +13,7 @@
 #include <valhalla/baldr/pathlocation.h>
 #include <valhalla/baldr/double_bucket_queue.h>
 #include <valhalla/sif/dynamiccost.h>
+#include <valhalla/sif/concretecost.h>
 #include <valhalla/sif/edgelabel.h>
 #include <valhalla/sif/hierarchylimits.h>
 #include <valhalla/thor/astarheuristic.h>
@@ -74,6 +75,7 @@ class AStarPathAlgorithm : public PathAlgorithm {
   uint32_t max_label_count_;    // Max label count to allow
   sif::TravelMode mode_;        // Current travel mode
   uint8_t travel_type_;         // Current travel type
+  uint32_t origin_time_;        // Seconds of the week at the origin (local)
 
   // Hierarchy limits.
   std::vector<sif::HierarchyLimits> hierarchy_limits_;
@@ -93,6 +95,9 @@ class AStarPathAlgorithm : public PathAlgorithm {
   // Destinations, id and cost
   std::map<uint64_t, sif::Cost> destinations_;
 
+  // Destinations, id and percent along the edge
+  std::map<uint64_t, float> destination_dists_;
+
   /**
    * Initializes the hierarchy limits, A* heuristic, and adjacency list.
    * @param  origll  Lat,lng of the origin.
@@ -166,6 +171,23 @@ class AStarPathAlgorithm : public PathAlgorithm {
    *          destination - along with travel modes and elapsed time.
    */
   std::vector<PathInfo> FormPath(const uint32_t dest);
+
+  /**
+   * Expand the search from the origin until the best path to the destination
+   * is found. The costing calls made for every edge are resolved at compile
+   * time for concrete costing classes.
+   * @param  origin       Origin location.
+   * @param  destination  Destination location.
+   * @param  graphreader  Graph reader for accessing routing graph.
+   * @param  costing      Costing method wrapped by its concrete class.
+   * @param  mindist      Distance from the origin to the destination.
+   * @return Returns the path edges (and elapsed time/modes at end of
+   *          each edge).
+   */
+  template <class cost_t>
+  std::vector<PathInfo> Search(baldr::PathLocation& origin,
+          baldr::PathLocation& destination, baldr::GraphReader& graphreader,
+          const sif::ConcreteCost<cost_t>& costing, float mindist);
 };
 
 }
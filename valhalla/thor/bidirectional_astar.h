@@ -9,6 +9,7 @@
 #include <memory>
 
 #include <valhalla/baldr/double_bucket_queue.h>
+#include <valhalla/sif/concretecost.h>
 #include <valhalla/sif/edgelabel.h>
 #include <valhalla/sif/hierarchylimits.h>
 #include <valhalla/thor/pathalgorithm.h>
@@ -102,6 +103,27 @@ class BidirectionalAStar : public PathAlgorithm {
   uint32_t threshold_;
   CandidateConnection best_connection_;
 
+  // Seconds of the week (local) at the origin and the destination. When one
+  // of them is known only that side is searched so the time at every edge
+  // can be predicted from it.
+  uint32_t origin_time_;
+  uint32_t destination_time_;
+  bool search_forward_;
+  bool search_reverse_;
+
+  /**
+   * Check if expansion on a hierarchy level should stop. A one sided search
+   * has to get back down to the local level near the other end, so it also
+   * keeps expanding within a distance of it (like A*).
+   * @param  limits  Hierarchy limits of the level.
+   * @param  dist    Distance to the other end of the route.
+   * @return Returns true if expansion at this hierarchy level should stop.
+   */
+  bool StopExpanding(const sif::HierarchyLimits& limits, const float dist) const {
+    return (search_forward_ && search_reverse_) ?
+        limits.StopExpanding() : limits.StopExpanding(dist);
+  }
+
   /**
    * Initialize the A* heuristic and adjacency lists for both the forward
    * and reverse search.
@@ -111,20 +133,32 @@ class BidirectionalAStar : public PathAlgorithm {
    */
   void Init(const PointLL& origll, const PointLL& destll);
 
+  /**
+   * Search in both directions until the best connection is found. The
+   * costing calls made for every edge are resolved at compile time for
+   * concrete costing classes.
+   */
+  template <class cost_t>
+  std::vector<PathInfo> Search(baldr::GraphReader& graphreader,
+           const sif::ConcreteCost<cost_t>& costing);
+
   /**
    * Expand from the node along the forward search path.
    */
+  template <class cost_t>
   void ExpandForward(baldr::GraphReader& graphreader,
            const baldr::GraphId& node, const sif::EdgeLabel& pred,
-           const uint32_t pred_idx, const bool from_transition);
+           const uint32_t pred_idx, const bool from_transition,
+           const sif::ConcreteCost<cost_t>& costing);
 
   /**
    * Expand from the node along the reverse search path.
    */
+  template <class cost_t>
   void ExpandReverse(baldr::GraphReader& graphreader,
            const baldr::GraphId& node, const sif::EdgeLabel& pred,
            const uint32_t pred_idx, const baldr::DirectedEdge* opp_pred_edge,
-           const bool from_transition);
+           const bool from_transition, const sif::ConcreteCost<cost_t>& costing);
 
   /**
    * Add edges at the origin to the forward adjacency list.
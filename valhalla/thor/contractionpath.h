@@ -0,0 +1,122 @@
+#ifndef VALHALLA_THOR_CONTRACTIONPATH_H_
+#define VALHALLA_THOR_CONTRACTIONPATH_H_
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <valhalla/baldr/contractionhierarchy.h>
+#include <valhalla/thor/pathalgorithm.h>
+
+namespace valhalla {
+namespace thor {
+
+/**
+ * Path algorithm over the contraction hierarchy built by mjolnir. A
+ * bidirectional Dijkstra search where the forward search only follows
+ * arcs up the hierarchy and the reverse search only follows arcs down the
+ * hierarchy, so each settles a few thousand vertices even for continental
+ * routes. The hierarchy holds the costs of the default auto costing, so
+ * this must only be used for auto requests that do not change it.
+ */
+class ContractionPathAlgorithm : public PathAlgorithm {
+ public:
+  /**
+   * Constructor.
+   */
+  ContractionPathAlgorithm();
+
+  /**
+   * Destructor
+   */
+  virtual ~ContractionPathAlgorithm();
+
+  /**
+   * Set the hierarchy to search.
+   * @param  hierarchy  Contraction hierarchy.
+   */
+  void set_hierarchy(const std::shared_ptr<const baldr::ContractionHierarchy>& hierarchy);
+
+  /**
+   * Is there a hierarchy to search.
+   */
+  bool has_hierarchy() const;
+
+  /**
+   * Form path between and origin and destination location using
+   * the contraction hierarchy.
+   * @param  origin  Origin location
+   * @param  dest    Destination location
+   * @param  graphreader  Graph reader for accessing routing graph.
+   * @param  mode_costing  An array of costing methods, one per TravelMode.
+   *                       Used for the partial origin and destination edges.
+   * @param  mode     Travel mode from the origin.
+   * @return  Returns the path edges (and elapsed time/modes at end of
+   *          each edge). Returns no path if there is none or if the path
+   *          passes the end of a complex restriction, which the hierarchy
+   *          does not enforce.
+   */
+  std::vector<PathInfo> GetBestPath(baldr::PathLocation& origin,
+           baldr::PathLocation& dest, baldr::GraphReader& graphreader,
+           const std::shared_ptr<sif::DynamicCost>* mode_costing,
+           const sif::TravelMode mode);
+
+  /**
+   * Clear the temporary information generated during path construction.
+   */
+  void Clear();
+
+ protected:
+  // Label of a vertex reached by one of the searches
+  struct Label {
+    uint32_t vertex;
+    float cost;
+    uint32_t predecessor;              // Label the vertex was reached from
+    const baldr::ContractionArc* arc;  // Arc it was reached by
+  };
+
+  // Search state of one direction
+  struct Search {
+    std::vector<Label> labels;
+    std::unordered_map<uint32_t, uint32_t> status;  // Vertex to label
+    std::vector<std::pair<float, uint32_t> > queue;  // Min heap of labels
+    float min_initial;  // Lowest cost of the initial labels
+
+    // Time along the partial origin or destination edge of initial labels
+    std::unordered_map<uint32_t, float> partial_secs;
+
+    void Clear();
+    void Add(const uint32_t vertex, const float cost, const uint32_t predecessor,
+             const baldr::ContractionArc* arc);
+  };
+
+  std::shared_ptr<const baldr::ContractionHierarchy> hierarchy_;
+  Search forward_;
+  Search reverse_;
+
+  /**
+   * Settle the next vertex of a search and relax its arcs.
+   * @param  search    Search to advance.
+   * @param  other     Search in the other direction.
+   * @param  forward   Is this the forward search.
+   * @param  best      Cost of the best connection so far.
+   * @param  meeting   Vertex of the best connection so far.
+   */
+  void Step(Search& search, const Search& other, const bool forward,
+            float& best, uint32_t& meeting);
+
+  /**
+   * Form the path through the vertex where the searches met.
+   * @param  meeting  Vertex of the best connection.
+   * @param  mode     Travel mode.
+   */
+  std::vector<PathInfo> FormPath(const uint32_t meeting,
+                                 const sif::TravelMode mode);
+};
+
+}
+}
+
+#endif  // VALHALLA_THOR_CONTRACTIONPATH_H_
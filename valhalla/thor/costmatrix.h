@@ -14,6 +14,7 @@
 #include <valhalla/baldr/pathlocation.h>
 #include <valhalla/baldr/double_bucket_queue.h>
 #include <valhalla/sif/dynamiccost.h>
+#include <valhalla/sif/concretecost.h>
 #include <valhalla/sif/edgelabel.h>
 #include <valhalla/thor/edgestatus.h>
 
@@ -88,12 +89,35 @@ struct BestCandidate {
   }
 };
 
+/**
+ * Change to the status of a source and target pair, queued while the
+ * searches of a round run and applied in location order afterwards.
+ */
+struct StatusUpdate {
+  uint32_t source;
+  uint32_t target;
+  uint32_t label_count;   // Edge labels of the source and target searches
+
+  StatusUpdate(const uint32_t s, const uint32_t t, const uint32_t n)
+      : source(s),
+        target(t),
+        label_count(n) {
+  }
+};
+
 /**
  * Class to compute cost (cost + time + distance) matrices among locations.
  * This uses a bidirectional search with highway hierarchies. This is a
  * method described by Sebastian Knopp, "Efficient Computation of Many-to-Many
  * Shortest Paths".
  * https://i11www.iti.uni-karlsruhe.de/_media/teaching/theses/files/da-sknopp-06.pdf
+ *
+ * Each round advances every target search by one edge and then every source
+ * search by one edge. The searches of a round only touch their own state so
+ * they can run on worker threads; anything they change in shared state (the
+ * edges reached by each target and the location status) is queued per
+ * location and applied in location order once the round is done, so the
+ * result is the same no matter how many threads are used.
  */
 class CostMatrix {
  public:
@@ -104,6 +128,15 @@ class CostMatrix {
    */
   CostMatrix();
 
+  /**
+   * Constructor with worker threads. A worker thread is started for each of
+   * the graph readers (the readers must not be used by anything else while
+   * a matrix is computed), the calling thread uses the reader passed to
+   * SourceToTarget.
+   * @param  worker_readers  Graph readers for the worker threads.
+   */
+  CostMatrix(const std::vector<std::shared_ptr<baldr::GraphReader>>& worker_readers);
+
   /**
    * Forms a time distance matrix from the set of source locations
    * to the set of target locations.
@@ -168,6 +201,15 @@ class CostMatrix {
   // Mark each target edge with a list of target indexes that have reached it
   std::unordered_map<baldr::GraphId, std::vector<uint32_t>> targets_;
 
+  // Edges reached by each target search and status updates of each
+  // location during the current round
+  std::vector<std::vector<baldr::GraphId>> target_reached_;
+  std::vector<std::vector<StatusUpdate>> source_updates_;
+  std::vector<std::vector<StatusUpdate>> target_updates_;
+
+  // Graph readers of the worker threads
+  std::vector<std::shared_ptr<baldr::GraphReader>> worker_readers_;
+
   // List of best connections found so far
   std::vector<BestCandidate> best_connection_;
 
@@ -189,16 +231,29 @@ class CostMatrix {
       const std::vector<baldr::PathLocation>& source_location_list,
       const std::vector<baldr::PathLocation>& target_location_list);
 
+  /**
+   * Run the forward and backward searches until every source and target
+   * is done.
+   * @param  graphreader  Graph reader for accessing routing graph.
+   * @param  costing      Costing method wrapped by its concrete class.
+   */
+  template <class cost_t>
+  void Search(baldr::GraphReader& graphreader,
+              const sif::ConcreteCost<cost_t>& costing);
+
   /**
    * Iterate the forward search from the source/origin location.
    * @param  index        Index of the source location.
    * @param  n            Iteration counter.
    * @param  graphreader  Graph reader for accessing routing graph.
-   * @param  costing      Costing methods.
+   * @param  costing      Costing method wrapped by its concrete class.
    */
+  template <class cost_t>
   void ForwardSearch(const uint32_t index, const uint32_t n,
-                     baldr::GraphReader& graphreader);
+                     baldr::GraphReader& graphreader,
+                     const sif::ConcreteCost<cost_t>& costing);
 
+  template <class cost_t>
   void ExpandForward(baldr::GraphReader& graphreader,
                      const baldr::GraphTile* tile,
                      const baldr::GraphId& node,
@@ -208,8 +263,10 @@ class CostMatrix {
                      std::vector<sif::EdgeLabel>& edgelabels,
                      EdgeStatus& edgestate,
                      std::shared_ptr<baldr::DoubleBucketQueue>& adj,
-                     const bool from_transition);
+                     const bool from_transition,
+                     const sif::ConcreteCost<cost_t>& costing);
 
+  template <class cost_t>
   void ExpandReverse(baldr::GraphReader& graphreader,
                      const baldr::GraphTile* tile,
                      const baldr::GraphId& node,
@@ -221,7 +278,8 @@ class CostMatrix {
                      std::vector<sif::EdgeLabel>& edgelabels,
                      EdgeStatus& edgestate,
                      std::shared_ptr<baldr::DoubleBucketQueue>& adj,
-                     const bool from_transition);
+                     const bool from_transition,
+                     const sif::ConcreteCost<cost_t>& costing);
 
   /**
    * Check if the edge on the forward search connects to a reached edge
@@ -233,20 +291,31 @@ class CostMatrix {
   void CheckForwardConnections(const uint32_t source,
                                const sif::EdgeLabel& pred, const uint32_t n);
 
+  /**
+   * Queue a status update when a connection is found.
+   * @param  updates  Status updates of the location being searched.
+   * @param  source   Source index
+   * @param  target   Target index
+   */
+  void QueueStatus(std::vector<StatusUpdate>& updates,
+                   const uint32_t source, const uint32_t target);
+
   /**
    * Update status when a connection is found.
-   * @param  source  Source index
-   * @param  target  Target index
+   * @param  update  Queued status update.
    */
-  void UpdateStatus(const uint32_t source_, const uint32_t target);
+  void UpdateStatus(const StatusUpdate& update);
 
   /**
    * Iterate the backward search from the target/destination location.
    * @param  index        Index of the target location.
    * @param  graphreader  Graph reader for accessing routing graph.
+   * @param  costing      Costing method wrapped by its concrete class.
    */
+  template <class cost_t>
   void BackwardSearch(const uint32_t index,
-                      baldr::GraphReader& graphreader);
+                      baldr::GraphReader& graphreader,
+                      const sif::ConcreteCost<cost_t>& costing);
 
   /**
    * Sets the source/origin locations. Search expands forward from these
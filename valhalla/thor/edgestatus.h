@@ -1,13 +1,17 @@
 #ifndef VALHALLA_THOR_EDGESTATUS_H_
 #define VALHALLA_THOR_EDGESTATUS_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <unordered_map>
+#include <vector>
 #include <valhalla/baldr/graphid.h>
 
 namespace valhalla {
 namespace thor {
 
-// Default size to reserve for the EdgeStatus unordered map
+// Default number of EdgeStatus entries to keep allocated between searches
 constexpr uint32_t kDefaultEdgeStatusSize = 2000000;
 
 // Edge label status
@@ -48,23 +52,40 @@ struct EdgeStatusInfo {
 
 /**
  * Class to define / lookup the status and index of an edge in the edge label
- * list during shortest path algorithms.
+ * list during shortest path algorithms. Status is kept in a flat array per
+ * tile, indexed by the directed edge index within the tile. Each entry is
+ * stamped with the generation in which it was last set so that Init() does
+ * not need to touch the arrays to mark every edge unreached.
  */
 class EdgeStatus {
  public:
   /**
-   * Constructor given an initial size.
-   * @param  sz  Size to reserve for edgestatus unordered map.
+   * Constructor given the number of entries to retain between searches.
+   * @param  sz  Maximum number of status entries kept allocated across Init
+   *             calls. Beyond this the per tile arrays are released.
    */
-  EdgeStatus(const uint32_t sz = kDefaultEdgeStatusSize) {
-    edgestatus_.reserve(sz);
+  EdgeStatus(const uint32_t sz = kDefaultEdgeStatusSize)
+      : max_retained_(sz),
+        allocated_(0),
+        generation_(1),
+        last_tile_(kInvalidTile),
+        last_index_(0) {
   }
 
   /**
    * Initialize the status to unreached for all edges.
    */
   void Init() {
-    edgestatus_.clear();
+    // Release the arrays if too many tiles have been touched. Otherwise
+    // bumping the generation invalidates every entry. If the generation
+    // wraps the stale stamps could collide so release in that case too.
+    if (allocated_ > max_retained_ || ++generation_ == 0) {
+      tile_index_.clear();
+      tiles_.clear();
+      allocated_ = 0;
+      generation_ = 1;
+    }
+    last_tile_ = kInvalidTile;
   }
 
   /**
@@ -75,7 +96,9 @@ class EdgeStatus {
    */
   void Set(const baldr::GraphId& edgeid, const EdgeSet set,
            const uint32_t index) {
-    edgestatus_[edgeid.value] = { set, index };
+    entry_t& entry = GetEntry(edgeid);
+    entry.info = { set, index };
+    entry.generation = generation_;
   }
 
   /**
@@ -84,7 +107,12 @@ class EdgeStatus {
    * @param  set      Label set for this directed edge.
    */
   void Update(const baldr::GraphId& edgeid, const EdgeSet set) {
-    edgestatus_[edgeid.value].status.set = static_cast<uint32_t>(set);
+    entry_t& entry = GetEntry(edgeid);
+    if (entry.generation != generation_) {
+      entry.info = EdgeStatusInfo();
+      entry.generation = generation_;
+    }
+    entry.info.status.set = static_cast<uint32_t>(set);
   }
 
   /**
@@ -93,14 +121,83 @@ class EdgeStatus {
    * @return  Returns edge status info.
    */
   EdgeStatusInfo Get(const baldr::GraphId& edgeid) const {
-    auto p = edgestatus_.find(edgeid.value);
-    return (p == edgestatus_.end()) ? EdgeStatusInfo() : p->second;
+    const uint32_t tile = TileKey(edgeid);
+    if (tile != last_tile_) {
+      auto p = tile_index_.find(tile);
+      if (p == tile_index_.end()) {
+        return EdgeStatusInfo();
+      }
+      last_tile_ = tile;
+      last_index_ = p->second;
+    }
+    const auto& entries = tiles_[last_index_];
+    const uint32_t id = edgeid.id();
+    return (id < entries.size() && entries[id].generation == generation_) ?
+              entries[id].info : EdgeStatusInfo();
   }
 
  private:
-  // Map to store the status and index of GraphIds that have been encountered.
-  // Any unreached edges are not added to the map.
-  std::unordered_map<uint64_t, EdgeStatusInfo> edgestatus_;
+  // Key used for lookups that never matches a real tile
+  static constexpr uint32_t kInvalidTile = std::numeric_limits<uint32_t>::max();
+
+  // Minimum number of entries allocated for a tile
+  static constexpr uint32_t kMinTileEntries = 1024;
+
+  // Status of a directed edge and the generation in which it was set
+  struct entry_t {
+    EdgeStatusInfo info;
+    uint32_t generation = 0;
+  };
+
+  // Tile id and level of the edge, without the edge index
+  static uint32_t TileKey(const baldr::GraphId& edgeid) {
+    return static_cast<uint32_t>(edgeid.Tile_Base().value);
+  }
+
+  // Get the entry for an edge, growing the tile's array to hold it if needed
+  entry_t& GetEntry(const baldr::GraphId& edgeid) {
+    const uint32_t tile = TileKey(edgeid);
+    if (tile != last_tile_) {
+      auto inserted = tile_index_.emplace(tile, tiles_.size());
+      if (inserted.second) {
+        tiles_.emplace_back();
+      }
+      last_tile_ = tile;
+      last_index_ = inserted.first->second;
+    }
+    auto& entries = tiles_[last_index_];
+    const uint32_t id = edgeid.id();
+    if (id >= entries.size()) {
+      size_t size = std::max(static_cast<size_t>(kMinTileEntries), entries.size());
+      while (size <= id) {
+        size *= 2;
+      }
+      allocated_ += size - entries.size();
+      entries.resize(size);
+    }
+    return entries[id];
+  }
+
+  // Maximum number of entries to keep allocated across Init calls
+  size_t max_retained_;
+
+  // Number of entries currently allocated across all tiles
+  size_t allocated_;
+
+  // Current generation. Entries stamped with any other generation are
+  // unreached.
+  uint32_t generation_;
+
+  // Index into tiles_ for each tile that has been encountered
+  std::unordered_map<uint32_t, uint32_t> tile_index_;
+
+  // Status entries for each tile, indexed by directed edge index
+  std::vector<std::vector<entry_t>> tiles_;
+
+  // The most recently used tile and its index into tiles_. Consecutive
+  // lookups are usually within the same tile so this skips the map lookup.
+  mutable uint32_t last_tile_;
+  mutable uint32_t last_index_;
 };
 
 }
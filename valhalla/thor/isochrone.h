@@ -14,8 +14,10 @@
 #include <valhalla/baldr/pathlocation.h>
 #include <valhalla/baldr/double_bucket_queue.h>
 #include <valhalla/sif/dynamiccost.h>
+#include <valhalla/sif/concretecost.h>
 #include <valhalla/sif/edgelabel.h>
 #include <valhalla/thor/edgestatus.h>
+#include <valhalla/thor/phast.h>
 
 namespace valhalla {
 namespace thor {
@@ -89,6 +91,29 @@ class Isochrone {
                const std::shared_ptr<sif::DynamicCost>* mode_costing,
                const sif::TravelMode mode);
 
+  /**
+   * Compute an isochrone grid with a sweep over a contraction hierarchy
+   * rather than a search of the graph. The sweep finds the time to every
+   * edge within reach at once, which pays off for large isochrones. It only
+   * covers the part of the hierarchy that leads down to the edges within
+   * reach, unless that is most of it. The costing must be the one the
+   * hierarchy was built with.
+   * @param  origin_locations  List of origin locations.
+   * @param  max_minutes  Maximum time (minutes) for largest contour
+   * @param  graphreader  Graphreader
+   * @param  mode_costing List of costing objects
+   * @param  mode         Travel mode
+   * @param  sweep        Sweep over all vertices of the hierarchy, used as
+   *                      is when the isochrone covers most of it.
+   */
+  std::shared_ptr<const GriddedData<midgard::PointLL> > ComputeSweep(
+               std::vector<baldr::PathLocation>& origin_locations,
+               const unsigned int max_minutes,
+               baldr::GraphReader& graphreader,
+               const std::shared_ptr<sif::DynamicCost>* mode_costing,
+               const sif::TravelMode mode,
+               const Phast& sweep);
+
  protected:
   float shape_interval_;        // Interval along shape to mark time
   sif::TravelMode mode_;        // Current travel mode
@@ -126,20 +151,45 @@ class Isochrone {
   void ConstructIsoTile(const bool multimodal, const unsigned int max_minutes,
                         std::vector<baldr::PathLocation>& origin_locations);
 
+  /**
+   * Expand the forward search until the time limit is exceeded or there is
+   * nothing left to expand.
+   * @param  graphreader  Graphreader
+   * @param  max_seconds  Maximum time (seconds) for largest contour
+   * @param  costing      Costing method wrapped by its concrete class.
+   */
+  template <class cost_t>
+  void SearchForward(baldr::GraphReader& graphreader, const uint32_t max_seconds,
+                     const sif::ConcreteCost<cost_t>& costing);
+
+  /**
+   * Expand the reverse search until the time limit is exceeded or there is
+   * nothing left to expand.
+   * @param  graphreader  Graphreader
+   * @param  max_seconds  Maximum time (seconds) for largest contour
+   * @param  costing      Costing method wrapped by its concrete class.
+   */
+  template <class cost_t>
+  void SearchReverse(baldr::GraphReader& graphreader, const uint32_t max_seconds,
+                     const sif::ConcreteCost<cost_t>& costing);
+
   /**
    * Expand from the node along the forward search path.
    */
+  template <class cost_t>
   void ExpandForward(baldr::GraphReader& graphreader,
            const baldr::GraphId& node, const sif::EdgeLabel& pred,
-           const uint32_t pred_idx, const bool from_transition);
+           const uint32_t pred_idx, const bool from_transition,
+           const sif::ConcreteCost<cost_t>& costing);
 
   /**
    * Expand from the node along the forward search path.
    */
+  template <class cost_t>
   void ExpandReverse(baldr::GraphReader& graphreader,
            const baldr::GraphId& node, const sif::EdgeLabel& pred,
            const uint32_t pred_idx, const baldr::DirectedEdge* opp_pred_edge,
-           const bool from_transition);
+           const bool from_transition, const sif::ConcreteCost<cost_t>& costing);
 
   /**
    * Updates the isotile using the edge information from the predecessor edge
@@ -153,6 +203,21 @@ class Isochrone {
                      baldr::GraphReader& graphreader,
                      const midgard::PointLL& ll);
 
+  /**
+   * Updates the isotile along an edge.
+   * @param  edgeid       Directed edge.
+   * @param  opp          Opposing directed edge.
+   * @param  t2           Tile of the opposing edge.
+   * @param  secs0        Time at the begin node of the edge.
+   * @param  secs1        Time at the end node of the edge.
+   * @param  graphreader  Graph reader
+   * @param  ll           Lat,lon at the end of the edge.
+   */
+  void UpdateIsoTile(const baldr::GraphId& edgeid, const baldr::GraphId& opp,
+                     const baldr::GraphTile* t2, const float secs0,
+                     const float secs1, baldr::GraphReader& graphreader,
+                     const midgard::PointLL& ll);
+
   /**
    * Add edge(s) at each origin location to the adjacency list.
    * @param  graphreader       Graph tile reader.
@@ -135,6 +135,130 @@ protected:
   }
 };
 
+/**
+ * Optimization method using local search. A tour is built by going to the
+ * nearest location not yet visited and is then improved with 2-opt moves
+ * (reversing part of the tour) and Or-opt moves (moving a run of 1 to 3
+ * locations elsewhere, possibly reversed). Only moves that make a new
+ * connection between a location and one of its nearest neighbors are
+ * tried, and a location whose moves did not improve the tour is not looked
+ * at again until one of its connections changes. Costs do not need to be
+ * symmetric. Once no move improves the tour it is perturbed a number of
+ * times by exchanging parts of it and improved again, keeping the best.
+ */
+class LocalSearchOptimizer {
+public:
+  // Which locations the tour has to start and end with
+  enum class TourType {
+    kFixedEnds,   // Starts at the first location and ends at the last
+    kOpen,        // Starts at the first location and ends anywhere
+    kRoundTrip    // Starts at the first location and returns to it
+  };
+
+  /**
+   * Constructor.
+   * @param  type           Which locations the tour starts and ends with.
+   * @param  perturbations  Number of times the best tour is perturbed and
+   *                        improved again. 0 stops at the first local
+   *                        optimum.
+   */
+  LocalSearchOptimizer(const TourType type = TourType::kFixedEnds,
+                       const uint32_t perturbations = 100);
+
+  /**
+   * Optimize the tour through a set of locations given the cost matrix
+   * among all locations.
+   * @param  count  Number of locations.
+   * @param  costs  2-D cost matrix.
+   * @return Returns the order the locations are visited in. A round trip
+   *         does not repeat the first location at the end.
+   */
+  std::vector<uint32_t> Solve(const uint32_t count,
+                              const std::vector<float>& costs);
+
+  /**
+   * Seed the random number generator used to perturb tours.
+   * @param  seed  Seed to use for the random number generator.
+   */
+  void Seed(const uint32_t seed) {
+    random_generator_.seed(seed);
+  }
+
+protected:
+  // Number of nearest neighbors kept for each location
+  static constexpr uint32_t kNeighborCount = 10;
+
+  TourType type_;
+  uint32_t perturbations_;
+  std::mt19937_64 random_generator_;
+
+  const std::vector<float>* costs_;  // Cost matrix being solved
+  uint32_t count_;                   // # of locations
+  uint32_t end_;                     // Location that ends the tour
+  std::vector<uint32_t> tour_;       // Current tour (order of locations)
+  std::vector<uint32_t> position_;   // Position of each location in tour_
+  std::vector<double> forward_;      // Cost of the tour up to a position
+  std::vector<double> backward_;     // Same but going back along the tour
+  std::vector<std::vector<uint32_t>> neighbors_;
+  std::vector<uint32_t> active_;     // Locations with moves left to try
+  std::vector<bool> queued_;         // Don't-look bits (cleared if queued)
+
+  /**
+   * Get the cost between two locations. The end of an open tour or a round
+   * trip is an extra location: open tours get there for free and round
+   * trips pay for returning to the first location.
+   */
+  float Cost(const uint32_t loc1, const uint32_t loc2) const {
+    if (loc1 == count_ || loc2 == count_) {
+      if (type_ == TourType::kOpen) {
+        return 0.0f;
+      }
+      return (*costs_)[(loc1 == count_ ? 0 : loc1) * count_ +
+                       (loc2 == count_ ? 0 : loc2)];
+    }
+    return (*costs_)[loc1 * count_ + loc2];
+  }
+
+  // Build the tour by going to the nearest location not yet visited
+  void NearestNeighborTour();
+
+  // Find the nearest neighbors of each location
+  void FindNeighbors();
+
+  // Update positions and running costs after the tour changed
+  void UpdateTour();
+
+  // Cost of the tour
+  double TourCost() const {
+    return forward_.back();
+  }
+
+  // Change in cost of reversing the run of the tour between positions p
+  // and q, not counting the connections at either end
+  double ReversedCost(const uint32_t p, const uint32_t q) const {
+    return (backward_[q] - backward_[p]) - (forward_[q] - forward_[p]);
+  }
+
+  // Make a location and the locations next to it in the tour active
+  void Activate(const uint32_t position);
+
+  // Run moves until none of the active locations improve the tour
+  void LocalSearch();
+
+  // Try the moves that connect a location to its neighbors, returns true
+  // if the tour was improved
+  bool ImproveLocation(const uint32_t location);
+
+  // Try to reverse the tour between positions p and q
+  bool TwoOpt(const uint32_t p, const uint32_t q);
+
+  // Try to move the run between positions p and q after position i
+  bool OrOpt(const uint32_t p, const uint32_t q, const uint32_t i);
+
+  // Exchange two random parts of the tour (double bridge)
+  void Perturb();
+};
+
 }
 }
 
@@ -68,6 +68,30 @@ class PathAlgorithm {
     interrupt = interrupt_callback;
   }
 
+  /**
+   * Do edge costs near a location depend on the time. They do when the
+   * location has a date and time, the costing uses speed profiles and the
+   * tiles of the location have speed profiles. Profiles are built for whole
+   * regions, so a location in tiles without them means the route has none.
+   * @param  location     Location.
+   * @param  costing      Costing method.
+   * @param  graphreader  Graph reader for accessing routing graph.
+   * @return Returns true if the location edges should be costed at a time.
+   */
+  static bool IsTimeDependent(const baldr::PathLocation& location,
+          const sif::DynamicCost& costing, baldr::GraphReader& graphreader) {
+    if (!location.date_time_ || !costing.UsesSpeedProfiles()) {
+      return false;
+    }
+    for (const auto& edge : location.edges) {
+      const baldr::GraphTile* tile = graphreader.GetGraphTile(edge.id);
+      if (tile != nullptr && tile->has_speed_profiles()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
  protected:
   const std::function<void()>* interrupt;
 };
@@ -0,0 +1,79 @@
+#ifndef VALHALLA_THOR_PHASERUNNER_H_
+#define VALHALLA_THOR_PHASERUNNER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace valhalla {
+namespace thor {
+
+/**
+ * Runs phases of independent work items on the calling thread and a set of
+ * worker threads that live as long as the runner. Items are handed out one
+ * at a time so uneven items balance across the threads, and Run returns once
+ * every item of the phase is done. This suits searches that advance many
+ * locations in lock step where each phase is short: the threads are started
+ * once instead of once per phase.
+ */
+class PhaseRunner {
+ public:
+  // Work for an item: the index of the item and the thread running it
+  // (0 is the calling thread, worker threads are numbered from 1)
+  using work_t = std::function<void (const uint32_t index, const uint32_t thread)>;
+
+  /**
+   * Constructor.
+   * @param  thread_count  Number of threads including the calling thread.
+   */
+  explicit PhaseRunner(const uint32_t thread_count);
+
+  /**
+   * Destructor. Stops and joins the worker threads.
+   */
+  ~PhaseRunner();
+
+  /**
+   * Get the number of threads including the calling thread.
+   */
+  uint32_t thread_count() const;
+
+  /**
+   * Run a phase. The first exception thrown by an item is rethrown once
+   * all of the threads are done with the phase.
+   * @param  count  Number of items.
+   * @param  work   Work for each item, called concurrently for different
+   *                items.
+   */
+  void Run(const uint32_t count, const work_t& work);
+
+ protected:
+  // Worker thread loop, waits for a phase and helps finish it
+  void Work(const uint32_t thread);
+
+  // Run items of the current phase until there are none left
+  void RunItems(const uint32_t thread);
+
+  std::vector<std::thread> threads_;
+
+  // Current phase
+  const work_t* work_;
+  uint32_t count_;
+  std::atomic<uint32_t> next_;
+  std::atomic<uint32_t> finished_;
+  std::atomic<uint32_t> phase_;
+  std::atomic<bool> stop_;
+
+  // First error of the current phase
+  std::mutex error_lock_;
+  std::exception_ptr error_;
+};
+
+}
+}
+
+#endif  // VALHALLA_THOR_PHASERUNNER_H_
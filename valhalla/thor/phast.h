@@ -0,0 +1,164 @@
+#ifndef VALHALLA_THOR_PHAST_H_
+#define VALHALLA_THOR_PHAST_H_
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <valhalla/baldr/contractionhierarchy.h>
+#include <valhalla/baldr/graphreader.h>
+#include <valhalla/baldr/pathlocation.h>
+#include <valhalla/sif/dynamiccost.h>
+#include <valhalla/thor/costmatrix.h>
+
+namespace valhalla {
+namespace thor {
+
+/**
+ * One to all searches over a contraction hierarchy (PHAST). A search runs
+ * a small upward search from the origin and then sweeps all vertices once
+ * in descending rank, relaxing the downward arcs into each vertex. The
+ * sweep reads a flat array of arcs in the order it needs them, so its cost
+ * is a linear pass over memory rather than a priority queue. The sweep can
+ * be restricted to the vertices that lead down to a set of targets
+ * (RPHAST), which makes it cheap enough to run for every source of a
+ * matrix. A sweep is not changed by searches, so threads can share one.
+ */
+class Phast {
+ public:
+  // Cost, elapsed time and length to reach a vertex
+  struct Label {
+    float cost;
+    float secs;
+    float length;
+  };
+
+  // A vertex a search starts from with what it already took to reach it
+  struct Seed {
+    uint32_t vertex;
+    Label label;
+  };
+
+  /**
+   * Constructor. Sweeps all vertices of the hierarchy.
+   * @param  hierarchy  Contraction hierarchy.
+   */
+  explicit Phast(const std::shared_ptr<const baldr::ContractionHierarchy>& hierarchy);
+
+  /**
+   * Constructor. Sweeps only the vertices needed to reach the targets.
+   * @param  hierarchy  Contraction hierarchy.
+   * @param  targets    Vertices the searches need to reach.
+   */
+  Phast(const std::shared_ptr<const baldr::ContractionHierarchy>& hierarchy,
+        const std::vector<uint32_t>& targets);
+
+  /**
+   * Get the hierarchy the sweep is over.
+   */
+  const baldr::ContractionHierarchy& hierarchy() const;
+
+  /**
+   * Get the number of vertices the sweep reaches.
+   */
+  uint32_t size() const;
+
+  /**
+   * Get the vertex at a position of the sweep.
+   * @param  index  Position within the sweep.
+   */
+  uint32_t vertex(const uint32_t index) const;
+
+  /**
+   * Get the position of a vertex within the sweep.
+   * @param  vertex  Vertex.
+   * @return Returns the position or kInvalidVertex if the sweep does not
+   *         reach the vertex.
+   */
+  uint32_t index(const uint32_t vertex) const;
+
+  /**
+   * Search from the seeds to all vertices of the sweep.
+   * @param  seeds   Vertices to start from.
+   * @param  labels  Set to the label of each position of the sweep, the
+   *                 cost is kMaxCost where the vertex cannot be reached.
+   */
+  void Search(const std::vector<Seed>& seeds, std::vector<Label>& labels) const;
+
+  /**
+   * Get a sweep over the same hierarchy restricted to the vertices needed
+   * to reach the targets.
+   * @param  targets    Vertices the searches need to reach.
+   */
+  Phast Restrict(const std::vector<uint32_t>& targets) const;
+
+ protected:
+  // Downward arc into a vertex from the vertex at a position of the sweep
+  struct SweepArc {
+    uint32_t source;
+    float cost;
+    float secs;
+    uint32_t length;
+  };
+
+  // Lay out the arcs of the sweep once the vertices are in place
+  void BuildArcs();
+
+  std::shared_ptr<const baldr::ContractionHierarchy> hierarchy_;
+
+  // Vertices in descending rank, and the position of each vertex when
+  // only some are swept
+  std::vector<uint32_t> vertices_;
+  std::unordered_map<uint32_t, uint32_t> positions_;
+  bool restricted_;
+
+  // Arcs into each position of the sweep
+  std::vector<uint64_t> offsets_;
+  std::vector<SweepArc> arcs_;
+};
+
+/**
+ * Time and distance matrix over a contraction hierarchy. The sweep is
+ * restricted to the targets and each source is a search over it, spread
+ * over a number of threads.
+ */
+class PhastMatrix {
+ public:
+  /**
+   * Constructor.
+   * @param  hierarchy     Contraction hierarchy.
+   * @param  thread_count  Number of threads including the calling thread.
+   */
+  PhastMatrix(const std::shared_ptr<const baldr::ContractionHierarchy>& hierarchy,
+              const uint32_t thread_count);
+
+  /**
+   * Time and distance from each source to each target.
+   * @param  source_location_list  List of source/origin locations.
+   * @param  target_location_list  List of target/destination locations.
+   * @param  graphreader           Graph reader for accessing routing graph.
+   * @param  mode_costing          Costing methods.
+   * @param  mode                  Travel mode to use.
+   * @param  max_matrix_distance   Maximum distance (meters) of a path, pairs
+   *                               further apart have no path.
+   * @return time/distance from each source to each target (source major).
+   */
+  std::vector<TimeDistance> SourceToTarget(
+          const std::vector<baldr::PathLocation>& source_location_list,
+          const std::vector<baldr::PathLocation>& target_location_list,
+          baldr::GraphReader& graphreader,
+          const std::shared_ptr<sif::DynamicCost>* mode_costing,
+          const sif::TravelMode mode,
+          const float max_matrix_distance);
+
+ protected:
+  std::shared_ptr<const baldr::ContractionHierarchy> hierarchy_;
+  uint32_t thread_count_;
+};
+
+}
+}
+
+#endif  // VALHALLA_THOR_PHAST_H_
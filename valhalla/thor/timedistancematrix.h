@@ -60,6 +60,16 @@ class TimeDistanceMatrix {
    */
   TimeDistanceMatrix();
 
+  /**
+   * Constructor with worker threads. A worker thread is started for each of
+   * the graph readers (the readers must not be used by anything else while
+   * a matrix is computed), the calling thread uses the reader passed in.
+   * The one to many (or many to one) searches of SourceToTarget are then
+   * spread across the threads.
+   * @param  worker_readers  Graph readers for the worker threads.
+   */
+  TimeDistanceMatrix(const std::vector<std::shared_ptr<baldr::GraphReader>>& worker_readers);
+
   /**
    * One to many time and distance cost matrix. Computes time and distance
    * matrix from one origin location to many other locations.
@@ -162,6 +172,9 @@ class TimeDistanceMatrix {
 
   sif::TravelMode mode_;
 
+  // Graph readers of the worker threads
+  std::vector<std::shared_ptr<baldr::GraphReader>> worker_readers_;
+
   /**
    * Get the cost threshold based on the current mode and the max arc-length distance
    * for that mode.
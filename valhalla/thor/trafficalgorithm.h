@@ -9,6 +9,7 @@
 #include <memory>
 
 #include <valhalla/thor/astar.h>
+#include <valhalla/thor/trafficspeeds.h>
 
 namespace valhalla {
 namespace thor {
@@ -49,18 +50,27 @@ public:
            const std::shared_ptr<sif::DynamicCost>* mode_costing,
            const sif::TravelMode mode);
 
+  /**
+   * Clear the temporary information generated during path construction
+   * and let go of the real-time speeds used by the last route.
+   */
+  virtual void Clear();
 
 protected:
-  // Map of real-time speeds
-  std::unordered_map<uint32_t, std::vector<uint8_t>> real_time_speeds_;
-  std::vector<uint8_t> empty_speeds_;
+  // Real-time speeds shared by the process and the generation of them
+  // pinned for the current route
+  std::shared_ptr<TrafficSpeeds> traffic_;
+  std::shared_ptr<const TrafficSpeeds::Generation> speeds_;
+
+  // Speeds of the tiles used by the current route. Saves going through
+  // the shared generation for every node expanded.
+  std::unordered_map<uint32_t, const TrafficSpeeds::speeds_t*> tile_speeds_;
 
   /**
-   * Get address of the real-time speed table for the specified tile.
-   * Loads the speeds if they are not yet loaded.
+   * Get the real-time speeds for the specified tile. Maps the speeds if they
+   * are not yet mapped.
    */
-  std::vector<uint8_t>& GetRealTimeSpeeds(const uint32_t tileid,
-                                          baldr::GraphReader& graphreader);
+  const TrafficSpeeds::speeds_t& GetRealTimeSpeeds(const uint32_t tileid);
 };
 
 }
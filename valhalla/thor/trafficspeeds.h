@@ -0,0 +1,157 @@
+#ifndef VALHALLA_THOR_TRAFFICSPEEDS_H_
+#define VALHALLA_THOR_TRAFFICSPEEDS_H_
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <sys/types.h>
+
+#include <valhalla/midgard/sequence.h>
+
+namespace valhalla {
+namespace thor {
+
+/**
+ * Real-time speed tiles shared by all traffic path algorithms in the
+ * process. A speed file holds one byte per directed edge in the tile (speed
+ * in kph, 0 if there is no real-time speed for the edge). Files are read the
+ * first time a tile is used.
+ *
+ * Speeds are published in generations so they can be updated atomically:
+ * write a complete set of speed files to <tile_dir>/traffic/<name>/ and then
+ * rename a file containing <name> over <tile_dir>/traffic/generation. The
+ * files of a generation must never be modified once published, so they are
+ * memory mapped read only and the page cache holds the only copy of the
+ * speeds no matter how many workers use them. Routes pin the generation that
+ * was current when they started, the prior generation is unmapped once the
+ * last route using it lets go of it.
+ *
+ * If there is no generation file speed files are read from
+ * <tile_dir>/traffic/. Those may be rewritten in place at any time so they
+ * are copied into memory instead, and a new copy is made for later routes
+ * once any of the files that were read change. Checking them means a stat
+ * per file, so they are checked at most once per legacy check interval.
+ */
+class TrafficSpeeds {
+ public:
+  /**
+   * Speeds of a tile, empty if the tile has no speeds. Mapped from a
+   * published generation or copied from a legacy speed file.
+   */
+  class speeds_t {
+   public:
+    speeds_t();
+    speeds_t(const std::string& fname, const size_t size, const bool map);
+
+    size_t size() const;
+    const uint8_t* get() const;
+
+   private:
+    midgard::mem_map<uint8_t> mapped_;
+    std::vector<uint8_t> copied_;
+  };
+
+  /**
+   * One complete set of speed tiles. It is thread-safe.
+   */
+  class Generation {
+   public:
+    /**
+     * Constructor.
+     * @param  speeds_dir  Directory holding the <tileid>.spd files.
+     * @param  published   True if the files were published as a generation
+     *                     and so never change (they can be mapped).
+     */
+    Generation(const std::string& speeds_dir, const bool published);
+
+    /**
+     * Get the speeds for the specified tile, mapping them if this is the
+     * first time the tile is used. The speeds stay valid for the lifetime of
+     * the generation.
+     * @param  tileid  Tile Id.
+     * @return  Returns the speeds (empty if the tile has no speeds).
+     */
+    const speeds_t& GetSpeeds(const uint32_t tileid) const;
+
+    /**
+     * Get the directory the speeds of this generation are read from.
+     */
+    const std::string& speeds_dir() const;
+
+    /**
+     * Check whether any speed file this generation has read (or found
+     * missing) has changed since. Published generations never change.
+     */
+    bool Changed() const;
+
+   private:
+    // Identity of a speed file when it was read, all 0 if it was missing
+    struct file_id_t {
+      ino_t inode;
+      time_t mtime;
+      long mtime_nsec;
+      off_t size;
+    };
+    static file_id_t file_id(const std::string& fname);
+
+    std::string speeds_dir_;
+    bool published_;
+    mutable std::mutex lock_;
+    mutable std::unordered_map<uint32_t, std::unique_ptr<speeds_t>> tiles_;
+    mutable std::unordered_map<uint32_t, file_id_t> files_;
+  };
+
+  /**
+   * Constructor.
+   * @param  tile_dir     Base tile directory, speeds live under its traffic
+   *                      subdirectory.
+   * @param  check_secs   Seconds between checks of the legacy speed files
+   *                      for changes.
+   */
+  TrafficSpeeds(const std::string& tile_dir,
+                const uint32_t check_secs = kLegacyCheckSecs);
+
+  // Default seconds between checks of the legacy speed files
+  static constexpr uint32_t kLegacyCheckSecs = 5;
+
+  /**
+   * Get the speeds store for the specified tile directory. There is one
+   * store per tile directory for the whole process.
+   * @param  tile_dir  Base tile directory.
+   */
+  static std::shared_ptr<TrafficSpeeds> get_instance(const std::string& tile_dir);
+
+  /**
+   * Get the current generation of speeds, switching over to a generation
+   * that has been published since the last call (or to a fresh copy of the
+   * legacy speed files if they changed). Hold on to it for the duration of a
+   * route so the route sees one consistent set of speeds.
+   * @return  Returns the current generation.
+   */
+  std::shared_ptr<const Generation> Current();
+
+ private:
+  std::string traffic_dir_;
+  std::chrono::steady_clock::duration check_interval_;
+
+  // Current generation and the identity of the generation file it was
+  // loaded from (all 0 when there was no generation file)
+  std::mutex lock_;
+  std::shared_ptr<const Generation> current_;
+  ino_t inode_;
+  time_t mtime_;
+  long mtime_nsec_;
+
+  // When the legacy speed files are next checked for changes
+  std::chrono::steady_clock::time_point next_check_;
+};
+
+}
+}
+
+#endif  // VALHALLA_THOR_TRAFFICSPEEDS_H_
@@ -2,6 +2,10 @@
 #define __VALHALLA_THOR_SERVICE_H__
 
 #include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <utility>
 
@@ -18,13 +22,16 @@
 #include <valhalla/sif/edgelabel.h>
 #include <valhalla/thor/bidirectional_astar.h>
 #include <valhalla/thor/astar.h>
+#include <valhalla/thor/contractionpath.h>
 #include <valhalla/thor/match_result.h>
 #include <valhalla/thor/multimodal.h>
 #include <valhalla/thor/trippathbuilder.h>
 #include <valhalla/thor/attributes_controller.h>
 #include <valhalla/thor/isochrone.h>
+#include <valhalla/thor/phast.h>
 #include <valhalla/meili/map_matcher_factory.h>
 #include <valhalla/proto/trippath.pb.h>
+#include <valhalla/proto/request.pb.h>
 #include <valhalla/tyr/actor.h>
 
 namespace valhalla {
@@ -44,7 +51,12 @@ class thor_worker_t : public service_worker_t{
   enum SOURCE_TO_TARGET_ALGORITHM {
     SELECT_OPTIMAL = 0,
     COST_MATRIX = 1,
-    TIME_DISTANCE_MATRIX = 2
+    TIME_DISTANCE_MATRIX = 2,
+    PHAST = 3
+  };
+  enum TOUR_ALGORITHM {
+    ANNEALING = 0,
+    LOCAL_SEARCH = 1
   };
   static const std::unordered_map<std::string, SHAPE_MATCH> STRING_TO_MATCH;
   thor_worker_t(const boost::property_tree::ptree& config);
@@ -56,7 +68,7 @@ class thor_worker_t : public service_worker_t{
 
   std::list<odin::TripPath> route(const boost::property_tree::ptree& request,
              const boost::optional<int> &date_time_type);
-  baldr::json::MapPtr matrix(tyr::ACTION_TYPE matrix_type, const boost::property_tree::ptree& request);
+  std::string matrix(tyr::ACTION_TYPE matrix_type, const boost::property_tree::ptree& request);
   std::list<odin::TripPath> optimized_route(const boost::property_tree::ptree& request);
   baldr::json::MapPtr isochrones(const boost::property_tree::ptree& request);
   odin::TripPath trace_route(const boost::property_tree::ptree& request);
@@ -66,6 +78,10 @@ class thor_worker_t : public service_worker_t{
 
   std::vector<thor::PathInfo> get_path(PathAlgorithm* path_algorithm, baldr::PathLocation& origin,
                 baldr::PathLocation& destination);
+  bool can_route_legs_concurrently(const std::string& costing,
+      const std::vector<baldr::PathLocation>& correlated);
+  std::vector<std::vector<thor::PathInfo>> get_leg_paths(const std::string& costing,
+      std::vector<baldr::PathLocation>& correlated);
   void log_admin(odin::TripPath&);
   valhalla::sif::cost_ptr_t get_costing(
       const boost::property_tree::ptree& request, const std::string& costing);
@@ -94,19 +110,45 @@ class thor_worker_t : public service_worker_t{
   std::vector<baldr::PathLocation> correlated;
   std::vector<baldr::PathLocation> correlated_s;
   std::vector<baldr::PathLocation> correlated_t;
+  // Envelope of the request from loki, holds the correlated locations
+  Request envelope;
   sif::CostFactory<sif::DynamicCost> factory;
   valhalla::sif::cost_ptr_t mode_costing[static_cast<int>(sif::TravelMode::kMaxTravelMode)];
+  // Costing options of the request, to make costing for other threads
+  boost::property_tree::ptree costing_options;
   // Path algorithms (TODO - perhaps use a map?))
   AStarPathAlgorithm astar;
   BidirectionalAStar bidir_astar;
   MultiModalPathAlgorithm multi_modal_astar;
+  ContractionPathAlgorithm contraction;
+  std::shared_ptr<const baldr::ContractionHierarchy> contraction_hierarchy;
+  // Can the request use the contraction hierarchy (default auto costing)
+  bool use_contraction;
   Isochrone isochrone_gen;
+  // Sweep over the whole hierarchy for isochrones, if configured
+  std::shared_ptr<const Phast> isochrone_sweep;
   float long_request;
   std::unordered_map<std::string, float> max_matrix_distance;
   SOURCE_TO_TARGET_ALGORITHM source_to_target_algorithm;
+  TOUR_ALGORITHM tour_algorithm;
   boost::optional<int> date_time_type;
   valhalla::meili::MapMatcherFactory matcher_factory;
   valhalla::baldr::GraphReader& reader;
+  // Graph readers for the extra threads used to compute matrices and legs
+  std::vector<std::shared_ptr<valhalla::baldr::GraphReader>> matrix_readers;
+  // Path algorithms and costing of each thread routing the legs of a route
+  struct leg_searcher_t {
+    AStarPathAlgorithm astar;
+    BidirectionalAStar bidir_astar;
+    ContractionPathAlgorithm contraction;
+    valhalla::sif::cost_ptr_t mode_costing[static_cast<int>(sif::TravelMode::kMaxTravelMode)];
+  };
+  std::vector<std::unique_ptr<leg_searcher_t>> leg_searchers;
+  // Interrupt shared by the leg searchers. Checks the request interrupt one
+  // thread at a time and, once it has fired, throws on every thread
+  std::function<void ()> leg_interrupt;
+  std::mutex leg_interrupt_lock;
+  std::exception_ptr leg_interruption;
   std::unordered_set<std::string> trace_customizable;
   boost::property_tree::ptree trace_config;
 
@@ -8,6 +8,7 @@
 
 #include <valhalla/worker.h>
 #include <valhalla/proto/tripdirections.pb.h>
+#include <valhalla/proto/directions_options.pb.h>
 #include <valhalla/proto/route.pb.h>
 #include <valhalla/tyr/actor.h>
 
@@ -16,6 +17,16 @@ namespace valhalla {
 
     baldr::json::MapPtr serializeDirections(ACTION_TYPE action, const boost::property_tree::ptree& request, const std::list<odin::TripDirections>& directions_legs);
 
+    /**
+     * Serializes the narrated legs given the already parsed request options.
+     * @param action              Action of the request (viaroute is osrm compatible)
+     * @param id                  Request id to echo back
+     * @param directions_options  Directions options of the request
+     * @param directions_legs     Narrated legs
+     */
+    baldr::json::MapPtr serializeDirections(ACTION_TYPE action, const boost::optional<std::string>& id,
+        const odin::DirectionsOptions& directions_options, const std::list<odin::TripDirections>& directions_legs);
+
     /**
      * Transfers the JSON route information returned from a route request into
      * the Route proto object passed in by reference.
@@ -25,6 +25,7 @@ namespace valhalla {
   worker_t::result_t jsonify_error(const valhalla_exception_t& exception, http_request_info_t& request_info, const boost::optional<std::string>& jsonp = boost::none);
   worker_t::result_t to_response(baldr::json::ArrayPtr array, const boost::optional<std::string>& jsonp, http_request_info_t& request_info);
   worker_t::result_t to_response(baldr::json::MapPtr map, const boost::optional<std::string>& jsonp, http_request_info_t& request_info);
+  worker_t::result_t to_response(const std::string& json, const boost::optional<std::string>& jsonp, http_request_info_t& request_info);
 #endif
 
   class service_worker_t {